@@ -149,6 +149,9 @@ checkandset_dependency(qpOASES)
 find_package(Catch2 QUIET)
 checkandset_dependency(Catch2)
 
+find_package(PythonInterp 3 QUIET)
+checkandset_dependency(PythonInterp)
+
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_tests "Compile tests?" ON WALKING_CONTROLLERS_HAS_Catch2 OFF)
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_YarpUtilities "Compile YarpHelper library?" ON WALKING_CONTROLLERS_HAS_YARP OFF)
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_iDynTreeUtilities "Compile iDynTreeHelper library?" ON "WALKING_CONTROLLERS_HAS_iDynTree;WALKING_CONTROLLERS_HAS_YARP;WALKING_CONTROLLERS_HAS_Eigen3" OFF)
@@ -161,6 +164,8 @@ walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_TrajectoryPlann
                                     "WALKING_CONTROLLERS_HAS_Threads;WALKING_CONTROLLERS_COMPILE_YarpUtilities;WALKING_CONTROLLERS_HAS_ICUB;WALKING_CONTROLLERS_HAS_UnicyclePlanner;WALKING_CONTROLLERS_HAS_Eigen3" OFF)
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_KinDynWrapper "Compile KinDynWrapper library?" ON
                                     "WALKING_CONTROLLERS_HAS_iDynTree;WALKING_CONTROLLERS_COMPILE_YarpUtilities;WALKING_CONTROLLERS_HAS_ICUB;WALKING_CONTROLLERS_HAS_Eigen3" OFF)
+walking_controllers_dependent_option(WALKING_CONTROLLERS_GENERATE_KINEMATICS_KERNEL "Generate the kinematics kernel of the robot from its URDF?" OFF
+                                    "WALKING_CONTROLLERS_COMPILE_KinDynWrapper;WALKING_CONTROLLERS_HAS_PythonInterp" OFF)
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_RetargetingHelper "Compile RetargetingHelper library?" ON
                                     "WALKING_CONTROLLERS_HAS_iDynTree;WALKING_CONTROLLERS_COMPILE_YarpUtilities;WALKING_CONTROLLERS_HAS_ICUB;WALKING_CONTROLLERS_HAS_Eigen3" OFF)
 walking_controllers_dependent_option(WALKING_CONTROLLERS_COMPILE_LoggerClient "Compile LoggerClient library?" ON WALKING_CONTROLLERS_COMPILE_YarpUtilities OFF)
@@ -0,0 +1,199 @@
+/**
+ * @file GeneratedKinematics.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_KINDYN_WRAPPER_GENERATED_KINEMATICS_H
+#define WALKING_CONTROLLERS_KINDYN_WRAPPER_GENERATED_KINEMATICS_H
+
+// std
+#include <array>
+#include <string>
+
+// Eigen
+#include <Eigen/Dense>
+
+#include <WalkingControllers/KinDynWrapper/KinematicsBackend.h>
+
+namespace WalkingControllers
+{
+
+    /**
+     * GeneratedKinematics implements the KinematicsBackend using a kernel generated from the URDF
+     * of the robot (see scripts/generate_kinematics_kernel.py). The kernel evaluates the pose of all
+     * the frames and the axis of all the joints w.r.t. the root frame of the model. All the
+     * quantities have a size known at compile time, hence no memory is allocated after the
+     * construction.
+     * The jacobian of a frame F w.r.t. a generic floating base B is obtained from the quantities
+     * evaluated in the root frame: the column of the j-th joint is multiplied by
+     * (s_F(j) - s_B(j)) where s_X(j) is 1 if the joint belongs to the path between the root and X.
+     * @tparam Kernel generated kinematics kernel.
+     */
+    template<class Kernel>
+    class GeneratedKinematics : public KinematicsBackend
+    {
+        static constexpr int DoFs = Kernel::numberOfDOFs;
+        static constexpr int Frames = Kernel::numberOfFrames;
+
+        std::array<Eigen::Matrix3d, Frames> m_rootRotations; /**< Rotation of each frame w.r.t. the root frame. */
+        std::array<Eigen::Vector3d, Frames> m_rootPositions; /**< Position of each frame in the root frame. */
+        Eigen::Matrix<double, 3, DoFs> m_rootAxes; /**< Axis of each joint expressed in the root frame. */
+        Eigen::Matrix<double, 3, DoFs> m_rootOrigins; /**< Origin of each joint expressed in the root frame. */
+
+        std::array<Eigen::Matrix3d, Frames> m_rotations; /**< Rotation of each frame w.r.t. the world. */
+        std::array<Eigen::Vector3d, Frames> m_positions; /**< Position of each frame in the world. */
+        Eigen::Matrix<double, 3, DoFs> m_axes; /**< Axis of each joint expressed in the world frame. */
+        Eigen::Matrix<double, 3, DoFs> m_linearTerms; /**< Velocity of the world origin due to each joint (origin x axis). */
+
+        Eigen::Matrix<double, Frames, DoFs> m_support; /**< 1 if the joint is in the path between the root and the frame, 0 otherwise. */
+        Eigen::Matrix<double, 1, Frames> m_masses; /**< Mass of each frame. */
+        Eigen::Matrix<double, 3, Frames> m_localCoMs; /**< Position of the CoM of each frame expressed in the frame. */
+        Eigen::Matrix<double, 3, Frames> m_firstMoments; /**< Mass times the CoM position of each frame. */
+        Eigen::Matrix<double, 1, DoFs> m_subtreeMasses; /**< Mass of the subtree moved by each joint. */
+        Eigen::Matrix<double, 3, DoFs> m_subtreeFirstMoments; /**< First moment of the subtree moved by each joint. */
+        Eigen::Vector3d m_firstMoment; /**< First moment of the whole robot. */
+        double m_totalMass; /**< Total mass of the robot. */
+
+        int m_baseFrameIndex{0}; /**< Index of the floating base frame. */
+
+    public:
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /**
+         * Constructor.
+         */
+        GeneratedKinematics()
+        {
+            for(int frame = 0; frame < Frames; frame++)
+            {
+                m_masses(frame) = Kernel::frameMass(frame);
+                m_localCoMs.col(frame) = Kernel::frameCoM(frame);
+                for(int dof = 0; dof < DoFs; dof++)
+                    m_support(frame, dof) = Kernel::isSupportedBy(frame, dof) ? 1.0 : 0.0;
+            }
+
+            m_totalMass = m_masses.sum();
+            m_subtreeMasses.noalias() = m_masses * m_support;
+
+            setRobotState(0, Eigen::Matrix3d::Identity(), Eigen::Vector3d::Zero(),
+                          Eigen::VectorXd::Zero(DoFs));
+        }
+
+        int getNrOfDOFs() const override
+        {
+            return DoFs;
+        }
+
+        std::string getJointName(const int& index) const override
+        {
+            return Kernel::jointName(index);
+        }
+
+        int getFrameIndex(const std::string& frameName) const override
+        {
+            for(int frame = 0; frame < Frames; frame++)
+                if(frameName == Kernel::frameName(frame))
+                    return frame;
+
+            return -1;
+        }
+
+        void setRobotState(const int& baseFrameIndex,
+                           const Eigen::Ref<const Eigen::Matrix3d>& worldToBaseRotation,
+                           const Eigen::Ref<const Eigen::Vector3d>& worldToBasePosition,
+                           const Eigen::Ref<const Eigen::VectorXd>& jointPositions) override
+        {
+            m_baseFrameIndex = baseFrameIndex;
+            Kernel::evaluate(jointPositions, m_rootRotations, m_rootPositions, m_rootAxes, m_rootOrigins);
+
+            // world_H_root = world_H_base * base_H_root
+            const Eigen::Matrix3d worldToRootRotation = worldToBaseRotation
+                * m_rootRotations[baseFrameIndex].transpose();
+            const Eigen::Vector3d worldToRootPosition = worldToBasePosition
+                - worldToRootRotation * m_rootPositions[baseFrameIndex];
+
+            for(int frame = 0; frame < Frames; frame++)
+            {
+                m_rotations[frame].noalias() = worldToRootRotation * m_rootRotations[frame];
+                m_positions[frame] = worldToRootPosition;
+                m_positions[frame].noalias() += worldToRootRotation * m_rootPositions[frame];
+
+                m_firstMoments.col(frame) = m_positions[frame];
+                m_firstMoments.col(frame).noalias() += m_rotations[frame] * m_localCoMs.col(frame);
+                m_firstMoments.col(frame) *= m_masses(frame);
+            }
+
+            m_axes.noalias() = worldToRootRotation * m_rootAxes;
+            for(int dof = 0; dof < DoFs; dof++)
+            {
+                const Eigen::Vector3d origin = worldToRootPosition + worldToRootRotation * m_rootOrigins.col(dof);
+                m_linearTerms.col(dof) = origin.cross(m_axes.col(dof));
+            }
+
+            m_firstMoment = m_firstMoments.rowwise().sum();
+            m_subtreeFirstMoments.noalias() = m_firstMoments * m_support;
+        }
+
+        void getWorldTransform(const int& frameIndex,
+                               Eigen::Ref<Eigen::Matrix3d> rotation,
+                               Eigen::Ref<Eigen::Vector3d> position) const override
+        {
+            rotation = m_rotations[frameIndex];
+            position = m_positions[frameIndex];
+        }
+
+        void getFrameJacobian(const int& frameIndex, Eigen::Ref<RowMajorMatrix> jacobian) const override
+        {
+            const Eigen::Vector3d& framePosition = m_positions[frameIndex];
+            const Eigen::Vector3d& basePosition = m_positions[m_baseFrameIndex];
+
+            jacobian.template leftCols<6>().setZero();
+            jacobian.template block<3, 3>(0, 0).setIdentity();
+            jacobian.template block<3, 3>(3, 3).setIdentity();
+            jacobian.template block<3, 3>(0, 3) << 0, -(basePosition(2) - framePosition(2)), basePosition(1) - framePosition(1),
+                basePosition(2) - framePosition(2), 0, -(basePosition(0) - framePosition(0)),
+                -(basePosition(1) - framePosition(1)), basePosition(0) - framePosition(0), 0;
+
+            for(int dof = 0; dof < DoFs; dof++)
+            {
+                const double coefficient = m_support(frameIndex, dof) - m_support(m_baseFrameIndex, dof);
+                jacobian.template block<3, 1>(0, 6 + dof) = coefficient
+                    * (m_linearTerms.col(dof) + m_axes.col(dof).cross(framePosition));
+                jacobian.template block<3, 1>(3, 6 + dof) = coefficient * m_axes.col(dof);
+            }
+        }
+
+        void getCoMPosition(Eigen::Ref<Eigen::Vector3d> position) const override
+        {
+            position = m_firstMoment / m_totalMass;
+        }
+
+        void getCoMJacobian(Eigen::Ref<RowMajorMatrix> jacobian) const override
+        {
+            const Eigen::Vector3d comPosition = m_firstMoment / m_totalMass;
+            const Eigen::Vector3d& basePosition = m_positions[m_baseFrameIndex];
+
+            jacobian.template block<3, 3>(0, 0).setIdentity();
+            jacobian.template block<3, 3>(0, 3) << 0, -(basePosition(2) - comPosition(2)), basePosition(1) - comPosition(1),
+                basePosition(2) - comPosition(2), 0, -(basePosition(0) - comPosition(0)),
+                -(basePosition(1) - comPosition(1)), basePosition(0) - comPosition(0), 0;
+
+            // the joints in the path between the root and the base move the rest of the robot
+            // in the opposite direction
+            for(int dof = 0; dof < DoFs; dof++)
+            {
+                const double isBaseSupport = m_support(m_baseFrameIndex, dof);
+                const double movedMass = m_subtreeMasses(dof) - isBaseSupport * m_totalMass;
+                const Eigen::Vector3d movedFirstMoment = m_subtreeFirstMoments.col(dof) - isBaseSupport * m_firstMoment;
+                jacobian.template block<3, 1>(0, 6 + dof) = (movedMass * m_linearTerms.col(dof)
+                                                             + m_axes.col(dof).cross(movedFirstMoment)) / m_totalMass;
+            }
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file KinematicsBackend.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_KINDYN_WRAPPER_KINEMATICS_BACKEND_H
+#define WALKING_CONTROLLERS_KINDYN_WRAPPER_KINEMATICS_BACKEND_H
+
+// std
+#include <string>
+
+// Eigen
+#include <Eigen/Dense>
+
+namespace WalkingControllers
+{
+
+    /**
+     * KinematicsBackend is the interface of the forward kinematics evaluated by WalkingFK in place
+     * of iDynTree::KinDynComputations. All the jacobians are expressed with the mixed representation
+     * and the columns are ordered as [base (6); joints].
+     */
+    class KinematicsBackend
+    {
+    public:
+
+        using RowMajorMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+        /**
+         * Destructor.
+         */
+        virtual ~KinematicsBackend() = default;
+
+        /**
+         * Get the number of DoFs considered by the backend.
+         * @return the number of DoFs.
+         */
+        virtual int getNrOfDOFs() const = 0;
+
+        /**
+         * Get the name of a DoF.
+         * @param index index of the DoF.
+         * @return the name of the joint.
+         */
+        virtual std::string getJointName(const int& index) const = 0;
+
+        /**
+         * Get the index of a frame.
+         * @param frameName name of the frame.
+         * @return the index of the frame (-1 if the frame does not exist).
+         */
+        virtual int getFrameIndex(const std::string& frameName) const = 0;
+
+        /**
+         * Set the state of the robot and evaluate the forward kinematics.
+         * @param baseFrameIndex index of the frame used as floating base;
+         * @param worldToBaseRotation rotation between the base frame and the world;
+         * @param worldToBasePosition position of the base frame in the world;
+         * @param jointPositions joint positions in radians.
+         */
+        virtual void setRobotState(const int& baseFrameIndex,
+                                   const Eigen::Ref<const Eigen::Matrix3d>& worldToBaseRotation,
+                                   const Eigen::Ref<const Eigen::Vector3d>& worldToBasePosition,
+                                   const Eigen::Ref<const Eigen::VectorXd>& jointPositions) = 0;
+
+        /**
+         * Get the world to frame transformation.
+         * @param frameIndex index of the frame;
+         * @param rotation rotation between the frame and the world;
+         * @param position position of the frame in the world.
+         */
+        virtual void getWorldTransform(const int& frameIndex,
+                                       Eigen::Ref<Eigen::Matrix3d> rotation,
+                                       Eigen::Ref<Eigen::Vector3d> position) const = 0;
+
+        /**
+         * Get the jacobian of a frame.
+         * @param frameIndex index of the frame;
+         * @param jacobian jacobian of the frame (6 x (6 + DoFs)).
+         */
+        virtual void getFrameJacobian(const int& frameIndex, Eigen::Ref<RowMajorMatrix> jacobian) const = 0;
+
+        /**
+         * Get the position of the CoM in the world.
+         * @param position position of the CoM.
+         */
+        virtual void getCoMPosition(Eigen::Ref<Eigen::Vector3d> position) const = 0;
+
+        /**
+         * Get the jacobian of the CoM.
+         * @param jacobian jacobian of the CoM (3 x (6 + DoFs)).
+         */
+        virtual void getCoMJacobian(Eigen::Ref<RowMajorMatrix> jacobian) const = 0;
+    };
+};
+
+#endif
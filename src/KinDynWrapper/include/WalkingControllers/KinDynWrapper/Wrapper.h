@@ -10,7 +10,10 @@
 #define WALKING_CONTROLLERS_KINDYN_WRAPPER_WRAPPER_H
 
 // std
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 
 // YARP
 #include <yarp/os/Searchable.h>
@@ -18,18 +21,53 @@
 //iDynTree
 #include <iDynTree/KinDynComputations.h>
 #include <iDynTree/Model/FreeFloatingState.h>
+#include <iDynTree/Model/Traversal.h>
+
+// Eigen
+#include <Eigen/Dense>
 
 // iCub-ctrl
 #include <iCub/ctrl/filters.h>
 
-#include <unordered_map>
+#include <WalkingControllers/KinDynWrapper/KinematicsBackend.h>
 
 namespace WalkingControllers
 {
 
     class WalkingFK
     {
-        iDynTree::KinDynComputations m_kinDyn; /**< KinDynComputations solver. */
+        /**
+         * Transformation evaluated for the current state of the robot.
+         */
+        struct CachedTransform
+        {
+            iDynTree::Transform transform; /**< World to frame transformation. */
+            bool isValid{false}; /**< True if the transformation is related to the current state. */
+        };
+
+        /**
+         * Jacobian evaluated for the current state of the robot.
+         */
+        struct CachedJacobian
+        {
+            iDynTree::MatrixDynSize jacobian; /**< Jacobian matrix (mixed representation). */
+            bool isValid{false}; /**< True if the jacobian is related to the current state. */
+        };
+
+        /**
+         * Candidate floating base. It is resolved at initialization so that the floating base
+         * can be changed without looking for the link and recomputing the traversals.
+         */
+        struct BaseFrame
+        {
+            iDynTree::LinkIndex linkIndex{iDynTree::LINK_INVALID_INDEX}; /**< Index of the link used as floating base. */
+            iDynTree::Transform frameToLinkTransform; /**< Transformation between the base frame and its link. */
+            std::unique_ptr<iDynTree::KinDynComputations> kinDyn; /**< KinDynComputations solver whose floating base is the link. */
+            iDynTree::Traversal traversal; /**< Traversal of the model rooted in the link. */
+        };
+
+        iDynTree::KinDynComputations m_defaultKinDyn; /**< KinDynComputations solver with the default floating base of the model. */
+        iDynTree::KinDynComputations* m_kinDyn{nullptr}; /**< KinDynComputations solver related to the current floating base. */
 
         bool m_useExternalRobotBase; /**< is external estimator for the base of robot used? */
         iDynTree::FreeFloatingGeneralizedTorques m_generalizedBiasForces;
@@ -38,7 +76,6 @@ namespace WalkingControllers
         bool m_dcmEvaluated; /**< is the DCM evaluated? */
         bool m_comEvaluated; /**< is the CoM evaluated? */
 
-        iDynTree::FrameIndex m_frameBaseIndex;
         iDynTree::FrameIndex m_frameLeftIndex; /**< Index of the frame attached to the left foot in which all the left foot transformations are expressed. */
         iDynTree::FrameIndex m_frameRightIndex; /**< Index of the frame attached to the right foot in which all the right foot transformations are expressed. */
         iDynTree::FrameIndex m_frameRootIndex; /**< Index of the frame attached to the root_link. */
@@ -47,13 +84,10 @@ namespace WalkingControllers
         iDynTree::FrameIndex m_frameRightHandIndex; /**< Index of the frame attached to the right hand. */
         iDynTree::FrameIndex m_frameHeadIndex; /**< Index of the frame attached to the head. */
 
-        std::string m_baseFrameLeft; /**< Name of the left base frame. */
-        std::string m_baseFrameRight;  /**< Name of the right base frame. */
-
-        iDynTree::Transform m_frameHlinkLeft; /**< Transformation between the l_sole and the l_foot frame (l_ankle_2?!). */
-        iDynTree::Transform m_frameHlinkRight; /**< Transformation between the l_sole and the l_foot frame (l_ankle_2?!). */
         iDynTree::Transform m_worldToBaseTransform; /**< World to base transformation. */
-        std::unordered_map<std::string, std::pair<const std::string, const iDynTree::Transform>> m_baseFrames;/**< Transform related to the base frame */
+        BaseFrame m_leftFootBase; /**< Floating base used when the left foot is the stance foot. */
+        BaseFrame m_rightFootBase; /**< Floating base used when the right foot is the stance foot. */
+        BaseFrame m_rootBase; /**< Floating base used when the base is retrieved from external. */
         iDynTree::Twist m_baseTwist;/**< twist related to base frame */
 
         iDynTree::Position m_comPosition; /**< Position of the CoM. */
@@ -71,6 +105,42 @@ namespace WalkingControllers
 
         iDynTree::VectorDynSize m_jointPositions; /**< joint positions in radians. */
 
+        // batched evaluation of the task jacobians
+        iDynTree::LinkIndex m_baseLinkIndex; /**< Index of the link used as floating base. */
+        iDynTree::Traversal m_defaultTraversal; /**< Traversal of the model rooted in the default floating base. */
+        Eigen::VectorXd m_linkMasses; /**< Mass of each link. */
+        Eigen::Matrix3Xd m_linkCoMPositions; /**< Position of the CoM of each link expressed in the link frame (3 x links). */
+        double m_totalMass; /**< Total mass of the robot. */
+        Eigen::Matrix3Xd m_jointAxes; /**< Angular part of the motion subspace of each DoF expressed in the world frame (3 x DoFs). */
+        Eigen::Matrix3Xd m_jointLinearTerms; /**< Linear part of the motion subspace of each DoF (velocity of the world origin) (3 x DoFs). */
+        Eigen::VectorXd m_subtreeMasses; /**< Mass of the subtree of each link. */
+        Eigen::Matrix3Xd m_subtreeFirstMoments; /**< Sum of mass times CoM position of the subtree of each link (3 x links). */
+        bool m_motionSubspacesEvaluated{false}; /**< are the motion subspaces evaluated? */
+        const iDynTree::Traversal* m_traversal{nullptr}; /**< Traversal related to the current floating base. */
+
+        // per state cache. It is invalidated every time the state or the base of the robot changes
+        CachedTransform m_leftFootTransform; /**< Cached world_H_left_frame. */
+        CachedTransform m_rightFootTransform; /**< Cached world_H_right_frame. */
+        CachedTransform m_leftHandTransform; /**< Cached world_H_left_hand. */
+        CachedTransform m_rightHandTransform; /**< Cached world_H_right_hand. */
+        CachedTransform m_headTransform; /**< Cached world_H_head. */
+        CachedTransform m_rootLinkTransform; /**< Cached world_H_root_frame. */
+        CachedTransform m_neckTransform; /**< Cached world_H_neck. */
+        CachedJacobian m_leftFootJacobian; /**< Cached left foot jacobian. */
+        CachedJacobian m_rightFootJacobian; /**< Cached right foot jacobian. */
+        CachedJacobian m_leftHandJacobian; /**< Cached left hand jacobian. */
+        CachedJacobian m_rightHandJacobian; /**< Cached right hand jacobian. */
+        CachedJacobian m_neckJacobian; /**< Cached neck jacobian. */
+        CachedJacobian m_comJacobian; /**< Cached CoM jacobian. */
+        CachedJacobian m_rootLinkJacobian; /**< Cached root link jacobian (used only by the kinematics backend). */
+        std::size_t m_cacheHits{0}; /**< Number of quantities read from the cache. */
+        std::size_t m_cacheMisses{0}; /**< Number of quantities evaluated because not cached. */
+
+        // optional kinematics backend used in place of KinDynComputations
+        std::unique_ptr<KinematicsBackend> m_kinematicsBackend; /**< Kinematics backend (nullptr if KinDynComputations is used). */
+        std::vector<int> m_backendFrameIndices; /**< Index of each frame of the model in the backend (-1 if the frame does not exist). */
+        Eigen::VectorXd m_robotVelocity; /**< Base twist and joint velocities. */
+
         /**
          * Set the model of the robot.
          * @param model iDynTree model.
@@ -78,6 +148,21 @@ namespace WalkingControllers
          */
         bool setRobotModel(const iDynTree::Model& model);
 
+        /**
+         * Instantiate the kinematics backend.
+         * @param config config of the FK solver (kinematics_backend can be iDynTree or generated);
+         * @param model iDynTree model.
+         * @return true/false in case of success/failure.
+         */
+        bool setKinematicsBackend(const yarp::os::Searchable& config, const iDynTree::Model& model);
+
+        /**
+         * Check that a frame is available in the kinematics backend.
+         * @param frameIndex index of the frame in the model.
+         * @return true if the frame can be evaluated.
+         */
+        bool isFrameInKinematicsBackend(const iDynTree::FrameIndex& frameIndex) const;
+
         /**
          * Set The base frames.
          * @note: During the walking task the frame shift from the left to the right foot.
@@ -89,12 +174,92 @@ namespace WalkingControllers
         bool setBaseFrames(const std::string& lFootFrame, const std::string& rFootFrame);
 
         /**
-         * Set The base frames for enabling using Gazebo as a base estimator.
+         * Set the floating base. Only the pointers to the KinDynComputations object and to the
+         * traversal related to the base are changed.
+         * @note The state of the robot has to be set (setInternalRobotState()) after the floating
+         * base is changed.
+         * @param base the new floating base.
+         */
+        void setFloatingBase(const BaseFrame& base);
+
+        /**
+         * Invalidate all the quantities evaluated for the previous state of the robot.
+         */
+        void invalidateCache();
+
+        /**
+         * Get the world to frame transformation. It is evaluated only if it is not cached.
+         * @param frameIndex index of the frame;
+         * @param cache cached transformation related to the frame.
+         * @return world_H_frame.
+         */
+        const iDynTree::Transform& getCachedWorldTransform(const iDynTree::FrameIndex& frameIndex,
+                                                           CachedTransform& cache);
+
+        /**
+         * Evaluate the motion subspace of each DoF in the world frame and the mass properties
+         * of each subtree (one traversal of the kinematic tree).
+         */
+        void evaluateMotionSubspaces();
+
+        /**
+         * Evaluate the jacobian of a frame using the motion subspaces of the joints in
+         * the path between the frame and the floating base.
+         * @param frameIndex index of the frame;
+         * @param jacobian jacobian of the frame (mixed representation).
+         */
+        void evaluateFrameJacobian(const iDynTree::FrameIndex& frameIndex,
+                                   iDynTree::MatrixDynSize& jacobian);
+
+        /**
+         * Evaluate the CoM jacobian using the motion subspaces of the joints.
+         * @param jacobian jacobian of the CoM (mixed representation).
+         */
+        void evaluateCoMJacobian(iDynTree::MatrixDynSize& jacobian);
+
+        /**
+         * Evaluate the jacobian of a frame for the current state.
+         * @param frameIndex index of the frame (iDynTree::FRAME_INVALID_INDEX for the CoM);
+         * @param jacobian jacobian of the frame.
+         */
+        void computeJacobian(const iDynTree::FrameIndex& frameIndex, iDynTree::MatrixDynSize& jacobian);
+
+        /**
+         * Evaluate the jacobian of a frame only if it is not cached.
+         * @param frameIndex index of the frame (iDynTree::FRAME_INVALID_INDEX for the CoM);
+         * @param cache cached jacobian.
+         */
+        void updateCachedJacobian(const iDynTree::FrameIndex& frameIndex, CachedJacobian& cache);
+
+        /**
+         * Get the jacobian of a frame. It is evaluated only if it is not cached.
+         * @param frameIndex index of the frame (iDynTree::FRAME_INVALID_INDEX for the CoM);
+         * @param cache cached jacobian;
+         * @param jacobian jacobian of the frame.
+         * @return true/false in case of success/failure.
+         */
+        bool getCachedJacobian(const iDynTree::FrameIndex& frameIndex,
+                               CachedJacobian& cache,
+                               iDynTree::MatrixDynSize& jacobian);
+
+        /**
+         * Get the jacobian of a frame without storing it in the cache. The jacobian is copied
+         * only if it is cached, otherwise it is evaluated directly in the output matrix.
+         * @param frameIndex index of the frame (iDynTree::FRAME_INVALID_INDEX for the CoM);
+         * @param cache cached jacobian;
+         * @param jacobian jacobian of the frame.
+         */
+        void getTaskJacobian(const iDynTree::FrameIndex& frameIndex,
+                             const CachedJacobian& cache,
+                             iDynTree::MatrixDynSize& jacobian);
+
+        /**
+         * Resolve a candidate floating base.
          * @param baseFrame the frame name inside model;
-         * @param name label for storing the frame information;
+         * @param base the floating base related to the frame;
          * @return true/false in case of success/failure.
          */
-        bool setBaseFrame(const std::string& baseFrame, const std::string& name);
+        bool setBaseFrame(const std::string& baseFrame, BaseFrame& base);
 
         /**
          * Evaluate the Divergent component of motion.
@@ -261,6 +426,43 @@ namespace WalkingControllers
          */
         bool getCoMJacobian(iDynTree::MatrixDynSize &jacobian);
 
+        /**
+         * Evaluate the jacobians of the tasks always used by the QP-IK. The kinematic tree is
+         * traversed only once: the motion subspace of each joint (expressed in the world frame)
+         * is shared by all the frames, then each jacobian is obtained walking from the frame to
+         * the base. The jacobians are evaluated directly in the output matrices and they are not
+         * cached, only the ones already cached for the current state are copied.
+         * @note The hand jacobians (getLeftHandJacobian() and getRightHandJacobian()) reuse the
+         * same motion subspaces.
+         * @param leftFootJacobian left foot jacobian matrix;
+         * @param rightFootJacobian right foot jacobian matrix;
+         * @param neckJacobian neck jacobian matrix;
+         * @param comJacobian CoM jacobian matrix.
+         * @return true/false in case of success/failure.
+         */
+        bool computeTaskJacobians(iDynTree::MatrixDynSize& leftFootJacobian,
+                                  iDynTree::MatrixDynSize& rightFootJacobian,
+                                  iDynTree::MatrixDynSize& neckJacobian,
+                                  iDynTree::MatrixDynSize& comJacobian);
+
+        /**
+         * Get the number of quantities (transformations and jacobians) read from the cache.
+         * @return the number of cache hits.
+         */
+        std::size_t getCacheHits() const;
+
+        /**
+         * Get the number of quantities (transformations and jacobians) evaluated because they
+         * were not cached.
+         * @return the number of cache misses.
+         */
+        std::size_t getCacheMisses() const;
+
+        /**
+         * Reset the cache hit and miss counters.
+         */
+        void resetCacheCounters();
+
         /**
          * Get the joint position
          * @return the joint position expressed in radians
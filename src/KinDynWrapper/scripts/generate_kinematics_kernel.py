@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+# Copyright (C) 2019 Fondazione Istituto Italiano di Tecnologia (IIT)
+# All Rights Reserved.
+# Authors: Giulio Romualdi <giulio.romualdi@iit.it>
+
+"""Generate a fixed-size forward kinematics kernel from a URDF model.
+
+Only the joints passed with --joints are considered (in the given order), all the other joints
+are fixed at zero as in iDynTree::ModelLoader::loadReducedModelFromFile. The kernel evaluates the
+pose of every link of the URDF w.r.t. the root link, the axis and the origin of every joint.
+All the constant quantities (joint origins, axes, masses, kinematic tree) are written in the code,
+the generated function does not contain loops nor branches.
+"""
+
+import argparse
+import math
+import sys
+import xml.etree.ElementTree as ET
+
+
+def parse_vector(text, default):
+    if text is None:
+        return list(default)
+    return [float(value) for value in text.split()]
+
+
+def rpy_to_matrix(rpy):
+    roll, pitch, yaw = rpy
+    cr, sr = math.cos(roll), math.sin(roll)
+    cp, sp = math.cos(pitch), math.sin(pitch)
+    cy, sy = math.cos(yaw), math.sin(yaw)
+    return [[cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr],
+            [sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr],
+            [-sp, cp * sr, cp * cr]]
+
+
+def is_identity(matrix):
+    return all(abs(matrix[i][j] - (1.0 if i == j else 0.0)) < 1e-15 for i in range(3) for j in range(3))
+
+
+def number(value):
+    return repr(float(value))
+
+
+def matrix_literal(matrix):
+    return "(Eigen::Matrix3d() << " + ", ".join(number(matrix[i][j]) for i in range(3) for j in range(3)) \
+        + ").finished()"
+
+
+def vector_literal(vector):
+    return "Eigen::Vector3d(" + ", ".join(number(value) for value in vector) + ")"
+
+
+def load_model(urdf_file, considered_joints):
+    root = ET.parse(urdf_file).getroot()
+
+    links = {}
+    for link in root.findall("link"):
+        mass = 0.0
+        com = [0.0, 0.0, 0.0]
+        inertial = link.find("inertial")
+        if inertial is not None:
+            mass_element = inertial.find("mass")
+            if mass_element is not None:
+                mass = float(mass_element.get("value"))
+            origin = inertial.find("origin")
+            if origin is not None:
+                com = parse_vector(origin.get("xyz"), [0.0, 0.0, 0.0])
+        links[link.get("name")] = {"mass": mass, "com": com}
+
+    joints = {}
+    children = {}
+    for joint in root.findall("joint"):
+        origin = joint.find("origin")
+        xyz = parse_vector(origin.get("xyz") if origin is not None else None, [0.0, 0.0, 0.0])
+        rpy = parse_vector(origin.get("rpy") if origin is not None else None, [0.0, 0.0, 0.0])
+        axis = joint.find("axis")
+        axis = parse_vector(axis.get("xyz") if axis is not None else None, [1.0, 0.0, 0.0])
+        norm = math.sqrt(sum(value * value for value in axis))
+        joint_data = {"name": joint.get("name"),
+                      "type": joint.get("type"),
+                      "parent": joint.find("parent").get("link"),
+                      "child": joint.find("child").get("link"),
+                      "position": xyz,
+                      "rotation": rpy_to_matrix(rpy),
+                      "axis": [value / norm for value in axis]}
+        joints[joint_data["name"]] = joint_data
+        children.setdefault(joint_data["parent"], []).append(joint_data)
+
+    for joint_name in considered_joints:
+        if joint_name not in joints:
+            sys.exit("The joint " + joint_name + " is not in the model.")
+        if joints[joint_name]["type"] not in ("revolute", "continuous"):
+            sys.exit("The joint " + joint_name + " is not revolute, only revolute joints are supported.")
+
+    child_links = set(joint["child"] for joint in joints.values())
+    roots = [name for name in links if name not in child_links]
+    if len(roots) != 1:
+        sys.exit("The model has to be a tree with a single root link.")
+
+    # depth first visit, the parent is always visited before its children
+    frames = []
+    stack = [(roots[0], None, None)]
+    while stack:
+        link, parent, joint = stack.pop()
+        frames.append({"name": link, "parent": parent, "joint": joint})
+        for child_joint in reversed(children.get(link, [])):
+            stack.append((child_joint["child"], len(frames) - 1, child_joint))
+
+    # a DoF supports a frame if it is in the path between the root and the frame
+    dof_index = {name: index for index, name in enumerate(considered_joints)}
+    for frame in frames:
+        if frame["parent"] is None:
+            frame["support"] = set()
+            continue
+        frame["support"] = set(frames[frame["parent"]]["support"])
+        if frame["joint"]["name"] in dof_index:
+            frame["support"].add(dof_index[frame["joint"]["name"]])
+
+    return frames, links, dof_index
+
+
+def generate(urdf_file, considered_joints, kernel_name):
+    frames, links, dof_index = load_model(urdf_file, considered_joints)
+    number_of_dofs = len(considered_joints)
+    number_of_frames = len(frames)
+
+    guard = "WALKING_CONTROLLERS_KINDYN_WRAPPER_GENERATED_KINEMATICS_KERNEL_H"
+    lines = []
+    lines.append("// This file has been generated by generate_kinematics_kernel.py. Do not edit it.")
+    lines.append("// model: " + urdf_file)
+    lines.append("")
+    lines.append("#ifndef " + guard)
+    lines.append("#define " + guard)
+    lines.append("")
+    lines.append("// std")
+    lines.append("#include <array>")
+    lines.append("#include <cmath>")
+    lines.append("")
+    lines.append("// Eigen")
+    lines.append("#include <Eigen/Dense>")
+    lines.append("")
+    lines.append("namespace WalkingControllers")
+    lines.append("{")
+    lines.append("    /**")
+    lines.append("     * Forward kinematics kernel of a fixed robot model (%d DoFs, %d frames)." % (number_of_dofs,
+                                                                                           number_of_frames))
+    lines.append("     */")
+    lines.append("    struct " + kernel_name)
+    lines.append("    {")
+    lines.append("        static constexpr int numberOfDOFs = %d; /**< Number of DoFs. */" % number_of_dofs)
+    lines.append("        static constexpr int numberOfFrames = %d; /**< Number of frames (links of the URDF). */"
+                 % number_of_frames)
+    lines.append("")
+
+    lines.append("        static const char* jointName(const int& index)")
+    lines.append("        {")
+    lines.append("            static const char* names[] = {" + ", ".join('"%s"' % name for name in considered_joints)
+                 + "};")
+    lines.append("            return names[index];")
+    lines.append("        }")
+    lines.append("")
+
+    lines.append("        static const char* frameName(const int& index)")
+    lines.append("        {")
+    lines.append("            static const char* names[] = {" + ", ".join('"%s"' % frame["name"] for frame in frames)
+                 + "};")
+    lines.append("            return names[index];")
+    lines.append("        }")
+    lines.append("")
+
+    lines.append("        static double frameMass(const int& index)")
+    lines.append("        {")
+    lines.append("            static const double masses[] = {"
+                 + ", ".join(number(links[frame["name"]]["mass"]) for frame in frames) + "};")
+    lines.append("            return masses[index];")
+    lines.append("        }")
+    lines.append("")
+
+    lines.append("        static Eigen::Vector3d frameCoM(const int& index)")
+    lines.append("        {")
+    lines.append("            static const double coms[][3] = {"
+                 + ", ".join("{" + ", ".join(number(value) for value in links[frame["name"]]["com"]) + "}"
+                             for frame in frames) + "};")
+    lines.append("            return Eigen::Vector3d(coms[index][0], coms[index][1], coms[index][2]);")
+    lines.append("        }")
+    lines.append("")
+
+    lines.append("        static bool isSupportedBy(const int& frameIndex, const int& dofIndex)")
+    lines.append("        {")
+    if number_of_dofs > 0:
+        lines.append("            static const bool support[][%d] = {" % number_of_dofs)
+        rows = []
+        for frame in frames:
+            rows.append("                {" + ", ".join("true" if dof in frame["support"] else "false"
+                                                      for dof in range(number_of_dofs)) + "}")
+        lines.append(",\n".join(rows))
+        lines.append("            };")
+        lines.append("            return support[frameIndex][dofIndex];")
+    else:
+        lines.append("            return false;")
+    lines.append("        }")
+    lines.append("")
+
+    lines.append("        /**")
+    lines.append("         * Evaluate the pose of all the frames and the axis and origin of all the joints")
+    lines.append("         * w.r.t. the root frame.")
+    lines.append("         */")
+    lines.append("        static void evaluate(const Eigen::Ref<const Eigen::VectorXd>& jointPositions,")
+    lines.append("                             std::array<Eigen::Matrix3d, numberOfFrames>& rotations,")
+    lines.append("                             std::array<Eigen::Vector3d, numberOfFrames>& positions,")
+    lines.append("                             Eigen::Matrix<double, 3, numberOfDOFs>& axes,")
+    lines.append("                             Eigen::Matrix<double, 3, numberOfDOFs>& origins)")
+    lines.append("        {")
+    lines.append("            rotations[0].setIdentity();")
+    lines.append("            positions[0].setZero();")
+    for index, frame in enumerate(frames):
+        if frame["parent"] is None:
+            continue
+        parent = frame["parent"]
+        joint = frame["joint"]
+        lines.append("")
+        lines.append("            // %s (%s)" % (frame["name"], joint["name"]))
+        lines.append("            positions[%d] = positions[%d] + rotations[%d] * %s;"
+                     % (index, parent, parent, vector_literal(joint["position"])))
+        if joint["name"] in dof_index:
+            dof = dof_index[joint["name"]]
+            x, y, z = joint["axis"]
+            parent_rotation = "rotations[%d]" % parent
+            if not is_identity(joint["rotation"]):
+                parent_rotation += " * " + matrix_literal(joint["rotation"])
+            lines.append("            {")
+            lines.append("                const double c = std::cos(jointPositions(%d));" % dof)
+            lines.append("                const double s = std::sin(jointPositions(%d));" % dof)
+            lines.append("                const double t = 1.0 - c;")
+            lines.append("                Eigen::Matrix3d jointRotation;")
+            lines.append("                jointRotation << t * %s + c, t * %s - s * %s, t * %s + s * %s,"
+                         % (number(x * x), number(x * y), number(z), number(x * z), number(y)))
+            lines.append("                    t * %s + s * %s, t * %s + c, t * %s - s * %s,"
+                         % (number(x * y), number(z), number(y * y), number(y * z), number(x)))
+            lines.append("                    t * %s - s * %s, t * %s + s * %s, t * %s + c;"
+                         % (number(x * z), number(y), number(y * z), number(x), number(z * z)))
+            lines.append("                rotations[%d] = %s * jointRotation;" % (index, parent_rotation))
+            lines.append("            }")
+            lines.append("            axes.col(%d) = rotations[%d] * %s;" % (dof, index, vector_literal(joint["axis"])))
+            lines.append("            origins.col(%d) = positions[%d];" % (dof, index))
+        elif is_identity(joint["rotation"]):
+            lines.append("            rotations[%d] = rotations[%d];" % (index, parent))
+        else:
+            lines.append("            rotations[%d] = rotations[%d] * %s;"
+                         % (index, parent, matrix_literal(joint["rotation"])))
+    lines.append("        }")
+    lines.append("    };")
+    lines.append("}")
+    lines.append("")
+    lines.append("#endif")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a fixed-size forward kinematics kernel from a URDF.")
+    parser.add_argument("--urdf", required=True, help="path to the URDF model")
+    parser.add_argument("--joints", required=True, nargs="+",
+                        help="list of the considered joints (the order defines the DoFs order)")
+    parser.add_argument("--name", default="GeneratedKinematicsKernel", help="name of the generated struct")
+    parser.add_argument("--output", required=True, help="generated header file")
+    args = parser.parse_args()
+
+    # the joints can be passed also as a CMake list
+    joints = [joint for argument in args.joints for joint in argument.split(";") if joint]
+    code = generate(args.urdf, joints, args.name)
+    with open(args.output, "w") as output:
+        output.write(code)
+
+
+if __name__ == "__main__":
+    main()
@@ -22,27 +22,183 @@
 #include <WalkingControllers/YarpUtilities/Helper.h>
 #include <WalkingControllers/KinDynWrapper/Wrapper.h>
 
+#ifdef WALKING_CONTROLLERS_USE_GENERATED_KINEMATICS
+#include <WalkingControllers/KinDynWrapper/GeneratedKinematics.h>
+#include <WalkingControllers/KinDynWrapper/GeneratedKinematicsKernel.h>
+#endif
+
 using namespace WalkingControllers;
 
 bool WalkingFK::setRobotModel(const iDynTree::Model& model)
 {
-    if(!m_kinDyn.loadRobotModel(model))
+    if(!m_defaultKinDyn.loadRobotModel(model))
     {
         yError() << "[WalkingFK::setRobotModel] Error while loading into KinDynComputations object.";
         return false;
     }
 
-    m_kinDyn.setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION);
+    m_defaultKinDyn.setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION);
+    m_kinDyn = &m_defaultKinDyn;
 
     // initialize some quantities needed for the first step
     m_prevContactLeft = false;
 
+    // quantities used by the batched evaluation of the jacobians
+    const iDynTree::Model& kinDynModel = m_kinDyn->model();
+    m_linkMasses.resize(kinDynModel.getNrOfLinks());
+    m_linkCoMPositions.resize(3, kinDynModel.getNrOfLinks());
+    for(int i = 0; i < kinDynModel.getNrOfLinks(); i++)
+    {
+        iDynTree::SpatialInertia inertia = kinDynModel.getLink(i)->getInertia();
+        m_linkMasses(i) = inertia.getMass();
+        m_linkCoMPositions.col(i) = iDynTree::toEigen(inertia.getCenterOfMass());
+    }
+    m_totalMass = m_linkMasses.sum();
+
+    m_jointAxes.resize(3, kinDynModel.getNrOfDOFs());
+    m_jointLinearTerms.resize(3, kinDynModel.getNrOfDOFs());
+    m_subtreeMasses.resize(kinDynModel.getNrOfLinks());
+    m_subtreeFirstMoments.resize(3, kinDynModel.getNrOfLinks());
+
+    m_baseLinkIndex = kinDynModel.getDefaultBaseLink();
+    kinDynModel.computeFullTreeTraversal(m_defaultTraversal, m_baseLinkIndex);
+    m_traversal = &m_defaultTraversal;
+
     return true;
 }
 
-bool WalkingFK::setBaseFrame(const std::string& baseFrame, const std::string& name)
+bool WalkingFK::setKinematicsBackend(const yarp::os::Searchable& config, const iDynTree::Model& model)
+{
+    std::string backend = config.check("kinematics_backend", yarp::os::Value("iDynTree")).asString();
+    if(backend == "iDynTree")
+        return true;
+
+    if(backend != "generated")
+    {
+        yError() << "[WalkingFK::setKinematicsBackend] Unknown kinematics backend: " << backend
+                 << ". Available backends: iDynTree and generated.";
+        return false;
+    }
+
+#ifdef WALKING_CONTROLLERS_USE_GENERATED_KINEMATICS
+    m_kinematicsBackend = std::make_unique<GeneratedKinematics<GeneratedKinematicsKernel>>();
+#else
+    yError() << "[WalkingFK::setKinematicsBackend] The generated kinematics is not available. "
+             << "Please compile the project with WALKING_CONTROLLERS_USE_GENERATED_KINEMATICS.";
+    return false;
+#endif
+
+    // the kernel has to be generated with the same joints (and in the same order) of the model
+    if(m_kinematicsBackend->getNrOfDOFs() != model.getNrOfDOFs())
+    {
+        yError() << "[WalkingFK::setKinematicsBackend] The kinematics backend has "
+                 << m_kinematicsBackend->getNrOfDOFs() << " DoFs while the model has "
+                 << model.getNrOfDOFs() << " DoFs.";
+        return false;
+    }
+
+    for(int i = 0; i < model.getNrOfDOFs(); i++)
+    {
+        if(m_kinematicsBackend->getJointName(i) != model.getJointName(i))
+        {
+            yError() << "[WalkingFK::setKinematicsBackend] The " << i << "-th DoF of the kinematics backend is "
+                     << m_kinematicsBackend->getJointName(i) << " while in the model is "
+                     << model.getJointName(i);
+            return false;
+        }
+    }
+
+    m_backendFrameIndices.resize(model.getNrOfFrames());
+    for(int i = 0; i < model.getNrOfFrames(); i++)
+        m_backendFrameIndices[i] = m_kinematicsBackend->getFrameIndex(model.getFrameName(i));
+
+    m_robotVelocity.resize(model.getNrOfDOFs() + 6);
+    m_robotVelocity.setZero();
+
+    return true;
+}
+
+bool WalkingFK::isFrameInKinematicsBackend(const iDynTree::FrameIndex& frameIndex) const
+{
+    if(m_kinematicsBackend == nullptr)
+        return true;
+
+    if(m_backendFrameIndices[frameIndex] < 0)
+    {
+        yError() << "[WalkingFK::isFrameInKinematicsBackend] The frame named "
+                 << m_kinDyn->model().getFrameName(frameIndex)
+                 << " is not available in the kinematics backend.";
+        return false;
+    }
+
+    return true;
+}
+
+void WalkingFK::setFloatingBase(const BaseFrame& base)
+{
+    m_kinDyn = base.kinDyn.get();
+    m_baseLinkIndex = base.linkIndex;
+    m_traversal = &base.traversal;
+
+    // the jacobians depend on the floating base
+    invalidateCache();
+}
+
+void WalkingFK::invalidateCache()
+{
+    m_comEvaluated = false;
+    m_dcmEvaluated = false;
+    m_motionSubspacesEvaluated = false;
+
+    m_leftFootTransform.isValid = false;
+    m_rightFootTransform.isValid = false;
+    m_leftHandTransform.isValid = false;
+    m_rightHandTransform.isValid = false;
+    m_headTransform.isValid = false;
+    m_rootLinkTransform.isValid = false;
+    m_neckTransform.isValid = false;
+
+    m_leftFootJacobian.isValid = false;
+    m_rightFootJacobian.isValid = false;
+    m_leftHandJacobian.isValid = false;
+    m_rightHandJacobian.isValid = false;
+    m_neckJacobian.isValid = false;
+    m_comJacobian.isValid = false;
+    m_rootLinkJacobian.isValid = false;
+}
+
+const iDynTree::Transform& WalkingFK::getCachedWorldTransform(const iDynTree::FrameIndex& frameIndex,
+                                                             CachedTransform& cache)
+{
+    if(!cache.isValid)
+    {
+        if(m_kinematicsBackend)
+        {
+            Eigen::Matrix3d rotation;
+            Eigen::Vector3d position;
+            m_kinematicsBackend->getWorldTransform(m_backendFrameIndices[frameIndex], rotation, position);
+
+            iDynTree::Rotation rotationIDyn;
+            iDynTree::Position positionIDyn;
+            iDynTree::toEigen(rotationIDyn) = rotation;
+            iDynTree::toEigen(positionIDyn) = position;
+            cache.transform.setRotation(rotationIDyn);
+            cache.transform.setPosition(positionIDyn);
+        }
+        else
+            cache.transform = m_kinDyn->getWorldTransform(frameIndex);
+        cache.isValid = true;
+        m_cacheMisses++;
+    }
+    else
+        m_cacheHits++;
+
+    return cache.transform;
+}
+
+bool WalkingFK::setBaseFrame(const std::string& baseFrame, BaseFrame& base)
 {
-    if(!m_kinDyn.isValid())
+    if(!m_kinDyn->isValid())
     {
         yError() << "[WalkingFK::setBaseFrames] Please set the Robot model before calling this method.";
         return false;
@@ -53,18 +209,32 @@ bool WalkingFK::setBaseFrame(const std::string& baseFrame, const std::string& na
     // - left_foot when the left foot is the stance foot;
     // - right_foot when the right foot is the stance foot.
     //.-.root when the external base supposed to be used
-    m_frameBaseIndex = m_kinDyn.model().getFrameIndex(baseFrame);
-    if(m_frameBaseIndex == iDynTree::FRAME_INVALID_INDEX)
+    const iDynTree::Model& model = m_kinDyn->model();
+    iDynTree::FrameIndex frameBaseIndex = model.getFrameIndex(baseFrame);
+    if(frameBaseIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[setBaseFrames] Unable to find the frame named: " << baseFrame;
         return false;
     }
-    iDynTree::LinkIndex linkBaseIndex = m_kinDyn.model().getFrameLink(m_frameBaseIndex);
+    base.linkIndex = model.getFrameLink(frameBaseIndex);
+    base.frameToLinkTransform = model.getFrameTransform(frameBaseIndex).inverse();
 
-    std::string baseFrameName = m_kinDyn.model().getLinkName(linkBaseIndex);
-    m_baseFrames.insert({name, std::make_pair(baseFrameName,
-                                              m_kinDyn.getRelativeTransform(m_frameBaseIndex,
-                                                                            linkBaseIndex))});
+    // each base has its own KinDynComputations object and traversal, so the floating base
+    // of a KinDynComputations object is never changed at runtime
+    base.kinDyn = std::make_unique<iDynTree::KinDynComputations>();
+    if(!base.kinDyn->loadRobotModel(model))
+    {
+        yError() << "[setBaseFrames] Error while loading into KinDynComputations object.";
+        return false;
+    }
+    base.kinDyn->setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION);
+    if(!base.kinDyn->setFloatingBase(model.getLinkName(base.linkIndex)))
+    {
+        yError() << "[setBaseFrames] Unable to set the floating base on link "
+                 << model.getLinkName(base.linkIndex);
+        return false;
+    }
+    model.computeFullTreeTraversal(base.traversal, base.linkIndex);
 
     return true;
 }
@@ -85,6 +255,12 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         return false;
     }
 
+    if(!setKinematicsBackend(config, model))
+    {
+        yError() << "[WalkingFK::initialize] Unable to set the kinematics backend.";
+        return false;
+    }
+
     // set the left foot frame
     std::string lFootFrame;
     if(!YarpUtilities::getStringFromSearchable(config, "left_foot_frame", lFootFrame))
@@ -101,7 +277,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         return false;
     }
 
-    m_frameLeftIndex = m_kinDyn.model().getFrameIndex(lFootFrame);
+    m_frameLeftIndex = m_kinDyn->model().getFrameIndex(lFootFrame);
     if(m_frameLeftIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << lFootFrame;
@@ -110,7 +286,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
 
 
     // set base frames
-    m_frameRightIndex = m_kinDyn.model().getFrameIndex(rFootFrame);
+    m_frameRightIndex = m_kinDyn->model().getFrameIndex(rFootFrame);
     if(m_frameRightIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << rFootFrame;
@@ -124,7 +300,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         yError() << "[WalkingFK::initialize] Unable to get the string from searchable.";
         return false;
     }
-    m_frameLeftHandIndex = m_kinDyn.model().getFrameIndex(lHandFrame);
+    m_frameLeftHandIndex = m_kinDyn->model().getFrameIndex(lHandFrame);
     if(m_frameLeftHandIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << lHandFrame;
@@ -138,7 +314,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         yError() << "[WalkingFK::initialize] Unable to get the string from searchable.";
         return false;
     }
-    m_frameRightHandIndex = m_kinDyn.model().getFrameIndex(rHandFrame);
+    m_frameRightHandIndex = m_kinDyn->model().getFrameIndex(rHandFrame);
     if(m_frameRightHandIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << rHandFrame;
@@ -151,7 +327,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         yError() << "[WalkingFK::initialize] Unable to get the string from searchable.";
         return false;
     }
-    m_frameHeadIndex = m_kinDyn.model().getFrameIndex(headFrame);
+    m_frameHeadIndex = m_kinDyn->model().getFrameIndex(headFrame);
     if(m_frameHeadIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << headFrame;
@@ -164,7 +340,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         yError() << "[WalkingFK::initialize] Unable to get the string from searchable.";
         return false;
     }
-    m_frameRootIndex = m_kinDyn.model().getFrameIndex(rootFrame);
+    m_frameRootIndex = m_kinDyn->model().getFrameIndex(rootFrame);
     if(m_frameRootIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << rootFrame;
@@ -177,7 +353,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
         yError() << "[WalkingFK::initialize] Unable to get the string from searchable.";
         return false;
     }
-    m_frameNeckIndex = m_kinDyn.model().getFrameIndex(torsoFrame);
+    m_frameNeckIndex = m_kinDyn->model().getFrameIndex(torsoFrame);
     if(m_frameNeckIndex == iDynTree::FRAME_INVALID_INDEX)
     {
         yError() << "[WalkingFK::initialize] Unable to find the frame named: " << torsoFrame;
@@ -188,13 +364,13 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
 
     if(!m_useExternalRobotBase)
     {
-        if(!setBaseFrame(lFootFrame, "leftFoot"))
+        if(!setBaseFrame(lFootFrame, m_leftFootBase))
         {
             yError() << "[initialize] Unable to set the leftFootFrame.";
             return false;
         }
 
-        if(!setBaseFrame(rFootFrame, "rightFoot"))
+        if(!setBaseFrame(rFootFrame, m_rightFootBase))
         {
             yError() << "[initialize] Unable to set the rightFootFrame.";
             return false;
@@ -206,16 +382,24 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
     }
     else
     {
-        if(!setBaseFrame(rootFrame, "root"))
+        if(!setBaseFrame(rootFrame, m_rootBase))
         {
             yError() << "[initialize] Unable to set the rightFootFrame.";
             return false;
         }
 
         // in this specific case the base is always the root link
-        if(!m_kinDyn.setFloatingBase(m_baseFrames["root"].first))
+        setFloatingBase(m_rootBase);
+    }
+
+    // all the frames (and the links used as floating base) have to be evaluated by the backend
+    for(const iDynTree::FrameIndex& frameIndex : {m_frameLeftIndex, m_frameRightIndex, m_frameLeftHandIndex,
+                m_frameRightHandIndex, m_frameHeadIndex, m_frameRootIndex, m_frameNeckIndex,
+                m_leftFootBase.linkIndex, m_rightFootBase.linkIndex, m_rootBase.linkIndex})
+    {
+        if(frameIndex != iDynTree::FRAME_INVALID_INDEX && !isFrameInKinematicsBackend(frameIndex))
         {
-            yError() << "[initialize] Unable to set the floating base";
+            yError() << "[WalkingFK::initialize] The kinematics backend cannot be used with this configuration.";
             return false;
         }
     }
@@ -276,12 +460,10 @@ void WalkingFK::evaluateWorldToBaseTransformation(const iDynTree::Transform& roo
         yWarning() << "[evaluateWorldToBaseTransformation] The base position is not retrieved from external. There is no reason to call this function.";
                        return;
     }
-    auto& base = m_baseFrames["root"];
-    m_worldToBaseTransform = rootTransform * base.second;
+    m_worldToBaseTransform = rootTransform * m_rootBase.frameToLinkTransform;
     m_baseTwist = rootTwist;
 
-    m_comEvaluated = false;
-    m_dcmEvaluated = false;
+    invalidateCache();
     return;
 }
 
@@ -301,14 +483,8 @@ bool WalkingFK::evaluateWorldToBaseTransformation(const iDynTree::Transform& lef
         // the right foot
         if(!m_prevContactLeft || m_firstStep)
         {
-            auto& base = m_baseFrames["leftFoot"];
-            m_worldToBaseTransform = leftFootTransform * base.second;
-            if(!m_kinDyn.setFloatingBase(base.first))
-            {
-                yError() << "[evaluateWorldToBaseTransformation] Error while setting the floating "
-                         << "base on link " << base.first;
-                return false;
-            }
+            m_worldToBaseTransform = leftFootTransform * m_leftFootBase.frameToLinkTransform;
+            setFloatingBase(m_leftFootBase);
             m_prevContactLeft = true;
         }
     }
@@ -318,22 +494,15 @@ bool WalkingFK::evaluateWorldToBaseTransformation(const iDynTree::Transform& lef
         // the left foot
         if(m_prevContactLeft || m_firstStep)
         {
-            auto base = m_baseFrames["rightFoot"];
-            m_worldToBaseTransform = rightFootTransform * base.second;
-            if(!m_kinDyn.setFloatingBase(base.first))
-            {
-                yError() << "[WalkingFK::evaluateWorldToBaseTransformation] Error while setting the floating "
-                         << "base on link " << base.first;
-                return false;
-            }
+            m_worldToBaseTransform = rightFootTransform * m_rightFootBase.frameToLinkTransform;
+            setFloatingBase(m_rightFootBase);
             m_prevContactLeft = false;
         }
     }
 
     m_firstStep = false;
 
-    m_comEvaluated = false;
-    m_dcmEvaluated = false;
+    invalidateCache();
     return true;
 }
 
@@ -344,7 +513,7 @@ bool WalkingFK::setInternalRobotState(const iDynTree::VectorDynSize& positionFee
     gravity.zero();
     gravity(2) = -9.81;
 
-    if(!m_kinDyn.setRobotState(m_worldToBaseTransform, positionFeedbackInRadians,
+    if(!m_kinDyn->setRobotState(m_worldToBaseTransform, positionFeedbackInRadians,
                                m_baseTwist, velocityFeedbackInRadians,
                                gravity))
     {
@@ -352,8 +521,22 @@ bool WalkingFK::setInternalRobotState(const iDynTree::VectorDynSize& positionFee
         return false;
     }
 
-    m_comEvaluated = false;
-    m_dcmEvaluated = false;
+    if(m_kinematicsBackend)
+    {
+        // the base link frame is also a frame of the model with the same index
+        iDynTree::Rotation worldToBaseRotation = m_worldToBaseTransform.getRotation();
+        iDynTree::Position worldToBasePosition = m_worldToBaseTransform.getPosition();
+        m_kinematicsBackend->setRobotState(m_backendFrameIndices[m_baseLinkIndex],
+                                           iDynTree::toEigen(worldToBaseRotation),
+                                           iDynTree::toEigen(worldToBasePosition),
+                                           iDynTree::toEigen(positionFeedbackInRadians));
+
+        m_robotVelocity.head<3>() = iDynTree::toEigen(m_baseTwist.getLinearVec3());
+        m_robotVelocity.segment<3>(3) = iDynTree::toEigen(m_baseTwist.getAngularVec3());
+        m_robotVelocity.tail(velocityFeedbackInRadians.size()) = iDynTree::toEigen(velocityFeedbackInRadians);
+    }
+
+    invalidateCache();
 
     return true;
 }
@@ -363,8 +546,20 @@ void WalkingFK::evaluateCoM()
     if(m_comEvaluated)
         return;
 
-    m_comPosition = m_kinDyn.getCenterOfMassPosition();
-    m_comVelocity = m_kinDyn.getCenterOfMassVelocity();
+    if(m_kinematicsBackend)
+    {
+        Eigen::Vector3d comPosition;
+        m_kinematicsBackend->getCoMPosition(comPosition);
+        iDynTree::toEigen(m_comPosition) = comPosition;
+
+        updateCachedJacobian(iDynTree::FRAME_INVALID_INDEX, m_comJacobian);
+        iDynTree::toEigen(m_comVelocity) = iDynTree::toEigen(m_comJacobian.jacobian) * m_robotVelocity;
+    }
+    else
+    {
+        m_comPosition = m_kinDyn->getCenterOfMassPosition();
+        m_comVelocity = m_kinDyn->getCenterOfMassVelocity();
+    }
 
     yarp::sig::Vector temp;
     temp.resize(3);
@@ -440,92 +635,294 @@ bool WalkingFK::setBaseOnTheFly()
             return false;
     }
 
-    auto base = m_baseFrames["leftFoot"];
-    m_worldToBaseTransform = base.second;
-    if(!m_kinDyn.setFloatingBase(base.first))
-    {
-        yError() << "[setBaseOnTheFly] Error while setting the floating base on link "
-                 << base.first;
-        return false;
-    }
+    m_worldToBaseTransform = m_leftFootBase.frameToLinkTransform;
+    setFloatingBase(m_leftFootBase);
 
     return true;
 }
 
 iDynTree::Transform WalkingFK::getLeftFootToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameLeftIndex);
+    return getCachedWorldTransform(m_frameLeftIndex, m_leftFootTransform);
 }
 
 iDynTree::Transform WalkingFK::getRightFootToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameRightIndex);
+    return getCachedWorldTransform(m_frameRightIndex, m_rightFootTransform);
 }
 
 iDynTree::Transform WalkingFK::getLeftHandToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameLeftHandIndex);
+    return getCachedWorldTransform(m_frameLeftHandIndex, m_leftHandTransform);
 }
 
 iDynTree::Transform WalkingFK::getRightHandToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameRightHandIndex);
+    return getCachedWorldTransform(m_frameRightHandIndex, m_rightHandTransform);
 }
 
 iDynTree::Transform WalkingFK::getHeadToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameHeadIndex);
+    return getCachedWorldTransform(m_frameHeadIndex, m_headTransform);
 }
 
 iDynTree::Transform WalkingFK::getRootLinkToWorldTransform()
 {
-    return m_kinDyn.getWorldTransform(m_frameRootIndex);
+    return getCachedWorldTransform(m_frameRootIndex, m_rootLinkTransform);
 }
 
 iDynTree::Twist WalkingFK::getRootLinkVelocity()
 {
-    return m_kinDyn.getFrameVel(m_frameRootIndex);
+    if(!m_kinematicsBackend)
+        return m_kinDyn->getFrameVel(m_frameRootIndex);
+
+    updateCachedJacobian(m_frameRootIndex, m_rootLinkJacobian);
+    Eigen::Matrix<double, 6, 1> velocity = iDynTree::toEigen(m_rootLinkJacobian.jacobian) * m_robotVelocity;
+    iDynTree::Twist rootLinkVelocity;
+    iDynTree::toEigen(rootLinkVelocity.getLinearVec3()) = velocity.head<3>();
+    iDynTree::toEigen(rootLinkVelocity.getAngularVec3()) = velocity.tail<3>();
+    return rootLinkVelocity;
 }
 
 iDynTree::Rotation WalkingFK::getNeckOrientation()
 {
-    return m_kinDyn.getWorldTransform(m_frameNeckIndex).getRotation();
+    return getCachedWorldTransform(m_frameNeckIndex, m_neckTransform).getRotation();
 }
 
 bool WalkingFK::getLeftFootJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getFrameFreeFloatingJacobian(m_frameLeftIndex, jacobian);
+    return getCachedJacobian(m_frameLeftIndex, m_leftFootJacobian, jacobian);
 }
 
 bool WalkingFK::getRightFootJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getFrameFreeFloatingJacobian(m_frameRightIndex, jacobian);
+    return getCachedJacobian(m_frameRightIndex, m_rightFootJacobian, jacobian);
 }
 
 bool WalkingFK::getRightHandJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getFrameFreeFloatingJacobian(m_frameRightHandIndex, jacobian);
+    return getCachedJacobian(m_frameRightHandIndex, m_rightHandJacobian, jacobian);
 }
 
 bool WalkingFK::getLeftHandJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getFrameFreeFloatingJacobian(m_frameLeftHandIndex, jacobian);
+    return getCachedJacobian(m_frameLeftHandIndex, m_leftHandJacobian, jacobian);
 }
 
 bool WalkingFK::getNeckJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getFrameFreeFloatingJacobian(m_frameNeckIndex, jacobian);
+    return getCachedJacobian(m_frameNeckIndex, m_neckJacobian, jacobian);
 }
 
 bool WalkingFK::getCoMJacobian(iDynTree::MatrixDynSize &jacobian)
 {
-    return m_kinDyn.getCenterOfMassJacobian(jacobian);
+    return getCachedJacobian(iDynTree::FRAME_INVALID_INDEX, m_comJacobian, jacobian);
+}
+
+void WalkingFK::evaluateMotionSubspaces()
+{
+    if(m_motionSubspacesEvaluated)
+        return;
+
+    const iDynTree::Traversal& traversal = *m_traversal;
+
+    // forward pass: motion subspace of each DoF expressed in the world frame. The velocity of a point
+    // p due to the i-th DoF is linearTerm_i + axis_i x p
+    for(int i = 0; i < traversal.getNrOfVisitedLinks(); i++)
+    {
+        const iDynTree::LinkIndex linkIndex = traversal.getLink(i)->getIndex();
+        iDynTree::Transform linkTransform = m_kinDyn->getWorldTransform(linkIndex);
+        iDynTree::Position linkPositionIDyn = linkTransform.getPosition();
+        iDynTree::Rotation linkRotationIDyn = linkTransform.getRotation();
+        auto linkPosition(iDynTree::toEigen(linkPositionIDyn));
+        auto linkRotation(iDynTree::toEigen(linkRotationIDyn));
+
+        m_subtreeMasses(linkIndex) = m_linkMasses(linkIndex);
+        m_subtreeFirstMoments.col(linkIndex) = m_linkMasses(linkIndex)
+            * (linkPosition + linkRotation * m_linkCoMPositions.col(linkIndex));
+
+        // the base does not have a parent joint
+        if(i == 0)
+            continue;
+
+        const iDynTree::IJoint* joint = traversal.getParentJoint(i);
+        const iDynTree::LinkIndex parentLinkIndex = traversal.getParentLink(i)->getIndex();
+        for(int j = 0; j < joint->getNrOfDOFs(); j++)
+        {
+            const int dof = joint->getDOFsOffset() + j;
+            iDynTree::SpatialMotionVector motionSubspace = joint->getMotionSubspaceVector(j, linkIndex,
+                                                                                         parentLinkIndex);
+            m_jointAxes.col(dof) = linkRotation * iDynTree::toEigen(motionSubspace.getAngularVec3());
+            m_jointLinearTerms.col(dof) = linkRotation * iDynTree::toEigen(motionSubspace.getLinearVec3())
+                - m_jointAxes.col(dof).cross(linkPosition);
+        }
+    }
+
+    // backward pass: mass and first moment of mass of each subtree
+    for(int i = traversal.getNrOfVisitedLinks() - 1; i > 0; i--)
+    {
+        const iDynTree::LinkIndex linkIndex = traversal.getLink(i)->getIndex();
+        const iDynTree::LinkIndex parentLinkIndex = traversal.getParentLink(i)->getIndex();
+        m_subtreeMasses(parentLinkIndex) += m_subtreeMasses(linkIndex);
+        m_subtreeFirstMoments.col(parentLinkIndex) += m_subtreeFirstMoments.col(linkIndex);
+    }
+
+    m_motionSubspacesEvaluated = true;
+}
+
+void WalkingFK::evaluateFrameJacobian(const iDynTree::FrameIndex& frameIndex,
+                                      iDynTree::MatrixDynSize& jacobian)
+{
+    jacobian.resize(6, m_kinDyn->getNrOfDegreesOfFreedom() + 6);
+    auto jacobianEigen(iDynTree::toEigen(jacobian));
+    jacobianEigen.setZero();
+
+    iDynTree::Position framePositionIDyn = m_kinDyn->getWorldTransform(frameIndex).getPosition();
+    iDynTree::Position basePositionIDyn = m_kinDyn->getWorldTransform(m_baseLinkIndex).getPosition();
+    auto framePosition(iDynTree::toEigen(framePositionIDyn));
+    auto basePosition(iDynTree::toEigen(basePositionIDyn));
+
+    // base (mixed representation) v_frame = v_base + omega x (p_frame - p_base)
+    jacobianEigen.topLeftCorner<3, 3>().setIdentity();
+    jacobianEigen.topRows<3>().middleCols<3>(3) = iDynTree::skew(basePosition - framePosition);
+    jacobianEigen.bottomRows<3>().middleCols<3>(3).setIdentity();
+
+    // joints in the path between the frame and the base
+    iDynTree::LinkIndex linkIndex = m_kinDyn->model().getFrameLink(frameIndex);
+    while(linkIndex != m_traversal->getBaseLink()->getIndex())
+    {
+        const iDynTree::IJoint* joint = m_traversal->getParentJointFromLinkIndex(linkIndex);
+        for(int i = 0; i < joint->getNrOfDOFs(); i++)
+        {
+            const int dof = joint->getDOFsOffset() + i;
+            jacobianEigen.block<3, 1>(0, dof + 6) = m_jointLinearTerms.col(dof)
+                + m_jointAxes.col(dof).cross(framePosition);
+            jacobianEigen.block<3, 1>(3, dof + 6) = m_jointAxes.col(dof);
+        }
+        linkIndex = m_traversal->getParentLinkFromLinkIndex(linkIndex)->getIndex();
+    }
+}
+
+void WalkingFK::evaluateCoMJacobian(iDynTree::MatrixDynSize& jacobian)
+{
+    // each DoF moves the CoM of its subtree
+    jacobian.resize(3, m_kinDyn->getNrOfDegreesOfFreedom() + 6);
+    auto comJacobianEigen(iDynTree::toEigen(jacobian));
+    iDynTree::Position basePositionIDyn = m_kinDyn->getWorldTransform(m_baseLinkIndex).getPosition();
+    auto basePosition(iDynTree::toEigen(basePositionIDyn));
+
+    comJacobianEigen.leftCols<3>().setIdentity();
+    comJacobianEigen.middleCols<3>(3) = iDynTree::skew(basePosition
+                                                       - m_subtreeFirstMoments.col(m_baseLinkIndex) / m_totalMass);
+    comJacobianEigen.rightCols(m_kinDyn->getNrOfDegreesOfFreedom()).setZero();
+    for(int i = 1; i < m_traversal->getNrOfVisitedLinks(); i++)
+    {
+        const iDynTree::LinkIndex linkIndex = m_traversal->getLink(i)->getIndex();
+        const iDynTree::IJoint* joint = m_traversal->getParentJoint(i);
+        for(int j = 0; j < joint->getNrOfDOFs(); j++)
+        {
+            const int dof = joint->getDOFsOffset() + j;
+            comJacobianEigen.col(dof + 6) = (m_subtreeMasses(linkIndex) * m_jointLinearTerms.col(dof)
+                                             + m_jointAxes.col(dof).cross(m_subtreeFirstMoments.col(linkIndex)))
+                / m_totalMass;
+        }
+    }
+}
+
+void WalkingFK::computeJacobian(const iDynTree::FrameIndex& frameIndex, iDynTree::MatrixDynSize& jacobian)
+{
+    if(m_kinematicsBackend)
+    {
+        jacobian.resize(frameIndex == iDynTree::FRAME_INVALID_INDEX ? 3 : 6,
+                        m_kinDyn->getNrOfDegreesOfFreedom() + 6);
+        auto jacobianEigen(iDynTree::toEigen(jacobian));
+        if(frameIndex == iDynTree::FRAME_INVALID_INDEX)
+            m_kinematicsBackend->getCoMJacobian(jacobianEigen);
+        else
+            m_kinematicsBackend->getFrameJacobian(m_backendFrameIndices[frameIndex], jacobianEigen);
+        return;
+    }
+
+    evaluateMotionSubspaces();
+
+    if(frameIndex == iDynTree::FRAME_INVALID_INDEX)
+        evaluateCoMJacobian(jacobian);
+    else
+        evaluateFrameJacobian(frameIndex, jacobian);
+}
+
+void WalkingFK::updateCachedJacobian(const iDynTree::FrameIndex& frameIndex, CachedJacobian& cache)
+{
+    if(cache.isValid)
+    {
+        m_cacheHits++;
+        return;
+    }
+
+    computeJacobian(frameIndex, cache.jacobian);
+    cache.isValid = true;
+    m_cacheMisses++;
+}
+
+bool WalkingFK::getCachedJacobian(const iDynTree::FrameIndex& frameIndex,
+                                  CachedJacobian& cache,
+                                  iDynTree::MatrixDynSize& jacobian)
+{
+    updateCachedJacobian(frameIndex, cache);
+    jacobian = cache.jacobian;
+    return true;
+}
+
+void WalkingFK::getTaskJacobian(const iDynTree::FrameIndex& frameIndex,
+                                const CachedJacobian& cache,
+                                iDynTree::MatrixDynSize& jacobian)
+{
+    if(cache.isValid)
+    {
+        jacobian = cache.jacobian;
+        m_cacheHits++;
+        return;
+    }
+
+    computeJacobian(frameIndex, jacobian);
+    m_cacheMisses++;
+}
+
+bool WalkingFK::computeTaskJacobians(iDynTree::MatrixDynSize& leftFootJacobian,
+                                     iDynTree::MatrixDynSize& rightFootJacobian,
+                                     iDynTree::MatrixDynSize& neckJacobian,
+                                     iDynTree::MatrixDynSize& comJacobian)
+{
+    // the motion subspaces are evaluated only once and shared by all the jacobians. The jacobians
+    // are read once per state by the QP-IK, hence they are not copied in the cache
+    getTaskJacobian(m_frameLeftIndex, m_leftFootJacobian, leftFootJacobian);
+    getTaskJacobian(m_frameRightIndex, m_rightFootJacobian, rightFootJacobian);
+    getTaskJacobian(m_frameNeckIndex, m_neckJacobian, neckJacobian);
+    getTaskJacobian(iDynTree::FRAME_INVALID_INDEX, m_comJacobian, comJacobian);
+
+    return true;
+}
+
+std::size_t WalkingFK::getCacheHits() const
+{
+    return m_cacheHits;
+}
+
+std::size_t WalkingFK::getCacheMisses() const
+{
+    return m_cacheMisses;
+}
+
+void WalkingFK::resetCacheCounters()
+{
+    m_cacheHits = 0;
+    m_cacheMisses = 0;
 }
 
 const iDynTree::VectorDynSize& WalkingFK::getJointPos()
 {
 
-    bool ok = m_kinDyn.getJointPos(m_jointPositions);
+    bool ok = m_kinDyn->getJointPos(m_jointPositions);
 
     assert(ok);
 
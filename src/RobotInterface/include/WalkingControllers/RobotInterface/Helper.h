@@ -32,8 +32,22 @@
 #include <iDynTree/Core/Transform.h>
 
 #include <WalkingControllers/RobotInterface/PIDHandler.h>
+#include <WalkingControllers/RobotInterface/SensorMailbox.h>
 namespace WalkingControllers
 {
+    /**
+     * SensorSnapshot contains the timing of the feedback signals read in a control cycle.
+     * All the signals are evaluated at the same timestamp, i.e. the one of the encoders.
+     */
+    struct SensorSnapshot
+    {
+        double timestamp{0.0}; /**< Timestamp of the feedback signals in seconds. */
+        double encodersAge{0.0}; /**< Difference between the current time and the timestamp. */
+        double leftWrenchAge{0.0}; /**< Difference between the timestamp and the newest left wrench sample. */
+        double rightWrenchAge{0.0}; /**< Difference between the timestamp and the newest right wrench sample. */
+        double robotBaseAge{0.0}; /**< Difference between the timestamp and the newest robot base sample. */
+    };
+
     class RobotInterface
     {
         yarp::dev::PolyDriver m_robotDevice; /**< Main robot device. */
@@ -77,6 +91,15 @@ namespace WalkingControllers
         std::unique_ptr<iCub::ctrl::FirstOrderLowPassFilter> m_velocityFilter; /**< Joint velocity low pass filter .*/
         bool m_useVelocityFilter; /**< True if the joint velocity filter is used. */
 
+        double m_maxSensorAge; /**< Maximum age of the samples received by the ports in seconds. */
+        std::vector<double> m_encodersTimestamps; /**< Timestamps of the joint encoders. */
+        SensorSnapshot m_sensorSnapshot; /**< Timing of the last feedback signals. */
+
+        // the mailboxes are declared before the ports, so the ports are closed before the mailboxes are destroyed
+        SensorMailbox m_leftWrenchMailbox; /**< Latest sample received by the left foot wrench port. */
+        SensorMailbox m_rightWrenchMailbox; /**< Latest sample received by the right foot wrench port. */
+        SensorMailbox m_robotBaseMailbox; /**< Latest sample received by the robot base port. */
+
         yarp::os::BufferedPort<yarp::sig::Vector> m_leftWrenchPort; /**< Left foot wrench port. */
         yarp::os::BufferedPort<yarp::sig::Vector> m_rightWrenchPort; /**< Right foot wrench port. */
         yarp::sig::Vector m_leftWrenchInput; /**< YARP vector that contains left foot wrench. */
@@ -96,6 +119,7 @@ namespace WalkingControllers
         iDynTree::Transform m_robotBaseTransform; /**< Robot base to world transform */
         iDynTree::Twist m_robotBaseTwist; /**< Robot twist base expressed in mixed representation. */
         yarp::os::BufferedPort<yarp::sig::Vector> m_robotBasePort; /**< Robot base data port. */
+        yarp::sig::Vector m_robotBaseInput; /**< YARP vector that contains the robot base data. */
         double m_heightOffset;/**< Offset between r_sole frame and ground in Z direction */
 
         int m_controlMode{-1}; /**< Current position control mode */
@@ -141,12 +165,28 @@ namespace WalkingControllers
         bool configurePIDHandler(const yarp::os::Bottle& config);
 
         /**
-         * Get all the feedback signal from the interfaces
+         * Get all the feedback signal from the interfaces and filter them.
+         * @param maxWaitingTime maximum time spent waiting for the samples of the ports in seconds.
          * @return true in case of success and false otherwise.
          */
-        bool getFeedbacks(unsigned int maxAttempts = 1);
+        bool getFeedbacks(double maxWaitingTime = 0.0);
 
-        bool getFeedbacksRaw(unsigned int maxAttempts = 1);
+        /**
+         * Get all the feedback signal from the interfaces. The encoders return the last state
+         * streamed by the robot and the ports are read from their mailboxes, so the method does not
+         * block unless a sample is older than max_sensor_age. In this case it waits for a new
+         * sample at most maxWaitingTime seconds. The signals of the ports are interpolated at
+         * the timestamp of the encoders.
+         * @param maxWaitingTime maximum time spent waiting for the samples of the ports in seconds.
+         * @return true in case of success and false otherwise.
+         */
+        bool getFeedbacksRaw(double maxWaitingTime = 0.0);
+
+        /**
+         * Get the timing of the last feedback signals.
+         * @return the sensor snapshot.
+         */
+        const SensorSnapshot& getSensorSnapshot() const;
 
         /**
          * Set the desired position reference. (The position will be sent using PositionControl mode)
@@ -18,13 +18,14 @@
 #include <map>
 #include <string>
 #include <vector>
-#include <deque>
 #include <yarp/dev/ControlBoardPid.h>
 #include <yarp/os/Bottle.h>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
 
+#include <WalkingControllers/StdUtilities/Span.h>
+
 namespace yarp{
     namespace os{
         class Searchable;
@@ -128,7 +129,7 @@ namespace WalkingControllers
 
         bool fromStringToPIDPhase(const std::string &input, PIDPhase &output);
 
-        bool guessPhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed);
+        bool guessPhases(const StdUtilities::Span<bool>& leftIsFixed, const StdUtilities::Span<bool>& rightIsFixed);
 
         void setPIDThread();
 
@@ -149,7 +150,7 @@ namespace WalkingControllers
 
         bool usingGainScheduling();
 
-        bool updatePhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed, double time);
+        bool updatePhases(const StdUtilities::Span<bool>& leftIsFixed, const StdUtilities::Span<bool>& rightIsFixed, double time);
 
         bool reset();
     };
@@ -0,0 +1,144 @@
+/**
+ * @file SensorMailbox.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2019 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2019
+ */
+
+#ifndef WALKING_CONTROLLERS_ROBOT_HELPER_SENSOR_MAILBOX_H
+#define WALKING_CONTROLLERS_ROBOT_HELPER_SENSOR_MAILBOX_H
+
+// std
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/TypedReaderCallback.h>
+#include <yarp/sig/Vector.h>
+
+namespace WalkingControllers
+{
+    /**
+     * SensorMailbox stores the latest samples received by a port. It is filled by the port
+     * callback, so the control loop reads the samples in constant time without polling the port.
+     * A short history of timestamped samples is kept in order to evaluate the signal at a given
+     * time. The timestamp of a sample is taken from the envelope of the port, i.e. it has the
+     * same time base of the encoders. The samples without the envelope are not interpolated.
+     */
+    class SensorMailbox : public yarp::os::TypedReaderCallback<yarp::sig::Vector>
+    {
+        std::mutex m_mutex; /**< Mutex. */
+        std::condition_variable m_conditionVariable; /**< Used to wait for a new sample. */
+
+        yarp::os::BufferedPort<yarp::sig::Vector>* m_port{nullptr}; /**< Port attached to the mailbox. */
+        yarp::os::Stamp m_envelope; /**< Envelope of the sample processed by the port callback. */
+
+        std::vector<yarp::sig::Vector> m_samples; /**< Circular buffer containing the latest samples. */
+        std::vector<double> m_timestamps; /**< Timestamps of the samples. */
+        std::vector<bool> m_hasEnvelope; /**< True if the timestamp of the sample is taken from the envelope. */
+        std::size_t m_newestSample{0}; /**< Index of the newest sample. */
+        std::size_t m_numberOfSamples{0}; /**< Number of samples stored in the buffer. */
+        double m_arrivalTime{-1.0}; /**< Time at which the newest sample has been received (negative if no sample is available). */
+
+        std::vector<std::size_t> m_angleIndices; /**< Elements of the samples that are angles. */
+
+        /**
+         * Check if the newest sample is not too old. The mutex has to be locked.
+         * @param maxAge maximum age of the sample in seconds.
+         * @return true if the sample can be used.
+         */
+        bool isSampleValid(double maxAge) const;
+
+        /**
+         * Wait until the newest sample is not too old.
+         * @param lock lock of the mutex;
+         * @param maxAge maximum age of the sample in seconds;
+         * @param maxWaitingTime maximum time spent waiting for a new sample in seconds.
+         * @return true if the sample can be used.
+         */
+        bool waitForSample(std::unique_lock<std::mutex>& lock, double maxAge, double maxWaitingTime);
+
+    public:
+
+        /**
+         * Constructor.
+         * @param historyLength number of samples stored by the mailbox.
+         */
+        SensorMailbox(std::size_t historyLength = 1);
+
+        /**
+         * Set the number of samples stored by the mailbox. The stored samples are discarded.
+         * @param historyLength number of samples stored by the mailbox.
+         */
+        void setHistoryLength(std::size_t historyLength);
+
+        /**
+         * Set the elements of the samples that are angles. They are interpolated along the
+         * shortest arc.
+         * @param angleIndices indices of the angles.
+         */
+        void setAngleIndices(const std::vector<std::size_t>& angleIndices);
+
+        /**
+         * Attach the mailbox to a port. The port callback is used to fill the mailbox.
+         * @param port the port.
+         */
+        void attach(yarp::os::BufferedPort<yarp::sig::Vector>& port);
+
+        using yarp::os::TypedReaderCallback<yarp::sig::Vector>::onRead;
+
+        /**
+         * Store the sample received by the port. It is called by the port thread.
+         * @param sample received sample.
+         */
+        void onRead(yarp::sig::Vector& sample) override;
+
+        /**
+         * Store a sample.
+         * @param sample the sample;
+         * @param envelope envelope of the sample (the sample has no timestamp if it is not valid).
+         */
+        void addSample(const yarp::sig::Vector& sample, const yarp::os::Stamp& envelope);
+
+        /**
+         * Get the latest sample. If the sample is older than maxAge the method waits for a new
+         * sample at most maxWaitingTime seconds.
+         * @param sample latest sample;
+         * @param maxAge maximum age of the sample in seconds;
+         * @param maxWaitingTime maximum time spent waiting for a new sample in seconds.
+         * @return true/false in case of success/failure (no sample or stale sample).
+         */
+        bool getLatestSample(yarp::sig::Vector& sample, double maxAge, double maxWaitingTime = 0.0);
+
+        /**
+         * Get the signal at a given time. The signal is linearly interpolated between the stored
+         * samples, outside the stored history the closest sample is held. If the newest sample
+         * has no envelope it is returned without interpolation. If the newest sample is
+         * older than maxAge the method waits for a new sample at most maxWaitingTime seconds.
+         * @param time time at which the signal is evaluated (time base of the envelopes);
+         * @param sample value of the signal;
+         * @param age difference between time and the timestamp of the newest sample (if the
+         * newest sample has no envelope, time elapsed since its arrival);
+         * @param maxAge maximum age of the newest sample in seconds;
+         * @param maxWaitingTime maximum time spent waiting for a new sample in seconds.
+         * @return true/false in case of success/failure (no sample or stale sample).
+         */
+        bool getSample(double time, yarp::sig::Vector& sample, double& age,
+                       double maxAge, double maxWaitingTime = 0.0);
+
+        /**
+         * Get the age of the newest sample.
+         * @return the age in seconds (negative if no sample is available).
+         */
+        double getAge();
+
+        /**
+         * Discard the stored samples.
+         */
+        void reset();
+    };
+};
+#endif
@@ -46,7 +46,7 @@ bool RobotInterface::getWorstError(const iDynTree::VectorDynSize& desiredJointPo
     return true;
 }
 
-bool RobotInterface::getFeedbacksRaw(unsigned int maxAttempts)
+bool RobotInterface::getFeedbacksRaw(double maxWaitingTime)
 {
     if(!m_encodersInterface)
     {
@@ -54,106 +54,104 @@ bool RobotInterface::getFeedbacksRaw(unsigned int maxAttempts)
         return false;
     }
 
-    bool okPosition = false;
-    bool okVelocity = false;
-
-    bool okLeftWrench = false;
-    bool okRightWrench = false;
-
-    bool okBaseEstimation = !m_useExternalRobotBase;
+    // the encoders interface returns the last state streamed by the robot without blocking
+    bool okPosition = m_encodersInterface->getEncodersTimed(m_positionFeedbackDeg.data(),
+                                                            m_encodersTimestamps.data());
+    bool okVelocity = m_encodersInterface->getEncoderSpeeds(m_velocityFeedbackDeg.data());
 
-    unsigned int attempt = 0;
-    do
+    // the timestamp of the feedback is the mean of the valid encoders timestamps (a joint that
+    // has not streamed any data has a null timestamp). If they are not available the current
+    // time is used
+    double now = yarp::os::Time::now();
+    double timestamp = 0;
+    std::size_t numberOfTimestamps = 0;
+    if(okPosition)
     {
-        if(!okPosition)
-            okPosition = m_encodersInterface->getEncoders(m_positionFeedbackDeg.data());
-
-        if(!okVelocity)
-            okVelocity = m_encodersInterface->getEncoderSpeeds(m_velocityFeedbackDeg.data());
-
-        if(!okLeftWrench)
+        for(const auto& encoderTimestamp : m_encodersTimestamps)
         {
-            yarp::sig::Vector *leftWrenchRaw = NULL;
-            leftWrenchRaw = m_leftWrenchPort.read(false);
-            if(leftWrenchRaw != NULL)
-            {
-                m_leftWrenchInput = *leftWrenchRaw;
-                okLeftWrench = true;
-            }
-        }
+            if(encoderTimestamp <= 0)
+                continue;
 
-        if(!okRightWrench)
-        {
-            yarp::sig::Vector *rightWrenchRaw = NULL;
-            rightWrenchRaw = m_rightWrenchPort.read(false);
-            if(rightWrenchRaw != NULL)
-            {
-                m_rightWrenchInput = *rightWrenchRaw;
-                okRightWrench = true;
-            }
+            timestamp += encoderTimestamp;
+            numberOfTimestamps++;
         }
+    }
+    if(numberOfTimestamps > 0)
+        timestamp /= numberOfTimestamps;
+    else
+        timestamp = now;
 
-        if(!okBaseEstimation)
+    m_sensorSnapshot.timestamp = timestamp;
+    m_sensorSnapshot.encodersAge = now - timestamp;
+
+    // the samples of the ports are stored by the port callbacks and they are interpolated at the
+    // timestamp of the encoders. A stale sample is rejected
+    bool okLeftWrench = m_leftWrenchMailbox.getSample(timestamp, m_leftWrenchInput,
+                                                      m_sensorSnapshot.leftWrenchAge,
+                                                      m_maxSensorAge, maxWaitingTime);
+    bool okRightWrench = m_rightWrenchMailbox.getSample(timestamp, m_rightWrenchInput,
+                                                        m_sensorSnapshot.rightWrenchAge,
+                                                        m_maxSensorAge, maxWaitingTime);
+
+    bool okBaseEstimation = !m_useExternalRobotBase;
+    if(!okBaseEstimation)
+    {
+        okBaseEstimation = m_robotBaseMailbox.getSample(timestamp, m_robotBaseInput,
+                                                        m_sensorSnapshot.robotBaseAge,
+                                                        m_maxSensorAge, maxWaitingTime);
+        if(okBaseEstimation)
         {
-            yarp::sig::Vector *base = NULL;
-            base = m_robotBasePort.read(false);
-            if(base != NULL)
-            {
-                m_robotBaseTransform.setPosition(iDynTree::Position((*base)(0),
-                                                                    (*base)(1),
-                                                                    (*base)(2) - m_heightOffset));
+            m_robotBaseTransform.setPosition(iDynTree::Position(m_robotBaseInput(0),
+                                                                m_robotBaseInput(1),
+                                                                m_robotBaseInput(2) - m_heightOffset));
 
-                m_robotBaseTransform.setRotation(iDynTree::Rotation::RPY((*base)(3),
-                                                                         (*base)(4),
-                                                                         (*base)(5)));
+            m_robotBaseTransform.setRotation(iDynTree::Rotation::RPY(m_robotBaseInput(3),
+                                                                     m_robotBaseInput(4),
+                                                                     m_robotBaseInput(5)));
 
-                m_robotBaseTwist.setLinearVec3(iDynTree::Vector3(base->data() + 6, 3));
-                m_robotBaseTwist.setAngularVec3(iDynTree::Vector3(base->data() + 6 + 3, 3));
-                okBaseEstimation = true;
-            }
+            m_robotBaseTwist.setLinearVec3(iDynTree::Vector3(m_robotBaseInput.data() + 6, 3));
+            m_robotBaseTwist.setAngularVec3(iDynTree::Vector3(m_robotBaseInput.data() + 6 + 3, 3));
         }
+    }
 
-        if(okPosition && okVelocity && okLeftWrench && okRightWrench && okBaseEstimation)
-        {
-            for(unsigned j = 0 ; j < m_actuatedDOFs; j++)
-            {
-                m_positionFeedbackRad(j) = iDynTree::deg2rad(m_positionFeedbackDeg(j));
-                m_velocityFeedbackRad(j) = iDynTree::deg2rad(m_velocityFeedbackDeg(j));
-            }
+    if(!(okPosition && okVelocity && okLeftWrench && okRightWrench && okBaseEstimation))
+    {
+        yError() << "[RobotInterface::getFeedbacksRaw] The following readings failed:";
+        if(!okPosition)
+            yError() << "\t - Position encoders";
 
-            if(!iDynTree::toiDynTree(m_leftWrenchInput, m_leftWrench))
-            {
-                yError() << "[RobotInterface::getFeedbacksRaw] Unable to convert left foot wrench.";
-                return false;
-            }
-            if(!iDynTree::toiDynTree(m_rightWrenchInput, m_rightWrench))
-            {
-                yError() << "[RobotInterface::getFeedbacksRaw] Unable to convert right foot wrench.";
-                return false;
-            }
-            return true;
-        }
-        yarp::os::Time::delay(0.001);
-        attempt++;
-    } while (attempt < maxAttempts);
+        if(!okVelocity)
+            yError() << "\t - Velocity encoders";
 
-    yError() << "[RobotInterface::getFeedbacksRaw] The following readings failed:";
-    if(!okPosition)
-        yError() << "\t - Position encoders";
+        if(!okLeftWrench)
+            yError() << "\t - Left wrench (age: " << m_leftWrenchMailbox.getAge() << " s)";
 
-    if(!okVelocity)
-        yError() << "\t - Velocity encoders";
+        if(!okRightWrench)
+            yError() << "\t - Right wrench (age: " << m_rightWrenchMailbox.getAge() << " s)";
 
-    if(!okLeftWrench)
-        yError() << "\t - Left wrench";
+        if(!okBaseEstimation)
+            yError() << "\t - Base estimation (age: " << m_robotBaseMailbox.getAge() << " s)";
 
-    if(!okRightWrench)
-        yError() << "\t - Right wrench";
+        return false;
+    }
 
-    if(!okBaseEstimation)
-        yError() << "\t - Base estimation";
+    for(unsigned j = 0 ; j < m_actuatedDOFs; j++)
+    {
+        m_positionFeedbackRad(j) = iDynTree::deg2rad(m_positionFeedbackDeg(j));
+        m_velocityFeedbackRad(j) = iDynTree::deg2rad(m_velocityFeedbackDeg(j));
+    }
 
-    return false;
+    if(!iDynTree::toiDynTree(m_leftWrenchInput, m_leftWrench))
+    {
+        yError() << "[RobotInterface::getFeedbacksRaw] Unable to convert left foot wrench.";
+        return false;
+    }
+    if(!iDynTree::toiDynTree(m_rightWrenchInput, m_rightWrench))
+    {
+        yError() << "[RobotInterface::getFeedbacksRaw] Unable to convert right foot wrench.";
+        return false;
+    }
+    return true;
 }
 
 bool RobotInterface::configureRobot(const yarp::os::Searchable& config)
@@ -308,6 +306,7 @@ bool RobotInterface::configureRobot(const yarp::os::Searchable& config)
 
     // resize the buffers
     m_positionFeedbackDeg.resize(m_actuatedDOFs, 0.0);
+    m_encodersTimestamps.resize(m_actuatedDOFs, 0.0);
     m_velocityFeedbackDeg.resize(m_actuatedDOFs, 0.0);
     m_positionFeedbackRad.resize(m_actuatedDOFs);
     m_velocityFeedbackRad.resize(m_actuatedDOFs);
@@ -391,9 +390,33 @@ bool RobotInterface::configureRobot(const yarp::os::Searchable& config)
 
     }
 
+    // a sample received by a port is used only if it is not older than the maximum age
+    m_maxSensorAge = config.check("max_sensor_age", yarp::os::Value(0.1)).asDouble();
+    if(m_maxSensorAge <= 0)
+    {
+        yError() << "[RobotInterface::configureRobot] The maximum age of the sensor samples has to be positive.";
+        return false;
+    }
+
+    // number of samples of the ports stored in order to align them with the encoders
+    int sensorHistoryLength = config.check("sensor_history_length", yarp::os::Value(10)).asInt();
+    if(sensorHistoryLength <= 0)
+    {
+        yError() << "[RobotInterface::configureRobot] The length of the sensor history has to be positive.";
+        return false;
+    }
+    m_leftWrenchMailbox.setHistoryLength(sensorHistoryLength);
+    m_rightWrenchMailbox.setHistoryLength(sensorHistoryLength);
+    m_robotBaseMailbox.setHistoryLength(sensorHistoryLength);
+
+    // the base port contains the position, the RPY angles and the twist of the base
+    m_robotBaseMailbox.setAngleIndices({3, 4, 5});
+
     m_useExternalRobotBase = config.check("use_external_robot_base", yarp::os::Value("False")).asBool();
     if(m_useExternalRobotBase)
     {
+        m_robotBaseMailbox.reset();
+        m_robotBaseMailbox.attach(m_robotBasePort);
         m_robotBasePort.open("/" + name + "/robotBase:i");
         // connect port
 
@@ -460,7 +483,9 @@ bool RobotInterface::configureForceTorqueSensors(const yarp::os::Searchable& con
         yError() << "[RobotInterface::configureForceTorqueSensors] Unable to get the string from searchable.";
         return false;
     }
-    // open port
+    // open port. The samples are stored by the callback
+    m_leftWrenchMailbox.reset();
+    m_leftWrenchMailbox.attach(m_leftWrenchPort);
     m_leftWrenchPort.open("/" + name + portInput);
     // connect port
     if(!yarp::os::Network::connect(portOutput, "/" + name + portInput))
@@ -481,7 +506,9 @@ bool RobotInterface::configureForceTorqueSensors(const yarp::os::Searchable& con
         yError() << "[RobotInterface::configureForceTorqueSensors] Unable to get the string from searchable.";
         return false;
     }
-    // open port
+    // open port. The samples are stored by the callback
+    m_rightWrenchMailbox.reset();
+    m_rightWrenchMailbox.attach(m_rightWrenchPort);
     m_rightWrenchPort.open("/" + name + portInput);
     // connect port
     if(!yarp::os::Network::connect(portOutput, "/" + name + portInput))
@@ -518,7 +545,7 @@ bool RobotInterface::configurePIDHandler(const yarp::os::Bottle& config)
 
 bool RobotInterface::resetFilters()
 {
-    if(!getFeedbacksRaw(100))
+    if(!getFeedbacksRaw(m_maxSensorAge))
     {
         yError() << "[RobotInterface::resetFilters] Unable to get the feedback from the robot";
         return false;
@@ -536,9 +563,9 @@ bool RobotInterface::resetFilters()
     return true;
 }
 
-bool RobotInterface::getFeedbacks(unsigned int maxAttempts)
+bool RobotInterface::getFeedbacks(double maxWaitingTime)
 {
-    if(!getFeedbacksRaw(maxAttempts))
+    if(!getFeedbacksRaw(maxWaitingTime))
     {
         yError() << "[RobotInterface::getFeedbacks] Unable to get the feedback from the robot";
         return false;
@@ -836,6 +863,8 @@ bool RobotInterface::close()
 {
     m_rightWrenchPort.close();
     m_leftWrenchPort.close();
+    if(m_useExternalRobotBase)
+        m_robotBasePort.close();
     switchToControlMode(VOCAB_CM_POSITION);
     m_controlMode = VOCAB_CM_POSITION;
     setInteractionMode(yarp::dev::InteractionModeEnum::VOCAB_IM_STIFF);
@@ -848,6 +877,11 @@ bool RobotInterface::close()
     return true;
 }
 
+const SensorSnapshot& RobotInterface::getSensorSnapshot() const
+{
+    return m_sensorSnapshot;
+}
+
 const iDynTree::VectorDynSize& RobotInterface::getJointPosition() const
 {
     return m_positionFeedbackRad;
@@ -225,7 +225,7 @@ bool WalkingPIDHandler::fromStringToPIDPhase(const std::string &input, PIDPhase
     return true;
 }
 
-bool WalkingPIDHandler::guessPhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed)
+bool WalkingPIDHandler::guessPhases(const StdUtilities::Span<bool>& leftIsFixed, const StdUtilities::Span<bool>& rightIsFixed)
 {
     if (leftIsFixed.size() != rightIsFixed.size()){
         yError() << "Incongruous dimension of the leftIsFixed and rightIsFixed vectors.";
@@ -669,7 +669,7 @@ bool WalkingPIDHandler::usingGainScheduling()
     return m_useGainScheduling;
 }
 
-bool WalkingPIDHandler::updatePhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed, double time)
+bool WalkingPIDHandler::updatePhases(const StdUtilities::Span<bool>& leftIsFixed, const StdUtilities::Span<bool>& rightIsFixed, double time)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
@@ -0,0 +1,193 @@
+/**
+ * @file SensorMailbox.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2019 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2019
+ */
+
+// std
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <yarp/os/Time.h>
+
+#include <WalkingControllers/RobotInterface/SensorMailbox.h>
+
+using namespace WalkingControllers;
+
+SensorMailbox::SensorMailbox(std::size_t historyLength)
+{
+    setHistoryLength(historyLength);
+}
+
+void SensorMailbox::setHistoryLength(std::size_t historyLength)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    historyLength = std::max(historyLength, (std::size_t) 1);
+    m_samples.resize(historyLength);
+    m_timestamps.resize(historyLength);
+    m_hasEnvelope.resize(historyLength);
+    m_newestSample = 0;
+    m_numberOfSamples = 0;
+    m_arrivalTime = -1.0;
+}
+
+void SensorMailbox::setAngleIndices(const std::vector<std::size_t>& angleIndices)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_angleIndices = angleIndices;
+}
+
+void SensorMailbox::attach(yarp::os::BufferedPort<yarp::sig::Vector>& port)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_port = &port;
+    }
+    port.useCallback(*this);
+}
+
+bool SensorMailbox::isSampleValid(double maxAge) const
+{
+    return m_arrivalTime >= 0 && yarp::os::Time::now() - m_arrivalTime <= maxAge;
+}
+
+bool SensorMailbox::waitForSample(std::unique_lock<std::mutex>& lock, double maxAge, double maxWaitingTime)
+{
+    if(isSampleValid(maxAge))
+        return true;
+
+    if(maxWaitingTime <= 0)
+        return false;
+
+    auto timeout = std::chrono::duration<double>(maxWaitingTime);
+    return m_conditionVariable.wait_for(lock, timeout, [&](){return isSampleValid(maxAge);});
+}
+
+void SensorMailbox::onRead(yarp::sig::Vector& sample)
+{
+    // the envelope refers to the sample that is currently processed by the callback
+    if(m_port == nullptr || !m_port->getEnvelope(m_envelope))
+        m_envelope = yarp::os::Stamp();
+
+    addSample(sample, m_envelope);
+}
+
+void SensorMailbox::addSample(const yarp::sig::Vector& sample, const yarp::os::Stamp& envelope)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_arrivalTime = yarp::os::Time::now();
+
+        bool hasEnvelope = envelope.isValid();
+
+        m_newestSample = (m_newestSample + 1) % m_samples.size();
+        m_samples[m_newestSample] = sample;
+        m_timestamps[m_newestSample] = hasEnvelope ? envelope.getTime() : m_arrivalTime;
+        m_hasEnvelope[m_newestSample] = hasEnvelope;
+        m_numberOfSamples = std::min(m_numberOfSamples + 1, m_samples.size());
+    }
+    m_conditionVariable.notify_all();
+}
+
+bool SensorMailbox::getLatestSample(yarp::sig::Vector& sample, double maxAge, double maxWaitingTime)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(!waitForSample(lock, maxAge, maxWaitingTime))
+        return false;
+
+    sample = m_samples[m_newestSample];
+    return true;
+}
+
+bool SensorMailbox::getSample(double time, yarp::sig::Vector& sample, double& age,
+                              double maxAge, double maxWaitingTime)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(!waitForSample(lock, maxAge, maxWaitingTime))
+        return false;
+
+    // the arrival time and the time of the envelope are not compared. Without the envelope the
+    // newest sample is used and its age is evaluated from the arrival time
+    if(!m_hasEnvelope[m_newestSample])
+    {
+        age = yarp::os::Time::now() - m_arrivalTime;
+        sample = m_samples[m_newestSample];
+        return true;
+    }
+
+    age = time - m_timestamps[m_newestSample];
+
+    // the signal is not extrapolated
+    if(time >= m_timestamps[m_newestSample])
+    {
+        sample = m_samples[m_newestSample];
+        return true;
+    }
+
+    // look for the two samples around the required time (from the newest to the oldest)
+    const std::size_t historyLength = m_samples.size();
+    std::size_t newer = m_newestSample;
+    for(std::size_t i = 1; i < m_numberOfSamples; i++)
+    {
+        std::size_t older = (m_newestSample + historyLength - i) % historyLength;
+
+        // the history is interrupted by a sample without the envelope
+        if(!m_hasEnvelope[older])
+            break;
+
+        if(m_timestamps[older] <= time)
+        {
+            const yarp::sig::Vector& olderSample = m_samples[older];
+            const yarp::sig::Vector& newerSample = m_samples[newer];
+            if(olderSample.size() != newerSample.size())
+            {
+                sample = newerSample;
+                return true;
+            }
+
+            double length = m_timestamps[newer] - m_timestamps[older];
+            double s = length > 0 ? (time - m_timestamps[older]) / length : 1.0;
+
+            sample.resize(newerSample.size());
+            for(std::size_t j = 0; j < newerSample.size(); j++)
+                sample[j] = olderSample[j] + s * (newerSample[j] - olderSample[j]);
+
+            // the angles are interpolated along the shortest arc
+            for(const auto& j : m_angleIndices)
+            {
+                if(j >= newerSample.size())
+                    continue;
+
+                double difference = newerSample[j] - olderSample[j];
+                difference = std::atan2(std::sin(difference), std::cos(difference));
+                sample[j] = olderSample[j] + s * difference;
+            }
+            return true;
+        }
+        newer = older;
+    }
+
+    // the required time is older than the history, the oldest sample with the envelope is held
+    sample = m_samples[newer];
+    return true;
+}
+
+double SensorMailbox::getAge()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_arrivalTime < 0)
+        return -1.0;
+
+    return yarp::os::Time::now() - m_arrivalTime;
+}
+
+void SensorMailbox::reset()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_newestSample = 0;
+    m_numberOfSamples = 0;
+    m_arrivalTime = -1.0;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file CondensedMPCSolver.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_CONDENSED_MPC_SOLVER_H
+#define WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_CONDENSED_MPC_SOLVER_H
+
+// std
+#include <memory>
+
+// osqp-eigen
+#include <OsqpEigen/OsqpEigen.h>
+
+#include <WalkingControllers/iDynTreeUtilities/Helper.h>
+#include <WalkingControllers/SimplifiedModelControllers/MPCSolver.h>
+
+namespace WalkingControllers
+{
+
+    /**
+     * CondensedMPCSolver class. The states are eliminated using the DCM dynamics
+     * \f$ x_{k+1} = a x_k + b u_k \f$ (a and b are scalars), hence the problem does not contain
+     * equality constraints. Since \f$ a > 1 \f$ eliminating the states directly leads to a
+     * hessian matrix whose entries grow as \f$ a^{2N} \f$. For this reason the input is
+     * pre-stabilized, \f$ u_k = K x_k + v_k \f$, and the offsets \f$ v_k \f$ are the optimization
+     * variables. The gain moves the pole of the closed loop dynamics in \f$ \rho = a + b K \f$.
+     * The optimal input sequence is the same of the sparse formulation.
+     */
+    class CondensedMPCSolver : public MPCSolver
+    {
+        /**
+         * Pointer to the optimization solver
+         */
+        std::unique_ptr<OsqpEigen::Solver> m_optimizerSolver;
+        Eigen::Matrix2d m_stateWeightMatrix; /**< State weight matrix (Q) */
+        Eigen::Matrix2d m_inputWeightMatrix; /**< Input weight matrix (R) */
+
+        double m_inputDynamics; /**< Coefficient of the input dynamics (b). */
+        double m_feedbackGain; /**< Pre-stabilizing feedback gain (K). */
+        double m_closedLoopDynamics; /**< Coefficient of the closed loop dynamics (rho = a + b K). */
+        Eigen::VectorXd m_closedLoopDynamicsPowers; /**< Vector containing rho^k for k = 0, ..., N. */
+
+        Eigen::VectorXd m_lowerBound; /**< Lower bound vector. */
+        Eigen::VectorXd m_upperBound; /**< Upper bound vector. */
+        Eigen::VectorXd m_gradient; /**< Gradient vector. */
+        Eigen::SparseMatrix<double> m_constraintsMatrix; /**< Linear constraints matrix (only the first input is constrained). */
+        Eigen::MatrixXd m_firstInputConstraintsMatrix; /**< Constraints matrix of the first input (used to shift the bounds). */
+
+        Eigen::Vector2d m_currentState; /**< Current value of the state. */
+        Eigen::Matrix2Xd m_referenceSignal; /**< Reference signal along the horizon. */
+        Eigen::Vector2d m_previousControllerOutput; /**< Previous controller output. */
+
+        int m_stateSize; /**< Size of the state vector (2). */
+        int m_inputSize; /**< Size of the controlled input vector (2). */
+        int m_controllerHorizon; /**< Controller horizon (in steps)*/
+        int m_numberOfInequalityConstraints; /**< Number of inequality constraints*/
+
+        /**
+         * Evaluate the gradient vector using the current state, the reference signal and the
+         * previous controller output. The cost of the evaluation is linear in the controller horizon.
+         */
+        void evaluateGradient();
+
+    public:
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /**
+         * Constructor.
+         * @param stateSize size of the state vector;
+         * @param inputSize size of the controlled input vector;
+         * @param controllerHorizon controller horizon (in steps);
+         * @param numberOfInequalityConstraints number of inequality constraints;
+         * @param stateDynamics coefficient of the state dynamics (a);
+         * @param inputDynamics coefficient of the input dynamics (b);
+         * @param feedbackGain pre-stabilizing feedback gain (K);
+         * @param stateWeightMatrix state weight matrix \f$ Q \f$;
+         * @param inputWeightMatrix input weight matrix \f$ R \f$.
+         */
+        CondensedMPCSolver(const int& stateSize, const int& inputSize,
+                           const int& controllerHorizon,
+                           const int& numberOfInequalityConstraints,
+                           const double& stateDynamics,
+                           const double& inputDynamics,
+                           const double& feedbackGain,
+                           const iDynSparseMatrix& stateWeightMatrix,
+                           const iDynSparseMatrix& inputWeightMatrix);
+
+        /**
+         * Set the hessian matrix. It has to be the condensed hessian matrix of the pre-stabilized
+         * problem \f$ \Gamma^T \tilde{Q} \Gamma + M^T \Theta^T \tilde{R} \Theta M \f$.
+         * Please do not call this function to update the hessian matrix! It can be set only once.
+         * @param hessian hessian matrix.
+         * @return true/false in case of success/failure.
+         */
+        bool setHessianMatrix(const iDynSparseMatrix& hessian) final;
+
+        /**
+         * Set or update the linear constraints matrix.
+         * @param inequalityConstraintsMatrix  matrix of the inequalities constraints (Ax < b)
+         * @return true/false in case of success/failure.
+         */
+        bool setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix) final;
+
+        /**
+         * Get the number of inequality constraints handled by the solver.
+         * @return the number of inequality constraints.
+         */
+        int getNumberOfInequalityConstraints() const final;
+
+        /**
+         * Set or update the bounds. The current state is stored since it is required by the
+         * gradient. The bounds are shifted by the feedback term of the first input.
+         * @param currentState value of the current state
+         * @param inequalityConstraintsVector vector of the inequalities constraints (Ax < b)
+         * @return true/false in case of success/failure.
+         */
+        bool setBounds(const iDynTree::Vector2& currentState,
+                       const iDynTree::VectorDynSize& inequalityConstraintsVector) final;
+
+        /**
+         * Set the reference signal and the previous controller output. The gradient is evaluated
+         * when the problem is solved.
+         * @param referenceSignal reference signal vector;
+         * @param previousControllerOutput previous controller output;
+         * @param resetTrajectory set equal to true if you do not want to use the previous trajectory.
+         * Otherwise the stored reference signal is shifted and only the last sample is read.
+         * @return true/false in case of success/failure.
+         */
+        bool setGradient(const StdUtilities::Span<iDynTree::Vector2>& refereceSignal,
+                         const iDynTree::Vector2& previousControllerOutput,
+                         const bool& resetTrajectory) final;
+
+        /**
+         * Get the shifted sequence of input offsets. The problem does not have equality constraints, hence
+         * the dynamicsDualVariable is empty.
+         * @param primalVariable shifted primal variable vector;
+         * @param dynamicsDualVariable shifted dual variable related to the equality constraints.
+         * @return true/false in case of success/failure.
+         */
+        bool getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                 Eigen::VectorXd& dynamicsDualVariable) final;
+
+        /**
+         * Warm start the solver.
+         * @param primalVariable primal variable vector;
+         * @param dynamicsDualVariable not used.
+         * @return true/false in case of success/failure.
+         */
+        bool setWarmStart(const Eigen::VectorXd& primalVariable,
+                          const Eigen::VectorXd& dynamicsDualVariable) final;
+
+        /**
+         * Get the state of the solver.
+         * @return true if the solver is initialized false otherwise.
+         */
+        bool isInitialized() final;
+
+        /**
+         * Initialize the solver.
+         * @return true/false in case of success/failure.
+         */
+        bool initialize() final;
+
+        /**
+         * Solve the optimization problem.
+         * @return true/false in case of success/failure.
+         */
+        bool solve() final;
+
+        /**
+         * Get the first element of the optimal input sequence (i.e. the desired ZMP)
+         * \f$ u_0 = K x_0 + v_0 \f$.
+         * @param input the first element of the input sequence.
+         * @return true/false in case of success/failure.
+         */
+        bool getFirstInput(iDynTree::Vector2& input) final;
+    };
+};
+
+#endif
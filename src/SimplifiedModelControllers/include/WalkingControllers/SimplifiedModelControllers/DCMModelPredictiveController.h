@@ -25,7 +25,9 @@
 #include <yarp/os/Value.h>
 
 #include <unordered_map>
-#include <deque>
+#include <map>
+
+#include <WalkingControllers/StdUtilities/Span.h>
 
 // solver
 #include <WalkingControllers/SimplifiedModelControllers/MPCSolver.h>
@@ -33,6 +35,13 @@
 namespace WalkingControllers
 {
 
+/**
+ * Formulation of the DCM model predictive controller.
+ * - Sparse: the states and the inputs are the optimization variables;
+ * - Condensed: the states are eliminated and only the inputs are the optimization variables.
+ */
+    enum class MPCFormulation {Sparse, Condensed};
+
 /**
  * WalkingController class contains the controller instances.
  * Each controller depends on the number of the inequality constraints.
@@ -64,6 +73,15 @@ namespace WalkingControllers
          */
         iDynSparseMatrix m_stateWeightMatrix;
 
+        MPCFormulation m_formulation; /**< Formulation of the optimization problem. */
+        bool m_useRiccatiSolver; /**< True if the Riccati based solver is used instead of osqp. */
+
+        double m_stateDynamics; /**< Coefficient of the state dynamics (\f$ e^{\omega dT} \f$). */
+        double m_inputDynamics; /**< Coefficient of the input dynamics (\f$ 1 - e^{\omega dT} \f$). */
+        double m_condensedFeedbackGain{0}; /**< Pre-stabilizing feedback gain used by the condensed formulation. */
+
+        iDynSparseMatrix m_inputWeightMatrix; /**< Input weight matrix \f$ R \f$. */
+
         int m_stateSize; /**< Size of the state vector. It is equal to 2. */
         int m_inputSize;  /**< Size of the input vector. It is equal to 2. */
         int m_controllerHorizon; /**< Length of the controller horizon. */
@@ -76,12 +94,23 @@ namespace WalkingControllers
         iDynTree::ConvexHullProjectionConstraint m_convexHullComputer; /**<iDynTree convex hull helper. */
         std::vector<iDynTree::Polygon> m_feetPolygons; /**<Vector containing the polygon of each foot (left and right). */
 
+        /**
+         * Pool of MPC solvers. A solver is stored for each contact configuration (left stance,
+         * right stance and double support) and it is reused every time the configuration occurs.
+         */
+        std::map<std::pair<bool, bool>, std::shared_ptr<MPCSolver>> m_controllers;
+
         /**
          * Pointer to the current MPCSolver.
-         * A new MPC solver is initialized when a new phase occurs.
+         * The controller is taken from the pool when a new phase occurs.
          */
         std::shared_ptr<MPCSolver> m_currentController;
 
+        bool m_isWarmStartAvailable{false}; /**< True if the current controller has to be warm started. */
+        bool m_isGradientOutdated{false}; /**< True if the gradient of the current controller has to be evaluated from scratch. */
+        Eigen::VectorXd m_warmStartPrimalVariable; /**< Primal variable used to warm start the current controller. */
+        Eigen::VectorXd m_warmStartDualVariable; /**< Dual variable (dynamics constraints) used to warm start the current controller. */
+
         iDynTree::Vector2 m_output; /**< Vector containing the output of the controller. */
 
         /**
@@ -150,6 +179,25 @@ namespace WalkingControllers
         iDynSparseMatrix evaluateGradientSubmatrix(const iDynTree::Triplets& inputWeightStackedMatrix,
                                                    const iDynSparseMatrix& thetaMatrix);
 
+        /**
+         * Evaluate the hessian matrix of the condensed formulation.
+         * \f$ \Gamma^T \tilde{Q} \Gamma + M^T \Theta^T \tilde{R} \Theta M \f$ where \f$ \Gamma \f$
+         * and \f$ M \f$ map the input offsets of the pre-stabilized problem into the state and the
+         * input sequences.
+         * @param stateWeightMatrix is the state weight matrix (\f$ Q \f$);
+         * @param inputWeightMatrix is the input weight matrix (\f$ R \f$).
+         * @return the hessian matrix.
+         */
+        iDynSparseMatrix evaluateCondensedHessianMatrix(const iDynSparseMatrix& stateWeightMatrix,
+                                                        const iDynSparseMatrix& inputWeightMatrix);
+
+        /**
+         * Instantiate a new MPC solver according to the chosen formulation and solver.
+         * @param numberOfConstraints number of inequality constraints.
+         * @return pointer to the solver (nullptr in case of failure).
+         */
+        std::shared_ptr<MPCSolver> instantiateSolver(const int& numberOfConstraints);
+
         /**
          * Evaluate the equal constraint matrix.
          * @param stateDynamicsTriplets are the triplets related to the linear state dynamics matrix;
@@ -199,22 +247,23 @@ namespace WalkingControllers
         bool initialize(const yarp::os::Searchable& config);
 
         /**
-         * If the phase (DS or SS) is changed the new convex hull is evaluated and a new MPCSolver
-         * is initialize.
-         * @param leftFoot deque containing the homogeneous transformation of the left foot during
+         * If the phase (DS or SS) is changed the new convex hull is evaluated and the MPCSolver
+         * associated to the new phase is taken from the pool. Its constraints matrix is updated and
+         * it is warm started with the shifted solution of the previous solver.
+         * @param leftFoot view of the homogeneous transformation of the left foot during
          * the trajectory;
-         * @param rightFoot deque containing the homogeneous transformation of the right foot during
+         * @param rightFoot view of the homogeneous transformation of the right foot during
          * the trajectory;
-         * @param leftInContact deque containing information about the state of the left foot
+         * @param leftInContact view of information about the state of the left foot
          * (stance = true, swing = false);
-         * @param rightInContact deque containing information about the state of the left foot
+         * @param rightInContact view of information about the state of the left foot
          * (stance = true, swing = false).
          * @return true/false in case of success/failure.
          */
-        bool setConvexHullConstraint(const std::deque<iDynTree::Transform>& leftFoot,
-                                     const std::deque<iDynTree::Transform>& rightFoot,
-                                     const std::deque<bool>& leftInContact,
-                                     const std::deque<bool>& rightInContact);
+        bool setConvexHullConstraint(const StdUtilities::Span<iDynTree::Transform>& leftFoot,
+                                     const StdUtilities::Span<iDynTree::Transform>& rightFoot,
+                                     const StdUtilities::Span<bool>& leftInContact,
+                                     const StdUtilities::Span<bool>& rightInContact);
 
         /**
          * Set the feedback.
@@ -225,11 +274,11 @@ namespace WalkingControllers
 
         /**
          * Set the reference signal
-         * @param reference signal deque containing the reference signal.
+         * @param reference signal view of the reference signal.
          * @param resetTrajectory set equal to true if you do clear the old trajectory.
          * @return true/false in case of success/failure.
          */
-        bool setReferenceSignal(const std::deque<iDynTree::Vector2>& referenceSignal,
+        bool setReferenceSignal(const StdUtilities::Span<iDynTree::Vector2>& referenceSignal,
                                 const bool& resetTrajectory);
 
         /**
@@ -244,6 +293,12 @@ namespace WalkingControllers
          */
         const iDynTree::Vector2& getControllerOutput() const;
 
+        /**
+         * Get the length of the controller horizon.
+         * @return the number of samples of the horizon.
+         */
+        int getControllerHorizon() const;
+
         /**
          * Reset the controller
          */
@@ -9,60 +9,32 @@
 #ifndef WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_MPC_SOLVER_H
 #define WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_MPC_SOLVER_H
 
-// std
-#include <deque>
+// eigen
+#include <Eigen/Dense>
 
 // iDynTree
 #include <iDynTree/Core/SparseMatrix.h>
 #include <iDynTree/Core/VectorDynSize.h>
-
-// osqp-eigen
-#include <OsqpEigen/OsqpEigen.h>
+#include <iDynTree/Core/VectorFixSize.h>
+#include <iDynTree/Core/MatrixDynSize.h>
 
 #include <WalkingControllers/iDynTreeUtilities/Helper.h>
+#include <WalkingControllers/StdUtilities/Span.h>
 
 namespace WalkingControllers
 {
 
     /**
-     * MPCSolver class
+     * MPCSolver is the interface of the solvers of the DCM model predictive controller.
      */
     class MPCSolver
     {
-        /**
-         * Pointer to the optimization solver
-         */
-        std::unique_ptr<OsqpEigen::Solver> m_optimizerSolver;
-        iDynTree::Triplets const* m_equalConstraintsMatrix; /**< Equal part of the constraints matrix. */
-        iDynSparseMatrix const* m_gradientSubmatrix; /**< Matrix used to evaluate the gradient vector */
-        iDynSparseMatrix const* m_stateWeightMatrix; /**< State weight stacked matrix */
-
-        Eigen::VectorXd m_lowerBound; /**< Lower bound vector. */
-        Eigen::VectorXd m_upperBound; /**< Upper bound vector. */
-        Eigen::VectorXd m_gradient; /**< Gradient vector. */
-
-        int m_stateSize; /**< Size of the state vector (2). */
-        int m_inputSize; /**< Size of the controlled input vector (2). */
-        int m_controllerHorizon; /**< Controller horizon (in steps)*/
-        int m_numberOfInequalityConstraints; /**< Number of inequality constraints*/
-
     public:
 
         /**
-         * Constructor.
-         * @param stateSize size of the state vector;
-         * @param inputSize size of the controlled input vector;
-         * @param equalConstraintsMatrix equal submatrix  of the constraints matrix;
-         * @param gradientSubmatrix matrix used to evaluate the gradient vector
-         * (\f$-\Theta^T \tilde{R} e_1\f$);
-         * @param stateWeightStackedMatrix \f$ \tilde{Q} = diag([Q, Q, ..., Q]) \f$.
+         * Destructor.
          */
-        MPCSolver(const int& stateSize, const int& inputSize,
-                  const int& controllerHorizon,
-                  const int& numberOfInequalityConstraints,
-                  const iDynTree::Triplets& equalConstraintsMatrix,
-                  const iDynSparseMatrix& gradientSubmatrix,
-                  const iDynSparseMatrix& stateWeightStackedMatrix);
+        virtual ~MPCSolver() = default;
 
         /**
          * Set the hessian matrix.
@@ -70,7 +42,7 @@ namespace WalkingControllers
          * @param hessian hessian matrix.
          * @return true/false in case of success/failure.
          */
-        bool setHessianMatrix(const iDynSparseMatrix& hessian);
+        virtual bool setHessianMatrix(const iDynSparseMatrix& hessian) = 0;
 
         /**
          * Set or update the linear constraints matrix.
@@ -79,7 +51,13 @@ namespace WalkingControllers
          * @param inequalityConstraintsMatrix  matrix of the inequalities constraints (Ax < b)
          * @return true/false in case of success/failure.
          */
-        bool setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix);
+        virtual bool setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix) = 0;
+
+        /**
+         * Get the number of inequality constraints handled by the solver.
+         * @return the number of inequality constraints.
+         */
+        virtual int getNumberOfInequalityConstraints() const = 0;
 
         /**
          * Set or update the lower and the upper bounds
@@ -87,8 +65,8 @@ namespace WalkingControllers
          * @param inequalityConstraintsVector vector of the inequalities constraints (Ax < b)
          * @return true/false in case of success/failure.
          */
-        bool setBounds(const iDynTree::Vector2& currentState,
-                       const iDynTree::VectorDynSize& inequalityConstraintsVector);
+        virtual bool setBounds(const iDynTree::Vector2& currentState,
+                               const iDynTree::VectorDynSize& inequalityConstraintsVector) = 0;
 
         /**
          * Set or update the gradient
@@ -98,47 +76,55 @@ namespace WalkingControllers
          * @param resetTrajectory set equal to true if you do not want to use the previous trajectory.
          * @return true/false in case of success/failure.
          */
-        bool setGradient(const std::deque<iDynTree::Vector2>& refereceSignal,
-                         const iDynTree::Vector2& previousControllerOutput,
-                         const bool& resetTrajectory);
+        virtual bool setGradient(const StdUtilities::Span<iDynTree::Vector2>& refereceSignal,
+                                 const iDynTree::Vector2& previousControllerOutput,
+                                 const bool& resetTrajectory) = 0;
 
         /**
-         * Get the primal variable.
-         * @param primalVariable primal variable vector
+         * Get the warm start for the next control cycle. The primal variable and the dual variable
+         * related to the dynamics constraints are shifted by one time step, the last element is
+         * repeated.
+         * @param primalVariable shifted primal variable vector;
+         * @param dynamicsDualVariable shifted dual variable related to the equality constraints.
          * @return true/false in case of success/failure.
          */
-        bool getPrimalVariable(Eigen::VectorXd& primalVariable);
+        virtual bool getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                         Eigen::VectorXd& dynamicsDualVariable) = 0;
 
         /**
-         * Set the primal variable.
-         * @param primalVariable primal variable vector
+         * Warm start the solver. The dual variable associated to the inequality constraints
+         * is set equal to zero since it depends on the contact configuration.
+         * @param primalVariable primal variable vector;
+         * @param dynamicsDualVariable dual variable related to the equality constraints.
          * @return true/false in case of success/failure.
          */
-        bool setPrimalVariable(const Eigen::VectorXd& primalVariable);
+        virtual bool setWarmStart(const Eigen::VectorXd& primalVariable,
+                                  const Eigen::VectorXd& dynamicsDualVariable) = 0;
 
         /**
          * Get the state of the solver.
          * @return true if the solver is initialized false otherwise.
          */
-        bool isInitialized();
+        virtual bool isInitialized() = 0;
 
         /**
          * Initialize the solver.
          * @return true/false in case of success/failure.
          */
-        bool initialize();
+        virtual bool initialize() = 0;
 
         /**
          * Solve the optimization problem.
          * @return true/false in case of success/failure.
          */
-        bool solve();
+        virtual bool solve() = 0;
 
         /**
-         * Get the solver solution
-         * @return the entire solution of the solver
+         * Get the first element of the optimal input sequence (i.e. the desired ZMP).
+         * @param input the first element of the input sequence.
+         * @return true/false in case of success/failure.
          */
-        iDynTree::VectorDynSize getSolution();
+        virtual bool getFirstInput(iDynTree::Vector2& input) = 0;
     };
 };
 
@@ -0,0 +1,182 @@
+/**
+ * @file RiccatiMPCSolver.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_RICCATI_MPC_SOLVER_H
+#define WALKING_CONTROLLERS_SIMPLIFIED_MODEL_CONTROLLERS_RICCATI_MPC_SOLVER_H
+
+// std
+#include <vector>
+
+// eigen
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include <WalkingControllers/iDynTreeUtilities/Helper.h>
+#include <WalkingControllers/SimplifiedModelControllers/MPCSolver.h>
+
+namespace WalkingControllers
+{
+
+    /**
+     * RiccatiMPCSolver class. It exploits the structure of the DCM MPC problem.
+     * The state is augmented with the previous input \f$ z_k = [x_k; u_{k-1}] \f$ so that the cost
+     * on the input variation becomes a stage cost. Since the inequality constraints act only on the
+     * first input, the cost-to-go from the second time step is quadratic and it is evaluated with a
+     * backward Riccati recursion (linear in the controller horizon). The remaining problem has two
+     * variables and it is solved exactly by enumerating the active sets of the convex hull.
+     * No memory is allocated after the construction of the object.
+     */
+    class RiccatiMPCSolver : public MPCSolver
+    {
+        typedef std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d>> Matrix4dVector;
+
+        int m_stateSize; /**< Size of the state vector (2). */
+        int m_inputSize; /**< Size of the controlled input vector (2). */
+        int m_controllerHorizon; /**< Controller horizon (in steps)*/
+        int m_numberOfInequalityConstraints; /**< Number of inequality constraints*/
+
+        double m_stateDynamics; /**< Coefficient of the state dynamics (a). */
+        double m_inputDynamics; /**< Coefficient of the input dynamics (b). */
+        Eigen::Matrix2d m_stateWeightMatrix; /**< State weight matrix (Q). */
+        Eigen::Matrix2d m_inputWeightMatrix; /**< Input variation weight matrix (R). */
+
+        /**
+         * Matrices used to propagate backward the linear term of the cost-to-go
+         * \f$ p_k = q_k + T_k p_{k+1} \f$ (k = 1, ..., N-1).
+         */
+        Matrix4dVector m_costToGoPropagationMatrices;
+
+        Eigen::Matrix2d m_firstStageHessian; /**< Hessian of the first stage problem. */
+        Eigen::Matrix2d m_firstStageHessianInverse; /**< Inverse of the hessian of the first stage problem. */
+        Eigen::Matrix<double, 2, 4> m_firstStageCrossMatrix; /**< Cross term between the augmented state and the first input. */
+
+        Eigen::MatrixXd m_constraintsMatrix; /**< Inequality constraints matrix. */
+        Eigen::VectorXd m_constraintsVector; /**< Inequality constraints vector. */
+        Eigen::Matrix2Xd m_referenceSignal; /**< Reference signal along the horizon. */
+        Eigen::Vector4d m_augmentedState; /**< Current augmented state [x_0; u_{-1}]. */
+        Eigen::Vector2d m_solution; /**< First input of the optimal sequence. */
+
+        bool m_isInitialized{false}; /**< True if the solver is initialized. */
+
+        /**
+         * Check if a point satisfies the inequality constraints.
+         * @param input the point.
+         * @return true if the constraints are satisfied.
+         */
+        bool isFeasible(const Eigen::Vector2d& input) const;
+
+    public:
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /**
+         * Constructor.
+         * @param stateSize size of the state vector;
+         * @param inputSize size of the controlled input vector;
+         * @param controllerHorizon controller horizon (in steps);
+         * @param numberOfInequalityConstraints number of inequality constraints;
+         * @param stateDynamics coefficient of the state dynamics (a);
+         * @param inputDynamics coefficient of the input dynamics (b);
+         * @param stateWeightMatrix state weight matrix \f$ Q \f$;
+         * @param inputWeightMatrix input weight matrix \f$ R \f$.
+         */
+        RiccatiMPCSolver(const int& stateSize, const int& inputSize,
+                         const int& controllerHorizon,
+                         const int& numberOfInequalityConstraints,
+                         const double& stateDynamics,
+                         const double& inputDynamics,
+                         const iDynSparseMatrix& stateWeightMatrix,
+                         const iDynSparseMatrix& inputWeightMatrix);
+
+        /**
+         * The hessian matrix is not used by this solver since the weight matrices are passed to the
+         * constructor.
+         * @param hessian hessian matrix.
+         * @return true.
+         */
+        bool setHessianMatrix(const iDynSparseMatrix& hessian) final;
+
+        /**
+         * Set or update the linear constraints matrix.
+         * @param inequalityConstraintsMatrix  matrix of the inequalities constraints (Ax < b)
+         * @return true/false in case of success/failure.
+         */
+        bool setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix) final;
+
+        /**
+         * Get the number of inequality constraints handled by the solver.
+         * @return the number of inequality constraints.
+         */
+        int getNumberOfInequalityConstraints() const final;
+
+        /**
+         * Set the current state and the inequality constraints vector.
+         * @param currentState value of the current state
+         * @param inequalityConstraintsVector vector of the inequalities constraints (Ax < b)
+         * @return true/false in case of success/failure.
+         */
+        bool setBounds(const iDynTree::Vector2& currentState,
+                       const iDynTree::VectorDynSize& inequalityConstraintsVector) final;
+
+        /**
+         * Set the reference signal and the previous controller output.
+         * @param referenceSignal reference signal vector;
+         * @param previousControllerOutput previous controller output;
+         * @param resetTrajectory not used.
+         * @return true/false in case of success/failure.
+         */
+        bool setGradient(const StdUtilities::Span<iDynTree::Vector2>& refereceSignal,
+                         const iDynTree::Vector2& previousControllerOutput,
+                         const bool& resetTrajectory) final;
+
+        /**
+         * The solver is not iterative, hence it does not require a warm start.
+         * @param primalVariable cleared;
+         * @param dynamicsDualVariable cleared.
+         * @return true.
+         */
+        bool getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                 Eigen::VectorXd& dynamicsDualVariable) final;
+
+        /**
+         * The solver is not iterative, hence it does not require a warm start.
+         * @param primalVariable not used;
+         * @param dynamicsDualVariable not used.
+         * @return true.
+         */
+        bool setWarmStart(const Eigen::VectorXd& primalVariable,
+                          const Eigen::VectorXd& dynamicsDualVariable) final;
+
+        /**
+         * Get the state of the solver.
+         * @return true if the solver is initialized false otherwise.
+         */
+        bool isInitialized() final;
+
+        /**
+         * Initialize the solver. The Riccati recursion is evaluated here.
+         * @return true/false in case of success/failure.
+         */
+        bool initialize() final;
+
+        /**
+         * Solve the optimization problem.
+         * @return true/false in case of success/failure.
+         */
+        bool solve() final;
+
+        /**
+         * Get the first element of the optimal input sequence (i.e. the desired ZMP).
+         * @param input the first element of the input sequence.
+         * @return true/false in case of success/failure.
+         */
+        bool getFirstInput(iDynTree::Vector2& input) final;
+    };
+};
+
+#endif
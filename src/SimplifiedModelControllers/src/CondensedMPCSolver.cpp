@@ -0,0 +1,345 @@
+/**
+ * @file CondensedMPCSolver.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cmath>
+#include <vector>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/EigenSparseHelpers.h>
+
+#include <WalkingControllers/SimplifiedModelControllers/CondensedMPCSolver.h>
+
+using namespace WalkingControllers;
+
+CondensedMPCSolver::CondensedMPCSolver(const int& stateSize, const int& inputSize,
+                                       const int& controllerHorizon,
+                                       const int& numberOfInequalityConstraints,
+                                       const double& stateDynamics,
+                                       const double& inputDynamics,
+                                       const double& feedbackGain,
+                                       const iDynSparseMatrix& stateWeightMatrix,
+                                       const iDynSparseMatrix& inputWeightMatrix)
+    :m_inputDynamics(inputDynamics),
+     m_feedbackGain(feedbackGain),
+     m_closedLoopDynamics(stateDynamics + inputDynamics * feedbackGain),
+     m_stateSize(stateSize),
+     m_inputSize(inputSize),
+     m_controllerHorizon(controllerHorizon),
+     m_numberOfInequalityConstraints(numberOfInequalityConstraints)
+{
+    // instantiate the solver class
+    m_optimizerSolver = std::make_unique<OsqpEigen::Solver>();
+
+    // only the inputs are the optimization variables
+    int numberOfVariables = m_inputSize * m_controllerHorizon;
+    m_optimizerSolver->data()->setNumberOfVariables(numberOfVariables);
+    m_optimizerSolver->data()->setNumberOfConstraints(m_numberOfInequalityConstraints);
+
+    // resize vectors
+    m_gradient = Eigen::VectorXd::Zero(numberOfVariables);
+    m_lowerBound = Eigen::VectorXd::Constant(m_numberOfInequalityConstraints, -OsqpEigen::INFTY);
+    m_upperBound = Eigen::VectorXd::Zero(m_numberOfInequalityConstraints);
+
+    m_stateWeightMatrix = Eigen::MatrixXd(iDynTree::toEigen(stateWeightMatrix));
+    m_inputWeightMatrix = Eigen::MatrixXd(iDynTree::toEigen(inputWeightMatrix));
+    m_firstInputConstraintsMatrix = Eigen::MatrixXd::Zero(m_numberOfInequalityConstraints, m_inputSize);
+
+    // rho^k, k = 0, ..., N
+    m_closedLoopDynamicsPowers.resize(m_controllerHorizon + 1);
+    m_closedLoopDynamicsPowers(0) = 1;
+    for(int k = 1; k < m_controllerHorizon + 1; k++)
+        m_closedLoopDynamicsPowers(k) = m_closedLoopDynamicsPowers(k - 1) * m_closedLoopDynamics;
+
+    m_currentState.setZero();
+    m_previousControllerOutput.setZero();
+    m_referenceSignal = Eigen::Matrix2Xd::Zero(m_stateSize, m_controllerHorizon + 1);
+
+    m_optimizerSolver->settings()->setVerbosity(false);
+    m_optimizerSolver->settings()->setWarmStart(true);
+}
+
+bool CondensedMPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
+{
+    Eigen::SparseMatrix<double> hessianEigen = iDynTree::toEigen(hessian);
+    if(m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[CondensedMPCSolver::setHessianMatrix] Something goes wrong. "
+                  << "In this particular problem the hessian matrix is constant."
+                  << std::endl;
+        return false;
+    }
+
+    if(!m_optimizerSolver->data()->setHessianMatrix(hessianEigen))
+    {
+        std::cerr << "[CondensedMPCSolver::setHessianMatrix] Unable to set first time the hessian matrix."
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CondensedMPCSolver::setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix)
+{
+    if(inequalityConstraintsMatrix.rows() != m_numberOfInequalityConstraints
+       || inequalityConstraintsMatrix.cols() != m_inputSize)
+    {
+        std::cerr << "[CondensedMPCSolver::setConstraintsMatrix] The size of the inequalityConstraintsMatrix has to be: "
+                  << m_numberOfInequalityConstraints << " x " << m_inputSize << std::endl;
+        return false;
+    }
+
+    // it is used to shift the bounds by the feedback term of the first input
+    m_firstInputConstraintsMatrix = iDynTree::toEigen(inequalityConstraintsMatrix);
+
+    if(m_optimizerSolver->isInitialized())
+    {
+        // the sparsity pattern is fixed. Only the values are updated
+        for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+            for(int j = 0; j < m_inputSize; j++)
+                m_constraintsMatrix.coeffRef(i, j) = inequalityConstraintsMatrix(i, j);
+
+        if(!m_optimizerSolver->updateLinearConstraintsMatrix(m_constraintsMatrix))
+        {
+            std::cerr << "[CondensedMPCSolver::setConstraintsMatrix] Unable to update the constraints matrix."
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // only the first input is constrained. The block is stored as dense
+    std::vector<Eigen::Triplet<double>> constraintsTriplets;
+    for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+        for(int j = 0; j < m_inputSize; j++)
+            constraintsTriplets.emplace_back(i, j, inequalityConstraintsMatrix(i, j));
+
+    m_constraintsMatrix.resize(m_numberOfInequalityConstraints, m_inputSize * m_controllerHorizon);
+    m_constraintsMatrix.setFromTriplets(constraintsTriplets.begin(), constraintsTriplets.end());
+
+    if(!m_optimizerSolver->data()->setLinearConstraintsMatrix(m_constraintsMatrix))
+    {
+        std::cerr << "[CondensedMPCSolver::setConstraintsMatrix] Unable to set the constraints matrix."
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int CondensedMPCSolver::getNumberOfInequalityConstraints() const
+{
+    return m_numberOfInequalityConstraints;
+}
+
+bool CondensedMPCSolver::setBounds(const iDynTree::Vector2& currentState,
+                                   const iDynTree::VectorDynSize& inequalityConstraintsVector)
+{
+    if(inequalityConstraintsVector.size() != m_numberOfInequalityConstraints)
+    {
+        std::cerr << "[CondensedMPCSolver::setBounds] The size of the inequalityConstraintsVector has to equal: "
+                  << m_numberOfInequalityConstraints << std::endl;
+        return false;
+    }
+
+    // A u_0 <= b with u_0 = K x_0 + v_0
+    m_currentState = iDynTree::toEigen(currentState);
+    m_upperBound.noalias() = -m_feedbackGain * m_firstInputConstraintsMatrix * m_currentState;
+    m_upperBound += iDynTree::toEigen(inequalityConstraintsVector);
+
+    if(m_optimizerSolver->isInitialized())
+    {
+        if(!m_optimizerSolver->updateUpperBound(m_upperBound))
+        {
+            std::cerr << "[CondensedMPCSolver::setBounds] Unable to update the bounds."
+                      << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        if(!m_optimizerSolver->data()->setLowerBound(m_lowerBound)
+           || !m_optimizerSolver->data()->setUpperBound(m_upperBound))
+        {
+            std::cerr << "[CondensedMPCSolver::setBounds] Unable to set the first time the bounds."
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CondensedMPCSolver::setGradient(const StdUtilities::Span<iDynTree::Vector2>& referenceSignal,
+                                     const iDynTree::Vector2& previousControllerOutput,
+                                     const bool& resetTrajectory)
+{
+    if(referenceSignal.empty())
+    {
+        std::cerr << "[CondensedMPCSolver::setGradient] The reference signal is empty."
+                  << std::endl;
+        return false;
+    }
+
+    // if the reference signal is shorter than the controller horizon it is assumed constant
+    if(!m_optimizerSolver->isInitialized() || resetTrajectory)
+    {
+        for(int i = 0; i < m_controllerHorizon + 1; i++)
+        {
+            const iDynTree::Vector2& reference = i < referenceSignal.size() ? referenceSignal[i]
+                : referenceSignal.back();
+            m_referenceSignal.col(i) = iDynTree::toEigen(reference);
+        }
+    }
+    else
+    {
+        // shift the reference signal and read only the new sample
+        for(int i = 0; i < m_controllerHorizon; i++)
+            m_referenceSignal.col(i) = m_referenceSignal.col(i + 1);
+
+        const iDynTree::Vector2& reference = m_controllerHorizon < referenceSignal.size() ?
+            referenceSignal[m_controllerHorizon] : referenceSignal.back();
+        m_referenceSignal.col(m_controllerHorizon) = iDynTree::toEigen(reference);
+    }
+
+    m_previousControllerOutput = iDynTree::toEigen(previousControllerOutput);
+
+    // the gradient is evaluated here only the first time. Then it is evaluated before solving
+    // the problem since it depends also on the current state
+    if(!m_optimizerSolver->isInitialized())
+    {
+        evaluateGradient();
+        if(!m_optimizerSolver->data()->setGradient(m_gradient))
+        {
+            std::cerr << "[CondensedMPCSolver::setGradient] Unable to set first time the gradient."
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CondensedMPCSolver::evaluateGradient()
+{
+    // the state along the horizon is x = Phi x_0 + Gamma v and the input is u = M v + K Phi_s x_0
+    // (the matrices contain the powers of rho). The gradient is
+    // Gamma^T Q_tilde (Phi x_0 - r) + M^T Theta^T R_tilde (K Theta Phi_s x_0 - e_1 u_{-1})
+    // Gamma^T y is evaluated using the following backward recursion (y_k = Q (rho^k x_0 - r_k))
+    // c_{N-1} = y_N, c_j = y_{j+1} + rho c_{j+1}, (Gamma^T y)_j = b c_j
+    Eigen::Vector2d c = Eigen::Vector2d::Zero();
+    for(int j = m_controllerHorizon - 1; j >= 0; j--)
+    {
+        c = m_stateWeightMatrix * (m_closedLoopDynamicsPowers(j + 1) * m_currentState
+                                   - m_referenceSignal.col(j + 1)) + m_closedLoopDynamics * c;
+        m_gradient.segment<2>(j * m_inputSize) = m_inputDynamics * c;
+    }
+
+    // M^T s with s = Theta^T z is evaluated using a second backward recursion
+    // (z_j = R w_j, s_j = z_j - z_{j+1}, e_{N-1} = 0, e_j = s_{j+1} + rho e_{j+1}, (M^T s)_j = s_j + K b e_j)
+    // where w_0 = K x_0 - u_{-1} and w_j = K (rho^j - rho^{j-1}) x_0
+    Eigen::Vector2d e = Eigen::Vector2d::Zero();
+    Eigen::Vector2d nextZ = Eigen::Vector2d::Zero();
+    Eigen::Vector2d nextS = Eigen::Vector2d::Zero();
+    for(int j = m_controllerHorizon - 1; j >= 0; j--)
+    {
+        Eigen::Vector2d z;
+        if(j == 0)
+            z = m_inputWeightMatrix * (m_feedbackGain * m_currentState - m_previousControllerOutput);
+        else
+            z = (m_feedbackGain * (m_closedLoopDynamicsPowers(j) - m_closedLoopDynamicsPowers(j - 1)))
+                * (m_inputWeightMatrix * m_currentState);
+
+        Eigen::Vector2d s = z - nextZ;
+        if(j < m_controllerHorizon - 1)
+            e = nextS + m_closedLoopDynamics * e;
+
+        m_gradient.segment<2>(j * m_inputSize) += s + m_feedbackGain * m_inputDynamics * e;
+        nextZ = z;
+        nextS = s;
+    }
+}
+
+bool CondensedMPCSolver::getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                             Eigen::VectorXd& dynamicsDualVariable)
+{
+    if(!m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[CondensedMPCSolver::getShiftedWarmStart] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    if(!m_optimizerSolver->getPrimalVariable(primalVariable))
+    {
+        std::cerr << "[CondensedMPCSolver::getShiftedWarmStart] Unable to get the primal variable."
+                  << std::endl;
+        return false;
+    }
+
+    // v_k <- v_{k+1}. The last element is kept constant
+    int inputVariablesSize = m_inputSize * m_controllerHorizon;
+    primalVariable.head(inputVariablesSize - m_inputSize) =
+        primalVariable.tail(inputVariablesSize - m_inputSize).eval();
+
+    dynamicsDualVariable.resize(0);
+    return true;
+}
+
+bool CondensedMPCSolver::setWarmStart(const Eigen::VectorXd& primalVariable,
+                                      const Eigen::VectorXd& dynamicsDualVariable)
+{
+    if(!m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[CondensedMPCSolver::setWarmStart] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    Eigen::VectorXd dualVariable = Eigen::VectorXd::Zero(m_numberOfInequalityConstraints);
+    return m_optimizerSolver->setPrimalVariable(primalVariable)
+        && m_optimizerSolver->setDualVariable(dualVariable);
+}
+
+bool CondensedMPCSolver::isInitialized()
+{
+    return m_optimizerSolver->isInitialized();
+}
+
+bool CondensedMPCSolver::initialize()
+{
+    evaluateGradient();
+    return m_optimizerSolver->initSolver();
+}
+
+bool CondensedMPCSolver::solve()
+{
+    if(!m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[CondensedMPCSolver::solve] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    evaluateGradient();
+    if(!m_optimizerSolver->updateGradient(m_gradient))
+    {
+        std::cerr << "[CondensedMPCSolver::solve] Unable to update the gradient."
+                  << std::endl;
+        return false;
+    }
+
+    return m_optimizerSolver->solve();
+}
+
+bool CondensedMPCSolver::getFirstInput(iDynTree::Vector2& input)
+{
+    // u_0 = K x_0 + v_0
+    const Eigen::VectorXd& solution = m_optimizerSolver->getSolution();
+    input(0) = m_feedbackGain * m_currentState(0) + solution(0);
+    input(1) = m_feedbackGain * m_currentState(1) + solution(1);
+    return true;
+}
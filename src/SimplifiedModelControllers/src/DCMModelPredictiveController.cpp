@@ -9,6 +9,7 @@
 // std
 #define NOMINMAX
 #include <algorithm>
+#include <vector>
 
 // yarp
 #include <yarp/os/LogStream.h>
@@ -20,6 +21,9 @@
 #include <WalkingControllers/iDynTreeUtilities/Helper.h>
 #include <WalkingControllers/YarpUtilities/Helper.h>
 #include <WalkingControllers/SimplifiedModelControllers/DCMModelPredictiveController.h>
+#include <WalkingControllers/SimplifiedModelControllers/SparseMPCSolver.h>
+#include <WalkingControllers/SimplifiedModelControllers/CondensedMPCSolver.h>
+#include <WalkingControllers/SimplifiedModelControllers/RiccatiMPCSolver.h>
 
 using namespace WalkingControllers;
 
@@ -147,6 +151,73 @@ iDynSparseMatrix WalkingController::evaluateHessianMatrix(const iDynTree::Triple
 }
 
 
+iDynSparseMatrix WalkingController::evaluateCondensedHessianMatrix(const iDynSparseMatrix& stateWeightMatrix,
+                                                                   const iDynSparseMatrix& inputWeightMatrix)
+{
+    // the dynamics x_{k+1} = a x_k + b u_k and the pre-stabilized input u_k = K x_k + v_k are
+    // scalar, hence the hessian is Gamma^T Gamma (x) Q + P^T P (x) R, where Gamma and P = Theta M
+    // are N x N matrices and (x) is the Kronecker product. The closed loop dynamics is
+    // x_{k+1} = rho x_k + b v_k with rho = a + b K < 1. So the entries of the hessian
+    // do not grow with the controller horizon.
+    double rho = m_stateDynamics + m_inputDynamics * m_condensedFeedbackGain;
+
+    // the block (i,j) of Gamma^T Gamma is b^2 rho^|i-j| S(max(i,j)), where S(m) = sum_{t=0}^{N-1-m} rho^{2t}
+    std::vector<double> S(m_controllerHorizon);
+    S[m_controllerHorizon - 1] = 1;
+    for(int m = m_controllerHorizon - 2; m >= 0; m--)
+        S[m] = 1 + rho * rho * S[m + 1];
+
+    Eigen::MatrixXd stateHessian(m_controllerHorizon, m_controllerHorizon);
+    for(int i = 0; i < m_controllerHorizon; i++)
+    {
+        double power = 1;
+        for(int j = i; j < m_controllerHorizon; j++)
+        {
+            stateHessian(i, j) = m_inputDynamics * m_inputDynamics * power * S[j];
+            stateHessian(j, i) = stateHessian(i, j);
+            power *= rho;
+        }
+    }
+
+    // M = I + K Gamma_s, where (Gamma_s)_{kj} = b rho^{k-1-j} for j < k, and P = Theta M
+    Eigen::MatrixXd inputMap = Eigen::MatrixXd::Identity(m_controllerHorizon, m_controllerHorizon);
+    for(int j = 0; j < m_controllerHorizon; j++)
+    {
+        double power = 1;
+        for(int k = j + 1; k < m_controllerHorizon; k++)
+        {
+            inputMap(k, j) += m_condensedFeedbackGain * m_inputDynamics * power;
+            power *= rho;
+        }
+    }
+    Eigen::MatrixXd inputRateMap = inputMap;
+    inputRateMap.bottomRows(m_controllerHorizon - 1) -= inputMap.topRows(m_controllerHorizon - 1);
+    Eigen::MatrixXd inputHessian(m_controllerHorizon, m_controllerHorizon);
+    inputHessian.noalias() = inputRateMap.transpose() * inputRateMap;
+
+    // the hessian is dense in the horizon. Only the zeros of Q and R are not stored
+    Eigen::Matrix2d stateWeight = Eigen::MatrixXd(iDynTree::toEigen(stateWeightMatrix));
+    Eigen::Matrix2d inputWeight = Eigen::MatrixXd(iDynTree::toEigen(inputWeightMatrix));
+    std::vector<Eigen::Triplet<double>> hessianTriplets;
+    for(int i = 0; i < m_controllerHorizon; i++)
+        for(int j = 0; j < m_controllerHorizon; j++)
+            for(int r = 0; r < m_inputSize; r++)
+                for(int c = 0; c < m_inputSize; c++)
+                {
+                    if(stateWeight(r, c) != 0)
+                        hessianTriplets.emplace_back(i * m_inputSize + r, j * m_inputSize + c,
+                                                     stateHessian(i, j) * stateWeight(r, c));
+                    if(inputWeight(r, c) != 0)
+                        hessianTriplets.emplace_back(i * m_inputSize + r, j * m_inputSize + c,
+                                                     inputHessian(i, j) * inputWeight(r, c));
+                }
+
+    int matrixDimension = m_inputSize * m_controllerHorizon;
+    Eigen::SparseMatrix<double> hessian(matrixDimension, matrixDimension);
+    hessian.setFromTriplets(hessianTriplets.begin(), hessianTriplets.end());
+
+    return iDynTreeUtilities::SparseMatrix::fromEigen(hessian);
+}
 
 iDynSparseMatrix WalkingController::evaluateGradientSubmatrix(const iDynTree::Triplets& inputWeightStackedTriplets,
                                                               const iDynSparseMatrix& thetaMatrix)
@@ -209,6 +280,8 @@ bool WalkingController::initializeMatrices(const yarp::os::Searchable& config)
         yError() << "Initialization failed while reading inputWeightTriplets vector.";
         return false;
     }
+    m_inputWeightMatrix.resize(m_inputSize, m_inputSize);
+    m_inputWeightMatrix.setFromConstTriplets(inputWeightMatrix);
 
     // evaluate submatrices
     iDynSparseMatrix thetaMatrix = evaluateThetaMatrix();
@@ -217,9 +290,6 @@ bool WalkingController::initializeMatrices(const yarp::os::Searchable& config)
     iDynSparseMatrix hessianInputSubmatrix = evaluateHessianInputSubmatrix(inputWeightStackedMatrix,
                                                                            thetaMatrix);
 
-    // evaluate hessian matrix
-    m_hessianMatrix = evaluateHessianMatrix(stateWeightStackedMatrix, hessianInputSubmatrix);
-
     // evaluate gradient submatrix
     m_gradientSubmatrix = evaluateGradientSubmatrix(inputWeightStackedMatrix, thetaMatrix);
 
@@ -232,12 +302,26 @@ bool WalkingController::initializeMatrices(const yarp::os::Searchable& config)
     }
     double gravityAcceleration = config.check("gravity_acceleration", yarp::os::Value(9.81)).asDouble();
     double omega = sqrt(gravityAcceleration / comHeight);
+    m_stateDynamics = exp(omega * dT);
+    m_inputDynamics = 1 - exp(omega * dT);
+
+    if(m_formulation == MPCFormulation::Condensed)
+    {
+        // the states are not optimization variables. The dynamics is embedded in the hessian.
+        // The feedback gain mirrors the unstable pole of the DCM dynamics (rho = 1 / a)
+        m_condensedFeedbackGain = (1 / m_stateDynamics - m_stateDynamics) / m_inputDynamics;
+        m_hessianMatrix = evaluateCondensedHessianMatrix(m_stateWeightMatrix, m_inputWeightMatrix);
+        return true;
+    }
+
+    // evaluate hessian matrix
+    m_hessianMatrix = evaluateHessianMatrix(stateWeightStackedMatrix, hessianInputSubmatrix);
 
     // evaluate dynamics matrix
     iDynTree::Triplets stateDynamicsTriplets;
     iDynTree::Triplets inputDynamicsTriplets;
-    stateDynamicsTriplets.addDiagonalMatrix(0, 0, exp(omega * dT), m_stateSize);
-    inputDynamicsTriplets.addDiagonalMatrix(0, 0, 1 - exp(omega * dT), m_inputSize);
+    stateDynamicsTriplets.addDiagonalMatrix(0, 0, m_stateDynamics, m_stateSize);
+    inputDynamicsTriplets.addDiagonalMatrix(0, 0, m_inputDynamics, m_inputSize);
 
     // evaluate equal constraints matrix
     m_equalConstraintsMatrixTriplets = evaluateEqualConstraintsMatrix(stateDynamicsTriplets,
@@ -317,6 +401,28 @@ bool WalkingController::initialize(const yarp::os::Searchable& config)
     m_stateSize = 2;
     m_inputSize = 2;
 
+    std::string formulation = config.check("mpc_formulation", yarp::os::Value("sparse")).asString();
+    if(formulation == "sparse")
+        m_formulation = MPCFormulation::Sparse;
+    else if(formulation == "condensed")
+        m_formulation = MPCFormulation::Condensed;
+    else
+    {
+        yError() << "[initialize] The mpc_formulation " << formulation << " is not supported. "
+                 << "Please use sparse or condensed.";
+        return false;
+    }
+
+    // the Riccati solver does not depend on the formulation
+    std::string solver = config.check("mpc_solver", yarp::os::Value("osqp")).asString();
+    if(solver != "osqp" && solver != "riccati")
+    {
+        yError() << "[initialize] The mpc_solver " << solver << " is not supported. "
+                 << "Please use osqp or riccati.";
+        return false;
+    }
+    m_useRiccatiSolver = solver == "riccati";
+
     yarp::os::Value input = config.find("initial_zmp_position");
     if(input.isNull())
     {
@@ -364,10 +470,10 @@ bool WalkingController::initialize(const yarp::os::Searchable& config)
     return true;
 }
 
-bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Transform>& leftFoot,
-                                                const std::deque<iDynTree::Transform>& rightFoot,
-                                                const std::deque<bool>& leftInContact,
-                                                const std::deque<bool>& rightInContact)
+bool WalkingController::setConvexHullConstraint(const StdUtilities::Span<iDynTree::Transform>& leftFoot,
+                                                const StdUtilities::Span<iDynTree::Transform>& rightFoot,
+                                                const StdUtilities::Span<bool>& leftInContact,
+                                                const StdUtilities::Span<bool>& rightInContact)
 {
     auto feetStatus = std::make_pair(leftInContact.front(), rightInContact.front());
 
@@ -414,38 +520,92 @@ bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Trans
 
     int numberOfConstraints = m_convexHullComputer.A.rows();
 
-    // is it possible to reuse the old solver??
-    m_currentController = std::make_shared<MPCSolver>(m_stateSize, m_inputSize,
-                                                      m_controllerHorizon,
-                                                      numberOfConstraints,
-                                                      m_equalConstraintsMatrixTriplets,
-                                                      m_gradientSubmatrix,
-                                                      m_stateWeightMatrix);
-    // the hessian matrix is set only once
-    if(!m_currentController->setHessianMatrix(m_hessianMatrix))
+    // store the shifted solution of the old solver. It is used to warm start the new one
+    m_isWarmStartAvailable = false;
+    if(m_currentController != nullptr && m_currentController->isInitialized())
+        m_isWarmStartAvailable = m_currentController->getShiftedWarmStart(m_warmStartPrimalVariable,
+                                                                          m_warmStartDualVariable);
+
+    // a new solver is instantiated only if the contact configuration never occurred or the number
+    // of vertices of the convex hull is changed
+    std::shared_ptr<MPCSolver>& controller = m_controllers[feetStatus];
+    if(controller == nullptr || controller->getNumberOfInequalityConstraints() != numberOfConstraints)
     {
-        yError() << "[addNewController] Unable to set the hessian matrix.";
-        return false;
+        controller = instantiateSolver(numberOfConstraints);
+        if(controller == nullptr)
+        {
+            yError() << "[setConvexHullConstraint] Unable to instantiate the solver.";
+            return false;
+        }
     }
 
-    if(!m_currentController->setConstraintsMatrix(m_convexHullComputer.A))
+    if(!controller->setConstraintsMatrix(m_convexHullComputer.A))
     {
         yError() << "[setConvexHullConstraint] Unable to add set constraints Matrix.";
         return false;
     }
 
+    m_currentController = controller;
+
+    // the gradient stored in the solver refers to the last time the phase occurred
+    m_isGradientOutdated = true;
+
     return true;
 }
 
+std::shared_ptr<MPCSolver> WalkingController::instantiateSolver(const int& numberOfConstraints)
+{
+    std::shared_ptr<MPCSolver> solver;
+    if(m_useRiccatiSolver)
+        solver = std::allocate_shared<RiccatiMPCSolver>(Eigen::aligned_allocator<RiccatiMPCSolver>(),
+                                                        m_stateSize, m_inputSize,
+                                                        m_controllerHorizon,
+                                                        numberOfConstraints,
+                                                        m_stateDynamics,
+                                                        m_inputDynamics,
+                                                        m_stateWeightMatrix,
+                                                        m_inputWeightMatrix);
+    else if(m_formulation == MPCFormulation::Condensed)
+        // the solver contains fixed size eigen objects
+        solver = std::allocate_shared<CondensedMPCSolver>(Eigen::aligned_allocator<CondensedMPCSolver>(),
+                                                          m_stateSize, m_inputSize,
+                                                          m_controllerHorizon,
+                                                          numberOfConstraints,
+                                                          m_stateDynamics,
+                                                          m_inputDynamics,
+                                                          m_condensedFeedbackGain,
+                                                          m_stateWeightMatrix,
+                                                          m_inputWeightMatrix);
+    else
+        solver = std::make_shared<SparseMPCSolver>(m_stateSize, m_inputSize,
+                                                   m_controllerHorizon,
+                                                   numberOfConstraints,
+                                                   m_equalConstraintsMatrixTriplets,
+                                                   m_gradientSubmatrix,
+                                                   m_stateWeightMatrix);
+
+    // the hessian matrix is set only once
+    if(!solver->setHessianMatrix(m_hessianMatrix))
+    {
+        yError() << "[instantiateSolver] Unable to set the hessian matrix.";
+        return nullptr;
+    }
+
+    return solver;
+}
+
 bool WalkingController::setFeedback(const iDynTree::Vector2& currentState)
 {
     return m_currentController->setBounds(currentState, m_convexHullComputer.b);
 }
 
-bool WalkingController::setReferenceSignal(const std::deque<iDynTree::Vector2>& referenceSignal,
+bool WalkingController::setReferenceSignal(const StdUtilities::Span<iDynTree::Vector2>& referenceSignal,
                                            const bool& resetTrajectory)
 {
-    return m_currentController->setGradient(referenceSignal, m_output, resetTrajectory);
+    bool ok = m_currentController->setGradient(referenceSignal, m_output,
+                                               resetTrajectory || m_isGradientOutdated);
+    m_isGradientOutdated = false;
+    return ok;
 }
 
 bool WalkingController::buildConvexHull(const iDynTree::Transform& leftFootTransform,
@@ -502,15 +662,26 @@ bool WalkingController::solve()
         }
     }
 
+    if(m_isWarmStartAvailable)
+    {
+        // the warm start is not mandatory
+        if(!m_currentController->setWarmStart(m_warmStartPrimalVariable, m_warmStartDualVariable))
+            yWarning() << "[solve] Unable to warm start the solver.";
+
+        m_isWarmStartAvailable = false;
+    }
+
     if(!m_currentController->solve())
     {
         yError() << "[solve] Unable to solve the problem.";
         return false;
     }
 
-    iDynTree::VectorDynSize solution = m_currentController->getSolution();
-    m_output(0) = solution(m_stateSize * (m_controllerHorizon + 1));
-    m_output(1) = solution(m_stateSize * (m_controllerHorizon + 1) + 1);
+    if(!m_currentController->getFirstInput(m_output))
+    {
+        yError() << "[solve] Unable to get the solution.";
+        return false;
+    }
 
     if(m_convexHullComputer.computeMargin(m_output) < -m_convexHullTolerance)
     {
@@ -526,8 +697,17 @@ const iDynTree::Vector2& WalkingController::getControllerOutput() const
     return m_output;
 }
 
+int WalkingController::getControllerHorizon() const
+{
+    return m_controllerHorizon;
+}
+
 void WalkingController::reset()
 {
     // used to indicate the first step.
     m_feetStatus = std::make_pair<bool, bool>(false, false);
+
+    // the solvers are kept in the pool, however the old solution cannot be used as warm start
+    m_currentController = nullptr;
+    m_isWarmStartAvailable = false;
 }
@@ -0,0 +1,270 @@
+/**
+ * @file RiccatiMPCSolver.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <iostream>
+#include <limits>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/EigenSparseHelpers.h>
+
+#include <WalkingControllers/SimplifiedModelControllers/RiccatiMPCSolver.h>
+
+using namespace WalkingControllers;
+
+RiccatiMPCSolver::RiccatiMPCSolver(const int& stateSize, const int& inputSize,
+                                   const int& controllerHorizon,
+                                   const int& numberOfInequalityConstraints,
+                                   const double& stateDynamics,
+                                   const double& inputDynamics,
+                                   const iDynSparseMatrix& stateWeightMatrix,
+                                   const iDynSparseMatrix& inputWeightMatrix)
+    :m_stateSize(stateSize),
+     m_inputSize(inputSize),
+     m_controllerHorizon(controllerHorizon),
+     m_numberOfInequalityConstraints(numberOfInequalityConstraints),
+     m_stateDynamics(stateDynamics),
+     m_inputDynamics(inputDynamics)
+{
+    m_stateWeightMatrix = Eigen::MatrixXd(iDynTree::toEigen(stateWeightMatrix));
+    m_inputWeightMatrix = Eigen::MatrixXd(iDynTree::toEigen(inputWeightMatrix));
+
+    // all the memory is allocated here
+    m_costToGoPropagationMatrices.resize(m_controllerHorizon);
+    m_constraintsMatrix = Eigen::MatrixXd::Zero(m_numberOfInequalityConstraints, m_inputSize);
+    m_constraintsVector = Eigen::VectorXd::Zero(m_numberOfInequalityConstraints);
+    m_referenceSignal = Eigen::Matrix2Xd::Zero(m_stateSize, m_controllerHorizon + 1);
+
+    m_augmentedState.setZero();
+    m_solution.setZero();
+}
+
+bool RiccatiMPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
+{
+    return true;
+}
+
+bool RiccatiMPCSolver::setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix)
+{
+    if(inequalityConstraintsMatrix.rows() != m_numberOfInequalityConstraints
+       || inequalityConstraintsMatrix.cols() != m_inputSize)
+    {
+        std::cerr << "[RiccatiMPCSolver::setConstraintsMatrix] The size of the inequalityConstraintsMatrix has to be: "
+                  << m_numberOfInequalityConstraints << " x " << m_inputSize << std::endl;
+        return false;
+    }
+
+    m_constraintsMatrix = iDynTree::toEigen(inequalityConstraintsMatrix);
+    return true;
+}
+
+int RiccatiMPCSolver::getNumberOfInequalityConstraints() const
+{
+    return m_numberOfInequalityConstraints;
+}
+
+bool RiccatiMPCSolver::setBounds(const iDynTree::Vector2& currentState,
+                                 const iDynTree::VectorDynSize& inequalityConstraintsVector)
+{
+    if(inequalityConstraintsVector.size() != m_numberOfInequalityConstraints)
+    {
+        std::cerr << "[RiccatiMPCSolver::setBounds] The size of the inequalityConstraintsVector has to equal: "
+                  << m_numberOfInequalityConstraints << std::endl;
+        return false;
+    }
+
+    m_augmentedState.head<2>() = iDynTree::toEigen(currentState);
+    m_constraintsVector = iDynTree::toEigen(inequalityConstraintsVector);
+    return true;
+}
+
+bool RiccatiMPCSolver::setGradient(const StdUtilities::Span<iDynTree::Vector2>& referenceSignal,
+                                   const iDynTree::Vector2& previousControllerOutput,
+                                   const bool& resetTrajectory)
+{
+    if(referenceSignal.empty())
+    {
+        std::cerr << "[RiccatiMPCSolver::setGradient] The reference signal is empty."
+                  << std::endl;
+        return false;
+    }
+
+    // if the reference signal is shorter than the controller horizon it is assumed constant
+    for(int i = 0; i < m_controllerHorizon + 1; i++)
+    {
+        const iDynTree::Vector2& reference = i < referenceSignal.size() ? referenceSignal[i]
+            : referenceSignal.back();
+        m_referenceSignal.col(i) = iDynTree::toEigen(reference);
+    }
+
+    m_augmentedState.tail<2>() = iDynTree::toEigen(previousControllerOutput);
+    return true;
+}
+
+bool RiccatiMPCSolver::getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                           Eigen::VectorXd& dynamicsDualVariable)
+{
+    primalVariable.resize(0);
+    dynamicsDualVariable.resize(0);
+    return true;
+}
+
+bool RiccatiMPCSolver::setWarmStart(const Eigen::VectorXd& primalVariable,
+                                    const Eigen::VectorXd& dynamicsDualVariable)
+{
+    return true;
+}
+
+bool RiccatiMPCSolver::isInitialized()
+{
+    return m_isInitialized;
+}
+
+bool RiccatiMPCSolver::initialize()
+{
+    if(m_controllerHorizon < 1)
+    {
+        std::cerr << "[RiccatiMPCSolver::initialize] The controller horizon has to be positive."
+                  << std::endl;
+        return false;
+    }
+
+    // augmented dynamics z_{k+1} = F z_k + G u_k with z_k = [x_k; u_{k-1}]
+    Eigen::Matrix4d F = Eigen::Matrix4d::Zero();
+    F.topLeftCorner<2, 2>() = m_stateDynamics * Eigen::Matrix2d::Identity();
+    Eigen::Matrix<double, 4, 2> G;
+    G.topRows<2>() = m_inputDynamics * Eigen::Matrix2d::Identity();
+    G.bottomRows<2>() = Eigen::Matrix2d::Identity();
+
+    // stage cost 1/2 z' Qz z + 1/2 u' R u + u' S z
+    Eigen::Matrix4d Qz = Eigen::Matrix4d::Zero();
+    Qz.topLeftCorner<2, 2>() = m_stateWeightMatrix;
+    Qz.bottomRightCorner<2, 2>() = m_inputWeightMatrix;
+    Eigen::Matrix<double, 2, 4> S = Eigen::Matrix<double, 2, 4>::Zero();
+    S.rightCols<2>() = -m_inputWeightMatrix;
+
+    // terminal cost
+    Eigen::Matrix4d P = Eigen::Matrix4d::Zero();
+    P.topLeftCorner<2, 2>() = m_stateWeightMatrix;
+
+    for(int k = m_controllerHorizon - 1; k >= 1; k--)
+    {
+        Eigen::Matrix2d Huu = m_inputWeightMatrix + G.transpose() * P * G;
+        Eigen::Matrix<double, 2, 4> Huz = S + G.transpose() * P * F;
+        Eigen::Matrix<double, 4, 2> M = Huz.transpose() * Huu.inverse();
+
+        m_costToGoPropagationMatrices[k] = F.transpose() - M * G.transpose();
+        P = Qz + F.transpose() * P * F - M * Huz;
+    }
+
+    // first stage problem
+    m_firstStageHessian = m_inputWeightMatrix + G.transpose() * P * G;
+    m_firstStageHessianInverse = m_firstStageHessian.inverse();
+    m_firstStageCrossMatrix = S + G.transpose() * P * F;
+
+    m_isInitialized = true;
+    return true;
+}
+
+bool RiccatiMPCSolver::isFeasible(const Eigen::Vector2d& input) const
+{
+    const double tolerance = 1e-9;
+    for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+        if(m_constraintsMatrix.row(i).dot(input) > m_constraintsVector(i) + tolerance)
+            return false;
+
+    return true;
+}
+
+bool RiccatiMPCSolver::solve()
+{
+    if(!m_isInitialized)
+    {
+        std::cerr << "[RiccatiMPCSolver::solve] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    // backward propagation of the linear term of the cost-to-go
+    // p_N = [-Q r_N; 0], p_k = [-Q r_k; 0] + T_k p_{k+1}
+    Eigen::Vector4d p = Eigen::Vector4d::Zero();
+    p.head<2>() = -m_stateWeightMatrix * m_referenceSignal.col(m_controllerHorizon);
+    for(int k = m_controllerHorizon - 1; k >= 1; k--)
+    {
+        p = (m_costToGoPropagationMatrices[k] * p).eval();
+        p.head<2>() -= m_stateWeightMatrix * m_referenceSignal.col(k);
+    }
+
+    // first stage problem: min 1/2 u' H u + h' u s.t. A u <= b
+    Eigen::Vector2d h = m_firstStageCrossMatrix * m_augmentedState
+        + m_inputDynamics * p.head<2>() + p.tail<2>();
+
+    // unconstrained solution
+    Eigen::Vector2d unconstrainedSolution = -m_firstStageHessianInverse * h;
+    if(isFeasible(unconstrainedSolution))
+    {
+        m_solution = unconstrainedSolution;
+        return true;
+    }
+
+    // the optimum lies on an edge or on a vertex of the convex hull. Among the feasible
+    // candidates the one with the lowest cost is the solution
+    auto cost = [&](const Eigen::Vector2d& u){return 0.5 * u.dot(m_firstStageHessian * u) + h.dot(u);};
+    double bestCost = std::numeric_limits<double>::infinity();
+    Eigen::Vector2d candidate;
+
+    for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+    {
+        Eigen::Vector2d a = m_constraintsMatrix.row(i).transpose();
+        Eigen::Vector2d HinvA = m_firstStageHessianInverse * a;
+        double den = a.dot(HinvA);
+        if(den < std::numeric_limits<double>::epsilon())
+            continue;
+
+        candidate = unconstrainedSolution + (m_constraintsVector(i) - a.dot(unconstrainedSolution)) / den * HinvA;
+        if(isFeasible(candidate) && cost(candidate) < bestCost)
+        {
+            bestCost = cost(candidate);
+            m_solution = candidate;
+        }
+
+        for(int j = i + 1; j < m_numberOfInequalityConstraints; j++)
+        {
+            Eigen::Matrix2d activeConstraints;
+            activeConstraints.row(0) = m_constraintsMatrix.row(i);
+            activeConstraints.row(1) = m_constraintsMatrix.row(j);
+            double determinant = activeConstraints.determinant();
+            if(std::abs(determinant) < std::numeric_limits<double>::epsilon())
+                continue;
+
+            candidate = activeConstraints.inverse()
+                * Eigen::Vector2d(m_constraintsVector(i), m_constraintsVector(j));
+            if(isFeasible(candidate) && cost(candidate) < bestCost)
+            {
+                bestCost = cost(candidate);
+                m_solution = candidate;
+            }
+        }
+    }
+
+    if(bestCost == std::numeric_limits<double>::infinity())
+    {
+        std::cerr << "[RiccatiMPCSolver::solve] The problem is infeasible."
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool RiccatiMPCSolver::getFirstInput(iDynTree::Vector2& input)
+{
+    iDynTree::toEigen(input) = m_solution;
+    return true;
+}
@@ -1,26 +1,29 @@
 /**
- * @file MPCSolver.cpp
+ * @file SparseMPCSolver.cpp
  * @authors Giulio Romualdi <giulio.romualdi@iit.it>
  * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
  *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
  * @date 2018
  */
 
+// std
+#include <vector>
+
 // iDynTree
 #include <iDynTree/Core/EigenHelpers.h>
 #include <iDynTree/Core/EigenSparseHelpers.h>
 
 #include <WalkingControllers/iDynTreeUtilities/Helper.h>
-#include <WalkingControllers/SimplifiedModelControllers/MPCSolver.h>
+#include <WalkingControllers/SimplifiedModelControllers/SparseMPCSolver.h>
 
 using namespace WalkingControllers;
 
-MPCSolver::MPCSolver(const int& stateSize, const int& inputSize,
-                     const int& controllerHorizon,
-                     const int& numberOfInequalityConstraints,
-                     const iDynTree::Triplets& equalConstraintsMatrixTriplets,
-                     const iDynSparseMatrix& gradientSubmatrix,
-                     const iDynSparseMatrix& stateWeightMatrix)
+SparseMPCSolver::SparseMPCSolver(const int& stateSize, const int& inputSize,
+                                 const int& controllerHorizon,
+                                 const int& numberOfInequalityConstraints,
+                                 const iDynTree::Triplets& equalConstraintsMatrixTriplets,
+                                 const iDynSparseMatrix& gradientSubmatrix,
+                                 const iDynSparseMatrix& stateWeightMatrix)
     :m_stateSize(stateSize),
      m_inputSize(inputSize),
      m_controllerHorizon(controllerHorizon),
@@ -51,9 +54,10 @@ MPCSolver::MPCSolver(const int& stateSize, const int& inputSize,
         m_lowerBound(i) = - OsqpEigen::INFTY;
 
     m_optimizerSolver->settings()->setVerbosity(false);
+    m_optimizerSolver->settings()->setWarmStart(true);
 }
 
-bool MPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
+bool SparseMPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
 {
     Eigen::SparseMatrix<double> hessianEigen = iDynTree::toEigen(hessian);
     if(m_optimizerSolver->isInitialized())
@@ -75,56 +79,72 @@ bool MPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
     return true;
 }
 
-bool MPCSolver::setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix)
+bool SparseMPCSolver::setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityConstraintsMatrix)
 {
-    // set the linear constraints matrix triplets
-    iDynTree::Triplets constraintsTriplets;
-    iDynTreeUtilities::Triplets::pushTriplets(*m_equalConstraintsMatrix, constraintsTriplets);
+    if(inequalityConstraintsMatrix.rows() != m_numberOfInequalityConstraints
+       || inequalityConstraintsMatrix.cols() != m_inputSize)
+    {
+        std::cerr << "[setLinearConstraintsMatrix] The size of the inequalityConstraintsMatrix has to be: "
+                  << m_numberOfInequalityConstraints << " x " << m_inputSize << std::endl;
+        return false;
+    }
 
     int inequalityConstraintsMatrixRowPos = m_stateSize * (m_controllerHorizon + 1);
     int inequalityConstraintsMatrixColumnPos = m_stateSize * (m_controllerHorizon + 1);
-    constraintsTriplets.addSubMatrix(inequalityConstraintsMatrixRowPos,
-                                     inequalityConstraintsMatrixColumnPos,
-                                     inequalityConstraintsMatrix);
-
-    // convert triplets into a sparse matrix
-    int constraintsMatrixRows = m_stateSize * (m_controllerHorizon + 1) +
-        m_numberOfInequalityConstraints;
-    int constraintsMatrixCols = m_stateSize * (m_controllerHorizon + 1) +
-        m_inputSize * m_controllerHorizon;
-    iDynSparseMatrix constraintsMatrix(constraintsMatrixRows,
-                                       constraintsMatrixCols);
-
-    constraintsMatrix.setFromConstTriplets(constraintsTriplets);
-
-    // convert iDynTree sparse matrix in eigen sparse matrix
-    // it is required by the osqp library
-    Eigen::SparseMatrix<double> constraintsMatrixEigen =
-        iDynTree::toEigen(constraintsMatrix);
 
     if(m_optimizerSolver->isInitialized())
     {
-        if(!m_optimizerSolver->updateLinearConstraintsMatrix(constraintsMatrixEigen))
+        // the sparsity pattern is fixed. Only the values of the inequality block are updated
+        for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+            for(int j = 0; j < m_inputSize; j++)
+                m_constraintsMatrix.coeffRef(inequalityConstraintsMatrixRowPos + i,
+                                             inequalityConstraintsMatrixColumnPos + j)
+                    = inequalityConstraintsMatrix(i, j);
+
+        if(!m_optimizerSolver->updateLinearConstraintsMatrix(m_constraintsMatrix))
         {
             std::cerr << "[setLinearConstraintsMatrix] Unable to update the constraints matrix."
                       << std::endl;
             return false;
         }
+        return true;
     }
-    else
-    {
-        if(!m_optimizerSolver->data()->setLinearConstraintsMatrix(constraintsMatrixEigen))
-        {
-            std::cerr << "[setLinearConstraintsMatrix] Unable to set the constraints matrix."
-                      << std::endl;
-            return false;
-        }
 
+    // set the linear constraints matrix triplets
+    std::vector<Eigen::Triplet<double>> constraintsTriplets;
+    for(const auto& triplet : *m_equalConstraintsMatrix)
+        constraintsTriplets.emplace_back(triplet.row, triplet.column, triplet.value);
+
+    // the inequality block is stored as dense (also the zero elements are kept). In this way the
+    // sparsity pattern does not depend on the orientation of the convex hull
+    for(int i = 0; i < m_numberOfInequalityConstraints; i++)
+        for(int j = 0; j < m_inputSize; j++)
+            constraintsTriplets.emplace_back(inequalityConstraintsMatrixRowPos + i,
+                                             inequalityConstraintsMatrixColumnPos + j,
+                                             inequalityConstraintsMatrix(i, j));
+
+    int constraintsMatrixRows = m_stateSize * (m_controllerHorizon + 1) +
+        m_numberOfInequalityConstraints;
+    int constraintsMatrixCols = m_stateSize * (m_controllerHorizon + 1) +
+        m_inputSize * m_controllerHorizon;
+    m_constraintsMatrix.resize(constraintsMatrixRows, constraintsMatrixCols);
+    m_constraintsMatrix.setFromTriplets(constraintsTriplets.begin(), constraintsTriplets.end());
+
+    if(!m_optimizerSolver->data()->setLinearConstraintsMatrix(m_constraintsMatrix))
+    {
+        std::cerr << "[setLinearConstraintsMatrix] Unable to set the constraints matrix."
+                  << std::endl;
+        return false;
     }
     return true;
 }
 
-bool MPCSolver::setBounds(const iDynTree::Vector2& currentState,
+int SparseMPCSolver::getNumberOfInequalityConstraints() const
+{
+    return m_numberOfInequalityConstraints;
+}
+
+bool SparseMPCSolver::setBounds(const iDynTree::Vector2& currentState,
                           const iDynTree::VectorDynSize& inequalityConstraintsVector)
 {
     if(currentState.size() != m_stateSize)
@@ -182,7 +202,7 @@ bool MPCSolver::setBounds(const iDynTree::Vector2& currentState,
     return true;
 }
 
-bool MPCSolver::setGradient(const std::deque<iDynTree::Vector2>& referenceSignal,
+bool SparseMPCSolver::setGradient(const StdUtilities::Span<iDynTree::Vector2>& referenceSignal,
                             const iDynTree::Vector2& previousControllerOutput,
                             const bool& resetTrajectory)
 {
@@ -267,7 +287,7 @@ bool MPCSolver::setGradient(const std::deque<iDynTree::Vector2>& referenceSignal
     return true;
 }
 
-bool MPCSolver::getPrimalVariable(Eigen::VectorXd& primalVariable)
+bool SparseMPCSolver::getPrimalVariable(Eigen::VectorXd& primalVariable)
 {
     if(!m_optimizerSolver->isInitialized())
     {
@@ -278,7 +298,7 @@ bool MPCSolver::getPrimalVariable(Eigen::VectorXd& primalVariable)
     return m_optimizerSolver->getPrimalVariable(primalVariable);
 }
 
-bool MPCSolver::setPrimalVariable(const Eigen::VectorXd& primalVariable)
+bool SparseMPCSolver::setPrimalVariable(const Eigen::VectorXd& primalVariable)
 {
     if(!m_optimizerSolver->isInitialized())
     {
@@ -289,17 +309,80 @@ bool MPCSolver::setPrimalVariable(const Eigen::VectorXd& primalVariable)
     return m_optimizerSolver->setPrimalVariable(primalVariable);
 }
 
-bool MPCSolver::isInitialized()
+bool SparseMPCSolver::getShiftedWarmStart(Eigen::VectorXd& primalVariable,
+                                    Eigen::VectorXd& dynamicsDualVariable)
+{
+    if(!m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[getShiftedWarmStart] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    Eigen::VectorXd dualVariable;
+    if(!m_optimizerSolver->getPrimalVariable(primalVariable)
+       || !m_optimizerSolver->getDualVariable(dualVariable))
+    {
+        std::cerr << "[getShiftedWarmStart] Unable to get the primal and dual variables."
+                  << std::endl;
+        return false;
+    }
+
+    int stateVariablesSize = m_stateSize * (m_controllerHorizon + 1);
+    int inputVariablesSize = m_inputSize * m_controllerHorizon;
+
+    // x_k <- x_{k+1} and u_k <- u_{k+1}. The last element is kept constant
+    primalVariable.head(stateVariablesSize - m_stateSize) =
+        primalVariable.segment(m_stateSize, stateVariablesSize - m_stateSize).eval();
+    primalVariable.segment(stateVariablesSize, inputVariablesSize - m_inputSize) =
+        primalVariable.segment(stateVariablesSize + m_inputSize, inputVariablesSize - m_inputSize).eval();
+
+    // the dual variable related to the inequality constraints depends on the solver
+    dynamicsDualVariable.resize(stateVariablesSize);
+    dynamicsDualVariable.head(stateVariablesSize - m_stateSize) =
+        dualVariable.segment(m_stateSize, stateVariablesSize - m_stateSize);
+    dynamicsDualVariable.tail(m_stateSize) = dualVariable.segment(stateVariablesSize - m_stateSize,
+                                                                  m_stateSize);
+    return true;
+}
+
+bool SparseMPCSolver::setWarmStart(const Eigen::VectorXd& primalVariable,
+                             const Eigen::VectorXd& dynamicsDualVariable)
+{
+    if(!m_optimizerSolver->isInitialized())
+    {
+        std::cerr << "[setWarmStart] The solver is not initilialize."
+                  << std::endl;
+        return false;
+    }
+
+    int stateVariablesSize = m_stateSize * (m_controllerHorizon + 1);
+    if(dynamicsDualVariable.size() != stateVariablesSize)
+    {
+        std::cerr << "[setWarmStart] The size of the dynamicsDualVariable has to be: "
+                  << stateVariablesSize << std::endl;
+        return false;
+    }
+
+    Eigen::VectorXd dualVariable = Eigen::VectorXd::Zero(stateVariablesSize +
+                                                         m_numberOfInequalityConstraints);
+    dualVariable.head(stateVariablesSize) = dynamicsDualVariable;
+
+    return m_optimizerSolver->setPrimalVariable(primalVariable)
+        && m_optimizerSolver->setDualVariable(dualVariable);
+}
+
+bool SparseMPCSolver::isInitialized()
 {
     return m_optimizerSolver->isInitialized();
 }
 
-bool MPCSolver::initialize()
+bool SparseMPCSolver::initialize()
 {
     return m_optimizerSolver->initSolver();
 }
 
-bool MPCSolver::solve()
+bool SparseMPCSolver::solve()
 {
     if(!m_optimizerSolver->isInitialized())
     {
@@ -311,7 +394,7 @@ bool MPCSolver::solve()
     return m_optimizerSolver->solve();
 }
 
-iDynTree::VectorDynSize MPCSolver::getSolution()
+iDynTree::VectorDynSize SparseMPCSolver::getSolution()
 {
     Eigen::VectorXd solutionEigen = m_optimizerSolver->getSolution();
 
@@ -322,3 +405,11 @@ iDynTree::VectorDynSize MPCSolver::getSolution()
 
     return solution;
 }
+
+bool SparseMPCSolver::getFirstInput(iDynTree::Vector2& input)
+{
+    const Eigen::VectorXd& solution = m_optimizerSolver->getSolution();
+    input(0) = solution(m_stateSize * (m_controllerHorizon + 1));
+    input(1) = solution(m_stateSize * (m_controllerHorizon + 1) + 1);
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file HermiteSpline.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_STD_HERMITE_SPLINE_H
+#define WALKING_CONTROLLERS_STD_HERMITE_SPLINE_H
+
+// std
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace WalkingControllers
+{
+    namespace StdUtilities
+    {
+        /**
+         * HermiteSpline is a piecewise cubic polynomial of dimension N. Each piece is defined by
+         * the value and the derivative at its two knots, so the curve and its first derivative
+         * are continuous. It is used to store a trajectory with a small number of knots and to
+         * evaluate it only when it is required.
+         */
+        template<std::size_t N>
+        class HermiteSpline
+        {
+        public:
+            typedef std::array<double, N> Point; /**< Value (or derivative) of the spline. */
+
+        private:
+            std::vector<double> m_knots; /**< Knots of the spline (strictly increasing). */
+            std::vector<Point> m_values; /**< Value of the spline at each knot. */
+            std::vector<Point> m_derivatives; /**< Derivative of the spline at each knot. */
+
+        public:
+
+            /**
+             * Allocate the memory for the knots.
+             * @param numberOfKnots expected number of knots.
+             */
+            void reserve(std::size_t numberOfKnots);
+
+            /**
+             * Add a knot at the end of the spline.
+             * @param knot position of the knot. It has to be greater than the last knot;
+             * @param value value of the spline at the knot;
+             * @param derivative derivative of the spline at the knot.
+             * @return true/false in case of success/failure.
+             */
+            bool addKnot(double knot, const Point& value, const Point& derivative);
+
+            /**
+             * Evaluate the spline. Outside the knots range the first (last) value is held and the
+             * derivative is equal to zero.
+             * @param point point where the spline is evaluated;
+             * @param value value of the spline;
+             * @param derivative derivative of the spline.
+             * @return true/false in case of success/failure.
+             */
+            bool evaluate(double point, Point& value, Point& derivative) const;
+
+            /**
+             * Remove all the knots. The memory is not released.
+             */
+            void clear();
+
+            std::size_t getNumberOfKnots() const { return m_knots.size(); }
+
+            bool empty() const { return m_knots.empty(); }
+        };
+    }
+}
+#include "HermiteSpline.tpp"
+
+#endif
@@ -0,0 +1,92 @@
+// std
+#include <algorithm>
+#include <iostream>
+
+template<std::size_t N>
+void WalkingControllers::StdUtilities::HermiteSpline<N>::reserve(std::size_t numberOfKnots)
+{
+    m_knots.reserve(numberOfKnots);
+    m_values.reserve(numberOfKnots);
+    m_derivatives.reserve(numberOfKnots);
+}
+
+template<std::size_t N>
+bool WalkingControllers::StdUtilities::HermiteSpline<N>::addKnot(double knot, const Point& value,
+                                                                 const Point& derivative)
+{
+    if(!m_knots.empty() && knot <= m_knots.back())
+    {
+        std::cerr << "[StdUtilities::HermiteSpline::addKnot] The knots have to be strictly increasing."
+                  << std::endl;
+        return false;
+    }
+
+    m_knots.push_back(knot);
+    m_values.push_back(value);
+    m_derivatives.push_back(derivative);
+    return true;
+}
+
+template<std::size_t N>
+bool WalkingControllers::StdUtilities::HermiteSpline<N>::evaluate(double point, Point& value,
+                                                                  Point& derivative) const
+{
+    if(m_knots.empty())
+    {
+        std::cerr << "[StdUtilities::HermiteSpline::evaluate] The spline is empty."
+                  << std::endl;
+        return false;
+    }
+
+    if(point <= m_knots.front() || point >= m_knots.back())
+    {
+        std::size_t index = point <= m_knots.front() ? 0 : m_knots.size() - 1;
+        value = m_values[index];
+        // the derivative is kept only at the boundary knots
+        if(point == m_knots[index])
+            derivative = m_derivatives[index];
+        else
+            derivative.fill(0.0);
+        return true;
+    }
+
+    // find the piece containing the point
+    std::size_t index = std::upper_bound(m_knots.begin(), m_knots.end(), point) - m_knots.begin() - 1;
+
+    const double length = m_knots[index + 1] - m_knots[index];
+    const double s = (point - m_knots[index]) / length;
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+
+    // Hermite basis functions and their derivatives (with respect to s)
+    const double h00 = 2 * s3 - 3 * s2 + 1;
+    const double h10 = s3 - 2 * s2 + s;
+    const double h01 = -2 * s3 + 3 * s2;
+    const double h11 = s3 - s2;
+
+    const double dh00 = 6 * s2 - 6 * s;
+    const double dh10 = 3 * s2 - 4 * s + 1;
+    const double dh01 = -6 * s2 + 6 * s;
+    const double dh11 = 3 * s2 - 2 * s;
+
+    const Point& p0 = m_values[index];
+    const Point& p1 = m_values[index + 1];
+    const Point& m0 = m_derivatives[index];
+    const Point& m1 = m_derivatives[index + 1];
+
+    for(std::size_t i = 0; i < N; i++)
+    {
+        value[i] = h00 * p0[i] + h10 * length * m0[i] + h01 * p1[i] + h11 * length * m1[i];
+        derivative[i] = (dh00 * p0[i] + dh01 * p1[i]) / length + dh10 * m0[i] + dh11 * m1[i];
+    }
+
+    return true;
+}
+
+template<std::size_t N>
+void WalkingControllers::StdUtilities::HermiteSpline<N>::clear()
+{
+    m_knots.clear();
+    m_values.clear();
+    m_derivatives.clear();
+}
@@ -0,0 +1,144 @@
+/**
+ * @file RingBuffer.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_STD_RING_BUFFER_H
+#define WALKING_CONTROLLERS_STD_RING_BUFFER_H
+
+// std
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <WalkingControllers/StdUtilities/Span.h>
+
+namespace WalkingControllers
+{
+    namespace StdUtilities
+    {
+        /**
+         * RingBuffer is a preallocated struct of arrays used to store the reference trajectories.
+         * All the fields share the same head and size, hence they are advanced and spliced together.
+         * Every element is stored once. When the content wraps around the end of the storage the
+         * views are made of two contiguous parts.
+         * Advancing the buffer costs O(1) and it does not allocate memory.
+         */
+        template<typename... T>
+        class RingBuffer
+        {
+        public:
+            /**
+             * Type of the I-th field.
+             */
+            template<std::size_t I>
+            using Element = typename std::tuple_element<I, std::tuple<T...>>::type;
+
+        private:
+            std::tuple<std::unique_ptr<T[]>...> m_data; /**< Storage of each field. */
+            std::size_t m_capacity{0}; /**< Maximum number of elements. */
+            std::size_t m_head{0}; /**< Position of the first element. */
+            std::size_t m_size{0}; /**< Number of elements. */
+
+            /**
+             * Get the position in the storage of an element.
+             * @param index position of the element with respect to the first element.
+             * @return the position in the storage.
+             */
+            std::size_t position(std::size_t index) const;
+
+            /**
+             * Move the content of the fields from I on in new storages.
+             * @param capacity capacity of the new storages.
+             */
+            template<std::size_t I = 0>
+            typename std::enable_if<I == sizeof...(T)>::type reallocate(std::size_t) {}
+
+            template<std::size_t I = 0>
+            typename std::enable_if<I < sizeof...(T)>::type reallocate(std::size_t capacity);
+
+            /**
+             * Repeat the last element of the fields from I on at the given position.
+             * @param index position of the new element with respect to the first element.
+             */
+            template<std::size_t I = 0>
+            typename std::enable_if<I == sizeof...(T)>::type repeatLast(std::size_t) {}
+
+            template<std::size_t I = 0>
+            typename std::enable_if<I < sizeof...(T)>::type repeatLast(std::size_t index);
+
+            /**
+             * Copy the input vectors of the fields from I on starting from initPoint.
+             * @param inputs input vectors;
+             * @param initPoint point where the vectors will be copied.
+             */
+            template<std::size_t I = 0>
+            typename std::enable_if<I == sizeof...(T)>::type write(const std::tuple<const std::vector<T>&...>&,
+                                                                   std::size_t) {}
+
+            template<std::size_t I = 0>
+            typename std::enable_if<I < sizeof...(T)>::type write(const std::tuple<const std::vector<T>&...>& inputs,
+                                                                  std::size_t initPoint);
+
+        public:
+
+            /**
+             * Allocate the memory. The content of the buffer is kept.
+             * @param capacity maximum number of elements.
+             */
+            void reserve(std::size_t capacity);
+
+            /**
+             * Remove the first element and repeat the last one. The size does not change.
+             * @return true/false in case of success/failure.
+             */
+            bool advance();
+
+            /**
+             * Replace the elements from initPoint with the content of the input vectors (one for
+             * each field, all with the same size). The size of the buffer becomes
+             * initPoint + size of the inputs. If the capacity is not enough the buffer is
+             * reallocated with the required capacity.
+             * @param initPoint point where the vectors will be copied;
+             * @param inputs input vectors.
+             * @return true/false in case of success/failure.
+             */
+            bool splice(std::size_t initPoint, const std::vector<T>&... inputs);
+
+            /**
+             * Remove all the elements. The memory is not released.
+             */
+            void clear();
+
+            template<std::size_t I>
+            const Element<I>& get(std::size_t index) const { return std::get<I>(m_data)[position(index)]; }
+
+            template<std::size_t I>
+            const Element<I>& front() const { return std::get<I>(m_data)[m_head]; }
+
+            template<std::size_t I>
+            const Element<I>& back() const { return std::get<I>(m_data)[position(m_size - 1)]; }
+
+            std::size_t size() const { return m_size; }
+
+            std::size_t capacity() const { return m_capacity; }
+
+            bool empty() const { return m_size == 0; }
+
+            /**
+             * Get a view of the elements of a field.
+             * @return the view.
+             */
+            template<std::size_t I>
+            Span<Element<I>> view() const;
+        };
+    }
+}
+#include "RingBuffer.tpp"
+
+#endif
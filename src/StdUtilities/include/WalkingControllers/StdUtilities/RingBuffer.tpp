@@ -0,0 +1,129 @@
+// std
+#include <algorithm>
+#include <iostream>
+
+template<typename... T>
+std::size_t WalkingControllers::StdUtilities::RingBuffer<T...>::position(std::size_t index) const
+{
+    std::size_t position = m_head + index;
+    return position < m_capacity ? position : position - m_capacity;
+}
+
+template<typename... T>
+template<std::size_t I>
+typename std::enable_if<I < sizeof...(T)>::type
+WalkingControllers::StdUtilities::RingBuffer<T...>::reallocate(std::size_t capacity)
+{
+    // the old elements are moved at the beginning of the new storage
+    std::unique_ptr<Element<I>[]> data(new Element<I>[capacity]);
+    for(std::size_t i = 0; i < m_size; i++)
+        data[i] = std::move(std::get<I>(m_data)[position(i)]);
+
+    std::get<I>(m_data) = std::move(data);
+    reallocate<I + 1>(capacity);
+}
+
+template<typename... T>
+template<std::size_t I>
+typename std::enable_if<I < sizeof...(T)>::type
+WalkingControllers::StdUtilities::RingBuffer<T...>::repeatLast(std::size_t index)
+{
+    std::get<I>(m_data)[position(index)] = std::get<I>(m_data)[position(index - 1)];
+    repeatLast<I + 1>(index);
+}
+
+template<typename... T>
+template<std::size_t I>
+typename std::enable_if<I < sizeof...(T)>::type
+WalkingControllers::StdUtilities::RingBuffer<T...>::write(const std::tuple<const std::vector<T>&...>& inputs,
+                                                         std::size_t initPoint)
+{
+    const std::vector<Element<I>>& input = std::get<I>(inputs);
+    for(std::size_t i = 0; i < input.size(); i++)
+        std::get<I>(m_data)[position(initPoint + i)] = input[i];
+
+    write<I + 1>(inputs, initPoint);
+}
+
+template<typename... T>
+void WalkingControllers::StdUtilities::RingBuffer<T...>::reserve(std::size_t capacity)
+{
+    if(capacity <= m_capacity)
+        return;
+
+    reallocate(capacity);
+    m_capacity = capacity;
+    m_head = 0;
+}
+
+template<typename... T>
+bool WalkingControllers::StdUtilities::RingBuffer<T...>::advance()
+{
+    if(m_size == 0)
+    {
+        std::cerr << "[StdUtilities::RingBuffer::advance] Cannot advance an empty buffer."
+                  << std::endl;
+        return false;
+    }
+
+    // the old first element becomes the new last one
+    m_head = position(1);
+    if(m_size > 1)
+        repeatLast(m_size - 1);
+
+    return true;
+}
+
+template<typename... T>
+bool WalkingControllers::StdUtilities::RingBuffer<T...>::splice(std::size_t initPoint,
+                                                               const std::vector<T>&... inputs)
+{
+    if(initPoint > m_size)
+    {
+        std::cerr << "[StdUtilities::RingBuffer::splice] The init point has to be less or equal to the size of the buffer."
+                  << std::endl;
+        return false;
+    }
+
+    const std::size_t inputSizes[] = {inputs.size()...};
+    if(std::any_of(std::begin(inputSizes), std::end(inputSizes),
+                   [&inputSizes](std::size_t size){ return size != inputSizes[0]; }))
+    {
+        std::cerr << "[StdUtilities::RingBuffer::splice] The input vectors must have the same size."
+                  << std::endl;
+        return false;
+    }
+
+    // the memory is allocated only if the new trajectory is longer than the capacity. The user
+    // should reserve the maximum length of the trajectories in advance
+    std::size_t size = initPoint + inputSizes[0];
+    if(size > m_capacity)
+    {
+        // only the elements before the init point are kept
+        m_size = initPoint;
+        reserve(size);
+    }
+
+    write(std::tuple<const std::vector<T>&...>(inputs...), initPoint);
+
+    m_size = size;
+    return true;
+}
+
+template<typename... T>
+void WalkingControllers::StdUtilities::RingBuffer<T...>::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
+
+template<typename... T>
+template<std::size_t I>
+WalkingControllers::StdUtilities::Span<typename WalkingControllers::StdUtilities::RingBuffer<T...>::template Element<I>>
+WalkingControllers::StdUtilities::RingBuffer<T...>::view() const
+{
+    // the elements after the end of the storage are at its beginning
+    const Element<I>* data = std::get<I>(m_data).get();
+    std::size_t firstPartSize = std::min(m_size, m_capacity - m_head);
+    return Span<Element<I>>(data + m_head, firstPartSize, data, m_size - firstPartSize);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file SampledTrajectory.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_STD_SAMPLED_TRAJECTORY_H
+#define WALKING_CONTROLLERS_STD_SAMPLED_TRAJECTORY_H
+
+// std
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <WalkingControllers/StdUtilities/Span.h>
+
+namespace WalkingControllers
+{
+    namespace StdUtilities
+    {
+        /**
+         * SampledTrajectory stores a reference trajectory as a sequence of samplers instead of
+         * a sequence of samples. A sample is evaluated only when it is accessed. It has the same
+         * interface of RingBuffer: advancing the trajectory removes the first sample and repeats
+         * the last one, splicing replaces the samples after a given point.
+         */
+        template<typename T>
+        class SampledTrajectory
+        {
+        public:
+            /**
+             * Function used to evaluate the sample of a segment. The first argument is the index
+             * of the sample with respect to the beginning of the segment.
+             */
+            typedef std::function<void(std::size_t, T&)> Sampler;
+
+        private:
+            /**
+             * Portion of the trajectory generated by a single sampler.
+             */
+            struct Segment
+            {
+                Sampler sampler; /**< Sampler of the segment. */
+                std::size_t begin; /**< Index of the first sample (with respect to the beginning of the trajectory). */
+                std::size_t length; /**< Number of samples. */
+            };
+
+            std::deque<Segment> m_segments; /**< Segments of the trajectory (sorted by begin). */
+            std::size_t m_head{0}; /**< Index of the first sample. */
+            std::size_t m_size{0}; /**< Number of samples. */
+
+            mutable T m_front; /**< Cached value of the first sample. */
+            mutable bool m_isFrontValid{false}; /**< True if m_front is evaluated at the current head. */
+            mutable std::vector<T> m_window; /**< Circular storage of the evaluated samples returned by view(). */
+            mutable std::size_t m_windowStart{0}; /**< Position in m_window of the first evaluated sample. */
+            mutable std::size_t m_windowBegin{0}; /**< Index of the first evaluated sample (with respect to the beginning of the trajectory). */
+            mutable std::size_t m_windowSize{0}; /**< Number of evaluated samples stored in m_window. */
+
+            /**
+             * Evaluate a sample.
+             * @param index index of the sample with respect to the first sample;
+             * @param value value of the sample.
+             * @return true/false in case of success/failure.
+             */
+            bool evaluate(std::size_t index, T& value) const;
+
+        public:
+
+            /**
+             * Remove the first sample and repeat the last one. The size does not change.
+             * @return true/false in case of success/failure.
+             */
+            bool advance();
+
+            /**
+             * Replace the samples from initPoint with the samples generated by the sampler.
+             * The size of the trajectory becomes initPoint + length.
+             * @param sampler function used to evaluate the new samples;
+             * @param length number of new samples;
+             * @param initPoint point where the new samples begin.
+             * @return true/false in case of success/failure.
+             */
+            bool splice(const Sampler& sampler, std::size_t length, std::size_t initPoint);
+
+            /**
+             * Remove all the samples.
+             */
+            void clear();
+
+            T operator[](std::size_t index) const;
+
+            const T& front() const;
+
+            std::size_t size() const { return m_size; }
+
+            bool empty() const { return m_size == 0; }
+
+            /**
+             * Get a view of the first samples. The evaluated samples are cached: after an advance
+             * only the new samples at the end of the view are evaluated, after a splice only the
+             * replaced ones. The view is valid until the next call of this method.
+             * @param length maximum number of samples.
+             * @return the view.
+             */
+            Span<T> view(std::size_t length) const;
+        };
+    }
+}
+#include "SampledTrajectory.tpp"
+
+#endif
@@ -0,0 +1,154 @@
+// std
+#include <algorithm>
+#include <iostream>
+
+template<typename T>
+bool WalkingControllers::StdUtilities::SampledTrajectory<T>::evaluate(std::size_t index, T& value) const
+{
+    if(m_segments.empty())
+    {
+        std::cerr << "[StdUtilities::SampledTrajectory::evaluate] Cannot evaluate a sample of an empty trajectory."
+                  << std::endl;
+        return false;
+    }
+
+    // the number of segments is small (the old trajectory and the merged ones)
+    const std::size_t point = m_head + index;
+    auto segment = m_segments.rbegin();
+    while(segment->begin > point)
+        segment++;
+
+    // after the end of the last segment its last sample is repeated
+    segment->sampler(std::min(point - segment->begin, segment->length - 1), value);
+    return true;
+}
+
+template<typename T>
+bool WalkingControllers::StdUtilities::SampledTrajectory<T>::advance()
+{
+    if(m_size == 0)
+    {
+        std::cerr << "[StdUtilities::SampledTrajectory::advance] Cannot advance an empty trajectory."
+                  << std::endl;
+        return false;
+    }
+
+    m_head++;
+    m_isFrontValid = false;
+
+    // remove the segments that cannot be accessed anymore
+    while(m_segments.size() > 1 && m_segments[1].begin <= m_head)
+        m_segments.pop_front();
+
+    return true;
+}
+
+template<typename T>
+bool WalkingControllers::StdUtilities::SampledTrajectory<T>::splice(const Sampler& sampler,
+                                                                   std::size_t length,
+                                                                   std::size_t initPoint)
+{
+    if(initPoint > m_size)
+    {
+        std::cerr << "[StdUtilities::SampledTrajectory::splice] The init point has to be less or equal to the size of the trajectory."
+                  << std::endl;
+        return false;
+    }
+
+    if(length == 0 || !sampler)
+    {
+        std::cerr << "[StdUtilities::SampledTrajectory::splice] The new samples are not valid."
+                  << std::endl;
+        return false;
+    }
+
+    const std::size_t begin = m_head + initPoint;
+    while(!m_segments.empty() && m_segments.back().begin >= begin)
+        m_segments.pop_back();
+
+    m_segments.push_back({sampler, begin, length});
+    m_size = initPoint + length;
+
+    // the evaluated samples after the init point are not valid anymore
+    if(m_windowBegin + m_windowSize > begin)
+        m_windowSize = begin > m_windowBegin ? begin - m_windowBegin : 0;
+
+    if(initPoint == 0)
+        m_isFrontValid = false;
+
+    return true;
+}
+
+template<typename T>
+void WalkingControllers::StdUtilities::SampledTrajectory<T>::clear()
+{
+    m_segments.clear();
+    m_head = 0;
+    m_size = 0;
+    m_isFrontValid = false;
+    m_windowBegin = 0;
+    m_windowSize = 0;
+}
+
+template<typename T>
+T WalkingControllers::StdUtilities::SampledTrajectory<T>::operator[](std::size_t index) const
+{
+    if(index == 0)
+        return front();
+
+    T value{};
+    evaluate(index, value);
+    return value;
+}
+
+template<typename T>
+const T& WalkingControllers::StdUtilities::SampledTrajectory<T>::front() const
+{
+    // the first sample is accessed several times in a control cycle, it is evaluated once
+    if(!m_isFrontValid)
+    {
+        evaluate(0, m_front);
+        m_isFrontValid = true;
+    }
+    return m_front;
+}
+
+template<typename T>
+WalkingControllers::StdUtilities::Span<T> WalkingControllers::StdUtilities::SampledTrajectory<T>::view(std::size_t length) const
+{
+    length = std::min(length, m_size);
+
+    // the storage grows only when a longer view is required, the samples are evaluated again
+    if(m_window.size() < length)
+    {
+        m_window.resize(length);
+        m_windowStart = 0;
+        m_windowSize = 0;
+    }
+
+    // remove the samples that precede the head
+    const std::size_t removed = std::min(m_head - m_windowBegin, m_windowSize);
+    m_windowStart += removed;
+    if(m_windowStart >= m_window.size())
+        m_windowStart -= m_window.size();
+    m_windowSize -= removed;
+    m_windowBegin = m_head;
+
+    // evaluate only the samples that are not stored yet (the last one after an advance)
+    for(std::size_t i = m_windowSize; i < length; i++)
+    {
+        std::size_t position = m_windowStart + i;
+        if(position >= m_window.size())
+            position -= m_window.size();
+
+        if(!evaluate(i, m_window[position]))
+        {
+            m_windowSize = 0;
+            return Span<T>();
+        }
+    }
+    m_windowSize = std::max(m_windowSize, length);
+
+    const std::size_t firstSize = std::min(length, m_window.size() - m_windowStart);
+    return Span<T>(m_window.data() + m_windowStart, firstSize, m_window.data(), length - firstSize);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file Span.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_STD_SPAN_H
+#define WALKING_CONTROLLERS_STD_SPAN_H
+
+// std
+#include <cstddef>
+#include <vector>
+
+namespace WalkingControllers
+{
+    namespace StdUtilities
+    {
+        /**
+         * Span is a read-only view of a sequence of objects. It does not own the data.
+         * The sequence can be made of two contiguous parts (e.g. the content of a ring buffer
+         * that wraps around the end of its storage).
+         */
+        template<typename T>
+        class Span
+        {
+            const T* m_first{nullptr}; /**< Pointer to the first element of the first part. */
+            std::size_t m_firstSize{0}; /**< Number of elements of the first part. */
+            const T* m_second{nullptr}; /**< Pointer to the first element of the second part. */
+            std::size_t m_size{0}; /**< Number of elements. */
+
+        public:
+
+            /**
+             * Iterator of the span.
+             */
+            class Iterator
+            {
+                const Span* m_span; /**< Pointer to the span. */
+                std::size_t m_index; /**< Index of the element. */
+
+            public:
+                Iterator(const Span* span, std::size_t index) : m_span(span), m_index(index) {}
+
+                const T& operator*() const { return (*m_span)[m_index]; }
+
+                Iterator& operator++() { m_index++; return *this; }
+
+                bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+                bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+            };
+
+            /**
+             * Constructor.
+             * @param data pointer to the first element;
+             * @param size number of elements.
+             */
+            Span(const T* data = nullptr, std::size_t size = 0)
+                : m_first(data), m_firstSize(size), m_second(data + size), m_size(size) {}
+
+            /**
+             * Constructor of a span made of two contiguous parts.
+             * @param first pointer to the first element of the first part;
+             * @param firstSize number of elements of the first part;
+             * @param second pointer to the first element of the second part;
+             * @param secondSize number of elements of the second part.
+             */
+            Span(const T* first, std::size_t firstSize, const T* second, std::size_t secondSize)
+                : m_first(first), m_firstSize(firstSize), m_second(second), m_size(firstSize + secondSize) {}
+
+            /**
+             * Constructor from a vector (std::vector<bool> is not contiguous).
+             * @param vector the vector.
+             */
+            Span(const std::vector<T>& vector) : Span(vector.data(), vector.size()) {}
+
+            const T& operator[](std::size_t index) const
+            {
+                return index < m_firstSize ? m_first[index] : m_second[index - m_firstSize];
+            }
+
+            const T& front() const { return (*this)[0]; }
+
+            const T& back() const { return (*this)[m_size - 1]; }
+
+            Iterator begin() const { return Iterator(this, 0); }
+
+            Iterator end() const { return Iterator(this, m_size); }
+
+            std::size_t size() const { return m_size; }
+
+            bool empty() const { return m_size == 0; }
+        };
+    }
+}
+
+#endif
@@ -12,6 +12,7 @@
 // std
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace WalkingControllers
 {
@@ -63,6 +64,7 @@ namespace WalkingControllers
         int m_counter; /**< Counter useful to print the profiling quantities only every m_maxCounter times. */
         int m_maxCounter; /**< The profiling quantities will be printed every maxCounter cycles. */
         std::map<std::string, std::unique_ptr<Timer>> m_timers; /**< Dictionary that contains all the timers. */
+        std::map<std::string, std::size_t> m_counters; /**< Dictionary that contains all the counters. */
 
     public:
 
@@ -93,11 +95,76 @@ namespace WalkingControllers
          */
         bool setEndTime(const std::string& key);
 
+        /**
+         * Add a new counter. Its average value per cycle is printed with the timers.
+         * @param key is the name of the counter.
+         * @return true/false in case of success/failure.
+         */
+        bool addCounter(const std::string& key);
+
+        /**
+         * Increase the counter named "key"
+         * @param key is the name of the counter;
+         * @param value is added to the counter.
+         * @return true/false in case of success/failure.
+         */
+        bool increaseCounter(const std::string& key, std::size_t value);
+
         /**
          * Print the profiling quantities.
          */
         void profiling();
     };
+
+    /**
+     * Histogram of the latencies of a process. It is used to evaluate the percentiles of the
+     * latency without storing all the samples. If a window is set, only the last samples are
+     * considered so that the histogram follows the changes of the latency.
+     */
+    class LatencyHistogram
+    {
+        double m_binWidth{0.0}; /**< Width of each bin (in seconds). */
+        std::vector<std::size_t> m_bins; /**< Number of samples in each bin. The last bin contains also the samples out of range. */
+        std::size_t m_numberOfSamples{0}; /**< Total number of samples. */
+        std::vector<std::size_t> m_window; /**< Bins of the last samples (empty if all the samples are considered). */
+        std::size_t m_windowHead{0}; /**< Position in m_window of the oldest sample (or of the next one if it is not full). */
+
+    public:
+
+        /**
+         * Initialize the histogram.
+         * @param binWidth width of each bin (in seconds);
+         * @param maxLatency maximum latency that can be represented (in seconds);
+         * @param windowLength number of samples considered (0 to consider all the samples).
+         * @return true/false in case of success/failure.
+         */
+        bool initialize(double binWidth, double maxLatency, std::size_t windowLength = 0);
+
+        /**
+         * Add a new sample. If the window is full the oldest sample is removed.
+         * @param latency latency of the process (in seconds).
+         */
+        void addSample(double latency);
+
+        /**
+         * Get the latency at a given percentile. The upper edge of the bin is returned.
+         * @param percentile percentile (between 0 and 1);
+         * @param latency latency at the percentile (in seconds).
+         * @return true/false in case of success/failure (e.g. no samples are available).
+         */
+        bool getPercentile(double percentile, double& latency) const;
+
+        /**
+         * Get the number of samples (at most the length of the window).
+         * @return the number of samples.
+         */
+        std::size_t getNumberOfSamples() const;
+
+        /**
+         * Remove all the samples.
+         */
+        void reset();
+    };
 };
 
 #endif
@@ -6,6 +6,8 @@
  * @date 2018
  */
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <iostream>
 #include <string>
@@ -84,6 +86,30 @@ bool TimeProfiler::setEndTime(const std::string& key)
     return true;
 }
 
+bool TimeProfiler::addCounter(const std::string& key)
+{
+    if(!m_counters.insert(std::make_pair(key, 0)).second)
+    {
+        std::cerr << "[TimeProfiler::addCounter] This counter already exist." <<std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool TimeProfiler::increaseCounter(const std::string& key, std::size_t value)
+{
+    auto counter = m_counters.find(key);
+    if(counter == m_counters.end())
+    {
+        std::cerr << "[TimeProfiler::increaseCounter] Unable to find the counter." <<std::endl;
+        return false;
+    }
+
+    counter->second += value;
+    return true;
+}
+
 void TimeProfiler::profiling()
 {
     std::string infoStream;
@@ -101,7 +127,97 @@ void TimeProfiler::profiling()
     }
     if(m_counter == m_maxCounter)
     {
+        for(auto& counter : m_counters)
+        {
+            infoStream += counter.first + ": "
+                + std::to_string(static_cast<double>(counter.second) / m_counter) + " ";
+            counter.second = 0;
+        }
+
         m_counter = 0;
         std::cout << infoStream << std::endl;
     }
 }
+
+bool LatencyHistogram::initialize(double binWidth, double maxLatency, std::size_t windowLength)
+{
+    if(binWidth <= 0 || maxLatency < binWidth)
+    {
+        std::cerr << "[LatencyHistogram::initialize] The bin width has to be positive and lower than the maximum latency." << std::endl;
+        return false;
+    }
+
+    m_binWidth = binWidth;
+    m_bins.assign(static_cast<std::size_t>(std::ceil(maxLatency / binWidth)), 0);
+    m_numberOfSamples = 0;
+    m_window.assign(windowLength, 0);
+    m_windowHead = 0;
+    return true;
+}
+
+void LatencyHistogram::addSample(double latency)
+{
+    if(m_bins.empty())
+        return;
+
+    // the samples out of range are stored in the last bin
+    std::size_t index = latency > 0 ? static_cast<std::size_t>(latency / m_binWidth) : 0;
+    index = std::min(index, m_bins.size() - 1);
+
+    if(!m_window.empty())
+    {
+        // the oldest sample is removed from its bin
+        if(m_numberOfSamples == m_window.size())
+        {
+            m_bins[m_window[m_windowHead]]--;
+            m_numberOfSamples--;
+        }
+
+        m_window[m_windowHead] = index;
+        m_windowHead = m_windowHead + 1 < m_window.size() ? m_windowHead + 1 : 0;
+    }
+
+    m_bins[index]++;
+    m_numberOfSamples++;
+}
+
+bool LatencyHistogram::getPercentile(double percentile, double& latency) const
+{
+    if(m_numberOfSamples == 0)
+        return false;
+
+    if(percentile < 0 || percentile > 1)
+    {
+        std::cerr << "[LatencyHistogram::getPercentile] The percentile has to be between 0 and 1." << std::endl;
+        return false;
+    }
+
+    // number of samples that have to be lower or equal than the latency
+    std::size_t threshold = std::max(static_cast<std::size_t>(std::ceil(percentile * m_numberOfSamples)),
+                                     static_cast<std::size_t>(1));
+
+    std::size_t cumulative = 0;
+    for(std::size_t i = 0; i < m_bins.size(); i++)
+    {
+        cumulative += m_bins[i];
+        if(cumulative >= threshold)
+        {
+            latency = (i + 1) * m_binWidth;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::size_t LatencyHistogram::getNumberOfSamples() const
+{
+    return m_numberOfSamples;
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(m_bins.begin(), m_bins.end(), 0);
+    m_numberOfSamples = 0;
+    m_windowHead = 0;
+}
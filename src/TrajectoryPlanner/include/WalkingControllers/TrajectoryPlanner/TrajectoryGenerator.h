@@ -14,6 +14,7 @@
 #include <thread>
 #include <condition_variable>
 #include <memory>
+#include <vector>
 
 // YARP
 #include <yarp/os/Searchable.h>
@@ -23,6 +24,9 @@
 
 #include <UnicycleGenerator.h>
 
+#include <WalkingControllers/StdUtilities/HermiteSpline.h>
+#include <WalkingControllers/TimeProfiler/TimeProfiler.h>
+
 namespace WalkingControllers
 {
 
@@ -31,11 +35,161 @@ namespace WalkingControllers
  */
     enum class GeneratorState {NotConfigured, Configured, FirstStep, Called, Returned, Closing};
 
+/**
+ * DenseTrajectory contains the trajectories evaluated by the planner sampled at each tick.
+ */
+    struct DenseTrajectory
+    {
+        std::vector<iDynTree::Vector2> DCMPosition; /**< Desired 2D-DCM position trajectory. */
+        std::vector<iDynTree::Vector2> DCMVelocity; /**< Desired 2D-DCM velocity trajectory. */
+        std::vector<iDynTree::Transform> leftFootTrajectory; /**< Left foot trajectory. */
+        std::vector<iDynTree::Transform> rightFootTrajectory; /**< Right foot trajectory. */
+        std::vector<iDynTree::Twist> leftFootTwist; /**< Left foot twist (mixed representation). */
+        std::vector<iDynTree::Twist> rightFootTwist; /**< Right foot twist (mixed representation). */
+        std::vector<double> CoMHeightTrajectory; /**< Trajectory of the CoM on the z axis. */
+        std::vector<double> CoMHeightVelocity; /**< Velocity of the CoM on the z axis. */
+    };
+
+/**
+ * TrajectorySnapshot contains all the trajectories evaluated by the planner in a single call.
+ * Once published the snapshot is never modified, so it can be read without copies.
+ * The continuous trajectories are stored as Hermite splines and they are sampled only when
+ * required. The dense trajectories are stored only if the debug mode is enabled, in this case
+ * they are used in place of the splines.
+ */
+    struct TrajectorySnapshot
+    {
+        std::size_t size{0}; /**< Number of samples of the trajectories. */
+        double dT{0.0}; /**< Sampling time of the trajectories. */
+
+        StdUtilities::HermiteSpline<2> DCM; /**< Desired 2D-DCM trajectory (the derivative is the DCM velocity). */
+        StdUtilities::HermiteSpline<3> leftFootPosition; /**< Position of the left foot (the derivative is the linear velocity). */
+        StdUtilities::HermiteSpline<3> leftFootRPY; /**< Roll pitch yaw angles of the left foot. */
+        StdUtilities::HermiteSpline<3> rightFootPosition; /**< Position of the right foot (the derivative is the linear velocity). */
+        StdUtilities::HermiteSpline<3> rightFootRPY; /**< Roll pitch yaw angles of the right foot. */
+        StdUtilities::HermiteSpline<1> CoMHeight; /**< CoM height trajectory (the derivative is the CoM height velocity). */
+
+        std::vector<bool> leftInContact; /**< State of the left foot (true = in contact). */
+        std::vector<bool> rightInContact; /**< State of the right foot (true = in contact). */
+        std::vector<bool> isLeftFixedFrame; /**< True if the main frame of the left foot is the fixed frame. */
+        std::vector<size_t> mergePoints; /**< Merge points of the trajectory. */
+        std::vector<bool> isStancePhase; /**< True if the robot is in the stance phase. */
+        std::vector<double> weightInLeft; /**< Weight percentage on the left foot. */
+        std::vector<double> weightInRight; /**< Weight percentage on the right foot. */
+        bool isTruncated{false}; /**< True if the robot is still walking at the end of the trajectory. */
+
+        bool isDense{false}; /**< True if the dense trajectories are stored (debug mode). */
+        DenseTrajectory dense; /**< Dense trajectories (empty if isDense is false). */
+
+        /**
+         * Get the desired DCM position at a given sample.
+         * @param index index of the sample;
+         * @param DCMPosition desired DCM position.
+         */
+        void getDCMPosition(std::size_t index, iDynTree::Vector2& DCMPosition) const;
+
+        /**
+         * Get the desired DCM velocity at a given sample.
+         * @param index index of the sample;
+         * @param DCMVelocity desired DCM velocity.
+         */
+        void getDCMVelocity(std::size_t index, iDynTree::Vector2& DCMVelocity) const;
+
+        /**
+         * Get the left foot transformation at a given sample.
+         * @param index index of the sample;
+         * @param transform transformation between the left foot and the world frame.
+         */
+        void getLeftFootTransform(std::size_t index, iDynTree::Transform& transform) const;
+
+        /**
+         * Get the right foot transformation at a given sample.
+         * @param index index of the sample;
+         * @param transform transformation between the right foot and the world frame.
+         */
+        void getRightFootTransform(std::size_t index, iDynTree::Transform& transform) const;
+
+        /**
+         * Get the left foot twist (mixed representation) at a given sample.
+         * @param index index of the sample;
+         * @param twist twist of the left foot.
+         */
+        void getLeftFootTwist(std::size_t index, iDynTree::Twist& twist) const;
+
+        /**
+         * Get the right foot twist (mixed representation) at a given sample.
+         * @param index index of the sample;
+         * @param twist twist of the right foot.
+         */
+        void getRightFootTwist(std::size_t index, iDynTree::Twist& twist) const;
+
+        /**
+         * Get the CoM height at a given sample.
+         * @param index index of the sample;
+         * @param CoMHeight height of the CoM.
+         */
+        void getCoMHeight(std::size_t index, double& CoMHeight) const;
+
+        /**
+         * Get the CoM height velocity at a given sample.
+         * @param index index of the sample;
+         * @param CoMHeightVelocity velocity of the CoM on the z axis.
+         */
+        void getCoMHeightVelocity(std::size_t index, double& CoMHeightVelocity) const;
+
+        /**
+         * Evaluate the transformation of a foot given its splines.
+         * @param positionSpline spline of the foot position;
+         * @param rpySpline spline of the roll pitch yaw angles of the foot;
+         * @param time time at which the splines are evaluated;
+         * @param transform transformation between the foot and the world frame.
+         */
+        static void evaluateFootTransform(const StdUtilities::HermiteSpline<3>& positionSpline,
+                                          const StdUtilities::HermiteSpline<3>& rpySpline,
+                                          double time, iDynTree::Transform& transform);
+
+        /**
+         * Evaluate the twist (mixed representation) of a foot given its splines.
+         * @param positionSpline spline of the foot position;
+         * @param rpySpline spline of the roll pitch yaw angles of the foot;
+         * @param time time at which the splines are evaluated;
+         * @param twist twist of the foot.
+         */
+        static void evaluateFootTwist(const StdUtilities::HermiteSpline<3>& positionSpline,
+                                      const StdUtilities::HermiteSpline<3>& rpySpline,
+                                      double time, iDynTree::Twist& twist);
+    };
+
 /**
  * TrajectoryGenerator class is used to handle the UnicycleTrajectoryGenerator library.
  */
     class TrajectoryGenerator
     {
+        /**
+         * Quantities required by the unicycle planner to evaluate a new trajectory.
+         */
+        struct PlannerInput
+        {
+            double initTime; /**< Init time of the trajectory. */
+            iDynTree::Vector2 desiredPoint; /**< Desired final position of the x-y projection of the CoM. */
+            iDynTree::Vector2 DCMBoundaryConditionAtMergePointPosition; /**< DCM position at the merge point. */
+            iDynTree::Vector2 DCMBoundaryConditionAtMergePointVelocity; /**< DCM velocity at the merge point. */
+            bool correctLeft; /**< The left foot has to be corrected. */
+            iDynTree::Vector2 measuredPosition; /**< Measured position of the stance foot. */
+            double measuredAngle; /**< Measured yaw angle of the stance foot. */
+        };
+
+        /**
+         * Trajectory precomputed by the planner for a possible goal.
+         */
+        struct SpeculativeCandidate
+        {
+            PlannerInput input; /**< Input of the planner. */
+            std::shared_ptr<const TrajectorySnapshot> trajectory; /**< Evaluated trajectory (nullptr if not evaluated yet). */
+            StepsList leftSteps; /**< Left footsteps of the evaluated trajectory. */
+            StepsList rightSteps; /**< Right footsteps of the evaluated trajectory. */
+        };
+
         UnicycleGenerator m_trajectoryGenerator; /**< UnicycleTrajectoryGenerator object. */
         std::shared_ptr<DCMTrajectoryGenerator> m_dcmGenerator;
         std::shared_ptr<CoMHeightTrajectoryGenerator> m_heightGenerator;
@@ -46,6 +200,9 @@ namespace WalkingControllers
 
         double m_dT; /**< Sampling time of the planner. */
         double m_plannerHorizon; /**< Horizon of the planner. */
+        double m_replanningHorizon; /**< Horizon of the trajectories evaluated while the robot is walking. */
+        double m_maxStepDuration; /**< Maximum duration of a step. */
+        bool m_isTrajectoryTruncated{false}; /**< True if the last evaluated trajectory is truncated by the replanning horizon. */
         std::size_t m_stancePhaseDelay; /**< Delay in ticks of the beginning of the stance phase. */
 
         double m_nominalWidth; /**< Nominal width between two feet. */
@@ -69,11 +226,144 @@ namespace WalkingControllers
 
         std::mutex m_mutex; /**< Mutex. */
 
+        /**
+         * Pool of trajectory snapshots. A snapshot is reused when it is held only by the pool,
+         * i.e. when it is not published anymore, no sampler of the module refers to it and it is
+         * not a precomputed candidate. The pool grows only until it contains all the snapshots
+         * that can be held at the same time. It is accessed only by the thread that runs the planner.
+         */
+        std::vector<std::shared_ptr<TrajectorySnapshot>> m_snapshotPool;
+        std::vector<bool> m_isKnot; /**< Buffer used to choose the knots of the splines. */
+        std::shared_ptr<const TrajectorySnapshot> m_publishedSnapshot; /**< Last published snapshot. */
+
+        bool m_useSpeculativePlanning; /**< True if the trajectories are precomputed before the merge point. */
+        std::size_t m_numberOfExtrapolatedGoals; /**< Number of extrapolated goals used to precompute the trajectories. */
+        double m_speculativeGoalTolerance; /**< Maximum distance between the goal and the goal of a precomputed trajectory. */
+
+        std::vector<SpeculativeCandidate> m_speculativeCandidates; /**< Trajectories precomputed for the next merge point. */
+        std::size_t m_nextSpeculativeCandidate{0}; /**< Index of the first candidate that has to be evaluated. */
+        std::size_t m_speculativeGeneration{0}; /**< Incremented every time the candidates are discarded. */
+        bool m_isSpeculating{false}; /**< True if the planner is evaluating a candidate. */
+
+        iDynTree::Vector2 m_lastGoal; /**< Last goal received by speculateTrajectories(). */
+        double m_lastGoalTime; /**< Time at which the last goal has been received. */
+        iDynTree::Vector2 m_goalVelocity; /**< Estimated velocity of the goal. */
+        bool m_isLastGoalValid{false}; /**< True if m_lastGoal has been set. */
+
+        LatencyHistogram m_plannerLatency; /**< Histogram of the time spent by the planner to evaluate a trajectory asked by the module. */
+        LatencyHistogram m_speculativeLatency; /**< Histogram of the time spent by the planner to precompute a candidate trajectory. */
+
+        double m_knotPeriod; /**< Maximum distance between two knots of the trajectory splines. */
+        bool m_useDenseTrajectories; /**< True if the dense trajectories are stored in the snapshots (debug mode). */
+        DenseTrajectory m_denseTrajectory; /**< Trajectories evaluated by the planner sampled at each tick. */
+
+        StepsList m_committedLeftSteps; /**< Left footsteps of the trajectory used by the controller. */
+        StepsList m_committedRightSteps; /**< Right footsteps of the trajectory used by the controller. */
+
         /**
          * Main thread method.
          */
         void computeThread();
 
+        /**
+         * Evaluate new trajectories with the unicycle planner.
+         * @param input input of the planner.
+         * @return true/false in case of success/failure.
+         */
+        bool evaluateTrajectories(const PlannerInput& input);
+
+        /**
+         * Ask for new trajectories given the desired point in the world frame.
+         * @param initTime is the initial time of the trajectory;
+         * @param DCMBoundaryConditionAtMergePointPosition is the position of the DCM at the merge point;
+         * @param DCMBoundaryConditionAtMergePointVelocity is the velocity of the DCM at the merge point;
+         * @param correctLeft true if the stance foot is the left one;
+         * @param measured Measured transformation between the stance foot and the world frame. (w_H_{stancefoot});
+         * @param desiredPoint final desired position of the projection of the CoM (world frame).
+         * @return true/false in case of success/failure.
+         */
+        bool requestTrajectories(double initTime, const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                 const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity, bool correctLeft,
+                                 const iDynTree::Transform& measured, const iDynTree::Vector2& desiredPoint);
+
+        /**
+         * Evaluate the desired point of the planner in the world frame.
+         * @param correctLeft true if the stance foot is the left one;
+         * @param measured measured transformation between the stance foot and the world frame;
+         * @param desiredPosition desired position expressed with respect to the stance foot.
+         * @return the desired point.
+         */
+        iDynTree::Vector2 evaluateDesiredPoint(bool correctLeft, const iDynTree::Transform& measured,
+                                               const iDynTree::Vector2& desiredPosition) const;
+
+        /**
+         * Check if two planner inputs refer to the same merge point (the desired point is not considered).
+         * @return true if the merge point is the same.
+         */
+        bool isSameMergePoint(const PlannerInput& first, const PlannerInput& second) const;
+
+        /**
+         * Discard all the precomputed trajectories. The mutex has to be locked.
+         */
+        void clearSpeculativeCandidates();
+
+        /**
+         * Store the footsteps of the last evaluated trajectory.
+         * @param leftSteps left footsteps;
+         * @param rightSteps right footsteps.
+         */
+        void getSteps(StepsList& leftSteps, StepsList& rightSteps);
+
+        /**
+         * Set the footsteps of the unicycle generator.
+         * @param leftSteps left footsteps;
+         * @param rightSteps right footsteps.
+         */
+        void setSteps(const StepsList& leftSteps, const StepsList& rightSteps);
+
+        /**
+         * Fill the snapshot with the trajectories evaluated by the planner. The knots of the
+         * splines are placed every m_knotPeriod seconds, around the contact switches and at
+         * the merge points.
+         * @param snapshot trajectory snapshot.
+         */
+        void fillSnapshot(TrajectorySnapshot& snapshot);
+
+        /**
+         * Add a knot to the splines of a foot.
+         * @param time time of the knot;
+         * @param transform transformation between the foot and the world frame;
+         * @param twist twist of the foot (mixed representation);
+         * @param positionSpline spline of the foot position;
+         * @param rpySpline spline of the roll pitch yaw angles of the foot;
+         * @param lastRPY angles of the last knot. The angles are unwrapped with respect to them.
+         */
+        void addFootKnot(double time, const iDynTree::Transform& transform, const iDynTree::Twist& twist,
+                         StdUtilities::HermiteSpline<3>& positionSpline,
+                         StdUtilities::HermiteSpline<3>& rpySpline,
+                         StdUtilities::HermiteSpline<3>::Point& lastRPY) const;
+
+        /**
+         * Get a snapshot of the pool that is not held by anyone else. A new snapshot is added to
+         * the pool only if all of them are in use.
+         * @return pointer to the snapshot.
+         */
+        std::shared_ptr<TrajectorySnapshot> acquireSnapshot();
+
+        /**
+         * Fill a snapshot of the pool with the trajectories evaluated by the planner and publish it.
+         * It has to be called by the thread that evaluated the trajectories.
+         */
+        void publishSnapshot();
+
+        /**
+         * Evaluate when the robot is in the stance phase given the DCM velocity.
+         * @param DCMVelocityTrajectory desired trajectory of the DCM velocity;
+         * @param isStancePhase vector containing if the robot is in the stance phase.
+         */
+        void evaluateIsStancePhase(const std::vector<iDynTree::Vector2>& DCMVelocityTrajectory,
+                                   std::vector<bool>& isStancePhase) const;
+
     public:
 
         /**
@@ -117,6 +407,8 @@ namespace WalkingControllers
          * The old trajectory will be deleted and a new one is evaluated. The boundary condition of the new trajectory is given by
          * the position and the velocity of the DCM at the merge point.
          * This method allows you to take into account the real position one foot at the beginning of the trajectory.
+         * If a trajectory has been already precomputed for the same merge point and a close desired position,
+         * it is immediately available.
          * @param initTime is the initial time of the trajectory;
          * @param DCMBoundaryConditionAtMergePointPosition is the position of the DCM at the merge point;
          * @param DCMBoundaryConditionAtMergePointVelocity is the velocity of the DCM at the merge point;
@@ -130,92 +422,80 @@ namespace WalkingControllers
                                 const iDynTree::Transform& measured, const iDynTree::Vector2& desiredPosition);
 
         /**
-         * Return if the trajectory was computed
-         * @return true if the trajectory has been computed false otherwise.
-         */
-        bool isTrajectoryComputed();
-
-        /**
-         * Configure the planner in order to add or not the terminal step
-         * @param terminalStep if it true the terminal step will be added
-         */
-        void addTerminalStep(bool terminalStep);
-
-        /**
-         * Return if a new trajectory is asked.
-         * @return true if the trajectory has already asked.
-         */
-        bool isTrajectoryAsked();
-
-        /**
-         * Get the desired 2D-DCM position trajectory
-         * @param DCMPositionTrajectory desired trajectory of the DCM.
+         * Extend the trajectory towards the last desired position. It has to be used when the
+         * trajectory has been truncated by the replanning horizon (TrajectorySnapshot::isTruncated).
+         * @param initTime is the initial time of the trajectory;
+         * @param DCMBoundaryConditionAtMergePointPosition is the position of the DCM at the merge point;
+         * @param DCMBoundaryConditionAtMergePointVelocity is the velocity of the DCM at the merge point;
+         * @param correctLeft true if the stance foot is the left one;
+         * @param measured Measured transformation between the stance foot and the world frame. (w_H_{stancefoot}).
          * @return true/false in case of success/failure.
          */
-        bool getDCMPositionTrajectory(std::vector<iDynTree::Vector2>& DCMPositionTrajectory);
+        bool extendTrajectories(double initTime, const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity, bool correctLeft,
+                                const iDynTree::Transform& measured);
 
         /**
-         * Get the desired 2D-DCM velocity trajectory
-         * @param DCMVelocityTrajectory desired trajectory of the DCM.
+         * Precompute the trajectories for the next merge point. The trajectories are evaluated for
+         * the desired position and for some positions extrapolated from the previous ones. They are
+         * used by updateTrajectories() if the merge point is the same and the desired position is
+         * close to one of them. The method does nothing if the speculative planning is disabled.
+         * @param time current time;
+         * @param initTime is the initial time of the trajectory;
+         * @param DCMBoundaryConditionAtMergePointPosition is the position of the DCM at the merge point;
+         * @param DCMBoundaryConditionAtMergePointVelocity is the velocity of the DCM at the merge point;
+         * @param correctLeft true if the stance foot is the left one;
+         * @param measured Measured transformation between the stance foot and the world frame. (w_H_{stancefoot});
+         * @param desiredPosition final desired position of the projection of the CoM.
          * @return true/false in case of success/failure.
          */
-        bool getDCMVelocityTrajectory(std::vector<iDynTree::Vector2>& DCMVelocityTrajectory);
+        bool speculateTrajectories(double time, double initTime,
+                                   const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                   const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity,
+                                   bool correctLeft, const iDynTree::Transform& measured,
+                                   const iDynTree::Vector2& desiredPosition);
 
         /**
-         * Get the feet trajectory
-         * @param lFootTrajectory vector containing the left foot trajectory;
-         * @param rFootTrajectory vector containing the right foot trajectory.
-         * @return true/false in case of success/failure.
+         * Get the time spent by the planner to evaluate a trajectory at a given percentile.
+         * Only the trajectories asked by the module are considered, not the precomputed ones.
+         * @param percentile percentile of the latency (between 0 and 1);
+         * @param latency latency of the planner (in seconds).
+         * @return true/false in case of success/failure (e.g. no trajectory has been evaluated yet).
          */
-        bool getFeetTrajectories(std::vector<iDynTree::Transform>& lFootTrajectory,
-                                 std::vector<iDynTree::Transform>& rFootTrajectory);
-
+        bool getPlannerLatency(double percentile, double& latency);
 
         /**
-         * Get the feet twist
-         * @param lFootTwist vector containing the left foot twists;
-         * @param rFootTwist vector containing the right foot twists.
-         * @return true/false in case of success/failure.
+         * Get the time spent by the planner to precompute a candidate trajectory at a given percentile.
+         * @param percentile percentile of the latency (between 0 and 1);
+         * @param latency latency of the planner (in seconds).
+         * @return true/false in case of success/failure (e.g. no candidate has been evaluated yet).
          */
-        bool getFeetTwist(std::vector<iDynTree::Twist>& lFootTwist,
-                          std::vector<iDynTree::Twist>& rFootTwist);
-        /**
-         * Get the when the main frame of the left foot is the fix frame.
-         * @param isLeftFixedFrame vector containing when the main frame of
-         * the left foot is the fix frame.
-         * @return true/false in case of success/failure.
-         */
-        bool getWhenUseLeftAsFixed(std::vector<bool>& isLeftFixedFrame);
+        bool getSpeculativeLatency(double percentile, double& latency);
 
         /**
-         * Get the feet phases
-         * @param lFootContacts vector containing the state of the left foot (true = in contact);
-         * @param rFootContacts vector containing the state of the right foot (true = in contact).
-         * @return true/false in case of success/failure.
+         * Return if the trajectory was computed
+         * @return true if the trajectory has been computed false otherwise.
          */
-        bool getFeetStandingPeriods(std::vector<bool>& lFootContacts,
-                                    std::vector<bool>& rFootContacts);
+        bool isTrajectoryComputed();
 
         /**
-         * Get the CoM height trajectory
-         * @param CoMHeightTrajectory vector containing trajectory of the COM on the z axis.
-         * @return true/false in case of success/failure.
+         * Configure the planner in order to add or not the terminal step
+         * @param terminalStep if it true the terminal step will be added
          */
-        bool getCoMHeightTrajectory(std::vector<double>& CoMHeightTrajectory);
+        void addTerminalStep(bool terminalStep);
 
         /**
-         * Get the CoM height velocity
-         * @param CoMHeightVelocity vector containing the velocity of the COM on the z axis.
-         * @return true/false in case of success/failure.
+         * Return if a new trajectory is asked.
+         * @return true if the trajectory has already asked.
          */
-        bool getCoMHeightVelocity(std::vector<double>& CoMHeightVelocity);
+        bool isTrajectoryAsked();
 
         /**
-         * Get the merge points along the trajectory
-         * @param mergePoints vector containing all the merge points of the trajectory.
-         * @return true/false in case of success/failure.
+         * Get the snapshot containing the last evaluated trajectories. No data is copied, the
+         * snapshot remains valid as long as the pointer is held.
+         * @return pointer to the snapshot (nullptr if no trajectory is available).
          */
-        bool getMergePoints(std::vector<size_t>& mergePoints);
+        std::shared_ptr<const TrajectorySnapshot> getTrajectorySnapshot();
 
         /**
          * Get the weight percentage for the left and right foot
@@ -223,19 +503,11 @@ namespace WalkingControllers
          * stance foot during SS, 1 in case of swing foot)
          * @param weightInRight vector containing the weight on the right foot (0 in case in case of
          * stance foot during SS, 1 in case of swing foot)
+         * @note the weight percentages are read from the published snapshot.
          * @return true/false in case of success/failure.
          */
         bool getWeightPercentage(std::vector<double> &weightInLeft, std::vector<double> &weightInRight);
 
-        /**
-         * Get the desired current state of the robot. If the robot is not walking (i.e. the DCM
-         * velocity is almost zero), it is considered in "stance" phase.
-         * @param isStancePhase vector containing if the robot is in the stance phase during the
-         * entire horizon.
-         * @return true/false in case of success/failure.
-         */
-        bool getIsStancePhase(std::vector<bool>& isStancePhase);
-
         /**
          * Reset the planner
          */
@@ -6,6 +6,11 @@
  * @date 2018
  */
 
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 // YARP
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Value.h>
@@ -23,7 +28,7 @@ TrajectoryGenerator::~TrajectoryGenerator()
     {
         std::lock_guard<std::mutex> guard(m_mutex);
         m_generatorState = GeneratorState::Closing;
-        m_conditionVariable.notify_one();
+        m_conditionVariable.notify_all();
     }
 
     if(m_generatorThread.joinable())
@@ -31,6 +36,15 @@ TrajectoryGenerator::~TrajectoryGenerator()
         m_generatorThread.join();
         m_generatorThread = std::thread();
     }
+
+    double latency;
+    if(m_plannerLatency.getPercentile(0.95, latency))
+        yInfo() << "[~TrajectoryGenerator] 95th percentile of the planner latency:" << latency * 1e3
+                << "ms (" << m_plannerLatency.getNumberOfSamples() << "trajectories).";
+
+    if(m_speculativeLatency.getPercentile(0.95, latency))
+        yInfo() << "[~TrajectoryGenerator] 95th percentile of the speculative planner latency:" << latency * 1e3
+                << "ms (" << m_speculativeLatency.getNumberOfSamples() << "candidates).";
 }
 
 bool TrajectoryGenerator::initialize(const yarp::os::Searchable& config)
@@ -54,6 +68,7 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
 
     m_dT = config.check("sampling_time", yarp::os::Value(0.016)).asDouble();
     m_plannerHorizon = config.check("plannerHorizon", yarp::os::Value(20.0)).asDouble();
+    m_replanningHorizon = config.check("replanningHorizon", yarp::os::Value(m_plannerHorizon)).asDouble();
     double unicycleGain = config.check("unicycleGain", yarp::os::Value(10.0)).asDouble();
     double stancePhaseDelaySeconds = config.check("stance_phase_delay",yarp::os::Value(0.0)).asDouble();
 
@@ -90,7 +105,7 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
                                                               yarp::os::Value(40.0)).asDouble());
     double minAngleVariation = iDynTree::deg2rad(config.check("minAngleVariation",
                                                               yarp::os::Value(5.0)).asDouble());
-    double maxStepDuration = config.check("maxStepDuration", yarp::os::Value(8.0)).asDouble();
+    m_maxStepDuration = config.check("maxStepDuration", yarp::os::Value(8.0)).asDouble();
     double minStepDuration = config.check("minStepDuration", yarp::os::Value(2.9)).asDouble();
     double stepHeight = config.check("stepHeight", yarp::os::Value(0.005)).asDouble();
     double landingVelocity = config.check("stepLandingVelocity", yarp::os::Value(0.0)).asDouble();
@@ -124,7 +139,7 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
     ok = ok && unicyclePlanner->setMaxAngleVariation(maxAngleVariation);
     ok = ok && unicyclePlanner->setCostWeights(positionWeight, timeWeight);
     ok = ok && unicyclePlanner->setStepTimings(minStepDuration,
-                                               maxStepDuration, nominalDuration);
+                                               m_maxStepDuration, nominalDuration);
     ok = ok && unicyclePlanner->setPlannerPeriod(m_dT);
     ok = ok && unicyclePlanner->setMinimumAngleForNewSteps(minAngleVariation);
     ok = ok && unicyclePlanner->setMinimumStepLength(minStepLength);
@@ -135,7 +150,7 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
 
     ok = ok && m_trajectoryGenerator.setSwitchOverSwingRatio(switchOverSwingRatio);
     ok = ok && m_trajectoryGenerator.setTerminalHalfSwitchTime(lastStepSwitchTime);
-    ok = ok && m_trajectoryGenerator.setPauseConditions(maxStepDuration, nominalDuration);
+    ok = ok && m_trajectoryGenerator.setPauseConditions(m_maxStepDuration, nominalDuration);
 
     if (m_useMinimumJerk) {
         m_feetGenerator = m_trajectoryGenerator.addFeetMinimumJerkGenerator();
@@ -156,6 +171,38 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
     m_dcmGenerator->setOmega(sqrt(9.81/comHeight));
     ok = ok && m_dcmGenerator->setLastStepDCMOffsetPercentage(lastStepDCMOffset);
 
+    m_useSpeculativePlanning = config.check("useSpeculativePlanning", yarp::os::Value(false)).asBool();
+    m_numberOfExtrapolatedGoals = config.check("speculativeExtrapolatedGoals", yarp::os::Value(2)).asInt();
+    m_speculativeGoalTolerance = config.check("speculativeGoalTolerance", yarp::os::Value(0.05)).asDouble();
+
+    m_knotPeriod = config.check("trajectoryKnotPeriod", yarp::os::Value(0.05)).asDouble();
+    m_useDenseTrajectories = config.check("useDenseTrajectories", yarp::os::Value(false)).asBool();
+
+    if(m_knotPeriod < m_dT)
+    {
+        yError() << "[configurePlanner] The knot period of the trajectories cannot be smaller than the sampling time.";
+        return false;
+    }
+
+    if(m_replanningHorizon <= 0 || m_replanningHorizon > m_plannerHorizon)
+    {
+        yError() << "[configurePlanner] The replanning horizon has to be positive and not greater than the planner horizon.";
+        return false;
+    }
+
+    // the latency of the planner is stored with a resolution of 1 ms. Two merge points are
+    // at most one step apart, a longer latency is stored in the last bin. Only the last
+    // solves are considered, so that the latency follows the load of the machine
+    int latencyWindow = config.check("plannerLatencyWindow", yarp::os::Value(50)).asInt();
+    if(latencyWindow < 0)
+    {
+        yError() << "[configurePlanner] The planner latency window has to be non negative.";
+        return false;
+    }
+    double maxLatency = std::min(m_maxStepDuration, m_plannerHorizon);
+    ok = ok && m_plannerLatency.initialize(0.001, maxLatency, latencyWindow);
+    ok = ok && m_speculativeLatency.initialize(0.001, maxLatency, latencyWindow);
+
     m_correctLeft = true;
 
     if(ok)
@@ -182,88 +229,107 @@ void TrajectoryGenerator::computeThread()
 {
     while (true)
     {
-        double initTime;
-        double endTime;
-        double dT;
-
-        bool correctLeft;
+        PlannerInput input;
 
-        iDynTree::Vector2 desiredPoint;
-        iDynTree::Vector2 measuredPositionLeft, measuredPositionRight;
-        double measuredAngleLeft, measuredAngleRight;
-
-        iDynTree::Vector2 DCMBoundaryConditionAtMergePointPosition;
-        iDynTree::Vector2 DCMBoundaryConditionAtMergePointVelocity;
+        bool isSpeculative;
+        std::size_t candidateIndex;
+        std::size_t generation;
 
         // wait until a new trajectory has to be evaluated.
         {
             std::unique_lock<std::mutex> lock(m_mutex);
             m_conditionVariable.wait(lock, [&]{return ((m_generatorState == GeneratorState::Called)
-                                                       || (m_generatorState == GeneratorState::Closing));});
+                                                       || (m_generatorState == GeneratorState::Closing)
+                                                       || (m_generatorState == GeneratorState::Returned
+                                                           && m_nextSpeculativeCandidate < m_speculativeCandidates.size()));});
 
             if(m_generatorState == GeneratorState::Closing)
                 break;
 
-            // set timings
-            dT = m_dT ;
-            initTime = m_initTime;
-            endTime = initTime + m_plannerHorizon;
-
-            // set desired point
-            desiredPoint = m_desiredPoint;
-
-            // dcm boundary conditions
-            DCMBoundaryConditionAtMergePointPosition = m_DCMBoundaryConditionAtMergePointPosition;
-            DCMBoundaryConditionAtMergePointVelocity = m_DCMBoundaryConditionAtMergePointVelocity;
-
-            // left foot
-            measuredPositionLeft(0) = m_measuredTransformLeft.getPosition()(0);
-            measuredPositionLeft(1) = m_measuredTransformLeft.getPosition()(1);
-            measuredAngleLeft = m_measuredTransformLeft.getRotation().asRPY()(2);
-
-            // right foot
-            measuredPositionRight(0) = m_measuredTransformRight.getPosition()(0);
-            measuredPositionRight(1) = m_measuredTransformRight.getPosition()(1);
-            measuredAngleRight = m_measuredTransformRight.getRotation().asRPY()(2);
-
-            correctLeft = m_correctLeft;
+            // the exact trajectory is evaluated only if it is asked by the user,
+            // otherwise a candidate is precomputed
+            isSpeculative = m_generatorState != GeneratorState::Called;
+            if(isSpeculative)
+            {
+                candidateIndex = m_nextSpeculativeCandidate++;
+                generation = m_speculativeGeneration;
+                input = m_speculativeCandidates[candidateIndex].input;
+                m_isSpeculating = true;
+            }
+            else
+            {
+                // set timings
+                input.initTime = m_initTime;
+
+                // set desired point
+                input.desiredPoint = m_desiredPoint;
+
+                // dcm boundary conditions
+                input.DCMBoundaryConditionAtMergePointPosition = m_DCMBoundaryConditionAtMergePointPosition;
+                input.DCMBoundaryConditionAtMergePointVelocity = m_DCMBoundaryConditionAtMergePointVelocity;
+
+                // stance foot
+                const iDynTree::Transform& measuredTransform = m_correctLeft ? m_measuredTransformLeft : m_measuredTransformRight;
+                input.measuredPosition(0) = measuredTransform.getPosition()(0);
+                input.measuredPosition(1) = measuredTransform.getPosition()(1);
+                input.measuredAngle = measuredTransform.getRotation().asRPY()(2);
+
+                input.correctLeft = m_correctLeft;
+            }
+
+            // the previous candidates may have changed the footsteps of the planner. The planner
+            // has to start from the footsteps of the trajectory used by the controller
+            if(m_useSpeculativePlanning)
+                setSteps(m_committedLeftSteps, m_committedRightSteps);
         }
 
-        // clear the old trajectory
-        std::shared_ptr<UnicyclePlanner> unicyclePlanner = m_trajectoryGenerator.unicyclePlanner();
-        unicyclePlanner->clearDesiredTrajectory();
+        auto startTime = std::chrono::steady_clock::now();
+        bool ok = evaluateTrajectories(input);
+        std::chrono::duration<double> latency = std::chrono::steady_clock::now() - startTime;
 
-        // add new point
-        if(!unicyclePlanner->addDesiredTrajectoryPoint(endTime, desiredPoint))
+        // the candidates are evaluated while the robot is walking and they are not waited for by
+        // the module, they do not contribute to the latency used to ask the trajectories
         {
-            // something goes wrong
             std::lock_guard<std::mutex> guard(m_mutex);
-            m_generatorState = GeneratorState::Configured;
-            yError() << "[TrajectoryGenerator_Thread] Error while setting the new reference.";
-            break;
+            if(isSpeculative)
+                m_speculativeLatency.addSample(latency.count());
+            else
+                m_plannerLatency.addSample(latency.count());
         }
 
-        iDynTree::Vector2 measuredPosition;
-        double measuredAngle;
-        measuredPosition = correctLeft ? measuredPositionLeft : measuredPositionRight;
-        measuredAngle = correctLeft ? measuredAngleLeft : measuredAngleRight;
-
-        DCMInitialState initialState;
-        initialState.initialPosition = DCMBoundaryConditionAtMergePointPosition;
-        initialState.initialVelocity = DCMBoundaryConditionAtMergePointVelocity;
+        if(isSpeculative)
+        {
+            std::shared_ptr<TrajectorySnapshot> trajectory;
+            if(ok)
+            {
+                trajectory = acquireSnapshot();
+                fillSnapshot(*trajectory);
+            }
 
-        if (!m_dcmGenerator->setDCMInitialState(initialState)) {
-            // something goes wrong
             std::lock_guard<std::mutex> guard(m_mutex);
-            m_generatorState = GeneratorState::Configured;
-            yError() << "[TrajectoryGenerator_Thread] Failed to set the initial state.";
-            break;
+
+            // the candidates may have been discarded in the meanwhile
+            if(ok && generation == m_speculativeGeneration)
+            {
+                SpeculativeCandidate& candidate = m_speculativeCandidates[candidateIndex];
+                candidate.trajectory = trajectory;
+                getSteps(candidate.leftSteps, candidate.rightSteps);
+            }
+
+            m_isSpeculating = false;
+            m_conditionVariable.notify_all();
+            continue;
         }
 
-        if(m_trajectoryGenerator.reGenerate(initTime, dT, endTime,
-                                            correctLeft, measuredPosition, measuredAngle))
+        if(ok)
         {
+            // the trajectories are copied here, outside the control thread
+            publishSnapshot();
+
             std::lock_guard<std::mutex> guard(m_mutex);
+            if(m_useSpeculativePlanning)
+                getSteps(m_committedLeftSteps, m_committedRightSteps);
+
             m_generatorState = GeneratorState::Returned;
             continue;
         }
@@ -277,6 +343,54 @@ void TrajectoryGenerator::computeThread()
     }
 }
 
+bool TrajectoryGenerator::evaluateTrajectories(const PlannerInput& input)
+{
+    // clear the old trajectory
+    std::shared_ptr<UnicyclePlanner> unicyclePlanner = m_trajectoryGenerator.unicyclePlanner();
+    unicyclePlanner->clearDesiredTrajectory();
+
+    // add new point. Only the window given by the replanning horizon is evaluated,
+    // the trajectory will be extended when the robot will consume it
+    double endTime = input.initTime + m_replanningHorizon;
+    if(!unicyclePlanner->addDesiredTrajectoryPoint(endTime, input.desiredPoint))
+    {
+        yError() << "[TrajectoryGenerator_Thread] Error while setting the new reference.";
+        return false;
+    }
+
+    DCMInitialState initialState;
+    initialState.initialPosition = input.DCMBoundaryConditionAtMergePointPosition;
+    initialState.initialVelocity = input.DCMBoundaryConditionAtMergePointVelocity;
+
+    if (!m_dcmGenerator->setDCMInitialState(initialState))
+    {
+        yError() << "[TrajectoryGenerator_Thread] Failed to set the initial state.";
+        return false;
+    }
+
+    if(!m_trajectoryGenerator.reGenerate(input.initTime, m_dT, endTime, input.correctLeft,
+                                         input.measuredPosition, input.measuredAngle))
+        return false;
+
+    // the trajectory is truncated if the robot is still walking at the end of the window
+    m_isTrajectoryTruncated = false;
+    if(m_replanningHorizon < m_plannerHorizon)
+    {
+        const StepsList& leftSteps = m_trajectoryGenerator.getLeftFootPrint()->getSteps();
+        const StepsList& rightSteps = m_trajectoryGenerator.getRightFootPrint()->getSteps();
+
+        double lastImpactTime = input.initTime;
+        if(!leftSteps.empty())
+            lastImpactTime = std::max(lastImpactTime, leftSteps.back().impactTime);
+        if(!rightSteps.empty())
+            lastImpactTime = std::max(lastImpactTime, rightSteps.back().impactTime);
+
+        m_isTrajectoryTruncated = lastImpactTime > endTime - m_maxStepDuration;
+    }
+
+    return true;
+}
+
 bool TrajectoryGenerator::generateFirstTrajectories(const iDynTree::Position& initialBasePosition)
 {
     // check if this step is the first one
@@ -326,6 +440,13 @@ bool TrajectoryGenerator::generateFirstTrajectories(const iDynTree::Position& in
         return false;
     }
 
+    m_isTrajectoryTruncated = false;
+    publishSnapshot();
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_useSpeculativePlanning)
+        getSteps(m_committedLeftSteps, m_committedRightSteps);
+
     m_generatorState = GeneratorState::Returned;
     return true;
 }
@@ -417,6 +538,13 @@ bool TrajectoryGenerator::generateFirstTrajectories(const iDynTree::Transform &l
         return false;
     }
 
+    m_isTrajectoryTruncated = false;
+    publishSnapshot();
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_useSpeculativePlanning)
+        getSteps(m_committedLeftSteps, m_committedRightSteps);
+
     m_generatorState = GeneratorState::Returned;
     return true;
 }
@@ -424,6 +552,30 @@ bool TrajectoryGenerator::generateFirstTrajectories(const iDynTree::Transform &l
 bool TrajectoryGenerator::updateTrajectories(double initTime, const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
                                              const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity, bool correctLeft,
                                              const iDynTree::Transform& measured, const iDynTree::Vector2& desiredPosition)
+{
+    return requestTrajectories(initTime, DCMBoundaryConditionAtMergePointPosition,
+                               DCMBoundaryConditionAtMergePointVelocity, correctLeft, measured,
+                               evaluateDesiredPoint(correctLeft, measured, desiredPosition));
+}
+
+bool TrajectoryGenerator::extendTrajectories(double initTime, const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                             const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity, bool correctLeft,
+                                             const iDynTree::Transform& measured)
+{
+    iDynTree::Vector2 desiredPoint;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        desiredPoint = m_desiredPoint;
+    }
+
+    return requestTrajectories(initTime, DCMBoundaryConditionAtMergePointPosition,
+                               DCMBoundaryConditionAtMergePointVelocity, correctLeft, measured,
+                               desiredPoint);
+}
+
+bool TrajectoryGenerator::requestTrajectories(double initTime, const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                              const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity, bool correctLeft,
+                                              const iDynTree::Transform& measured, const iDynTree::Vector2& desiredPoint)
 {
     {
         std::lock_guard<std::mutex> guard(m_mutex);
@@ -442,31 +594,56 @@ bool TrajectoryGenerator::updateTrajectories(double initTime, const iDynTree::Ve
             return false;
         }
     }
-    // if correctLeft is true the stance foot is the true.
-    // The vector (expressed in the unicycle reference frame from the left foot to the center of the
-    // unicycle is [0, width/2]')
-    iDynTree::Vector2 unicyclePositionFromStanceFoot;
-    unicyclePositionFromStanceFoot(0) = 0.0;
-    unicyclePositionFromStanceFoot(1) = correctLeft ? -m_nominalWidth/2 : m_nominalWidth/2;
-
-    iDynTree::Vector2 desredPositionFromStanceFoot;
-    iDynTree::toEigen(desredPositionFromStanceFoot) = iDynTree::toEigen(unicyclePositionFromStanceFoot)
-        + iDynTree::toEigen(m_referencePointDistance) + iDynTree::toEigen(desiredPosition);
-
-    // prepare the rotation matrix w_R_{unicycle}
-    double theta = measured.getRotation().asRPY()(2);
-    double s_theta = std::sin(theta);
-    double c_theta = std::cos(theta);
-
     // save the data
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        // apply the homogeneous transformation w_H_{unicycle}
-        m_desiredPoint(0) = c_theta * desredPositionFromStanceFoot(0)
-            - s_theta * desredPositionFromStanceFoot(1) + measured.getPosition()(0);
-        m_desiredPoint(1) = s_theta * desredPositionFromStanceFoot(0)
-            + c_theta * desredPositionFromStanceFoot(1) + measured.getPosition()(1);
+        // if a trajectory has been already precomputed for the same merge point
+        // and a close desired point it is immediately published
+        if(!m_speculativeCandidates.empty())
+        {
+            PlannerInput input;
+            input.initTime = initTime;
+            input.DCMBoundaryConditionAtMergePointPosition = DCMBoundaryConditionAtMergePointPosition;
+            input.DCMBoundaryConditionAtMergePointVelocity = DCMBoundaryConditionAtMergePointVelocity;
+            input.correctLeft = correctLeft;
+            input.measuredPosition(0) = measured.getPosition()(0);
+            input.measuredPosition(1) = measured.getPosition()(1);
+            input.measuredAngle = measured.getRotation().asRPY()(2);
+
+            const SpeculativeCandidate* closestCandidate = nullptr;
+            double minDistance = m_speculativeGoalTolerance;
+            for(const auto& candidate : m_speculativeCandidates)
+            {
+                if(candidate.trajectory == nullptr || !isSameMergePoint(candidate.input, input))
+                    continue;
+
+                double distance = (iDynTree::toEigen(candidate.input.desiredPoint)
+                                   - iDynTree::toEigen(desiredPoint)).norm();
+                if(distance <= minDistance)
+                {
+                    minDistance = distance;
+                    closestCandidate = &candidate;
+                }
+            }
+
+            if(closestCandidate != nullptr)
+            {
+                m_publishedSnapshot = closestCandidate->trajectory;
+                m_committedLeftSteps = closestCandidate->leftSteps;
+                m_committedRightSteps = closestCandidate->rightSteps;
+
+                m_desiredPoint = closestCandidate->input.desiredPoint;
+                m_initTime = initTime;
+
+                clearSpeculativeCandidates();
+                return true;
+            }
+
+            clearSpeculativeCandidates();
+        }
+
+        m_desiredPoint = desiredPoint;
 
         m_initTime = initTime;
 
@@ -484,168 +661,373 @@ bool TrajectoryGenerator::updateTrajectories(double initTime, const iDynTree::Ve
         m_generatorState = GeneratorState::Called;
     }
 
-    m_conditionVariable.notify_one();
+    m_conditionVariable.notify_all();
 
     return true;
 }
 
-bool TrajectoryGenerator::isTrajectoryComputed()
+iDynTree::Vector2 TrajectoryGenerator::evaluateDesiredPoint(bool correctLeft, const iDynTree::Transform& measured,
+                                                            const iDynTree::Vector2& desiredPosition) const
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
-    return m_generatorState == GeneratorState::Returned;
+    // if correctLeft is true the stance foot is the true.
+    // The vector (expressed in the unicycle reference frame from the left foot to the center of the
+    // unicycle is [0, width/2]')
+    iDynTree::Vector2 unicyclePositionFromStanceFoot;
+    unicyclePositionFromStanceFoot(0) = 0.0;
+    unicyclePositionFromStanceFoot(1) = correctLeft ? -m_nominalWidth/2 : m_nominalWidth/2;
+
+    iDynTree::Vector2 desredPositionFromStanceFoot;
+    iDynTree::toEigen(desredPositionFromStanceFoot) = iDynTree::toEigen(unicyclePositionFromStanceFoot)
+        + iDynTree::toEigen(m_referencePointDistance) + iDynTree::toEigen(desiredPosition);
+
+    // prepare the rotation matrix w_R_{unicycle}
+    double theta = measured.getRotation().asRPY()(2);
+    double s_theta = std::sin(theta);
+    double c_theta = std::cos(theta);
+
+    // apply the homogeneous transformation w_H_{unicycle}
+    iDynTree::Vector2 desiredPoint;
+    desiredPoint(0) = c_theta * desredPositionFromStanceFoot(0)
+        - s_theta * desredPositionFromStanceFoot(1) + measured.getPosition()(0);
+    desiredPoint(1) = s_theta * desredPositionFromStanceFoot(0)
+        + c_theta * desredPositionFromStanceFoot(1) + measured.getPosition()(1);
+
+    return desiredPoint;
 }
 
-bool TrajectoryGenerator::isTrajectoryAsked()
+bool TrajectoryGenerator::isSameMergePoint(const PlannerInput& first, const PlannerInput& second) const
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
-    return m_generatorState == GeneratorState::Called;
+    double tolerance = 1e-6;
+
+    return std::abs(first.initTime - second.initTime) < m_dT / 2
+        && first.correctLeft == second.correctLeft
+        && (iDynTree::toEigen(first.DCMBoundaryConditionAtMergePointPosition)
+            - iDynTree::toEigen(second.DCMBoundaryConditionAtMergePointPosition)).norm() < tolerance
+        && (iDynTree::toEigen(first.DCMBoundaryConditionAtMergePointVelocity)
+            - iDynTree::toEigen(second.DCMBoundaryConditionAtMergePointVelocity)).norm() < tolerance
+        && (iDynTree::toEigen(first.measuredPosition) - iDynTree::toEigen(second.measuredPosition)).norm() < tolerance
+        && std::abs(first.measuredAngle - second.measuredAngle) < tolerance;
 }
 
-bool TrajectoryGenerator::getDCMPositionTrajectory(std::vector<iDynTree::Vector2>& DCMPositionTrajectory)
+void TrajectoryGenerator::clearSpeculativeCandidates()
 {
-    if(!isTrajectoryComputed())
-    {
-        yError() << "[getDCMPositionTrajectory] No trajectories are available";
-        return false;
-    }
+    m_speculativeCandidates.clear();
+    m_nextSpeculativeCandidate = 0;
+    m_speculativeGeneration++;
+}
 
-    DCMPositionTrajectory = m_dcmGenerator->getDCMPosition();
-    return true;
+void TrajectoryGenerator::getSteps(StepsList& leftSteps, StepsList& rightSteps)
+{
+    leftSteps = m_trajectoryGenerator.getLeftFootPrint()->getSteps();
+    rightSteps = m_trajectoryGenerator.getRightFootPrint()->getSteps();
 }
 
-bool TrajectoryGenerator::getDCMVelocityTrajectory(std::vector<iDynTree::Vector2>& DCMVelocityTrajectory)
+void TrajectoryGenerator::setSteps(const StepsList& leftSteps, const StepsList& rightSteps)
 {
-    if(!isTrajectoryComputed())
-    {
-        yError() << "[getDCMVelocityTrajectory] No trajectories are available";
-        return false;
-    }
+    std::shared_ptr<FootPrint> left = m_trajectoryGenerator.getLeftFootPrint();
+    left->clearSteps();
+    for(const auto& step : leftSteps)
+        left->addStep(step);
 
-    DCMVelocityTrajectory = m_dcmGenerator->getDCMVelocity();
-    return true;
+    std::shared_ptr<FootPrint> right = m_trajectoryGenerator.getRightFootPrint();
+    right->clearSteps();
+    for(const auto& step : rightSteps)
+        right->addStep(step);
 }
 
-bool TrajectoryGenerator::getFeetTrajectories(std::vector<iDynTree::Transform>& lFootTrajectory,
-                                              std::vector<iDynTree::Transform>& rFootTrajectory)
+bool TrajectoryGenerator::speculateTrajectories(double time, double initTime,
+                                                const iDynTree::Vector2& DCMBoundaryConditionAtMergePointPosition,
+                                                const iDynTree::Vector2& DCMBoundaryConditionAtMergePointVelocity,
+                                                bool correctLeft, const iDynTree::Transform& measured,
+                                                const iDynTree::Vector2& desiredPosition)
 {
-    if(!isTrajectoryComputed())
+    if(!m_useSpeculativePlanning)
+        return true;
+
+    PlannerInput input;
+    input.initTime = initTime;
+    input.DCMBoundaryConditionAtMergePointPosition = DCMBoundaryConditionAtMergePointPosition;
+    input.DCMBoundaryConditionAtMergePointVelocity = DCMBoundaryConditionAtMergePointVelocity;
+    input.correctLeft = correctLeft;
+    input.measuredPosition(0) = measured.getPosition()(0);
+    input.measuredPosition(1) = measured.getPosition()(1);
+    input.measuredAngle = measured.getRotation().asRPY()(2);
+    input.desiredPoint = evaluateDesiredPoint(correctLeft, measured, desiredPosition);
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // estimate the velocity of the goal
+    if(m_isLastGoalValid && time > m_lastGoalTime
+       && (iDynTree::toEigen(desiredPosition) - iDynTree::toEigen(m_lastGoal)).norm() > 0)
     {
-        yError() << "[getFeetTrajectories] No trajectories are available";
-        return false;
+        iDynTree::toEigen(m_goalVelocity) = (iDynTree::toEigen(desiredPosition) - iDynTree::toEigen(m_lastGoal))
+            / (time - m_lastGoalTime);
+        m_lastGoal = desiredPosition;
+        m_lastGoalTime = time;
+    }
+    else if(!m_isLastGoalValid)
+    {
+        m_goalVelocity.zero();
+        m_lastGoal = desiredPosition;
+        m_lastGoalTime = time;
+        m_isLastGoalValid = true;
     }
 
-    m_feetGenerator->getFeetTrajectories(lFootTrajectory, rFootTrajectory);
+    // the candidates can be evaluated only when the planner is not busy
+    if(m_generatorState != GeneratorState::Returned)
+        return true;
 
-    return true;
-}
+    // the candidates are still valid if the merge point is the same and
+    // the desired point is close to one of them
+    if(!m_speculativeCandidates.empty() && isSameMergePoint(m_speculativeCandidates.front().input, input))
+    {
+        for(const auto& candidate : m_speculativeCandidates)
+            if((iDynTree::toEigen(candidate.input.desiredPoint) - iDynTree::toEigen(input.desiredPoint)).norm()
+               <= m_speculativeGoalTolerance)
+                return true;
+    }
 
-bool TrajectoryGenerator::getFeetTwist(std::vector<iDynTree::Twist>& lFootTwist,
-                                       std::vector<iDynTree::Twist>& rFootTwist)
-{
-    if(!isTrajectoryComputed())
+    clearSpeculativeCandidates();
+
+    // the first candidate is the current goal, the others are extrapolated until the init time
+    // of the trajectory
+    SpeculativeCandidate candidate;
+    candidate.input = input;
+    m_speculativeCandidates.push_back(candidate);
+
+    std::size_t numberOfExtrapolatedGoals = iDynTree::toEigen(m_goalVelocity).isZero() ? 0 : m_numberOfExtrapolatedGoals;
+    for(std::size_t i = 1; i <= numberOfExtrapolatedGoals; i++)
     {
-        yError() << "[getFeetTwist] No trajectories are available";
-        return false;
+        iDynTree::Vector2 extrapolatedPosition;
+        iDynTree::toEigen(extrapolatedPosition) = iDynTree::toEigen(desiredPosition)
+            + iDynTree::toEigen(m_goalVelocity) * (initTime - time) * i / numberOfExtrapolatedGoals;
+
+        candidate.input.desiredPoint = evaluateDesiredPoint(correctLeft, measured, extrapolatedPosition);
+        m_speculativeCandidates.push_back(candidate);
     }
 
-    m_feetGenerator->getFeetTwistsInMixedRepresentation(lFootTwist, rFootTwist);
+    m_conditionVariable.notify_all();
 
     return true;
 }
 
-bool TrajectoryGenerator::getWhenUseLeftAsFixed(std::vector<bool>& isLeftFixedFrame)
+bool TrajectoryGenerator::getPlannerLatency(double percentile, double& latency)
 {
-    if(!isTrajectoryComputed())
-    {
-        yError() << "[getWhenUseLeftAsFixed] No trajectories are available";
-        return false;
-    }
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_plannerLatency.getPercentile(percentile, latency);
+}
 
-    m_trajectoryGenerator.getWhenUseLeftAsFixed(isLeftFixedFrame);
-    return true;
+bool TrajectoryGenerator::getSpeculativeLatency(double percentile, double& latency)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_speculativeLatency.getPercentile(percentile, latency);
 }
 
+bool TrajectoryGenerator::isTrajectoryComputed()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_generatorState == GeneratorState::Returned;
+}
 
-bool TrajectoryGenerator::getFeetStandingPeriods(std::vector<bool>& lFootContacts,
-                                                 std::vector<bool>& rFootContacts)
+bool TrajectoryGenerator::isTrajectoryAsked()
 {
-    if(!isTrajectoryComputed())
-    {
-        yError() << "[getFeetStandingPeriods] No trajectories are available";
-        return false;
-    }
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_generatorState == GeneratorState::Called;
+}
 
-    m_trajectoryGenerator.getFeetStandingPeriods(lFootContacts, rFootContacts);
-    return true;
+std::shared_ptr<TrajectorySnapshot> TrajectoryGenerator::acquireSnapshot()
+{
+    // a snapshot held only by the pool cannot be reached by the other threads, so it can be
+    // filled without locking the mutex. Its vectors and splines keep their capacity
+    for(const auto& snapshot : m_snapshotPool)
+        if(snapshot.use_count() == 1)
+            return snapshot;
+
+    m_snapshotPool.push_back(std::make_shared<TrajectorySnapshot>());
+    return m_snapshotPool.back();
+}
+
+void TrajectoryGenerator::publishSnapshot()
+{
+    std::shared_ptr<TrajectorySnapshot> snapshot = acquireSnapshot();
+    fillSnapshot(*snapshot);
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_publishedSnapshot = snapshot;
 }
 
-bool TrajectoryGenerator::getCoMHeightTrajectory(std::vector<double>& CoMHeightTrajectory)
+void TrajectoryGenerator::fillSnapshot(TrajectorySnapshot& snapshot)
 {
-    if(!isTrajectoryComputed())
+    m_denseTrajectory.DCMPosition = m_dcmGenerator->getDCMPosition();
+    m_denseTrajectory.DCMVelocity = m_dcmGenerator->getDCMVelocity();
+
+    m_feetGenerator->getFeetTrajectories(m_denseTrajectory.leftFootTrajectory,
+                                         m_denseTrajectory.rightFootTrajectory);
+    m_feetGenerator->getFeetTwistsInMixedRepresentation(m_denseTrajectory.leftFootTwist,
+                                                        m_denseTrajectory.rightFootTwist);
+    m_trajectoryGenerator.getFeetStandingPeriods(snapshot.leftInContact, snapshot.rightInContact);
+    m_trajectoryGenerator.getWhenUseLeftAsFixed(snapshot.isLeftFixedFrame);
+
+    m_heightGenerator->getCoMHeightTrajectory(m_denseTrajectory.CoMHeightTrajectory);
+    m_heightGenerator->getCoMHeightVelocity(m_denseTrajectory.CoMHeightVelocity);
+
+    m_trajectoryGenerator.getMergePoints(snapshot.mergePoints);
+
+    evaluateIsStancePhase(m_denseTrajectory.DCMVelocity, snapshot.isStancePhase);
+    m_dcmGenerator->getWeightPercentage(snapshot.weightInLeft, snapshot.weightInRight);
+
+    snapshot.isTruncated = m_isTrajectoryTruncated;
+    snapshot.size = m_denseTrajectory.DCMPosition.size();
+    snapshot.dT = m_dT;
+
+    // choose the knots of the splines. The trajectories are not smooth when the contacts change,
+    // in this case the samples before and after the switch are used as knots
+    std::vector<bool>& isKnot = m_isKnot;
+    isKnot.assign(snapshot.size, false);
+    std::size_t knotStep = std::max((std::size_t) std::round(m_knotPeriod / m_dT), (std::size_t) 1);
+    for(std::size_t i = 0; i < snapshot.size; i += knotStep)
+        isKnot[i] = true;
+
+    if(snapshot.size > 0)
+        isKnot.back() = true;
+
+    for(std::size_t i = 1; i < snapshot.size; i++)
     {
-        yError() << "[getCoMHeightTrajectory] No trajectories are available";
-        return false;
+        if(snapshot.leftInContact[i] != snapshot.leftInContact[i - 1]
+           || snapshot.rightInContact[i] != snapshot.rightInContact[i - 1])
+        {
+            isKnot[i - 1] = true;
+            isKnot[i] = true;
+        }
     }
 
-    m_heightGenerator->getCoMHeightTrajectory(CoMHeightTrajectory);
-    return true;
+    for(const auto& mergePoint : snapshot.mergePoints)
+        if(mergePoint < snapshot.size)
+            isKnot[mergePoint] = true;
+
+    std::size_t numberOfKnots = std::count(isKnot.begin(), isKnot.end(), true);
+
+    snapshot.DCM.clear();
+    snapshot.leftFootPosition.clear();
+    snapshot.leftFootRPY.clear();
+    snapshot.rightFootPosition.clear();
+    snapshot.rightFootRPY.clear();
+    snapshot.CoMHeight.clear();
+
+    snapshot.DCM.reserve(numberOfKnots);
+    snapshot.leftFootPosition.reserve(numberOfKnots);
+    snapshot.leftFootRPY.reserve(numberOfKnots);
+    snapshot.rightFootPosition.reserve(numberOfKnots);
+    snapshot.rightFootRPY.reserve(numberOfKnots);
+    snapshot.CoMHeight.reserve(numberOfKnots);
+
+    StdUtilities::HermiteSpline<3>::Point lastLeftRPY, lastRightRPY;
+    for(std::size_t i = 0; i < snapshot.size; i++)
+    {
+        if(!isKnot[i])
+            continue;
+
+        double time = i * m_dT;
+
+        const iDynTree::Vector2& DCMPosition = m_denseTrajectory.DCMPosition[i];
+        const iDynTree::Vector2& DCMVelocity = m_denseTrajectory.DCMVelocity[i];
+        snapshot.DCM.addKnot(time, {{DCMPosition(0), DCMPosition(1)}},
+                             {{DCMVelocity(0), DCMVelocity(1)}});
+
+        addFootKnot(time, m_denseTrajectory.leftFootTrajectory[i], m_denseTrajectory.leftFootTwist[i],
+                    snapshot.leftFootPosition, snapshot.leftFootRPY, lastLeftRPY);
+        addFootKnot(time, m_denseTrajectory.rightFootTrajectory[i], m_denseTrajectory.rightFootTwist[i],
+                    snapshot.rightFootPosition, snapshot.rightFootRPY, lastRightRPY);
+
+        snapshot.CoMHeight.addKnot(time, {{m_denseTrajectory.CoMHeightTrajectory[i]}},
+                                   {{m_denseTrajectory.CoMHeightVelocity[i]}});
+    }
+
+    snapshot.isDense = m_useDenseTrajectories;
+    if(m_useDenseTrajectories)
+        snapshot.dense = m_denseTrajectory;
 }
 
-bool TrajectoryGenerator::getCoMHeightVelocity(std::vector<double>& CoMHeightVelocity)
+void TrajectoryGenerator::addFootKnot(double time, const iDynTree::Transform& transform,
+                                      const iDynTree::Twist& twist,
+                                      StdUtilities::HermiteSpline<3>& positionSpline,
+                                      StdUtilities::HermiteSpline<3>& rpySpline,
+                                      StdUtilities::HermiteSpline<3>::Point& lastRPY) const
 {
-    if(!isTrajectoryComputed())
+    iDynTree::Position position = transform.getPosition();
+    StdUtilities::HermiteSpline<3>::Point positionValue{{position(0), position(1), position(2)}};
+    StdUtilities::HermiteSpline<3>::Point linearVelocity{{twist.getLinearVec3()(0),
+                                                         twist.getLinearVec3()(1),
+                                                         twist.getLinearVec3()(2)}};
+    positionSpline.addKnot(time, positionValue, linearVelocity);
+
+    // the angles are unwrapped in order to be interpolated
+    iDynTree::Vector3 rpyValue = transform.getRotation().asRPY();
+    StdUtilities::HermiteSpline<3>::Point rpy;
+    for(std::size_t j = 0; j < 3; j++)
     {
-        yError() << "[getCoMHeightVelocity] No trajectories are available";
-        return false;
+        rpy[j] = rpyValue(j);
+        if(!rpySpline.empty())
+            rpy[j] += 2 * M_PI * std::round((lastRPY[j] - rpy[j]) / (2 * M_PI));
     }
-
-    m_heightGenerator->getCoMHeightVelocity(CoMHeightVelocity);
-    return true;
+    lastRPY = rpy;
+
+    // inverse of the map between the derivative of the RPY angles and the angular velocity
+    const auto& omega = twist.getAngularVec3();
+    double sinYaw = std::sin(rpy[2]);
+    double cosYaw = std::cos(rpy[2]);
+    double rollRate = (cosYaw * omega(0) + sinYaw * omega(1)) / std::cos(rpy[1]);
+    StdUtilities::HermiteSpline<3>::Point rpyRate{{rollRate,
+                                                  -sinYaw * omega(0) + cosYaw * omega(1),
+                                                  omega(2) + std::sin(rpy[1]) * rollRate}};
+    rpySpline.addKnot(time, rpy, rpyRate);
 }
 
-bool TrajectoryGenerator::getMergePoints(std::vector<size_t>& mergePoints)
+std::shared_ptr<const TrajectorySnapshot> TrajectoryGenerator::getTrajectorySnapshot()
 {
-    if(!isTrajectoryComputed())
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_generatorState != GeneratorState::Returned)
     {
-        yError() << "[getMergePoints] No trajectories are available";
-        return false;
+        yError() << "[getTrajectorySnapshot] No trajectories are available";
+        return nullptr;
     }
 
-    m_trajectoryGenerator.getMergePoints(mergePoints);
-    return true;
+    return m_publishedSnapshot;
 }
 
 bool TrajectoryGenerator::getWeightPercentage(std::vector<double> &weightInLeft,
                                               std::vector<double> &weightInRight)
 {
-    if(!isTrajectoryComputed())
+    // the generators are used by the planner thread, the published snapshot is read instead
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_generatorState != GeneratorState::Returned || m_publishedSnapshot == nullptr)
     {
         yError() << "[getWeightPercentage] No trajectories are available";
         return false;
     }
 
-    m_dcmGenerator->getWeightPercentage(weightInLeft, weightInRight);
+    weightInLeft = m_publishedSnapshot->weightInLeft;
+    weightInRight = m_publishedSnapshot->weightInRight;
     return true;
 }
 
 void TrajectoryGenerator::reset()
 {
-    // the mutex is automatically released when lock_guard goes out of its scope
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // the precomputed trajectories are discarded. Wait until the planner is not evaluating
+    // any candidate since it will be used to generate the first trajectory
+    clearSpeculativeCandidates();
+    m_isLastGoalValid = false;
+    m_conditionVariable.wait(lock, [&]{return !m_isSpeculating;});
 
     // change the state of the generator
     m_generatorState = GeneratorState::FirstStep;
 }
 
-bool TrajectoryGenerator::getIsStancePhase(std::vector<bool>& isStancePhase)
+void TrajectoryGenerator::evaluateIsStancePhase(const std::vector<iDynTree::Vector2>& DCMVelocityTrajectory,
+                                                std::vector<bool>& isStancePhase) const
 {
-    if(!isTrajectoryComputed())
-    {
-        yError() << "[getDCMVelocityTrajectory] No trajectories are available";
-        return false;
-    }
-
-    const auto & DCMVelocityTrajectory = m_dcmGenerator->getDCMVelocity();
     isStancePhase.resize(DCMVelocityTrajectory.size());
 
     double threshold = 0.001;
@@ -677,6 +1059,122 @@ bool TrajectoryGenerator::getIsStancePhase(std::vector<bool>& isStancePhase)
                 isStancePhase[i] = false;
         }
     }
+}
 
-    return true;
+void TrajectorySnapshot::getDCMPosition(std::size_t index, iDynTree::Vector2& DCMPosition) const
+{
+    if(isDense)
+    {
+        DCMPosition = dense.DCMPosition[index];
+        return;
+    }
+
+    StdUtilities::HermiteSpline<2>::Point value, derivative;
+    DCM.evaluate(index * dT, value, derivative);
+    DCMPosition(0) = value[0];
+    DCMPosition(1) = value[1];
+}
+
+void TrajectorySnapshot::getDCMVelocity(std::size_t index, iDynTree::Vector2& DCMVelocity) const
+{
+    if(isDense)
+    {
+        DCMVelocity = dense.DCMVelocity[index];
+        return;
+    }
+
+    StdUtilities::HermiteSpline<2>::Point value, derivative;
+    DCM.evaluate(index * dT, value, derivative);
+    DCMVelocity(0) = derivative[0];
+    DCMVelocity(1) = derivative[1];
+}
+
+void TrajectorySnapshot::getLeftFootTransform(std::size_t index, iDynTree::Transform& transform) const
+{
+    if(isDense)
+        transform = dense.leftFootTrajectory[index];
+    else
+        evaluateFootTransform(leftFootPosition, leftFootRPY, index * dT, transform);
+}
+
+void TrajectorySnapshot::getRightFootTransform(std::size_t index, iDynTree::Transform& transform) const
+{
+    if(isDense)
+        transform = dense.rightFootTrajectory[index];
+    else
+        evaluateFootTransform(rightFootPosition, rightFootRPY, index * dT, transform);
+}
+
+void TrajectorySnapshot::getLeftFootTwist(std::size_t index, iDynTree::Twist& twist) const
+{
+    if(isDense)
+        twist = dense.leftFootTwist[index];
+    else
+        evaluateFootTwist(leftFootPosition, leftFootRPY, index * dT, twist);
+}
+
+void TrajectorySnapshot::getRightFootTwist(std::size_t index, iDynTree::Twist& twist) const
+{
+    if(isDense)
+        twist = dense.rightFootTwist[index];
+    else
+        evaluateFootTwist(rightFootPosition, rightFootRPY, index * dT, twist);
+}
+
+void TrajectorySnapshot::getCoMHeight(std::size_t index, double& CoMHeight) const
+{
+    if(isDense)
+    {
+        CoMHeight = dense.CoMHeightTrajectory[index];
+        return;
+    }
+
+    StdUtilities::HermiteSpline<1>::Point value, derivative;
+    this->CoMHeight.evaluate(index * dT, value, derivative);
+    CoMHeight = value[0];
+}
+
+void TrajectorySnapshot::getCoMHeightVelocity(std::size_t index, double& CoMHeightVelocity) const
+{
+    if(isDense)
+    {
+        CoMHeightVelocity = dense.CoMHeightVelocity[index];
+        return;
+    }
+
+    StdUtilities::HermiteSpline<1>::Point value, derivative;
+    CoMHeight.evaluate(index * dT, value, derivative);
+    CoMHeightVelocity = derivative[0];
+}
+
+void TrajectorySnapshot::evaluateFootTransform(const StdUtilities::HermiteSpline<3>& positionSpline,
+                                               const StdUtilities::HermiteSpline<3>& rpySpline,
+                                               double time, iDynTree::Transform& transform)
+{
+    StdUtilities::HermiteSpline<3>::Point position, rpy, derivative;
+    positionSpline.evaluate(time, position, derivative);
+    rpySpline.evaluate(time, rpy, derivative);
+
+    transform.setPosition(iDynTree::Position(position[0], position[1], position[2]));
+    transform.setRotation(iDynTree::Rotation::RPY(rpy[0], rpy[1], rpy[2]));
+}
+
+void TrajectorySnapshot::evaluateFootTwist(const StdUtilities::HermiteSpline<3>& positionSpline,
+                                           const StdUtilities::HermiteSpline<3>& rpySpline,
+                                           double time, iDynTree::Twist& twist)
+{
+    StdUtilities::HermiteSpline<3>::Point value, linearVelocity, rpy, rpyRate;
+    positionSpline.evaluate(time, value, linearVelocity);
+    rpySpline.evaluate(time, rpy, rpyRate);
+
+    for(std::size_t i = 0; i < 3; i++)
+        twist.getLinearVec3()(i) = linearVelocity[i];
+
+    // map between the derivative of the RPY angles and the angular velocity
+    double sinYaw = std::sin(rpy[2]);
+    double cosYaw = std::cos(rpy[2]);
+    double cosPitch = std::cos(rpy[1]);
+    twist.getAngularVec3()(0) = cosYaw * cosPitch * rpyRate[0] - sinYaw * rpyRate[1];
+    twist.getAngularVec3()(1) = sinYaw * cosPitch * rpyRate[0] + cosYaw * rpyRate[1];
+    twist.getAngularVec3()(2) = -std::sin(rpy[1]) * rpyRate[0] + rpyRate[2];
 }
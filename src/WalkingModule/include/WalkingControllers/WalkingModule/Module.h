@@ -38,6 +38,9 @@
 #include <WalkingControllers/WholeBodyControllers/QPInverseKinematics.h>
 #include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_osqp.h>
 #include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_qpOASES.h>
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_activeSet.h>
+#include <WalkingControllers/StdUtilities/RingBuffer.h>
+#include <WalkingControllers/StdUtilities/SampledTrajectory.h>
 
 #include <WalkingControllers/KinDynWrapper/Wrapper.h>
 
@@ -69,7 +72,7 @@ namespace WalkingControllers
 
         bool m_useMPC; /**< True if the MPC controller is used. */
         bool m_useQPIK; /**< True if the QP-IK is used. */
-        bool m_useOSQP; /**< True if osqp is used to QP-IK problem. */
+        std::string m_QPIKSolverType; /**< Solver used for the QP-IK problem (osqp, qpOASES or active_set). */
         bool m_dumpData; /**< True if data are saved. */
 
         std::unique_ptr<RobotInterface> m_robotControlHelper; /**< Robot control helper. */
@@ -79,7 +82,8 @@ namespace WalkingControllers
         std::unique_ptr<WalkingZMPController> m_walkingZMPController; /**< Pointer to the walking ZMP controller object. */
         std::unique_ptr<WalkingIK> m_IKSolver; /**< Pointer to the inverse kinematics solver. */
         std::unique_ptr<WalkingQPIK> m_QPIKSolver; /**< Pointer to the inverse kinematics solver. */
-        std::unique_ptr<WalkingFK> m_FKSolver; /**< Pointer to the forward kinematics solver. */
+        std::unique_ptr<WalkingFK> m_FKSolver; /**< Pointer to the forward kinematics solver (measured state). */
+        std::unique_ptr<WalkingFK> m_desiredFKSolver; /**< Pointer to the forward kinematics solver used by the QP-IK (desired state). */
         std::unique_ptr<StableDCMModel> m_stableDCMModel; /**< Pointer to the stable DCM dynamics. */
         std::unique_ptr<WalkingPIDHandler> m_PIDHandler; /**< Pointer to the PID handler object. */
         std::unique_ptr<RetargetingClient> m_retargetingClient; /**< Pointer to the stable DCM dynamics. */
@@ -90,24 +94,28 @@ namespace WalkingControllers
         double m_desiredJointsWeight; /**< Desired joint weight matrix. */
         yarp::sig::Vector m_desiredJointInRadYarp; /**< Desired joint position (regularization task). */
 
-        std::deque<iDynTree::Transform> m_leftTrajectory; /**< Deque containing the trajectory of the left foot. */
-        std::deque<iDynTree::Transform> m_rightTrajectory; /**< Deque containing the trajectory of the right foot. */
+        StdUtilities::SampledTrajectory<iDynTree::Transform> m_leftTrajectory; /**< Trajectory of the left foot (sampled on demand). */
+        StdUtilities::SampledTrajectory<iDynTree::Transform> m_rightTrajectory; /**< Trajectory of the right foot (sampled on demand). */
 
-        std::deque<iDynTree::Twist> m_leftTwistTrajectory; /**< Deque containing the twist trajectory of the left foot. */
-        std::deque<iDynTree::Twist> m_rightTwistTrajectory; /**< Deque containing the twist trajectory of the right foot. */
+        StdUtilities::SampledTrajectory<iDynTree::Twist> m_leftTwistTrajectory; /**< Twist trajectory of the left foot (sampled on demand). */
+        StdUtilities::SampledTrajectory<iDynTree::Twist> m_rightTwistTrajectory; /**< Twist trajectory of the right foot (sampled on demand). */
 
-        std::deque<iDynTree::Vector2> m_DCMPositionDesired; /**< Deque containing the desired DCM position. */
-        std::deque<iDynTree::Vector2> m_DCMVelocityDesired; /**< Deque containing the desired DCM velocity. */
-        std::deque<bool> m_leftInContact; /**< Deque containing the left foot state. */
-        std::deque<bool> m_rightInContact; /**< Deque containing the right foot state. */
-        std::deque<double> m_comHeightTrajectory; /**< Deque containing the CoM height trajectory. */
-        std::deque<double> m_comHeightVelocity; /**< Deque containing the CoM height velocity. */
+        StdUtilities::SampledTrajectory<iDynTree::Vector2> m_DCMPositionDesired; /**< Desired DCM position trajectory (sampled on demand). */
+        StdUtilities::SampledTrajectory<iDynTree::Vector2> m_DCMVelocityDesired; /**< Desired DCM velocity trajectory (sampled on demand). */
+        StdUtilities::SampledTrajectory<double> m_comHeightTrajectory; /**< CoM height trajectory (sampled on demand). */
+        StdUtilities::SampledTrajectory<double> m_comHeightVelocity; /**< CoM height velocity trajectory (sampled on demand). */
         std::deque<size_t> m_mergePoints; /**< Deque containing the time position of the merge points. */
-        std::deque<bool> m_isStancePhase; /**< if true the robot is not walking */
 
-        std::deque<bool> m_isLeftFixedFrame; /**< Deque containing when the main frame of the left foot is the fixed frame
-                                                In general a main frame of a foot is the fix frame only during the
-                                                stance and the switch out phases. */
+        /**
+         * Fields of the phases buffer.
+         * - LeftInContact: state of the left foot;
+         * - RightInContact: state of the right foot;
+         * - IsStancePhase: if true the robot is not walking;
+         * - IsLeftFixedFrame: true when the main frame of the left foot is the fixed frame. In general
+         *   a main frame of a foot is the fix frame only during the stance and the switch out phases.
+         */
+        enum PhaseField : std::size_t {LeftInContact, RightInContact, IsStancePhase, IsLeftFixedFrame};
+        StdUtilities::RingBuffer<bool, bool, bool, bool> m_phases; /**< Buffer containing the phases (see PhaseField). */
 
 
         iDynTree::ModelLoader m_loader; /**< Model loader class. */
@@ -122,6 +130,11 @@ namespace WalkingControllers
 
         bool m_newTrajectoryRequired; /**< if true a new trajectory will be merged soon. (after m_newTrajectoryMergeCounter - 2 cycles). */
         size_t m_newTrajectoryMergeCounter; /**< The new trajectory will be merged after m_newTrajectoryMergeCounter - 2 cycles. */
+        size_t m_newTrajectoryAskCounter; /**< The new trajectory is asked when m_newTrajectoryMergeCounter is equal to this value. */
+        size_t m_defaultNewTrajectoryAskCounter; /**< Value of m_newTrajectoryAskCounter used until the latency of the planner is measured. */
+        double m_plannerLatencyPercentile; /**< Percentile of the planner latency used to evaluate m_newTrajectoryAskCounter. */
+        bool m_isTrajectoryTruncated; /**< True if the robot is still walking at the end of the current trajectory. */
+        bool m_isTrajectoryExtensionRequired; /**< True if the new trajectory is the extension of the truncated one. */
 
         std::mutex m_mutex; /**< Mutex. */
 
@@ -213,6 +226,13 @@ namespace WalkingControllers
          */
         bool updateTrajectories(const size_t& mergePoint);
 
+        /**
+         * Evaluate when a new trajectory has to be asked. The planner latency at the chosen
+         * percentile is considered so that the trajectory is available when it has to be merged.
+         * @return the value of m_newTrajectoryMergeCounter at which the new trajectory is asked.
+         */
+        size_t evaluateNewTrajectoryAskCounter();
+
         /**
          * Set the input of the planner. The desired position is expressed using a
          * reference frame attached to the robot. The X axis points forward while the
@@ -7,6 +7,8 @@
  */
 
 // std
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <memory>
 
@@ -26,7 +28,6 @@
 
 #include <WalkingControllers/WalkingModule/Module.h>
 #include <WalkingControllers/YarpUtilities/Helper.h>
-#include <WalkingControllers/StdUtilities/Helper.h>
 
 using namespace WalkingControllers;
 
@@ -41,8 +42,7 @@ bool WalkingModule::advanceReferenceSignals()
     // check if vector is not initialized
     if(m_leftTrajectory.empty()
        || m_rightTrajectory.empty()
-       || m_leftInContact.empty()
-       || m_rightInContact.empty()
+       || m_phases.empty()
        || m_DCMPositionDesired.empty()
        || m_DCMVelocityDesired.empty()
        || m_comHeightTrajectory.empty())
@@ -51,41 +51,20 @@ bool WalkingModule::advanceReferenceSignals()
         return false;
     }
 
-    m_rightTrajectory.pop_front();
-    m_rightTrajectory.push_back(m_rightTrajectory.back());
+    // the buffers are advanced in O(1) without allocating memory
+    m_rightTrajectory.advance();
+    m_leftTrajectory.advance();
 
-    m_leftTrajectory.pop_front();
-    m_leftTrajectory.push_back(m_leftTrajectory.back());
+    m_rightTwistTrajectory.advance();
+    m_leftTwistTrajectory.advance();
 
-    m_rightTwistTrajectory.pop_front();
-    m_rightTwistTrajectory.push_back(m_rightTwistTrajectory.back());
+    m_phases.advance();
 
-    m_leftTwistTrajectory.pop_front();
-    m_leftTwistTrajectory.push_back(m_leftTwistTrajectory.back());
+    m_DCMPositionDesired.advance();
+    m_DCMVelocityDesired.advance();
 
-    m_rightInContact.pop_front();
-    m_rightInContact.push_back(m_rightInContact.back());
-
-    m_leftInContact.pop_front();
-    m_leftInContact.push_back(m_leftInContact.back());
-
-    m_isLeftFixedFrame.pop_front();
-    m_isLeftFixedFrame.push_back(m_isLeftFixedFrame.back());
-
-    m_DCMPositionDesired.pop_front();
-    m_DCMPositionDesired.push_back(m_DCMPositionDesired.back());
-
-    m_DCMVelocityDesired.pop_front();
-    m_DCMVelocityDesired.push_back(m_DCMVelocityDesired.back());
-
-    m_comHeightTrajectory.pop_front();
-    m_comHeightTrajectory.push_back(m_comHeightTrajectory.back());
-
-    m_comHeightVelocity.pop_front();
-    m_comHeightVelocity.push_back(m_comHeightVelocity.back());
-
-    m_isStancePhase.pop_front();
-    m_isStancePhase.push_back(m_isStancePhase.back());
+    m_comHeightTrajectory.advance();
+    m_comHeightVelocity.advance();
 
     // at each sampling time the merge points are decreased by one.
     // If the first merge point is equal to 0 it will be dropped.
@@ -130,11 +109,16 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     // module name (used as prefix for opened ports)
     m_useMPC = rf.check("use_mpc", yarp::os::Value(false)).asBool();
     m_useQPIK = rf.check("use_QP-IK", yarp::os::Value(false)).asBool();
-    m_useOSQP = rf.check("use_osqp", yarp::os::Value(false)).asBool();
+    // use_osqp is kept for backward compatibility
+    bool useOSQP = rf.check("use_osqp", yarp::os::Value(false)).asBool();
+    m_QPIKSolverType = rf.check("qp_solver", yarp::os::Value(useOSQP ? "osqp" : "qpOASES")).asString();
     m_dumpData = rf.check("dump_data", yarp::os::Value(false)).asBool();
 
     yarp::os::Bottle& generalOptions = rf.findGroup("GENERAL");
     m_dT = generalOptions.check("sampling_time", yarp::os::Value(0.016)).asDouble();
+    m_plannerLatencyPercentile = generalOptions.check("planner_latency_percentile", yarp::os::Value(0.95)).asDouble();
+    double defaultMergeLeadTime = generalOptions.check("default_merge_lead_time", yarp::os::Value(0.2)).asDouble();
+    m_defaultNewTrajectoryAskCounter = (size_t) std::round(defaultMergeLeadTime / m_dT);
     std::string name;
     if(!YarpUtilities::getStringFromSearchable(generalOptions, "name", name))
     {
@@ -241,10 +225,18 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     {
         yarp::os::Bottle& inverseKinematicsQPSolverOptions = rf.findGroup("INVERSE_KINEMATICS_QP_SOLVER");
         inverseKinematicsQPSolverOptions.append(generalOptions);
-        if(m_useOSQP)
+        if(m_QPIKSolverType == "osqp")
             m_QPIKSolver = std::make_unique<WalkingQPIK_osqp>();
-        else
+        else if(m_QPIKSolverType == "qpOASES")
             m_QPIKSolver = std::make_unique<WalkingQPIK_qpOASES>();
+        else if(m_QPIKSolverType == "active_set")
+            m_QPIKSolver = std::make_unique<WalkingQPIK_activeSet>();
+        else
+        {
+            yError() << "[WalkingModule::configure] The qp_solver " << m_QPIKSolverType << " is not supported. "
+                     << "Please use osqp, qpOASES or active_set.";
+            return false;
+        }
 
         if(!m_QPIKSolver->initialize(inverseKinematicsQPSolverOptions,
                                      m_robotControlHelper->getActuatedDoFs(),
@@ -252,7 +244,7 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
                                      m_robotControlHelper->getPositionUpperLimits(),
                                      m_robotControlHelper->getPositionLowerLimits()))
         {
-            yError() << "[WalkingModule::configure] Failed to configure the QP-IK solver (qpOASES)";
+            yError() << "[WalkingModule::configure] Failed to configure the QP-IK solver (" << m_QPIKSolverType << ")";
             return false;
         }
     }
@@ -267,6 +259,18 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
+    // the QP-IK is solved using the desired state of the robot. A different kinematic context is
+    // used so the quantities evaluated with the measured state are not invalidated
+    if(m_useQPIK)
+    {
+        m_desiredFKSolver = std::make_unique<WalkingFK>();
+        if(!m_desiredFKSolver->initialize(forwardKinematicsSolverOptions, m_loader.model()))
+        {
+            yError() << "[WalkingModule::configure] Failed to configure the fk solver related to the desired state";
+            return false;
+        }
+    }
+
     // initialize the linear inverted pendulum model
     m_stableDCMModel = std::make_unique<StableDCMModel>();
     if(!m_stableDCMModel->initialize(generalOptions))
@@ -313,10 +317,20 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
 
     m_profiler->addTimer("IK");
     m_profiler->addTimer("Total");
+    m_profiler->addCounter("FK cache hits");
+    m_profiler->addCounter("FK cache misses");
+    if(m_useQPIK)
+    {
+        m_profiler->addCounter("desired FK cache hits");
+        m_profiler->addCounter("desired FK cache misses");
+    }
 
     // initialize some variables
     m_newTrajectoryRequired = false;
     m_newTrajectoryMergeCounter = -1;
+    m_newTrajectoryAskCounter = m_defaultNewTrajectoryAskCounter;
+    m_isTrajectoryTruncated = false;
+    m_isTrajectoryExtensionRequired = false;
     m_robotState = WalkingFSM::Configured;
 
     m_inertial_R_worldFrame = iDynTree::Rotation::Identity();
@@ -370,6 +384,7 @@ bool WalkingModule::close()
     m_IKSolver.reset(nullptr);
     m_QPIKSolver.reset(nullptr);
     m_FKSolver.reset(nullptr);
+    m_desiredFKSolver.reset(nullptr);
     m_stableDCMModel.reset(nullptr);
 
     return true;
@@ -381,8 +396,9 @@ bool WalkingModule::solveQPIK(const std::unique_ptr<WalkingQPIK>& solver, const
                               iDynTree::VectorDynSize &output)
 {
     bool ok = true;
-    solver->setPhase(m_isStancePhase.front());
-    ok &= solver->setRobotState(*m_FKSolver);
+    solver->setPhase(m_phases.front<IsStancePhase>());
+    solver->setStanceFoot(m_phases.front<IsLeftFixedFrame>());
+    ok &= solver->setRobotState(*m_desiredFKSolver);
     solver->setDesiredNeckOrientation(desiredNeckOrientation.inverse());
 
     solver->setDesiredFeetTransformation(m_leftTrajectory.front(),
@@ -395,33 +411,13 @@ bool WalkingModule::solveQPIK(const std::unique_ptr<WalkingQPIK>& solver, const
     solver->setDesiredCoMPosition(desiredCoMPosition);
 
     // TODO probably the problem can be written locally w.r.t. the root or the base
-    solver->setDesiredHandsTransformation(m_FKSolver->getHeadToWorldTransform() * m_retargetingClient->leftHandTransform(),
-                                          m_FKSolver->getHeadToWorldTransform() * m_retargetingClient->rightHandTransform());
+    solver->setDesiredHandsTransformation(m_desiredFKSolver->getHeadToWorldTransform() * m_retargetingClient->leftHandTransform(),
+                                          m_desiredFKSolver->getHeadToWorldTransform() * m_retargetingClient->rightHandTransform());
 
     ok &= solver->setDesiredRetargetingJoint(m_retargetingClient->jointValues());
 
-    // set jacobians
-    iDynTree::MatrixDynSize jacobian, comJacobian;
-    jacobian.resize(6, m_robotControlHelper->getActuatedDoFs() + 6);
-    comJacobian.resize(3, m_robotControlHelper->getActuatedDoFs() + 6);
-
-    ok &= m_FKSolver->getLeftFootJacobian(jacobian);
-    ok &= solver->setLeftFootJacobian(jacobian);
-
-    ok &= m_FKSolver->getRightFootJacobian(jacobian);
-    ok &= solver->setRightFootJacobian(jacobian);
-
-    ok &= m_FKSolver->getNeckJacobian(jacobian);
-    ok &= solver->setNeckJacobian(jacobian);
-
-    ok &= m_FKSolver->getCoMJacobian(comJacobian);
-    solver->setCoMJacobian(comJacobian);
-
-    ok &= m_FKSolver->getLeftHandJacobian(jacobian);
-    ok &= solver->setLeftHandJacobian(jacobian);
-
-    ok &= m_FKSolver->getRightHandJacobian(jacobian);
-    ok &= solver->setRightHandJacobian(jacobian);
+    // set jacobians (evaluated directly in the solver matrices)
+    ok &= solver->setJacobians(*m_desiredFKSolver);
 
     if(!ok)
     {
@@ -447,7 +443,7 @@ bool WalkingModule::updateModule()
     if(m_robotState == WalkingFSM::Preparing)
     {
 
-        if(!m_robotControlHelper->getFeedbacksRaw(100))
+        if(!m_robotControlHelper->getFeedbacksRaw())
             {
                 yError() << "[updateModule] Unable to get the feedback.";
                 return false;
@@ -492,7 +488,7 @@ bool WalkingModule::updateModule()
             m_stableDCMModel->reset(m_DCMPositionDesired.front());
 
             // reset the retargeting
-            if(!m_robotControlHelper->getFeedbacks(100))
+            if(!m_robotControlHelper->getFeedbacks())
             {
                 yError() << "[WalkingModule::updateModule] Unable to get the feedback.";
                 return false;
@@ -535,23 +531,61 @@ bool WalkingModule::updateModule()
                 return false;
             }
 
+        // the trajectory has been evaluated only on a window shorter than the planner horizon,
+        // it is extended at its last merge point
+        if(!m_newTrajectoryRequired && m_isTrajectoryTruncated && !m_mergePoints.empty())
+        {
+            m_newTrajectoryAskCounter = evaluateNewTrajectoryAskCounter();
+            if(m_mergePoints.back() > m_newTrajectoryAskCounter)
+            {
+                m_newTrajectoryMergeCounter = m_mergePoints.back();
+                m_newTrajectoryRequired = true;
+                m_isTrajectoryExtensionRequired = true;
+            }
+        }
+
         // if a new trajectory is required check if its the time to evaluate the new trajectory or
         // the time to attach new one
         if(m_newTrajectoryRequired)
         {
+            // before asking for the new trajectory the planner can precompute it
+            if(!m_isTrajectoryExtensionRequired
+               && m_newTrajectoryMergeCounter > m_newTrajectoryAskCounter
+               && m_newTrajectoryMergeCounter < m_DCMPositionDesired.size())
+            {
+                double initTimeTrajectory;
+                initTimeTrajectory = m_time + m_newTrajectoryMergeCounter * m_dT;
+
+                // the stance foot is the one that will be fixed when the trajectory is asked
+                bool isLeftFixedFrame = m_phases.get<IsLeftFixedFrame>(m_newTrajectoryMergeCounter - m_newTrajectoryAskCounter);
+                iDynTree::Transform measuredTransform = isLeftFixedFrame ?
+                    m_rightTrajectory[m_newTrajectoryMergeCounter] :
+                    m_leftTrajectory[m_newTrajectoryMergeCounter];
+
+                if(!m_trajectoryGenerator->speculateTrajectories(m_time, initTimeTrajectory,
+                                                                 m_DCMPositionDesired[m_newTrajectoryMergeCounter],
+                                                                 m_DCMVelocityDesired[m_newTrajectoryMergeCounter],
+                                                                 !isLeftFixedFrame, measuredTransform,
+                                                                 m_desiredPosition))
+                {
+                    yError() << "[WalkingModule::updateModule] Unable to precompute the new trajectory.";
+                    return false;
+                }
+            }
+
             // when we are near to the merge point the new trajectory is evaluated
-            if(m_newTrajectoryMergeCounter == 20)
+            if(m_newTrajectoryMergeCounter == m_newTrajectoryAskCounter)
             {
 
                 double initTimeTrajectory;
                 initTimeTrajectory = m_time + m_newTrajectoryMergeCounter * m_dT;
 
-                iDynTree::Transform measuredTransform = m_isLeftFixedFrame.front() ?
+                iDynTree::Transform measuredTransform = m_phases.front<IsLeftFixedFrame>() ?
                     m_rightTrajectory[m_newTrajectoryMergeCounter] :
                     m_leftTrajectory[m_newTrajectoryMergeCounter];
 
                 // ask for a new trajectory
-                if(!askNewTrajectories(initTimeTrajectory, !m_isLeftFixedFrame.front(),
+                if(!askNewTrajectories(initTimeTrajectory, !m_phases.front<IsLeftFixedFrame>(),
                                        measuredTransform, m_newTrajectoryMergeCounter,
                                        m_desiredPosition))
                 {
@@ -568,6 +602,7 @@ bool WalkingModule::updateModule()
                     return false;
                 }
                 m_newTrajectoryRequired = false;
+                m_isTrajectoryExtensionRequired = false;
                 resetTrajectory = true;
             }
 
@@ -576,7 +611,7 @@ bool WalkingModule::updateModule()
 
         if (m_robotControlHelper->getPIDHandler().usingGainScheduling())
         {
-            if (!m_robotControlHelper->getPIDHandler().updatePhases(m_leftInContact, m_rightInContact, m_time))
+            if (!m_robotControlHelper->getPIDHandler().updatePhases(m_phases.view<LeftInContact>(), m_phases.view<RightInContact>(), m_time))
             {
                 yError() << "[WalkingModule::updateModule] Unable to get the update PID.";
                 return false;
@@ -584,7 +619,7 @@ bool WalkingModule::updateModule()
         }
 
         // get feedbacks and evaluate useful quantities
-        if(!m_robotControlHelper->getFeedbacks(100))
+        if(!m_robotControlHelper->getFeedbacks())
         {
             yError() << "[WalkingModule::updateModule] Unable to get the feedback.";
             return false;
@@ -593,7 +628,7 @@ bool WalkingModule::updateModule()
         // if the retargeting is not in the approaching phase we can set the stance/walking phase
         if(!m_retargetingClient->isApproachingPhase())
         {
-            auto retargetingPhase = m_isStancePhase.front() ? RetargetingClient::Phase::stance : RetargetingClient::Phase::walking;
+            auto retargetingPhase = m_phases.front<IsStancePhase>() ? RetargetingClient::Phase::stance : RetargetingClient::Phase::walking;
             m_retargetingClient->setPhase(retargetingPhase);
         }
 
@@ -624,8 +659,9 @@ bool WalkingModule::updateModule()
         {
             // Model predictive controller
             m_profiler->setInitTime("MPC");
-            if(!m_walkingController->setConvexHullConstraint(m_leftTrajectory, m_rightTrajectory,
-                                                             m_leftInContact, m_rightInContact))
+            // the trajectories are sampled only in the portion used by the controller
+            if(!m_walkingController->setConvexHullConstraint(m_leftTrajectory.view(1), m_rightTrajectory.view(1),
+                                                             m_phases.view<LeftInContact>(), m_phases.view<RightInContact>()))
             {
                 yError() << "[WalkingModule::updateModule] unable to evaluate the convex hull.";
                 return false;
@@ -637,7 +673,8 @@ bool WalkingModule::updateModule()
                 return false;
             }
 
-            if(!m_walkingController->setReferenceSignal(m_DCMPositionDesired, resetTrajectory))
+            if(!m_walkingController->setReferenceSignal(m_DCMPositionDesired.view(m_walkingController->getControllerHorizon() + 1),
+                                                        resetTrajectory))
             {
                 yError() << "[WalkingModule::updateModule] unable to set the reference Signal.";
                 return false;
@@ -667,7 +704,7 @@ bool WalkingModule::updateModule()
         // inner COM-ZMP controller
         // if the the norm of desired DCM velocity is lower than a threshold then the robot
         // is stopped
-        m_walkingZMPController->setPhase(m_isStancePhase.front());
+        m_walkingZMPController->setPhase(m_phases.front<IsStancePhase>());
 
         iDynTree::Vector2 desiredZMP;
         if(m_useMPC)
@@ -726,7 +763,8 @@ bool WalkingModule::updateModule()
             yarp::sig::Vector bufferVelocity(m_robotControlHelper->getActuatedDoFs());
             yarp::sig::Vector bufferPosition(m_robotControlHelper->getActuatedDoFs());
 
-            if(!m_FKSolver->setInternalRobotState(m_qDesired, m_dqDesired))
+            // the measured state stored in m_FKSolver is not modified
+            if(!m_desiredFKSolver->setInternalRobotState(m_qDesired, m_dqDesired))
             {
                 yError() << "[WalkingModule::updateModule] Unable to set the internal robot state.";
                 return false;
@@ -744,14 +782,6 @@ bool WalkingModule::updateModule()
 
             bufferPosition = m_velocityIntegral->integrate(bufferVelocity);
             iDynTree::toiDynTree(bufferPosition, m_qDesired);
-
-            if(!m_FKSolver->setInternalRobotState(m_robotControlHelper->getJointPosition(),
-                                                  m_robotControlHelper->getJointVelocity()))
-            {
-                yError() << "[WalkingModule::updateModule] Unable to set the internal robot state.";
-                return false;
-            }
-
         }
         else
         {
@@ -769,8 +799,8 @@ bool WalkingModule::updateModule()
                     return false;
                 }
 
-                if(!m_IKSolver->computeIK(m_leftTrajectory.front(), m_rightTrajectory.front(),
-                                          desiredCoMPosition, m_qDesired))
+                if(!m_IKSolver->computeIKOnline(m_leftTrajectory.front(), m_rightTrajectory.front(),
+                                                desiredCoMPosition, m_qDesired))
                 {
                     yError() << "[WalkingModule::updateModule] Error during the inverse Kinematics iteration.";
                     return false;
@@ -787,6 +817,17 @@ bool WalkingModule::updateModule()
 
         m_profiler->setEndTime("Total");
 
+        // quantities read from the cache of the forward kinematics during the cycle
+        m_profiler->increaseCounter("FK cache hits", m_FKSolver->getCacheHits());
+        m_profiler->increaseCounter("FK cache misses", m_FKSolver->getCacheMisses());
+        m_FKSolver->resetCacheCounters();
+        if(m_desiredFKSolver != nullptr)
+        {
+            m_profiler->increaseCounter("desired FK cache hits", m_desiredFKSolver->getCacheHits());
+            m_profiler->increaseCounter("desired FK cache misses", m_desiredFKSolver->getCacheMisses());
+            m_desiredFKSolver->resetCacheCounters();
+        }
+
         // print timings
         m_profiler->profiling();
 
@@ -808,6 +849,15 @@ bool WalkingModule::updateModule()
 
             auto leftFoot = m_FKSolver->getLeftFootToWorldTransform();
             auto rightFoot = m_FKSolver->getRightFootToWorldTransform();
+
+            // timing of the feedback signals
+            const SensorSnapshot& sensorSnapshot = m_robotControlHelper->getSensorSnapshot();
+            yarp::sig::Vector sensorAges(4);
+            sensorAges(0) = sensorSnapshot.encodersAge;
+            sensorAges(1) = sensorSnapshot.leftWrenchAge;
+            sensorAges(2) = sensorSnapshot.rightWrenchAge;
+            sensorAges(3) = sensorSnapshot.robotBaseAge;
+
             m_walkingLogger->sendData(m_FKSolver->getDCM(), m_DCMPositionDesired.front(), m_DCMVelocityDesired.front(),
                                       measuredZMP, desiredZMP, m_FKSolver->getCoMPosition(),
                                       m_stableDCMModel->getCoMPosition(), yarp::sig::Vector(1, m_retargetingClient->comHeight()),
@@ -817,7 +867,7 @@ bool WalkingModule::updateModule()
                                       m_leftTrajectory.front().getPosition(), m_leftTrajectory.front().getRotation().asRPY(),
                                       m_rightTrajectory.front().getPosition(), m_rightTrajectory.front().getRotation().asRPY(),
                                       m_robotControlHelper->getJointPosition(),
-                                      m_retargetingClient->jointValues());
+                                      m_retargetingClient->jointValues(), sensorAges);
         }
 
         // in the approaching phase the robot should not move and the trajectories should not advance
@@ -901,8 +951,8 @@ bool WalkingModule::prepareRobot(bool onTheFly)
 
     // get the current state of the robot
     // this is necessary because the trajectories for the joints, CoM height and neck orientation
-    // depend on the current state of the robot
-    if(!m_robotControlHelper->getFeedbacksRaw(100))
+    // depend on the current state of the robot. Here the module can wait for the sensors
+    if(!m_robotControlHelper->getFeedbacksRaw(0.1))
     {
         yError() << "[WalkingModule::prepareRobot] Unable to get the feedback.";
         return false;
@@ -985,8 +1035,8 @@ bool WalkingModule::prepareRobot(bool onTheFly)
         }
     }
 
-    if(!m_IKSolver->computeIK(m_leftTrajectory.front(), m_rightTrajectory.front(),
-                              desiredCoMPosition, m_qDesired))
+    if(!m_IKSolver->computeCachedIK(m_leftTrajectory.front(), m_rightTrajectory.front(),
+                                    desiredCoMPosition, m_qDesired))
     {
         yError() << "[WalkingModule::prepareRobot] Inverse Kinematics failed while computing the initial position.";
         return false;
@@ -1085,6 +1135,19 @@ bool WalkingModule::askNewTrajectories(const double& initTime, const bool& isLef
         return false;
     }
 
+    // the truncated trajectory is extended towards the last desired position
+    if(m_isTrajectoryExtensionRequired)
+    {
+        if(!m_trajectoryGenerator->extendTrajectories(initTime, m_DCMPositionDesired[mergePoint],
+                                                      m_DCMVelocityDesired[mergePoint], isLeftSwinging,
+                                                      measuredTransform))
+        {
+            yError() << "[WalkingModule::askNewTrajectories] Unable to extend the trajectory.";
+            return false;
+        }
+        return true;
+    }
+
     if(!m_trajectoryGenerator->updateTrajectories(initTime, m_DCMPositionDesired[mergePoint],
                                                   m_DCMVelocityDesired[mergePoint], isLeftSwinging,
                                                   measuredTransform, desiredPosition))
@@ -1103,59 +1166,83 @@ bool WalkingModule::updateTrajectories(const size_t& mergePoint)
         return false;
     }
 
-    std::vector<iDynTree::Transform> leftTrajectory;
-    std::vector<iDynTree::Transform> rightTrajectory;
-    std::vector<iDynTree::Twist> leftTwistTrajectory;
-    std::vector<iDynTree::Twist> rightTwistTrajectory;
-    std::vector<iDynTree::Vector2> DCMPositionDesired;
-    std::vector<iDynTree::Vector2> DCMVelocityDesired;
-    std::vector<bool> rightInContact;
-    std::vector<bool> leftInContact;
-    std::vector<double> comHeightTrajectory;
-    std::vector<double> comHeightVelocity;
-    std::vector<size_t> mergePoints;
-    std::vector<bool> isLeftFixedFrame;
-    std::vector<bool> isStancePhase;
-
-    // get dcm position and velocity
-    m_trajectoryGenerator->getDCMPositionTrajectory(DCMPositionDesired);
-    m_trajectoryGenerator->getDCMVelocityTrajectory(DCMVelocityDesired);
+    // the snapshot is shared with the planner thread, the trajectories are not copied out of the generator
+    std::shared_ptr<const TrajectorySnapshot> trajectory = m_trajectoryGenerator->getTrajectorySnapshot();
+    if(trajectory == nullptr)
+    {
+        yError() << "[updateTrajectories] Unable to get the trajectories.";
+        return false;
+    }
 
-    // get feet trajectories
-    m_trajectoryGenerator->getFeetTrajectories(leftTrajectory, rightTrajectory);
-    m_trajectoryGenerator->getFeetTwist(leftTwistTrajectory, rightTwistTrajectory);
-    m_trajectoryGenerator->getFeetStandingPeriods(leftInContact, rightInContact);
-    m_trajectoryGenerator->getWhenUseLeftAsFixed(isLeftFixedFrame);
+    // the continuous trajectories are sampled from the snapshot only when they are accessed,
+    // the snapshot is kept alive by the samplers
+    std::size_t size = trajectory->size;
+    if(!m_leftTrajectory.splice([trajectory](std::size_t index, iDynTree::Transform& transform)
+                                {trajectory->getLeftFootTransform(index, transform);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the left foot trajectory.";
+        return false;
+    }
 
-    // get com height trajectory
-    m_trajectoryGenerator->getCoMHeightTrajectory(comHeightTrajectory);
-    m_trajectoryGenerator->getCoMHeightVelocity(comHeightVelocity);
+    if(!m_rightTrajectory.splice([trajectory](std::size_t index, iDynTree::Transform& transform)
+                                 {trajectory->getRightFootTransform(index, transform);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the right foot trajectory.";
+        return false;
+    }
 
-    // get merge points
-    m_trajectoryGenerator->getMergePoints(mergePoints);
+    if(!m_leftTwistTrajectory.splice([trajectory](std::size_t index, iDynTree::Twist& twist)
+                                     {trajectory->getLeftFootTwist(index, twist);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the left foot twist trajectory.";
+        return false;
+    }
 
-    // get stance phase flags
-    m_trajectoryGenerator->getIsStancePhase(isStancePhase);
+    if(!m_rightTwistTrajectory.splice([trajectory](std::size_t index, iDynTree::Twist& twist)
+                                      {trajectory->getRightFootTwist(index, twist);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the right foot twist trajectory.";
+        return false;
+    }
 
-    // append vectors to deques
-    StdUtilities::appendVectorToDeque(leftTrajectory, m_leftTrajectory, mergePoint);
-    StdUtilities::appendVectorToDeque(rightTrajectory, m_rightTrajectory, mergePoint);
-    StdUtilities::appendVectorToDeque(leftTwistTrajectory, m_leftTwistTrajectory, mergePoint);
-    StdUtilities::appendVectorToDeque(rightTwistTrajectory, m_rightTwistTrajectory, mergePoint);
-    StdUtilities::appendVectorToDeque(isLeftFixedFrame, m_isLeftFixedFrame, mergePoint);
+    if(!m_DCMPositionDesired.splice([trajectory](std::size_t index, iDynTree::Vector2& position)
+                                    {trajectory->getDCMPosition(index, position);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the DCM position trajectory.";
+        return false;
+    }
 
-    StdUtilities::appendVectorToDeque(DCMPositionDesired, m_DCMPositionDesired, mergePoint);
-    StdUtilities::appendVectorToDeque(DCMVelocityDesired, m_DCMVelocityDesired, mergePoint);
+    if(!m_DCMVelocityDesired.splice([trajectory](std::size_t index, iDynTree::Vector2& velocity)
+                                    {trajectory->getDCMVelocity(index, velocity);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the DCM velocity trajectory.";
+        return false;
+    }
 
-    StdUtilities::appendVectorToDeque(leftInContact, m_leftInContact, mergePoint);
-    StdUtilities::appendVectorToDeque(rightInContact, m_rightInContact, mergePoint);
+    if(!m_comHeightTrajectory.splice([trajectory](std::size_t index, double& height)
+                                     {trajectory->getCoMHeight(index, height);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the CoM height trajectory.";
+        return false;
+    }
 
-    StdUtilities::appendVectorToDeque(comHeightTrajectory, m_comHeightTrajectory, mergePoint);
-    StdUtilities::appendVectorToDeque(comHeightVelocity, m_comHeightVelocity, mergePoint);
+    if(!m_comHeightVelocity.splice([trajectory](std::size_t index, double& velocity)
+                                   {trajectory->getCoMHeightVelocity(index, velocity);}, size, mergePoint))
+    {
+        yError() << "[updateTrajectories] Unable to merge the CoM height velocity trajectory.";
+        return false;
+    }
 
-    StdUtilities::appendVectorToDeque(isStancePhase, m_isStancePhase, mergePoint);
+    // the phases are stored in a single buffer, all the fields are spliced together
+    if(!m_phases.splice(mergePoint, trajectory->leftInContact, trajectory->rightInContact,
+                        trajectory->isStancePhase, trajectory->isLeftFixedFrame))
+    {
+        yError() << "[updateTrajectories] Unable to merge the contact phases.";
+        return false;
+    }
 
-    m_mergePoints.assign(mergePoints.begin(), mergePoints.end());
+    m_mergePoints.assign(trajectory->mergePoints.begin(), trajectory->mergePoints.end());
+    m_isTrajectoryTruncated = trajectory->isTruncated;
 
     // the first merge point is always equal to 0
     m_mergePoints.pop_front();
@@ -1165,21 +1252,30 @@ bool WalkingModule::updateTrajectories(const size_t& mergePoint)
 
 bool WalkingModule::updateFKSolver()
 {
-    if(!m_robotControlHelper->isExternalRobotBaseUsed())
+    auto evaluateWorldToBaseTransformation = [this](std::unique_ptr<WalkingFK>& solver) {
+        if(!m_robotControlHelper->isExternalRobotBaseUsed())
+            return solver->evaluateWorldToBaseTransformation(m_leftTrajectory.front(),
+                                                             m_rightTrajectory.front(),
+                                                             m_phases.front<IsLeftFixedFrame>());
+
+        solver->evaluateWorldToBaseTransformation(m_robotControlHelper->getBaseTransform(),
+                                                  m_robotControlHelper->getBaseTwist());
+        return true;
+    };
+
+    if(!evaluateWorldToBaseTransformation(m_FKSolver))
     {
-        if(!m_FKSolver->evaluateWorldToBaseTransformation(m_leftTrajectory.front(),
-                                                          m_rightTrajectory.front(),
-                                                          m_isLeftFixedFrame.front()))
-        {
-            yError() << "[WalkingModule::updateFKSolver] Unable to evaluate the world to base transformation.";
-            return false;
-        }
+        yError() << "[WalkingModule::updateFKSolver] Unable to evaluate the world to base transformation.";
+        return false;
     }
-    else
-    {
-        m_FKSolver->evaluateWorldToBaseTransformation(m_robotControlHelper->getBaseTransform(),
-                                                      m_robotControlHelper->getBaseTwist());
 
+    // the desired kinematic context shares the base of the measured one, its joint state
+    // is set before solving the QP-IK
+    if(m_desiredFKSolver != nullptr && !evaluateWorldToBaseTransformation(m_desiredFKSolver))
+    {
+        yError() << "[WalkingModule::updateFKSolver] Unable to evaluate the world to base transformation "
+                 << "of the desired kinematic context.";
+        return false;
     }
 
     if(!m_FKSolver->setInternalRobotState(m_robotControlHelper->getJointPosition(),
@@ -1231,7 +1327,8 @@ bool WalkingModule::startWalking()
                     "l_shoulder_pitch_des", "l_shoulder_roll_des", "l_shoulder_yaw_des", "l_elbow_des", "l_wrist_prosup_des",
                     "r_shoulder_pitch_des", "r_shoulder_roll_des", "r_shoulder_yaw_des", "r_elbow_des", "r_wrist_prosup_des",
                     "l_hip_pitch_des", "l_hip_roll_des", "l_hip_yaw_des", "l_knee_des", "l_ankle_pitch_des", "l_ankle_roll_des",
-                    "r_hip_pitch_des", "r_hip_roll_des", "r_hip_yaw_des", "r_knee_des", "r_ankle_pitch_des", "r_ankle_roll_des"});
+                    "r_hip_pitch_des", "r_hip_roll_des", "r_hip_yaw_des", "r_knee_des", "r_ankle_pitch_des", "r_ankle_roll_des",
+                    "encoders_age", "l_wrench_age", "r_wrench_age", "robot_base_age"});
     }
 
     // if the robot was only prepared the filters has to be reseted
@@ -1264,6 +1361,25 @@ bool WalkingModule::startWalking()
     return true;
 }
 
+size_t WalkingModule::evaluateNewTrajectoryAskCounter()
+{
+    // the latency is evaluated on the last solves of the planner and it is bounded by the
+    // maximum duration of a step
+    double latency;
+    if(!m_trajectoryGenerator->getPlannerLatency(m_plannerLatencyPercentile, latency))
+        return m_defaultNewTrajectoryAskCounter;
+
+    // the new trajectory is merged when the counter is equal to 2. One more cycle is
+    // considered since the trajectory is asked at the beginning of the cycle
+    size_t askCounter = 3 + (size_t) std::ceil(latency / m_dT);
+
+    // the new trajectory cannot be asked after the end of the current one
+    if(!m_DCMPositionDesired.empty())
+        askCounter = std::min(askCounter, m_DCMPositionDesired.size() - 1);
+
+    return askCounter;
+}
+
 bool WalkingModule::setPlannerInput(double x, double y)
 {
     // in the approaching phase the robot should not move
@@ -1272,10 +1388,21 @@ bool WalkingModule::setPlannerInput(double x, double y)
     if(m_retargetingClient->isApproachingPhase())
         return true;
 
+    // a pending extension of the trajectory is replaced by the new goal if it has not been asked yet
+    if(m_isTrajectoryExtensionRequired && m_newTrajectoryMergeCounter > m_newTrajectoryAskCounter)
+    {
+        m_newTrajectoryRequired = false;
+        m_isTrajectoryExtensionRequired = false;
+    }
+
+    // the time required by the planner is chosen for each new trajectory
+    if(!m_newTrajectoryRequired)
+        m_newTrajectoryAskCounter = evaluateNewTrajectoryAskCounter();
+
     // the trajectory was already finished the new trajectory will be attached as soon as possible
     if(m_mergePoints.empty())
     {
-        if(!(m_leftInContact.front() && m_rightInContact.front()))
+        if(!(m_phases.front<LeftInContact>() && m_phases.front<RightInContact>()))
         {
             yError() << "[WalkingModule::setPlannerInput] The trajectory has already finished but the system is not in double support.";
             return false;
@@ -1285,13 +1412,13 @@ bool WalkingModule::setPlannerInput(double x, double y)
             return true;
 
         // Since the evaluation of a new trajectory takes time the new trajectory will be merged after x cycles
-        m_newTrajectoryMergeCounter = 20;
+        m_newTrajectoryMergeCounter = m_newTrajectoryAskCounter;
     }
 
     // the trajectory was not finished the new trajectory will be attached at the next merge point
     else
     {
-        if(m_mergePoints.front() > 20)
+        if(m_mergePoints.front() > m_newTrajectoryAskCounter)
             m_newTrajectoryMergeCounter = m_mergePoints.front();
         else if(m_mergePoints.size() > 1)
         {
@@ -1305,7 +1432,7 @@ bool WalkingModule::setPlannerInput(double x, double y)
             if(m_newTrajectoryRequired)
                 return true;
 
-            m_newTrajectoryMergeCounter = 20;
+            m_newTrajectoryMergeCounter = m_newTrajectoryAskCounter;
         }
     }
 
@@ -0,0 +1,201 @@
+/**
+ * @file GoldfarbIdnaniSolver.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_WHOLE_BODY_CONTROLLERS_GOLDFARB_IDNANI_SOLVER_H
+#define WALKING_CONTROLLERS_WHOLE_BODY_CONTROLLERS_GOLDFARB_IDNANI_SOLVER_H
+
+// std
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+namespace WalkingControllers
+{
+
+    /**
+     * GoldfarbIdnaniSolver class. It solves small dense QP problems in the form
+     * \f[
+     * \min_x \frac{1}{2} x^\top H x + g^\top x \quad \text{s.t.} \quad A x = b, \quad l \le x \le u
+     * \f]
+     * The equality constraints are eliminated using a QR decomposition of \f$ A^\top \f$
+     * (\f$ x = x_0 + Z z \f$ where the columns of \f$ Z \f$ are a basis of the null space of \f$ A \f$),
+     * hence the hessian matrix has to be positive definite only in the null space of the equality
+     * constraints. The bounds are then handled by the dual active set method of Goldfarb and Idnani.
+     * The solver is hot started: the factorizations of the hessian and of the equality constraints
+     * are kept if the matrices do not change, and the method starts from the bounds active at the
+     * previous call if they are dual feasible for the new problem.
+     * All the matrices are allocated in the constructor.
+     */
+    class GoldfarbIdnaniSolver
+    {
+        int m_numberOfVariables; /**< Number of variables (n). */
+        int m_numberOfEqualityConstraints; /**< Number of equality constraints (m). */
+        int m_reducedNumberOfVariables; /**< Dimension of the null space of the equality constraints (n - m). */
+        int m_maximumNumberOfIterations; /**< Maximum number of active set changes. */
+        double m_tolerance; /**< Tolerance used to check the bounds. */
+
+        Eigen::HouseholderQR<Eigen::MatrixXd> m_equalityConstraintsQR; /**< QR decomposition of the transpose of the equality matrix. */
+        Eigen::MatrixXd m_orthogonalMatrix; /**< Q matrix of the QR decomposition ([Y Z]). */
+        Eigen::VectorXd m_householderWorkspace; /**< Workspace used to evaluate the Q matrix. */
+        Eigen::VectorXd m_particularSolution; /**< Solution of the equality constraints (x_0). */
+        Eigen::VectorXd m_equalityMultipliers; /**< Auxiliary vector used to evaluate the particular solution. */
+
+        Eigen::MatrixXd m_hessianTimesNullSpace; /**< Product between the hessian matrix and Z. */
+        Eigen::MatrixXd m_reducedHessian; /**< Hessian matrix in the null space (Z' H Z). */
+        Eigen::VectorXd m_reducedGradient; /**< Gradient in the null space. */
+        Eigen::VectorXd m_auxiliaryVector; /**< Auxiliary vector (n). */
+        Eigen::LLT<Eigen::MatrixXd> m_reducedHessianLLT; /**< Cholesky decomposition of the reduced hessian. */
+        Eigen::MatrixXd m_initialJ; /**< Matrix J when no bound is active (L^-T). */
+
+        Eigen::MatrixXd m_factorizedHessian; /**< Hessian matrix of the last factorization. */
+        Eigen::MatrixXd m_factorizedEqualityMatrix; /**< Equality matrix of the last factorization. */
+        bool m_isFactorizationValid; /**< True if the factorizations refer to m_factorizedHessian and m_factorizedEqualityMatrix. */
+
+        Eigen::MatrixXd m_J; /**< Matrix J of the Goldfarb-Idnani method (L^-T Q). */
+        Eigen::MatrixXd m_R; /**< Upper triangular matrix of the Goldfarb-Idnani method. */
+        double m_RNorm; /**< Norm of the R matrix used to detect linear dependent constraints. */
+        Eigen::VectorXd m_reducedSolution; /**< Solution in the null space (z). */
+        Eigen::VectorXd m_primalStep; /**< Step direction in the primal space. */
+        Eigen::VectorXd m_dualStep; /**< Step direction in the dual space. */
+        Eigen::VectorXd m_d; /**< Auxiliary vector (J' n). */
+        Eigen::VectorXd m_constraintNormal; /**< Normal of the constraint added to the active set. */
+        Eigen::VectorXd m_multipliers; /**< Lagrange multipliers of the active constraints. */
+
+        std::vector<int> m_activeSet; /**< Indices of the active bounds (2 i lower bound, 2 i + 1 upper bound of the i-th variable). */
+        int m_activeSetSize; /**< Number of active bounds. */
+        std::vector<bool> m_isActive; /**< True if the bound is active. */
+        std::vector<bool> m_wasActive; /**< True if the bound was active at the previous call. */
+        int m_numberOfIterations; /**< Number of active set changes of the last call. */
+
+        Eigen::VectorXd m_solution; /**< Solution of the optimization problem. */
+
+        /**
+         * Evaluate the slack of a bound (positive if the bound is satisfied).
+         * @param index index of the bound;
+         * @param lowerBound lower bounds of the variables;
+         * @param upperBound upper bounds of the variables.
+         * @return the slack.
+         */
+        double evaluateSlack(const int& index,
+                             const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                             const Eigen::Ref<const Eigen::VectorXd>& upperBound) const;
+
+        /**
+         * Evaluate the QR decomposition of the equality constraints, the null space and the
+         * Cholesky decomposition of the reduced hessian. Nothing is done if the matrices
+         * did not change since the last call.
+         * @param hessian hessian matrix (n x n);
+         * @param equalityMatrix matrix of the equality constraints (m x n).
+         * @return true/false in case of success/failure.
+         */
+        bool factorize(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                       const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix);
+
+        /**
+         * Add the bounds active at the previous call to the active set. The primal solution and
+         * the multipliers are evaluated considering these bounds as equalities. If the multipliers
+         * are not positive (the bounds are not active anymore) the active set is emptied.
+         * @param previousActiveSetSize number of bounds active at the previous call;
+         * @param lowerBound lower bounds of the variables;
+         * @param upperBound upper bounds of the variables.
+         * @return true if the solver starts from the previous active set.
+         */
+        bool warmStart(const int& previousActiveSetSize,
+                       const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                       const Eigen::Ref<const Eigen::VectorXd>& upperBound);
+
+        /**
+         * Remove all the bounds from the active set (J = L^-T, R = 0).
+         */
+        void resetActiveSet();
+
+        /**
+         * Add a constraint to the active set and update J and R (Givens rotations).
+         * @return false if the constraint is linearly dependent from the active ones.
+         */
+        bool addConstraint();
+
+        /**
+         * Remove a constraint from the active set and update J and R (Givens rotations).
+         * @param position position of the constraint in the active set.
+         */
+        void deleteConstraint(const int& position);
+
+    public:
+
+        /**
+         * Constructor.
+         * @param numberOfVariables number of variables;
+         * @param numberOfEqualityConstraints number of equality constraints.
+         */
+        GoldfarbIdnaniSolver(const int& numberOfVariables, const int& numberOfEqualityConstraints);
+
+        /**
+         * Set the maximum number of active set changes.
+         * @param maximumNumberOfIterations maximum number of iterations.
+         */
+        void setMaximumNumberOfIterations(const int& maximumNumberOfIterations);
+
+        /**
+         * Set the tolerance used to check the bounds.
+         * @param tolerance the tolerance.
+         */
+        void setTolerance(const double& tolerance);
+
+        /**
+         * Solve the problem without considering the bounds. Only one factorization is required.
+         * @param hessian hessian matrix (n x n);
+         * @param gradient gradient vector (n);
+         * @param equalityMatrix matrix of the equality constraints (m x n);
+         * @param equalityVector vector of the equality constraints (m).
+         * @return true/false in case of success/failure.
+         */
+        bool solveEqualityConstrained(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                                      const Eigen::Ref<const Eigen::VectorXd>& gradient,
+                                      const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix,
+                                      const Eigen::Ref<const Eigen::VectorXd>& equalityVector);
+
+        /**
+         * Solve the problem. Infinite bounds are ignored.
+         * @param hessian hessian matrix (n x n);
+         * @param gradient gradient vector (n);
+         * @param equalityMatrix matrix of the equality constraints (m x n);
+         * @param equalityVector vector of the equality constraints (m);
+         * @param lowerBound lower bounds of the variables (n);
+         * @param upperBound upper bounds of the variables (n).
+         * @return true/false in case of success/failure.
+         */
+        bool solve(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                   const Eigen::Ref<const Eigen::VectorXd>& gradient,
+                   const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix,
+                   const Eigen::Ref<const Eigen::VectorXd>& equalityVector,
+                   const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                   const Eigen::Ref<const Eigen::VectorXd>& upperBound);
+
+        /**
+         * Get the solution of the last problem.
+         * @return the solution.
+         */
+        const Eigen::VectorXd& getSolution() const;
+
+        /**
+         * Get the number of active bounds at the solution.
+         * @return the number of active bounds.
+         */
+        int getActiveSetSize() const;
+
+        /**
+         * Get the number of active set changes of the last call.
+         * @return the number of iterations.
+         */
+        int getNumberOfIterations() const;
+    };
+};
+
+#endif
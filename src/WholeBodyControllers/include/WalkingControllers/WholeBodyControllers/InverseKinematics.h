@@ -13,7 +13,16 @@
 // iDynTree
 #include <iDynTree/KinDynComputations.h>
 #include <iDynTree/InverseKinematics.h>
+
+// std
+#include <cstdint>
+#include <deque>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
 
 namespace yarp {
     namespace os {
@@ -55,7 +64,8 @@ namespace WalkingControllers
 
         iDynTree::VectorDynSize m_jointRegularization, m_guess, m_feedback, m_qResult;
 
-        //DEBUG
+        // kinematics of the reduced model (base on the left foot). It is used by the damped least
+        // squares solver and to evaluate the errors in verbose mode
         iDynTree::KinDynComputations lchecker;
         iDynTree::VectorDynSize dummyVel;
         iDynTree::Twist dummyBaseVel;
@@ -68,8 +78,98 @@ namespace WalkingControllers
 
         double m_additionalRotationWeight, m_jointRegularizationWeight;
 
+        // damped least squares (Levenberg-Marquardt) solver used while walking
+        bool m_useDampedLeastSquares; /**< True if computeIKOnline uses the damped least squares solver. */
+        int m_dlsMaxIterations; /**< Maximum number of iterations. */
+        double m_dlsInitialDamping; /**< Damping used at the first iteration. */
+        double m_dlsConstraintsWeight; /**< Weight of the right foot and CoM tasks (constraints in the IPOPT problem). */
+        double m_dlsTolerance; /**< The solver stops when the norm of the step is smaller than the tolerance. */
+        double m_dlsErrorTolerance; /**< Maximum error of the right foot and CoM tasks at the solution. */
+        iDynTree::FrameIndex m_dlsRightFootIndex; /**< Index of the right foot frame in the reduced model. */
+        iDynTree::FrameIndex m_dlsAdditionalFrameIndex; /**< Index of the additional frame in the reduced model. */
+        iDynTree::Transform m_dlsBaseTransform; /**< Transform between the left foot frame and its link (reduced model). */
+        iDynTree::Transform m_dlsDesiredRightTransform; /**< Desired right foot pose (left foot frame). */
+        iDynTree::Position m_dlsDesiredCoMPosition; /**< Desired CoM position (left foot frame). */
+        iDynTree::Rotation m_dlsDesiredAdditionalRotation; /**< Desired rotation of the additional frame (left foot frame). */
+        iDynTree::VectorDynSize m_dlsJointPositions; /**< Joint positions set in the kinematics. */
+        iDynTree::MatrixDynSize m_dlsFrameJacobian; /**< Free floating jacobian of a frame. */
+        iDynTree::MatrixDynSize m_dlsCoMJacobian; /**< Free floating jacobian of the CoM. */
+        Eigen::VectorXd m_dlsJointLowerLimits; /**< Joint lower limits (reduced model). */
+        Eigen::VectorXd m_dlsJointUpperLimits; /**< Joint upper limits (reduced model). */
+        Eigen::MatrixXd m_dlsJacobian; /**< Jacobian of the tasks w.r.t. the joints ([right foot; CoM; additional rotation]). */
+        Eigen::MatrixXd m_dlsWeightedJacobian; /**< Weights times the jacobian of the tasks. */
+        Eigen::VectorXd m_dlsError; /**< Error of the tasks. */
+        Eigen::VectorXd m_dlsWeights; /**< Weight of each row of the tasks. */
+        Eigen::MatrixXd m_dlsHessian; /**< Hessian matrix of the damped least squares problem. */
+        Eigen::VectorXd m_dlsGradient; /**< Gradient of the damped least squares problem. */
+        Eigen::LLT<Eigen::MatrixXd> m_dlsHessianLLT; /**< Cholesky decomposition of the hessian matrix. */
+        Eigen::VectorXd m_dlsStep; /**< Step of the current iteration. */
+        Eigen::VectorXd m_dlsSolution; /**< Current solution. */
+        Eigen::VectorXd m_dlsCandidate; /**< Candidate solution (accepted only if the cost decreases). */
+
+        // persistent cache of the solutions computed by computeCachedIK
+        std::string m_solutionCacheFile; /**< File containing the cached solutions (empty if the cache is disabled). */
+        double m_solutionCacheTolerance; /**< Maximum error of the feet and CoM tasks of a cached solution. */
+        std::unordered_map<std::uint64_t, std::vector<double>> m_solutionCache; /**< Cached solutions (the key is the hash of the problem). */
+        std::deque<std::uint64_t> m_solutionCacheOrder; /**< Keys of the cached solutions from the oldest to the newest. */
+        std::size_t m_solutionCacheSize; /**< Maximum number of cached solutions. */
+
         bool prepareIK();
 
+        /**
+         * Add a solution to the cache. If the cache is full the oldest solution is removed.
+         * @param key key of the solution;
+         * @param solution joint positions of the reduced model.
+         */
+        void addSolutionToCache(const std::uint64_t& key, std::vector<double>&& solution);
+
+        /**
+         * Load the cached solutions from the cache file. A missing file is not an error.
+         * @return true on success, false otherwise
+         */
+        bool loadSolutionCache();
+
+        /**
+         * Save the cached solutions in the cache file.
+         * @return true on success, false otherwise
+         */
+        bool saveSolutionCache() const;
+
+        /**
+         * Evaluate the key of the solution cache. It is the hash of the reduced model, of the targets
+         * (expressed in the left foot frame) and of the regularization.
+         * @return the key.
+         */
+        std::uint64_t evaluateSolutionCacheKey();
+
+        /**
+         * Set the targets of the damped least squares problem.
+         * @param leftTransform transformation of the left foot (fixed);
+         * @param rightTransform desired transformation of the right foot;
+         * @param comPosition desired CoM position.
+         */
+        void setDampedLeastSquaresTargets(const iDynTree::Transform& leftTransform,
+                                          const iDynTree::Transform& rightTransform,
+                                          const iDynTree::Position& comPosition);
+
+        /**
+         * Resolve the frames and allocate the memory used by the damped least squares solver.
+         * @return true on success, false otherwise
+         */
+        bool prepareDampedLeastSquares();
+
+        /**
+         * Set the joint positions in the kinematics and evaluate the error of the tasks.
+         * @param jointPositions joint positions of the reduced model.
+         * @return the cost (weighted squared error plus joint regularization).
+         */
+        double evaluateDampedLeastSquaresError(const Eigen::Ref<const Eigen::VectorXd>& jointPositions);
+
+        /**
+         * Evaluate the jacobian of the tasks for the joint positions set in the kinematics.
+         */
+        void evaluateDampedLeastSquaresJacobian();
+
     public:
 
         /**
@@ -130,6 +230,53 @@ namespace WalkingControllers
                        const iDynTree::Position& comPosition,
                        iDynTree::VectorDynSize& result);
 
+        /**
+         * Compute the inverse kinematics with a bounded number of damped least squares
+         * (Levenberg-Marquardt) iterations warm started from the previous solution. The targets
+         * are the same of computeIK: the right foot and the CoM are tracked with the weight
+         * dls_constraints_weight. No memory is allocated.
+         * @param leftTransform transformation of the left foot (fixed);
+         * @param rightTransform desired transformation of the right foot;
+         * @param comPosition desired CoM position;
+         * @param result joint positions of the reduced model.
+         * @return true on success, false otherwise (e.g. the error of the right foot or of the CoM
+         * is greater than dls_error_tolerance)
+         */
+        bool computeIKDampedLeastSquares(const iDynTree::Transform& leftTransform,
+                                         const iDynTree::Transform& rightTransform,
+                                         const iDynTree::Position& comPosition,
+                                         iDynTree::VectorDynSize& result);
+
+        /**
+         * Compute the inverse kinematics while walking. The solver is chosen with the online_solver
+         * parameter (ipopt or damped_least_squares).
+         * @param leftTransform transformation of the left foot (fixed);
+         * @param rightTransform desired transformation of the right foot;
+         * @param comPosition desired CoM position;
+         * @param result joint positions of the reduced model.
+         * @return true on success, false otherwise
+         */
+        bool computeIKOnline(const iDynTree::Transform& leftTransform,
+                             const iDynTree::Transform& rightTransform,
+                             const iDynTree::Position& comPosition,
+                             iDynTree::VectorDynSize& result);
+
+        /**
+         * Compute the inverse kinematics using the persistent cache of solutions (solution_cache_file).
+         * If the problem is cached and the cached solution satisfies the right foot and CoM targets
+         * (one forward kinematics evaluation) it is returned directly, otherwise it is used as initial
+         * guess of computeIK and the new solution is stored in the cache.
+         * @param leftTransform transformation of the left foot (fixed);
+         * @param rightTransform desired transformation of the right foot;
+         * @param comPosition desired CoM position;
+         * @param result joint positions of the reduced model.
+         * @return true on success, false otherwise
+         */
+        bool computeCachedIK(const iDynTree::Transform& leftTransform,
+                             const iDynTree::Transform& rightTransform,
+                             const iDynTree::Position& comPosition,
+                             iDynTree::VectorDynSize& result);
+
 
         const std::string getLeftFootFrame() const;
 
@@ -11,6 +11,10 @@
 
 // std
 #include <memory>
+#include <vector>
+
+// Eigen
+#include <Eigen/Sparse>
 
 // YARP
 #include <yarp/os/Searchable.h>
@@ -25,6 +29,7 @@
 
 #include <WalkingControllers/iDynTreeUtilities/Helper.h>
 #include <WalkingControllers/KinDynWrapper/Wrapper.h>
+#include <WalkingControllers/WholeBodyControllers/GoldfarbIdnaniSolver.h>
 
 namespace WalkingControllers
 {
@@ -58,7 +63,7 @@ namespace WalkingControllers
 
     protected:
         iDynTree::MatrixDynSize m_comJacobian; /**< CoM jacobian (mixed representation). */
-        iDynTree::MatrixDynSize m_neckJacobian; /**< Neck jacobian (mixed representation). */
+        iDynTree::MatrixDynSize m_neckJacobian; /**< Neck jacobian (mixed representation). Only the angular part is used. */
         iDynTree::MatrixDynSize m_leftFootJacobian; /**< Left foot Jacobian (mixed representation). */
         iDynTree::MatrixDynSize m_rightFootJacobian; /**< Right foot Jacobian (mixed representation). */
         iDynTree::MatrixDynSize m_leftHandJacobian; /**< Left hand Jacobian (mixed representation). */
@@ -156,12 +161,47 @@ namespace WalkingControllers
         double m_torsoWeightWalking; /**< Weight matrix (only the diagonal) used for the torso during walking. */
         double m_torsoWeightStance; /**< Weight matrix (only the diagonal) used for the torso during stance. */
 
+        // outputs of the smoothers, they are read once per step (see updateSmoothedWeights())
+        iDynTree::VectorDynSize m_currentHandWeight; /**< Current weight of the hand tasks (only the diagonal). */
+        double m_currentTorsoWeight; /**< Current weight of the neck task used with the joint retargeting. */
+        iDynTree::VectorDynSize m_currentJointRegularizationWeight; /**< Current weight of the joint regularization
+                                                                       used with the joint retargeting. */
+        iDynTree::VectorDynSize m_currentJointRetargetingWeight; /**< Current weight of the joint retargeting. */
+
         bool m_useCoMAsConstraint; /**< True if the CoM is added as a constraint. */
         bool m_useJointsLimitsConstraint; /**< True if the CoM is added as a constraint. */
 
         iDynTree::MatrixDynSize m_hessianDense; /**< Hessian matrix */
+        Eigen::SparseMatrix<double> m_hessianSparse; /**< Upper triangular part of the hessian matrix.
+                                                        The sparsity pattern is fixed and only the values
+                                                        are updated. */
+        bool m_isHessianPatternDense{false}; /**< True if the sparsity pattern of the hessian matrix is
+                                                dense. It happens when the CoM is a task of the cost function. */
         iDynTree::VectorDynSize m_gradient; /**< Gradient vector */
         iDynSparseMatrix m_constraintsMatrixSparse; /**< Constraint matrix */
+        int m_numberOfTaskConstraints; /**< Number of constraints related to the tasks (feet and CoM if it is
+                                          used as constraint). They are stored in the first rows of the constraint matrix. */
+        std::vector<int> m_constraintsColumnsOffset; /**< Position (in the values of the CSC constraint matrix)
+                                                        of the first task row of each column. */
+        Eigen::MatrixXd m_equalityConstraintsMatrix; /**< Dense matrix of the task constraints (feet and CoM). */
+
+        bool m_useLeastSquaresFastPath; /**< True if the problem is solved in closed form when no joint
+                                           velocity bound is active. */
+        bool m_isJointVelocitiesBoundActive{false}; /**< True if a bound was active at the previous step. */
+        std::unique_ptr<GoldfarbIdnaniSolver> m_leastSquaresSolver; /**< Solver of the equality constrained problem. */
+
+        // reduced formulation: x = T qdot + x_a where the base velocity is evaluated from the stance foot constraint
+        bool m_useReducedFormulation; /**< True if the base variables are eliminated using the stance foot constraint. */
+        bool m_isLeftFootStance{true}; /**< True if the left foot is the stance foot. */
+        Eigen::PartialPivLU<Eigen::MatrixXd> m_stanceBaseJacobianLU; /**< LU decomposition of the base block of the stance foot jacobian. */
+        Eigen::MatrixXd m_baseEliminationMatrix; /**< Matrix T that maps the joint velocities into the variables. */
+        Eigen::VectorXd m_baseEliminationOffset; /**< Offset x_a (base velocity required by the stance foot twist). */
+        Eigen::MatrixXd m_hessianTimesEliminationMatrix; /**< Product between the hessian matrix and T. */
+        Eigen::VectorXd m_auxiliaryGradient; /**< Auxiliary vector used to evaluate the reduced gradient. */
+        Eigen::MatrixXd m_reducedHessian; /**< Hessian matrix of the reduced problem. */
+        Eigen::VectorXd m_reducedGradient; /**< Gradient of the reduced problem. */
+        Eigen::MatrixXd m_reducedEqualityConstraintsMatrix; /**< Constraints matrix of the reduced problem (swing foot and CoM). */
+        Eigen::VectorXd m_reducedEqualityConstraintsVector; /**< Constraints vector of the reduced problem. */
         iDynTree::VectorDynSize m_lowerBound; /**< Lower bound */
         iDynTree::VectorDynSize m_upperBound; /**< Upper bound */
         iDynTree::VectorDynSize m_solution; /**< Solution of the optimization problem */
@@ -188,6 +228,12 @@ namespace WalkingControllers
          */
         bool initializeJointRetargeting(const yarp::os::Searchable& config);
 
+        /**
+         * Copy the outputs of the smoothers of the weights. The smoothers return their output by
+         * value, so they are read only once per step and not while the hessian matrix is evaluated.
+         */
+        void updateSmoothedWeights();
+
 
         /**
          * Instantiate the solver
@@ -199,6 +245,27 @@ namespace WalkingControllers
          */
         void evaluateHessianMatrix();
 
+        /**
+         * Evaluate the sparsity pattern of the hessian matrix from the active tasks
+         * (neck, CoM, hands and joint regularization).
+         * @note The jacobians have to be set before calling this function. A zero column
+         * of a jacobian means that the variable does not belong to the kinematic chain between
+         * the task and the floating base. Since the floating base is the stance foot, the joints
+         * of both legs (the support of the feet jacobians) are added to each task, hence the
+         * pattern does not change while the robot moves or when the stance foot changes.
+         */
+        void initializeHessianSparsityPattern();
+
+        /**
+         * Evaluate the values of the hessian matrix in the preallocated sparse matrix.
+         * The entries of the pattern are evaluated directly from the jacobians of the tasks.
+         * When the CoM is a task of the cost function the pattern is dense, in this case
+         * the upper triangular part of the dense hessian matrix is copied.
+         * @note evaluateHessianMatrix() has to be called before if the pattern is dense.
+         * The function does not allocate memory.
+         */
+        void evaluateHessianMatrixSparse();
+
         /**
          * Evaluate the gradient vector.
          */
@@ -209,6 +276,62 @@ namespace WalkingControllers
          */
         void evaluateLinearConstraintMatrix();
 
+        /**
+         * Add the task rows to the sparsity pattern of the constraint matrix and store the position
+         * of each column in the CSC values. The task jacobians are then copied without
+         * searching for the elements in the sparse matrix.
+         * @return true/false in case of success/failure.
+         */
+        bool initializeConstraintsMatrixPattern();
+
+        /**
+         * Copy the jacobians into the dense matrix of the task constraints.
+         */
+        void evaluateEqualityConstraintsMatrix();
+
+        /**
+         * Check if the joint velocities satisfy the bounds.
+         * @param solution solution of the optimization problem (base velocity + joint velocities);
+         * @param margin minimum distance from the bounds.
+         * @return true if all the bounds are satisfied with the given margin.
+         */
+        virtual bool isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                   const double& margin) const;
+
+        /**
+         * Solve the problem considering only the task constraints (one factorization).
+         * The hessian matrix, the gradient and the bounds have to be already evaluated.
+         * @note The fast path is skipped if a bound was active at the previous step.
+         * @return true if the solution satisfies the joint velocities bounds, i.e. it is the
+         * solution of the QP problem.
+         */
+        bool solveLeastSquares();
+
+        /**
+         * Store if a joint velocities bound is active at the solution of the QP problem.
+         */
+        void updateActiveBoundsStatus();
+
+        /**
+         * Check if the solver supports the reduced formulation.
+         * @return true if the reduced formulation is supported.
+         */
+        virtual bool isReducedFormulationSupported() const;
+
+        /**
+         * Eliminate the base variables using the stance foot constraint. The variables of the reduced
+         * problem are the joint velocities and the stance foot constraint is satisfied by construction.
+         * The hessian matrix, the gradient and the bounds have to be already evaluated.
+         * @return true/false in case of success/failure.
+         */
+        bool evaluateReducedProblem();
+
+        /**
+         * Evaluate the solution (base velocity + joint velocities) from the solution of the reduced problem.
+         * @param jointVelocities solution of the reduced problem.
+         */
+        void setSolutionFromReducedProblem(const Eigen::Ref<const Eigen::VectorXd>& jointVelocities);
+
         /**
          * Evaluate Lower and upper bounds
          */
@@ -360,6 +483,20 @@ namespace WalkingControllers
          */
         void setDesiredCoMPosition(const iDynTree::Position& desiredComPosition);
 
+        /**
+         * Evaluate the jacobians of the tasks. The jacobians are written directly in the
+         * matrices used by the solver, so no copy is required.
+         * @param kinDynWrapper the kinDynWrapper object
+         * @return true in case of success and false otherwise.
+         */
+        bool setJacobians(WalkingFK& kinDynWrapper);
+
+        /**
+         * Set the stance foot. It is used by the reduced formulation to eliminate the base variables.
+         * @param isLeftFootStance true if the left foot is the stance foot (i.e. it is the fixed frame).
+         */
+        void setStanceFoot(const bool& isLeftFootStance);
+
         /**
          * Set the robot phase. This is used by the minimum jerk trajectory.
          * @param isStancePhase true if the robot is in the stance phase
@@ -400,10 +537,19 @@ namespace WalkingControllers
 
         /**
          * Get the hessian matrix
+         * @note WalkingQPIK_osqp evaluates the dense hessian matrix only if it is required by the
+         * least squares fast path or if the sparsity pattern is dense.
          * @return the hessian matrix
          */
         const iDynTree::MatrixDynSize& getHessianMatrix() const;
 
+        /**
+         * Get the upper triangular part of the hessian matrix stored with a fixed sparsity pattern.
+         * @note It is evaluated only by WalkingQPIK_osqp when the QP problem is solved.
+         * @return the upper triangular part of the hessian matrix
+         */
+        const Eigen::SparseMatrix<double>& getHessianMatrixSparse() const;
+
         /**
          * Get the gradient vector
          * @return the gradient vector
@@ -412,6 +558,7 @@ namespace WalkingControllers
 
         /**
          * Get the Constraint Matrix
+         * @note The qpOASES solver uses a dense constraint matrix, the sparse one is not evaluated.
          * @return the constraint matrix
          */
         const iDynSparseMatrix& getConstraintMatrix() const;
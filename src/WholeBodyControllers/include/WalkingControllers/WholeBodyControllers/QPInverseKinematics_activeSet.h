@@ -0,0 +1,71 @@
+/**
+ * @file QPInverseKinematics_activeSet.h
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_CONTROLLERS_WHOLE_BODY_CONTROLLERS_CONTROLLERS_QP_IK_ACTIVE_SET_H
+#define WALKING_CONTROLLERS_WHOLE_BODY_CONTROLLERS_CONTROLLERS_QP_IK_ACTIVE_SET_H
+
+// Eigen
+#include <Eigen/Dense>
+
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics.h>
+#include <WalkingControllers/WholeBodyControllers/GoldfarbIdnaniSolver.h>
+
+namespace WalkingControllers
+{
+    /**
+     * QP-IK solved with the dense Goldfarb-Idnani active set method. The feet (and the CoM)
+     * constraints are eliminated and the joint velocities bounds are handled by the active set.
+     * If no bound is active the solver requires only one factorization, hence the least squares
+     * fast path of WalkingQPIK is not used.
+     */
+    class WalkingQPIK_activeSet : public WalkingQPIK
+    {
+        std::unique_ptr<GoldfarbIdnaniSolver> m_optimizer{nullptr}; /**< Optimization solver. */
+
+        iDynTree::VectorDynSize m_minJointLimit; /**< Lower bound of the variables. */
+        iDynTree::VectorDynSize m_maxJointLimit; /**< Upper bound of the variables. */
+
+        /**
+         * Set joints velocity bounds
+         * @return true/false in case of success/failure.
+         */
+        virtual void setJointVelocitiesBounds() final;
+
+    protected:
+
+        /**
+         * Initialize the solver
+         */
+        virtual void instantiateSolver() final;
+
+        /**
+         * Set the number of constraints (it may change according to the solver used)
+         */
+        virtual void setNumberOfConstraints() final;
+
+        /**
+         * Initialize matrices that depends on the solver used
+         */
+        virtual void initializeSolverSpecificMatrices() final;
+
+        /**
+         * The reduced formulation is supported.
+         * @return true.
+         */
+        virtual bool isReducedFormulationSupported() const final;
+
+    public:
+
+        /**
+         * Solve the optimization problem.
+         * @return true/false in case of success/failure.
+         */
+        virtual bool solve() final;
+    };
+};
+#endif
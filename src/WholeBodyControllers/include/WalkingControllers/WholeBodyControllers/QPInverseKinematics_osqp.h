@@ -53,6 +53,15 @@ namespace WalkingControllers
          */
         virtual void initializeSolverSpecificMatrices() final;
 
+        /**
+         * Check if the joint velocities satisfy the bounds.
+         * @param solution solution of the optimization problem (base velocity + joint velocities);
+         * @param margin minimum distance from the bounds.
+         * @return true if all the bounds are satisfied with the given margin.
+         */
+        virtual bool isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                   const double& margin) const final;
+
     public:
         /**
          * Solve the optimization problem.
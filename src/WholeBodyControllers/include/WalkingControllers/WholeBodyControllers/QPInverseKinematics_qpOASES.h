@@ -22,6 +22,15 @@ namespace WalkingControllers
         iDynTree::VectorDynSize  m_minJointLimit;
         iDynTree::VectorDynSize  m_maxJointLimit;
 
+        iDynTree::MatrixDynSize m_constraintsMatrix; /**< Dense constraint matrix. It is stored row major
+                                                        as required by qpOASES. */
+
+        /**
+         * Copy the jacobians into the dense constraint matrix.
+         * @note The function does not allocate memory.
+         */
+        void evaluateDenseConstraintsMatrix();
+
         bool m_isFirstTime;
 
         /**
@@ -47,6 +56,24 @@ namespace WalkingControllers
          */
         virtual void initializeSolverSpecificMatrices() final;
 
+        /**
+         * Check if the joint velocities satisfy the bounds.
+         * @param solution solution of the optimization problem (base velocity + joint velocities);
+         * @param margin minimum distance from the bounds.
+         * @return true if all the bounds are satisfied with the given margin.
+         */
+        virtual bool isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                   const double& margin) const final;
+
+        /**
+         * Solve the QP problem with qpOASES. The first call initializes the solver, the following
+         * ones hot start it from the previous working set.
+         * @note The matrices of the problem are preallocated, however SQProblem::hotstart()
+         * allocates its internal matrices.
+         * @return true/false in case of success/failure.
+         */
+        virtual bool solveOptimizationProblem();
+
     public:
 
         /**
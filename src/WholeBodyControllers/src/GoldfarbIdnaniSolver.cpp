@@ -0,0 +1,540 @@
+/**
+ * @file GoldfarbIdnaniSolver.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include <WalkingControllers/WholeBodyControllers/GoldfarbIdnaniSolver.h>
+
+using namespace WalkingControllers;
+
+GoldfarbIdnaniSolver::GoldfarbIdnaniSolver(const int& numberOfVariables, const int& numberOfEqualityConstraints)
+    : m_numberOfVariables(numberOfVariables),
+      m_numberOfEqualityConstraints(numberOfEqualityConstraints),
+      m_reducedNumberOfVariables(numberOfVariables - numberOfEqualityConstraints),
+      m_maximumNumberOfIterations(10 * numberOfVariables),
+      m_tolerance(1e-9),
+      m_equalityConstraintsQR(numberOfVariables, numberOfEqualityConstraints),
+      m_reducedHessianLLT(numberOfVariables - numberOfEqualityConstraints)
+{
+    const int n = m_numberOfVariables;
+    const int m = m_numberOfEqualityConstraints;
+    const int p = m_reducedNumberOfVariables;
+
+    // all the memory is allocated here
+    m_orthogonalMatrix = Eigen::MatrixXd::Identity(n, n);
+    m_householderWorkspace = Eigen::VectorXd::Zero(n);
+    m_particularSolution = Eigen::VectorXd::Zero(n);
+    m_equalityMultipliers = Eigen::VectorXd::Zero(m);
+
+    m_hessianTimesNullSpace = Eigen::MatrixXd::Zero(n, p);
+    m_reducedHessian = Eigen::MatrixXd::Zero(p, p);
+    m_reducedGradient = Eigen::VectorXd::Zero(p);
+    m_auxiliaryVector = Eigen::VectorXd::Zero(n);
+    m_initialJ = Eigen::MatrixXd::Zero(p, p);
+
+    m_factorizedHessian = Eigen::MatrixXd::Zero(n, n);
+    m_factorizedEqualityMatrix = Eigen::MatrixXd::Zero(m, n);
+    m_isFactorizationValid = false;
+
+    m_J = Eigen::MatrixXd::Zero(p, p);
+    m_R = Eigen::MatrixXd::Zero(p, p);
+    m_RNorm = 1.0;
+    m_reducedSolution = Eigen::VectorXd::Zero(p);
+    m_primalStep = Eigen::VectorXd::Zero(p);
+    m_dualStep = Eigen::VectorXd::Zero(p);
+    m_d = Eigen::VectorXd::Zero(p);
+    m_constraintNormal = Eigen::VectorXd::Zero(p);
+    m_multipliers = Eigen::VectorXd::Zero(p);
+
+    // at most p linearly independent bounds can be active
+    m_activeSet.resize(p);
+    m_activeSetSize = 0;
+    m_isActive.assign(2 * n, false);
+    m_wasActive.assign(2 * n, false);
+    m_numberOfIterations = 0;
+
+    m_solution = Eigen::VectorXd::Zero(n);
+}
+
+void GoldfarbIdnaniSolver::setMaximumNumberOfIterations(const int& maximumNumberOfIterations)
+{
+    m_maximumNumberOfIterations = maximumNumberOfIterations;
+}
+
+void GoldfarbIdnaniSolver::setTolerance(const double& tolerance)
+{
+    m_tolerance = tolerance;
+}
+
+double GoldfarbIdnaniSolver::evaluateSlack(const int& index,
+                                           const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                                           const Eigen::Ref<const Eigen::VectorXd>& upperBound) const
+{
+    const int variable = index / 2;
+    const double value = m_particularSolution(variable)
+        + m_orthogonalMatrix.row(variable).tail(m_reducedNumberOfVariables).dot(m_reducedSolution);
+
+    if(index % 2 == 0)
+        return value - lowerBound(variable);
+
+    return upperBound(variable) - value;
+}
+
+bool GoldfarbIdnaniSolver::addConstraint()
+{
+    const int p = m_reducedNumberOfVariables;
+    const int q = m_activeSetSize;
+
+    if(q >= p)
+        return false;
+
+    // the Givens rotations zero the last elements of d and are applied to the columns of J
+    for(int j = p - 1; j > q; j--)
+    {
+        double cc = m_d(j - 1);
+        double ss = m_d(j);
+        const double h = std::hypot(cc, ss);
+        if(h < std::numeric_limits<double>::epsilon())
+            continue;
+
+        m_d(j) = 0.0;
+        cc = cc / h;
+        ss = ss / h;
+        if(cc < 0.0)
+        {
+            m_d(j - 1) = -h;
+            cc = -cc;
+            ss = -ss;
+        }
+        else
+            m_d(j - 1) = h;
+
+        const double xny = ss / (1.0 + cc);
+        for(int k = 0; k < p; k++)
+        {
+            const double t1 = m_J(k, j - 1);
+            const double t2 = m_J(k, j);
+            m_J(k, j - 1) = t1 * cc + t2 * ss;
+            m_J(k, j) = xny * (t1 + m_J(k, j - 1)) - t2;
+        }
+    }
+
+    m_R.col(q).head(q + 1) = m_d.head(q + 1);
+    m_activeSetSize++;
+
+    // the constraint is linearly dependent from the active ones
+    if(std::abs(m_d(q)) <= std::numeric_limits<double>::epsilon() * m_RNorm)
+        return false;
+
+    m_RNorm = std::max(m_RNorm, std::abs(m_d(q)));
+    return true;
+}
+
+void GoldfarbIdnaniSolver::deleteConstraint(const int& position)
+{
+    m_isActive[m_activeSet[position]] = false;
+
+    for(int i = position; i < m_activeSetSize - 1; i++)
+    {
+        m_activeSet[i] = m_activeSet[i + 1];
+        m_multipliers(i) = m_multipliers(i + 1);
+        m_R.col(i) = m_R.col(i + 1);
+    }
+    m_R.col(m_activeSetSize - 1).setZero();
+    m_activeSetSize--;
+
+    // restore the triangular structure of R
+    const int p = m_reducedNumberOfVariables;
+    for(int j = position; j < m_activeSetSize; j++)
+    {
+        double cc = m_R(j, j);
+        double ss = m_R(j + 1, j);
+        const double h = std::hypot(cc, ss);
+        if(h < std::numeric_limits<double>::epsilon())
+            continue;
+
+        cc = cc / h;
+        ss = ss / h;
+        m_R(j + 1, j) = 0.0;
+        if(cc < 0.0)
+        {
+            m_R(j, j) = -h;
+            cc = -cc;
+            ss = -ss;
+        }
+        else
+            m_R(j, j) = h;
+
+        const double xny = ss / (1.0 + cc);
+        for(int k = j + 1; k < m_activeSetSize; k++)
+        {
+            const double t1 = m_R(j, k);
+            const double t2 = m_R(j + 1, k);
+            m_R(j, k) = t1 * cc + t2 * ss;
+            m_R(j + 1, k) = xny * (t1 + m_R(j, k)) - t2;
+        }
+        for(int k = 0; k < p; k++)
+        {
+            const double t1 = m_J(k, j);
+            const double t2 = m_J(k, j + 1);
+            m_J(k, j) = t1 * cc + t2 * ss;
+            m_J(k, j + 1) = xny * (m_J(k, j) + t1) - t2;
+        }
+    }
+}
+
+bool GoldfarbIdnaniSolver::factorize(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                                     const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix)
+{
+    const int m = m_numberOfEqualityConstraints;
+    const int p = m_reducedNumberOfVariables;
+
+    // the comparison is cheaper than the factorizations
+    if(m_isFactorizationValid && hessian == m_factorizedHessian && equalityMatrix == m_factorizedEqualityMatrix)
+        return true;
+
+    m_isFactorizationValid = false;
+
+    if(m > 0)
+    {
+        // A' = [Y Z] [R; 0] hence A (Y w + Z z) = R' w
+        m_equalityConstraintsQR.compute(equalityMatrix.transpose());
+        m_equalityConstraintsQR.householderQ().evalTo(m_orthogonalMatrix, m_householderWorkspace);
+
+        const auto R = m_equalityConstraintsQR.matrixQR().topLeftCorner(m, m);
+        const double maxPivot = R.diagonal().cwiseAbs().maxCoeff();
+        if(R.diagonal().cwiseAbs().minCoeff() <= maxPivot * std::sqrt(std::numeric_limits<double>::epsilon()))
+        {
+            yError() << "[GoldfarbIdnaniSolver::factorize] The equality constraints are linearly dependent.";
+            return false;
+        }
+    }
+
+    // hessian matrix in the null space of the equality constraints
+    const auto Z = m_orthogonalMatrix.rightCols(p);
+    m_hessianTimesNullSpace.noalias() = hessian * Z;
+    m_reducedHessian.noalias() = Z.transpose() * m_hessianTimesNullSpace;
+
+    m_reducedHessianLLT.compute(m_reducedHessian);
+    if(m_reducedHessianLLT.info() != Eigen::Success)
+    {
+        yError() << "[GoldfarbIdnaniSolver::factorize] The hessian matrix is not positive definite "
+                 << "in the null space of the equality constraints.";
+        return false;
+    }
+
+    // J = L^-T where L L' is the Cholesky decomposition of the reduced hessian
+    m_initialJ.setIdentity();
+    m_reducedHessianLLT.matrixU().solveInPlace(m_initialJ);
+
+    m_factorizedHessian = hessian;
+    m_factorizedEqualityMatrix = equalityMatrix;
+    m_isFactorizationValid = true;
+
+    return true;
+}
+
+bool GoldfarbIdnaniSolver::solveEqualityConstrained(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                                                    const Eigen::Ref<const Eigen::VectorXd>& gradient,
+                                                    const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix,
+                                                    const Eigen::Ref<const Eigen::VectorXd>& equalityVector)
+{
+    const int n = m_numberOfVariables;
+    const int m = m_numberOfEqualityConstraints;
+    const int p = m_reducedNumberOfVariables;
+
+    if(hessian.rows() != n || hessian.cols() != n || gradient.size() != n)
+    {
+        yError() << "[GoldfarbIdnaniSolver::solveEqualityConstrained] The size of the hessian matrix "
+                 << "and of the gradient has to be coherent with the number of variables.";
+        return false;
+    }
+
+    if(equalityMatrix.rows() != m || equalityMatrix.cols() != n || equalityVector.size() != m)
+    {
+        yError() << "[GoldfarbIdnaniSolver::solveEqualityConstrained] The size of the equality constraints "
+                 << "is not coherent with the one passed to the constructor.";
+        return false;
+    }
+
+    if(!factorize(hessian, equalityMatrix))
+    {
+        yError() << "[GoldfarbIdnaniSolver::solveEqualityConstrained] Unable to factorize the problem.";
+        return false;
+    }
+
+    if(m > 0)
+    {
+        const auto R = m_equalityConstraintsQR.matrixQR().topLeftCorner(m, m);
+        m_equalityMultipliers = equalityVector;
+        R.triangularView<Eigen::Upper>().transpose().solveInPlace(m_equalityMultipliers);
+        m_particularSolution.noalias() = m_orthogonalMatrix.leftCols(m) * m_equalityMultipliers;
+    }
+    else
+        m_particularSolution.setZero();
+
+    // problem in the null space of the equality constraints
+    const auto Z = m_orthogonalMatrix.rightCols(p);
+    m_auxiliaryVector = gradient;
+    m_auxiliaryVector.noalias() += hessian * m_particularSolution;
+    m_reducedGradient.noalias() = Z.transpose() * m_auxiliaryVector;
+
+    m_reducedSolution = -m_reducedGradient;
+    m_reducedHessianLLT.solveInPlace(m_reducedSolution);
+
+    m_solution = m_particularSolution;
+    m_solution.noalias() += Z * m_reducedSolution;
+
+    m_numberOfIterations = 0;
+
+    return true;
+}
+
+void GoldfarbIdnaniSolver::resetActiveSet()
+{
+    for(int i = 0; i < m_activeSetSize; i++)
+        m_isActive[m_activeSet[i]] = false;
+
+    m_activeSetSize = 0;
+    m_J = m_initialJ;
+    m_R.setZero();
+    m_RNorm = 1.0;
+}
+
+bool GoldfarbIdnaniSolver::warmStart(const int& previousActiveSetSize,
+                                     const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                                     const Eigen::Ref<const Eigen::VectorXd>& upperBound)
+{
+    const int p = m_reducedNumberOfVariables;
+    const auto Z = m_orthogonalMatrix.rightCols(p);
+
+    // the previous bounds are added to the factorization without moving the primal solution.
+    // m_activeSet is filled in place since the previous bounds are read in the same order
+    int q = 0;
+    for(int i = 0; i < previousActiveSetSize; i++)
+    {
+        const int index = m_activeSet[i];
+        const double bound = index % 2 == 0 ? lowerBound(index / 2) : upperBound(index / 2);
+        if(!std::isfinite(bound))
+            continue;
+
+        const double sign = index % 2 == 0 ? 1.0 : -1.0;
+        m_constraintNormal = sign * Z.row(index / 2).transpose();
+        m_d.noalias() = m_J.transpose() * m_constraintNormal;
+        if(!addConstraint())
+        {
+            resetActiveSet();
+            return false;
+        }
+
+        // slack of the bound at the unconstrained minimum
+        m_dualStep(q) = evaluateSlack(index, lowerBound, upperBound);
+        m_activeSet[q] = index;
+        m_isActive[index] = true;
+        q++;
+    }
+
+    if(q == 0)
+        return false;
+
+    // with the bounds as equalities N' z = c the solution is z = z_0 + J_1 y, where y = -R^-T s
+    // (s is the slack at z_0), and the multipliers are R^-1 y
+    const auto R = m_R.topLeftCorner(q, q).triangularView<Eigen::Upper>();
+    m_primalStep.head(q) = -m_dualStep.head(q);
+    R.transpose().solveInPlace(m_primalStep.head(q));
+    m_multipliers.head(q) = m_primalStep.head(q);
+    R.solveInPlace(m_multipliers.head(q));
+
+    // the bounds are not active anymore, the method starts from the unconstrained minimum
+    if(m_multipliers.head(q).minCoeff() < -m_tolerance)
+    {
+        resetActiveSet();
+        return false;
+    }
+    m_multipliers.head(q) = m_multipliers.head(q).cwiseMax(0.0);
+
+    m_reducedSolution.noalias() += m_J.leftCols(q) * m_primalStep.head(q);
+    return true;
+}
+
+bool GoldfarbIdnaniSolver::solve(const Eigen::Ref<const Eigen::MatrixXd>& hessian,
+                                 const Eigen::Ref<const Eigen::VectorXd>& gradient,
+                                 const Eigen::Ref<const Eigen::MatrixXd>& equalityMatrix,
+                                 const Eigen::Ref<const Eigen::VectorXd>& equalityVector,
+                                 const Eigen::Ref<const Eigen::VectorXd>& lowerBound,
+                                 const Eigen::Ref<const Eigen::VectorXd>& upperBound)
+{
+    const int n = m_numberOfVariables;
+    const int p = m_reducedNumberOfVariables;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    if(lowerBound.size() != n || upperBound.size() != n)
+    {
+        yError() << "[GoldfarbIdnaniSolver::solve] The size of the bounds has to be equal to the number "
+                 << "of variables.";
+        return false;
+    }
+
+    // the bounds active at the previous call are used for the hot start
+    const int previousActiveSetSize = m_activeSetSize;
+    m_wasActive.swap(m_isActive);
+    std::fill(m_isActive.begin(), m_isActive.end(), false);
+    m_activeSetSize = 0;
+
+    // unconstrained minimum in the null space of the equality constraints. The factorizations
+    // are evaluated only if the hessian or the equality matrix changed
+    if(!solveEqualityConstrained(hessian, gradient, equalityMatrix, equalityVector))
+    {
+        yError() << "[GoldfarbIdnaniSolver::solve] Unable to solve the equality constrained problem.";
+        return false;
+    }
+
+    resetActiveSet();
+    warmStart(previousActiveSetSize, lowerBound, upperBound);
+
+    const auto Z = m_orthogonalMatrix.rightCols(p);
+    while(true)
+    {
+        // choose the most violated bound. The bounds active at the previous call are added first
+        int candidate = -1;
+        double candidateSlack = -m_tolerance;
+        bool candidateWasActive = false;
+        for(int index = 0; index < 2 * n; index++)
+        {
+            if(m_isActive[index])
+                continue;
+
+            const double bound = index % 2 == 0 ? lowerBound(index / 2) : upperBound(index / 2);
+            if(!std::isfinite(bound))
+                continue;
+
+            const double slack = evaluateSlack(index, lowerBound, upperBound);
+            if(slack >= -m_tolerance)
+                continue;
+
+            if((m_wasActive[index] && !candidateWasActive)
+               || (m_wasActive[index] == candidateWasActive && slack < candidateSlack))
+            {
+                candidate = index;
+                candidateSlack = slack;
+                candidateWasActive = m_wasActive[index];
+            }
+        }
+
+        // all the bounds are satisfied
+        if(candidate < 0)
+            break;
+
+        if(m_numberOfIterations >= m_maximumNumberOfIterations)
+        {
+            yError() << "[GoldfarbIdnaniSolver::solve] The maximum number of iterations has been reached.";
+            return false;
+        }
+        m_numberOfIterations++;
+
+        // normal of the bound in the null space of the equality constraints
+        const double sign = candidate % 2 == 0 ? 1.0 : -1.0;
+        m_constraintNormal = sign * Z.row(candidate / 2).transpose();
+        double candidateMultiplier = 0.0;
+
+        while(true)
+        {
+            const int q = m_activeSetSize;
+
+            // step directions in the primal and dual space
+            m_d.noalias() = m_J.transpose() * m_constraintNormal;
+            m_primalStep.noalias() = m_J.rightCols(p - q) * m_d.tail(p - q);
+            m_dualStep.head(q) = m_d.head(q);
+            m_R.topLeftCorner(q, q).triangularView<Eigen::Upper>().solveInPlace(m_dualStep.head(q));
+
+            // partial step length (an active constraint is dropped)
+            double partialStep = infinity;
+            int dropPosition = -1;
+            for(int j = 0; j < q; j++)
+            {
+                if(m_dualStep(j) > 0.0)
+                {
+                    const double step = m_multipliers(j) / m_dualStep(j);
+                    if(step < partialStep)
+                    {
+                        partialStep = step;
+                        dropPosition = j;
+                    }
+                }
+            }
+
+            // full step length (the candidate becomes active)
+            double fullStep = infinity;
+            if(m_primalStep.squaredNorm() > std::numeric_limits<double>::epsilon())
+                fullStep = -evaluateSlack(candidate, lowerBound, upperBound)
+                    / m_primalStep.dot(m_constraintNormal);
+
+            const double step = std::min(partialStep, fullStep);
+            if(step >= infinity)
+            {
+                yError() << "[GoldfarbIdnaniSolver::solve] The problem is infeasible.";
+                return false;
+            }
+
+            if(fullStep >= infinity)
+            {
+                // step in the dual space only
+                m_multipliers.head(q) -= step * m_dualStep.head(q);
+                candidateMultiplier += step;
+                deleteConstraint(dropPosition);
+                continue;
+            }
+
+            // step in the primal and in the dual space
+            m_reducedSolution += step * m_primalStep;
+            m_multipliers.head(q) -= step * m_dualStep.head(q);
+            candidateMultiplier += step;
+
+            if(fullStep <= partialStep)
+            {
+                if(!addConstraint())
+                {
+                    yError() << "[GoldfarbIdnaniSolver::solve] The bounds are linearly dependent.";
+                    return false;
+                }
+                m_multipliers(m_activeSetSize - 1) = candidateMultiplier;
+                m_activeSet[m_activeSetSize - 1] = candidate;
+                m_isActive[candidate] = true;
+                break;
+            }
+
+            deleteConstraint(dropPosition);
+        }
+    }
+
+    m_solution = m_particularSolution;
+    m_solution.noalias() += Z * m_reducedSolution;
+
+    return true;
+}
+
+const Eigen::VectorXd& GoldfarbIdnaniSolver::getSolution() const
+{
+    return m_solution;
+}
+
+int GoldfarbIdnaniSolver::getActiveSetSize() const
+{
+    return m_activeSetSize;
+}
+
+int GoldfarbIdnaniSolver::getNumberOfIterations() const
+{
+    return m_numberOfIterations;
+}
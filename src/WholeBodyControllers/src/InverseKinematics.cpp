@@ -23,13 +23,80 @@
 #include <iDynTree/yarp/YARPConfigurationsLoader.h>
 #include <iDynTree/KinDynComputations.h>
 
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
 // Eigen
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 
 #include <WalkingControllers/WholeBodyControllers/InverseKinematics.h>
 
 using namespace WalkingControllers;
 
+namespace
+{
+    /**
+     * Rotation error between two rotations (axis-angle of desired * actual^T).
+     * It is expressed in the same frame of the angular velocity of the mixed jacobian.
+     */
+    Eigen::Vector3d rotationError(const iDynTree::Rotation& desiredRotation,
+                                  const iDynTree::Rotation& rotation)
+    {
+        Eigen::AngleAxisd error(Eigen::Matrix3d(iDynTree::toEigen(desiredRotation)
+                                                * iDynTree::toEigen(rotation).transpose()));
+        return error.angle() * error.axis();
+    }
+
+    /**
+     * Update a FNV-1a hash with a sequence of bytes.
+     */
+    void hashCombine(std::uint64_t& hash, const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(std::size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    /**
+     * Update a hash with a double. The value is rounded so that the hash does not depend on the
+     * numerical noise of the inputs (the cached solution is validated anyway).
+     */
+    void hashCombine(std::uint64_t& hash, double value)
+    {
+        if(!std::isfinite(value))
+        {
+            hashCombine(hash, &value, sizeof(value));
+            return;
+        }
+        std::int64_t rounded = std::llround(value * 1e8);
+        hashCombine(hash, &rounded, sizeof(rounded));
+    }
+
+    void hashCombine(std::uint64_t& hash, const std::string& value)
+    {
+        // the terminating character separates consecutive strings
+        hashCombine(hash, value.c_str(), value.size() + 1);
+    }
+
+    void hashCombine(std::uint64_t& hash, const iDynTree::Transform& transform)
+    {
+        iDynTree::Matrix4x4 matrix = transform.asHomogeneousTransform();
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 4; j++)
+                hashCombine(hash, matrix(i, j));
+    }
+}
+
 WalkingIK::WalkingIK()
     : m_verbose(false)
     , m_lFootFrame("l_sole")
@@ -38,6 +105,14 @@ WalkingIK::WalkingIK()
     , m_prepared(false)
     , m_additionalRotationWeight(1.0)
     , m_jointRegularizationWeight(0.5)
+    , m_useDampedLeastSquares(false)
+    , m_dlsMaxIterations(10)
+    , m_dlsInitialDamping(1e-3)
+    , m_dlsConstraintsWeight(1e3)
+    , m_dlsTolerance(1e-6)
+    , m_dlsErrorTolerance(1e-3)
+    , m_solutionCacheTolerance(1e-3)
+    , m_solutionCacheSize(100)
 {}
 
 WalkingIK::~WalkingIK()
@@ -55,6 +130,77 @@ bool WalkingIK::initialize(yarp::os::Searchable& ikOption, const iDynTree::Model
     std::string rFootFrame = ikOption.check("right_foot_frame", yarp::os::Value("r_sole")).asString();
     std::string solverName = ikOption.check("solver_name", yarp::os::Value("mumps")).asString();
     m_additionalFrame = ikOption.check("additional_frame", yarp::os::Value("")).asString();
+
+    // solver used while walking. IPOPT is always used by computeIK (i.e. to prepare the robot)
+    std::string onlineSolver = ikOption.check("online_solver", yarp::os::Value("ipopt")).asString();
+    if(onlineSolver == "damped_least_squares")
+        m_useDampedLeastSquares = true;
+    else if(onlineSolver == "ipopt")
+        m_useDampedLeastSquares = false;
+    else
+    {
+        yError() << "[WalkingIK::initialize] Unknown online solver: " << onlineSolver
+                 << ". Available solvers: ipopt and damped_least_squares.";
+        return false;
+    }
+    m_dlsMaxIterations = ikOption.check("dls_max_iterations", yarp::os::Value(10)).asInt();
+    m_dlsInitialDamping = ikOption.check("dls_damping", yarp::os::Value(1e-3)).asDouble();
+    m_dlsConstraintsWeight = ikOption.check("dls_constraints_weight", yarp::os::Value(1e3)).asDouble();
+    m_dlsTolerance = ikOption.check("dls_tolerance", yarp::os::Value(1e-6)).asDouble();
+    m_dlsErrorTolerance = ikOption.check("dls_error_tolerance", yarp::os::Value(1e-3)).asDouble();
+    if(m_dlsMaxIterations < 1 || m_dlsInitialDamping <= 0 || m_dlsConstraintsWeight <= 0 || m_dlsErrorTolerance <= 0)
+    {
+        yError() << "[WalkingIK::initialize] dls_max_iterations, dls_damping, dls_constraints_weight "
+                 << "and dls_error_tolerance have to be positive.";
+        return false;
+    }
+    if(m_dlsTolerance < 0)
+    {
+        yError() << "[WalkingIK::initialize] dls_tolerance has to be non negative.";
+        return false;
+    }
+
+    // persistent cache of the solutions used to prepare the robot
+    std::string solutionCacheFile = ikOption.check("solution_cache_file", yarp::os::Value("")).asString();
+    m_solutionCacheTolerance = ikOption.check("solution_cache_tolerance", yarp::os::Value(1e-3)).asDouble();
+    int solutionCacheSize = ikOption.check("solution_cache_size", yarp::os::Value(100)).asInt();
+    if(m_solutionCacheTolerance <= 0 || solutionCacheSize <= 0)
+    {
+        yError() << "[WalkingIK::initialize] solution_cache_tolerance and solution_cache_size have to be positive.";
+        return false;
+    }
+    m_solutionCacheSize = static_cast<std::size_t>(solutionCacheSize);
+
+    // the cache file is searched in the context of the module (as the model). If it does not
+    // exist it is created in the home context path
+    m_solutionCacheFile.clear();
+    if(!solutionCacheFile.empty())
+    {
+        yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+        m_solutionCacheFile = rf.findFileByName(solutionCacheFile);
+        if(m_solutionCacheFile.empty())
+        {
+            std::string homeContextPath = rf.getHomeContextPath();
+            if(solutionCacheFile[0] == '/' || homeContextPath.empty())
+                m_solutionCacheFile = solutionCacheFile;
+            else
+            {
+                m_solutionCacheFile = homeContextPath + "/" + solutionCacheFile;
+                yarp::os::mkdir_p(m_solutionCacheFile.c_str(), 1);
+            }
+        }
+
+        if(m_verbose)
+            yInfo() << "[WalkingIK::initialize] Solution cache file: " << m_solutionCacheFile;
+    }
+    if(!m_solutionCacheFile.empty() && !loadSolutionCache())
+    {
+        yWarning() << "[WalkingIK::initialize] The solution cache file " << m_solutionCacheFile
+                   << " is not valid. It will be overwritten.";
+        m_solutionCache.clear();
+        m_solutionCacheOrder.clear();
+    }
+
     if(m_additionalFrame.size()!=0)
     {
         if(!iDynTree::parseRotationMatrix(ikOption, "additional_rotation", m_additionalRotation))
@@ -301,11 +447,137 @@ bool WalkingIK::prepareIK()
     dummyBaseVel.zero();
     dummygrav.zero();
 
+    if(!prepareDampedLeastSquares())
+    {
+        yError() << "WalkingIK: Unable to prepare the damped least squares solver.";
+        return false;
+    }
+
     m_prepared = true;
 
     return true;
 }
 
+bool WalkingIK::prepareDampedLeastSquares()
+{
+    const iDynTree::Model& model = lchecker.model();
+    const int numberOfDOFs = model.getNrOfDOFs();
+
+    // the left foot frame is the world frame
+    iDynTree::FrameIndex leftFootIndex = model.getFrameIndex(m_lFootFrame);
+    m_dlsRightFootIndex = model.getFrameIndex(m_rFootFrame);
+    if(leftFootIndex == iDynTree::FRAME_INVALID_INDEX || m_dlsRightFootIndex == iDynTree::FRAME_INVALID_INDEX)
+    {
+        yError() << "[WalkingIK::prepareDampedLeastSquares] Unable to find the feet frames in the reduced model.";
+        return false;
+    }
+    m_dlsBaseTransform = model.getFrameTransform(leftFootIndex).inverse();
+
+    m_dlsAdditionalFrameIndex = iDynTree::FRAME_INVALID_INDEX;
+    if(m_additionalFrame.size() != 0)
+    {
+        m_dlsAdditionalFrameIndex = model.getFrameIndex(m_additionalFrame);
+        if(m_dlsAdditionalFrameIndex == iDynTree::FRAME_INVALID_INDEX)
+        {
+            yError() << "[WalkingIK::prepareDampedLeastSquares] Unable to find the frame named: "
+                     << m_additionalFrame;
+            return false;
+        }
+    }
+
+    m_dlsJointLowerLimits.setConstant(numberOfDOFs, -std::numeric_limits<double>::infinity());
+    m_dlsJointUpperLimits.setConstant(numberOfDOFs, std::numeric_limits<double>::infinity());
+    for(iDynTree::JointIndex jointIdx = 0; jointIdx < static_cast<int>(model.getNrOfJoints()); ++jointIdx)
+    {
+        iDynTree::IJointConstPtr joint = model.getJoint(jointIdx);
+        if(!joint->hasPosLimits())
+            continue;
+
+        for(unsigned dof = 0; dof < joint->getNrOfDOFs(); ++dof)
+            joint->getPosLimits(dof, m_dlsJointLowerLimits(joint->getDOFsOffset() + dof),
+                                m_dlsJointUpperLimits(joint->getDOFsOffset() + dof));
+    }
+
+    // tasks: right foot (6), CoM (3) and additional rotation (3)
+    const int numberOfTasks = m_dlsAdditionalFrameIndex == iDynTree::FRAME_INVALID_INDEX ? 9 : 12;
+    m_dlsWeights.resize(numberOfTasks);
+    m_dlsWeights.head<9>().setConstant(m_dlsConstraintsWeight);
+    m_dlsWeights.tail(numberOfTasks - 9).setConstant(m_additionalRotationWeight);
+
+    m_dlsJointPositions.resize(numberOfDOFs);
+    m_dlsFrameJacobian.resize(6, numberOfDOFs + 6);
+    m_dlsCoMJacobian.resize(3, numberOfDOFs + 6);
+    m_dlsJacobian.resize(numberOfTasks, numberOfDOFs);
+    m_dlsWeightedJacobian.resize(numberOfTasks, numberOfDOFs);
+    m_dlsError.resize(numberOfTasks);
+    m_dlsHessian.resize(numberOfDOFs, numberOfDOFs);
+    m_dlsGradient.resize(numberOfDOFs);
+    m_dlsHessianLLT = Eigen::LLT<Eigen::MatrixXd>(numberOfDOFs);
+    m_dlsStep.resize(numberOfDOFs);
+    m_dlsSolution.resize(numberOfDOFs);
+    m_dlsCandidate.resize(numberOfDOFs);
+
+    return true;
+}
+
+double WalkingIK::evaluateDampedLeastSquaresError(const Eigen::Ref<const Eigen::VectorXd>& jointPositions)
+{
+    iDynTree::toEigen(m_dlsJointPositions) = jointPositions;
+    lchecker.setRobotState(m_dlsBaseTransform, m_dlsJointPositions, dummyBaseVel, dummyVel, dummygrav);
+
+    iDynTree::Transform rightFootTransform = lchecker.getWorldTransform(m_dlsRightFootIndex);
+    iDynTree::Position rightFootPosition = rightFootTransform.getPosition();
+    iDynTree::Position desiredRightFootPosition = m_dlsDesiredRightTransform.getPosition();
+    m_dlsError.segment<3>(0) = iDynTree::toEigen(desiredRightFootPosition) - iDynTree::toEigen(rightFootPosition);
+    m_dlsError.segment<3>(3) = rotationError(m_dlsDesiredRightTransform.getRotation(),
+                                             rightFootTransform.getRotation());
+
+    iDynTree::Position comPosition = lchecker.getCenterOfMassPosition();
+    m_dlsError.segment<3>(6) = iDynTree::toEigen(m_dlsDesiredCoMPosition) - iDynTree::toEigen(comPosition);
+
+    if(m_dlsAdditionalFrameIndex != iDynTree::FRAME_INVALID_INDEX)
+        m_dlsError.segment<3>(9) = rotationError(m_dlsDesiredAdditionalRotation,
+                                                 lchecker.getWorldTransform(m_dlsAdditionalFrameIndex).getRotation());
+
+    return m_dlsError.dot(m_dlsWeights.cwiseProduct(m_dlsError))
+        + m_jointRegularizationWeight * (jointPositions - iDynTree::toEigen(m_jointRegularization)).squaredNorm();
+}
+
+void WalkingIK::setDampedLeastSquaresTargets(const iDynTree::Transform& leftTransform,
+                                             const iDynTree::Transform& rightTransform,
+                                             const iDynTree::Position& comPosition)
+{
+    // all the targets are expressed in the left foot frame
+    m_dlsDesiredRightTransform = leftTransform.inverse() * rightTransform;
+    m_dlsDesiredCoMPosition = leftTransform.inverse() * comPosition;
+    if(m_additionalFrame.size() != 0)
+    {
+        m_dlsDesiredAdditionalRotation = leftTransform.getRotation().inverse() * m_inertial_R_world.inverse()
+            * m_additionalRotation;
+        m_dlsWeights.tail<3>().setConstant(m_additionalRotationWeight);
+    }
+}
+
+void WalkingIK::evaluateDampedLeastSquaresJacobian()
+{
+    // the base (left foot) is fixed, only the joint columns are considered
+    const int numberOfDOFs = m_dlsJacobian.cols();
+
+    lchecker.getFrameFreeFloatingJacobian(m_dlsRightFootIndex, m_dlsFrameJacobian);
+    m_dlsJacobian.topRows<6>() = iDynTree::toEigen(m_dlsFrameJacobian).rightCols(numberOfDOFs);
+
+    lchecker.getCenterOfMassJacobian(m_dlsCoMJacobian);
+    m_dlsJacobian.middleRows<3>(6) = iDynTree::toEigen(m_dlsCoMJacobian).rightCols(numberOfDOFs);
+
+    if(m_dlsAdditionalFrameIndex != iDynTree::FRAME_INVALID_INDEX)
+    {
+        lchecker.getFrameFreeFloatingJacobian(m_dlsAdditionalFrameIndex, m_dlsFrameJacobian);
+        m_dlsJacobian.middleRows<3>(9) = iDynTree::toEigen(m_dlsFrameJacobian).bottomRightCorner(3, numberOfDOFs);
+    }
+
+    m_dlsWeightedJacobian = m_dlsWeights.asDiagonal() * m_dlsJacobian;
+}
+
 bool WalkingIK::updateAdditionalRotation(const iDynTree::Rotation& additionalRotation)
 {
     if(m_additionalFrame.size() == 0)
@@ -409,12 +681,13 @@ bool WalkingIK::computeIK(const iDynTree::Transform& leftTransform, const iDynTr
 
     m_ik.getReducedSolution(baseTransform, m_qResult);
 
-    lchecker.setRobotState(m_baseTransform, m_qResult, dummyBaseVel, dummyVel,dummygrav);
+    // the errors are evaluated only to be printed
+    if (m_verbose) {
+        lchecker.setRobotState(m_baseTransform, m_qResult, dummyBaseVel, dummyVel,dummygrav);
 
-    iDynTree::Position comError = desiredCoMPosition - lchecker.getCenterOfMassPosition();
-    iDynTree::Position footError = desiredRightTransform.getPosition() - lchecker.getRelativeTransform(m_lFootFrame, m_rFootFrame).getPosition();
+        iDynTree::Position comError = desiredCoMPosition - lchecker.getCenterOfMassPosition();
+        iDynTree::Position footError = desiredRightTransform.getPosition() - lchecker.getRelativeTransform(m_lFootFrame, m_rFootFrame).getPosition();
 
-    if (m_verbose) {
         yInfo() << "CoM error position: "<< comError.toString();
         yInfo() << "Foot position error: "<<footError.toString();
     }
@@ -425,6 +698,317 @@ bool WalkingIK::computeIK(const iDynTree::Transform& leftTransform, const iDynTr
     return true;
 }
 
+bool WalkingIK::computeIKDampedLeastSquares(const iDynTree::Transform& leftTransform,
+                                            const iDynTree::Transform& rightTransform,
+                                            const iDynTree::Position& comPosition,
+                                            iDynTree::VectorDynSize& result)
+{
+    if(!m_prepared){
+        if(!prepareIK()){
+            yError()<<"WalkingIK: Error in the preparation phase.";
+            return false;
+        }
+    }
+
+    setDampedLeastSquaresTargets(leftTransform, rightTransform, comPosition);
+
+    // warm start
+    m_dlsSolution = iDynTree::toEigen(m_guess);
+    double cost = evaluateDampedLeastSquaresError(m_dlsSolution);
+    double damping = m_dlsInitialDamping;
+
+    for(int i = 0; i < m_dlsMaxIterations; i++)
+    {
+        // (J' W J + (damping + w_r) I) dq = J' W e + w_r (q_reg - q)
+        evaluateDampedLeastSquaresJacobian();
+        m_dlsHessian.noalias() = m_dlsJacobian.transpose() * m_dlsWeightedJacobian;
+        m_dlsHessian.diagonal().array() += damping + m_jointRegularizationWeight;
+        m_dlsGradient.noalias() = m_dlsWeightedJacobian.transpose() * m_dlsError;
+        m_dlsGradient += m_jointRegularizationWeight * (iDynTree::toEigen(m_jointRegularization) - m_dlsSolution);
+
+        m_dlsHessianLLT.compute(m_dlsHessian);
+        if(m_dlsHessianLLT.info() != Eigen::Success)
+        {
+            yError() << "[WalkingIK::computeIKDampedLeastSquares] Unable to factorize the hessian matrix.";
+            return false;
+        }
+        m_dlsStep = m_dlsGradient;
+        m_dlsHessianLLT.solveInPlace(m_dlsStep);
+
+        if(m_dlsStep.norm() < m_dlsTolerance)
+            break;
+
+        // the joint limits are enforced projecting the candidate solution
+        m_dlsCandidate = (m_dlsSolution + m_dlsStep).cwiseMax(m_dlsJointLowerLimits).cwiseMin(m_dlsJointUpperLimits);
+        double candidateCost = evaluateDampedLeastSquaresError(m_dlsCandidate);
+        if(candidateCost < cost)
+        {
+            m_dlsSolution.swap(m_dlsCandidate);
+            cost = candidateCost;
+            damping /= 10;
+        }
+        else
+        {
+            // the kinematics is restored to the current solution
+            damping *= 10;
+            evaluateDampedLeastSquaresError(m_dlsSolution);
+        }
+    }
+
+    if (m_verbose) {
+        yInfo() << "Foot position error: " << m_dlsError.head<3>().norm()
+                << " CoM position error: " << m_dlsError.segment<3>(6).norm();
+    }
+
+    // m_dlsError refers to m_dlsSolution. The right foot and CoM tasks are constraints in the IPOPT problem
+    double error = m_dlsError.head<9>().cwiseAbs().maxCoeff();
+    if(error > m_dlsErrorTolerance)
+    {
+        yError() << "[WalkingIK::computeIKDampedLeastSquares] The right foot and CoM targets are not reached "
+                 << "after " << m_dlsMaxIterations << " iterations. Error: " << error;
+        return false;
+    }
+
+    iDynTree::toEigen(m_qResult) = m_dlsSolution;
+    result = m_qResult;
+    m_guess = m_qResult;
+
+    return true;
+}
+
+bool WalkingIK::computeIKOnline(const iDynTree::Transform& leftTransform,
+                                const iDynTree::Transform& rightTransform,
+                                const iDynTree::Position& comPosition,
+                                iDynTree::VectorDynSize& result)
+{
+    if(m_useDampedLeastSquares)
+        return computeIKDampedLeastSquares(leftTransform, rightTransform, comPosition, result);
+
+    return computeIK(leftTransform, rightTransform, comPosition, result);
+}
+
+bool WalkingIK::computeCachedIK(const iDynTree::Transform& leftTransform,
+                                const iDynTree::Transform& rightTransform,
+                                const iDynTree::Position& comPosition,
+                                iDynTree::VectorDynSize& result)
+{
+    if(m_solutionCacheFile.empty())
+        return computeIK(leftTransform, rightTransform, comPosition, result);
+
+    if(!m_prepared){
+        if(!prepareIK()){
+            yError()<<"WalkingIK: Error in the preparation phase.";
+            return false;
+        }
+    }
+
+    setDampedLeastSquaresTargets(leftTransform, rightTransform, comPosition);
+    std::uint64_t key = evaluateSolutionCacheKey();
+
+    auto cachedSolution = m_solutionCache.find(key);
+    if(cachedSolution != m_solutionCache.end() && cachedSolution->second.size() == m_qResult.size())
+    {
+        Eigen::Map<const Eigen::VectorXd> solution(cachedSolution->second.data(),
+                                                   cachedSolution->second.size());
+
+        // a single forward kinematics evaluation validates the right foot and CoM targets
+        evaluateDampedLeastSquaresError(solution);
+        double error = m_dlsError.head<9>().cwiseAbs().maxCoeff();
+        if(error < m_solutionCacheTolerance)
+        {
+            if(m_verbose)
+                yInfo() << "[WalkingIK::computeCachedIK] Using the cached solution. Error: " << error;
+
+            iDynTree::toEigen(m_qResult) = solution;
+            result = m_qResult;
+            m_guess = m_qResult;
+            return true;
+        }
+
+        yWarning() << "[WalkingIK::computeCachedIK] The cached solution does not satisfy the targets (error: "
+                   << error << "). It is used as initial guess.";
+        iDynTree::toEigen(m_guess) = solution;
+    }
+
+    if(!computeIK(leftTransform, rightTransform, comPosition, result))
+        return false;
+
+    addSolutionToCache(key, std::vector<double>(result.data(), result.data() + result.size()));
+    if(!saveSolutionCache())
+        yWarning() << "[WalkingIK::computeCachedIK] Unable to save the solution in " << m_solutionCacheFile;
+
+    return true;
+}
+
+std::uint64_t WalkingIK::evaluateSolutionCacheKey()
+{
+    const iDynTree::Model& model = lchecker.model();
+
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    // reduced model
+    for(iDynTree::JointIndex jointIdx = 0; jointIdx < static_cast<int>(model.getNrOfJoints()); ++jointIdx)
+    {
+        iDynTree::IJointConstPtr joint = model.getJoint(jointIdx);
+        hashCombine(hash, model.getJointName(jointIdx));
+        hashCombine(hash, joint->getRestTransform(joint->getSecondAttachedLink(), joint->getFirstAttachedLink()));
+        for(unsigned dof = 0; dof < joint->getNrOfDOFs(); ++dof)
+        {
+            iDynTree::Vector6 motionSubspace = joint->getMotionSubspaceVector(dof, joint->getSecondAttachedLink(),
+                                                                             joint->getFirstAttachedLink()).asVector();
+            for(unsigned int i = 0; i < 6; i++)
+                hashCombine(hash, motionSubspace(i));
+
+            double jointMin = 0, jointMax = 0;
+            if(joint->hasPosLimits())
+                joint->getPosLimits(dof, jointMin, jointMax);
+            hashCombine(hash, jointMin);
+            hashCombine(hash, jointMax);
+        }
+    }
+
+    for(iDynTree::LinkIndex linkIdx = 0; linkIdx < static_cast<int>(model.getNrOfLinks()); ++linkIdx)
+    {
+        const iDynTree::SpatialInertia& inertia = model.getLink(linkIdx)->getInertia();
+        iDynTree::Position centerOfMass = inertia.getCenterOfMass();
+        hashCombine(hash, model.getLinkName(linkIdx));
+        hashCombine(hash, inertia.getMass());
+        for(unsigned int i = 0; i < 3; i++)
+            hashCombine(hash, centerOfMass(i));
+    }
+
+    hashCombine(hash, m_lFootFrame);
+    hashCombine(hash, m_dlsBaseTransform);
+    hashCombine(hash, m_rFootFrame);
+    hashCombine(hash, model.getFrameTransform(m_dlsRightFootIndex));
+    hashCombine(hash, m_additionalFrame);
+    if(m_dlsAdditionalFrameIndex != iDynTree::FRAME_INVALID_INDEX)
+        hashCombine(hash, model.getFrameTransform(m_dlsAdditionalFrameIndex));
+
+    // targets (left foot frame)
+    hashCombine(hash, m_dlsDesiredRightTransform);
+    for(unsigned int i = 0; i < 3; i++)
+        hashCombine(hash, m_dlsDesiredCoMPosition(i));
+    if(m_dlsAdditionalFrameIndex != iDynTree::FRAME_INVALID_INDEX)
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                hashCombine(hash, m_dlsDesiredAdditionalRotation(i, j));
+
+    // regularization
+    for(unsigned int i = 0; i < m_jointRegularization.size(); i++)
+        hashCombine(hash, m_jointRegularization(i));
+    hashCombine(hash, m_jointRegularizationWeight);
+    hashCombine(hash, m_additionalRotationWeight);
+
+    return hash;
+}
+
+void WalkingIK::addSolutionToCache(const std::uint64_t& key, std::vector<double>&& solution)
+{
+    // the key is moved to the end of the list (newest solution)
+    auto position = std::find(m_solutionCacheOrder.begin(), m_solutionCacheOrder.end(), key);
+    if(position != m_solutionCacheOrder.end())
+        m_solutionCacheOrder.erase(position);
+    m_solutionCacheOrder.push_back(key);
+    m_solutionCache[key] = std::move(solution);
+
+    // the oldest solutions are evicted
+    while(m_solutionCacheOrder.size() > m_solutionCacheSize)
+    {
+        m_solutionCache.erase(m_solutionCacheOrder.front());
+        m_solutionCacheOrder.pop_front();
+    }
+}
+
+bool WalkingIK::loadSolutionCache()
+{
+    m_solutionCache.clear();
+    m_solutionCacheOrder.clear();
+
+    std::ifstream file(m_solutionCacheFile);
+    if(!file.is_open())
+    {
+        yInfo() << "[WalkingIK::loadSolutionCache] The file " << m_solutionCacheFile
+                << " does not exist. It will be created.";
+        return true;
+    }
+
+    // each line contains the key (hexadecimal) followed by the joint positions. The lines are
+    // sorted from the oldest to the newest solution
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        std::uint64_t key;
+        if(!(stream >> std::hex >> key))
+        {
+            yError() << "[WalkingIK::loadSolutionCache] Unable to read the key of the line: " << line;
+            return false;
+        }
+        stream >> std::dec;
+
+        std::vector<double> solution;
+        double value;
+        while(stream >> value)
+            solution.push_back(value);
+
+        if(!stream.eof())
+        {
+            yError() << "[WalkingIK::loadSolutionCache] Unable to read the solution of the line: " << line;
+            return false;
+        }
+
+        addSolutionToCache(key, std::move(solution));
+    }
+
+    if(m_verbose)
+        yInfo() << "[WalkingIK::loadSolutionCache] Number of cached solutions: " << m_solutionCache.size();
+
+    return true;
+}
+
+bool WalkingIK::saveSolutionCache() const
+{
+    // the cache is written in a temporary file and then renamed to not corrupt it if the module is closed
+    const std::string temporaryFile = m_solutionCacheFile + ".tmp";
+    {
+        std::ofstream file(temporaryFile, std::ofstream::trunc);
+        if(!file.is_open())
+        {
+            yError() << "[WalkingIK::saveSolutionCache] Unable to open the file " << temporaryFile;
+            return false;
+        }
+
+        file << "# WalkingIK solution cache: <key> <joint positions [rad]>\n";
+        file << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for(const std::uint64_t& key : m_solutionCacheOrder)
+        {
+            file << std::hex << key << std::dec;
+            for(double value : m_solutionCache.at(key))
+                file << " " << value;
+            file << "\n";
+        }
+
+        if(!file.good())
+        {
+            yError() << "[WalkingIK::saveSolutionCache] Unable to write the file " << temporaryFile;
+            return false;
+        }
+    }
+
+    if(std::rename(temporaryFile.c_str(), m_solutionCacheFile.c_str()) != 0)
+    {
+        yError() << "[WalkingIK::saveSolutionCache] Unable to rename " << temporaryFile
+                 << " to " << m_solutionCacheFile;
+        return false;
+    }
+
+    return true;
+}
+
 const std::string WalkingIK::getLeftFootFrame() const
 {
     return m_lFootFrame;
@@ -13,6 +13,8 @@
 
 // std
 #include <cmath>
+#include <string>
+#include <vector>
 
 // YARP
 #include <yarp/os/LogStream.h>
@@ -64,6 +66,21 @@ bool WalkingQPIK::initialize(const yarp::os::Searchable &config,
         m_retargetingType = RetargetingType::none;
 
     m_useJointsLimitsConstraint = config.check("use_joint_limits_constraint", yarp::os::Value(false)).asBool();
+    m_useLeastSquaresFastPath = config.check("use_least_squares_fast_path", yarp::os::Value(false)).asBool();
+
+    std::string formulation = config.check("qp_ik_formulation", yarp::os::Value("full")).asString();
+    if(formulation != "full" && formulation != "reduced")
+    {
+        yError() << "[initialize] The qp_ik_formulation " << formulation << " is not supported. "
+                 << "Please use full or reduced.";
+        return false;
+    }
+    m_useReducedFormulation = formulation == "reduced";
+    if(m_useReducedFormulation && !isReducedFormulationSupported())
+    {
+        yError() << "[initialize] The reduced formulation is not supported by the chosen QP solver.";
+        return false;
+    }
 
     // TODO in the future the number of constraints should be added inside
     // the configuration file
@@ -92,7 +109,7 @@ bool WalkingQPIK::initialize(const yarp::os::Searchable &config,
 
     // resize Jacobians matrices
     m_comJacobian.resize(3, m_numberOfVariables);
-    m_neckJacobian.resize(3, m_numberOfVariables);
+    m_neckJacobian.resize(6, m_numberOfVariables);
     m_leftFootJacobian.resize(6, m_numberOfVariables);
     m_rightFootJacobian.resize(6, m_numberOfVariables);
     m_leftHandJacobian.resize(6, m_numberOfVariables);
@@ -111,6 +128,28 @@ bool WalkingQPIK::initialize(const yarp::os::Searchable &config,
 
     initializeSolverSpecificMatrices();
 
+    if(!initializeConstraintsMatrixPattern())
+    {
+        yError() << "[initialize] Unable to initialize the sparsity pattern of the constraint matrix.";
+        return false;
+    }
+    m_equalityConstraintsMatrix = Eigen::MatrixXd::Zero(m_numberOfTaskConstraints, m_numberOfVariables);
+
+    if(m_useReducedFormulation)
+    {
+        // the stance foot constraint is removed from the problem
+        m_stanceBaseJacobianLU = Eigen::PartialPivLU<Eigen::MatrixXd>(6);
+        m_baseEliminationMatrix = Eigen::MatrixXd::Zero(m_numberOfVariables, m_actuatedDOFs);
+        m_baseEliminationMatrix.bottomRows(m_actuatedDOFs).setIdentity();
+        m_baseEliminationOffset = Eigen::VectorXd::Zero(m_numberOfVariables);
+        m_hessianTimesEliminationMatrix = Eigen::MatrixXd::Zero(m_numberOfVariables, m_actuatedDOFs);
+        m_auxiliaryGradient = Eigen::VectorXd::Zero(m_numberOfVariables);
+        m_reducedHessian = Eigen::MatrixXd::Zero(m_actuatedDOFs, m_actuatedDOFs);
+        m_reducedGradient = Eigen::VectorXd::Zero(m_actuatedDOFs);
+        m_reducedEqualityConstraintsMatrix = Eigen::MatrixXd::Zero(m_numberOfTaskConstraints - 6, m_actuatedDOFs);
+        m_reducedEqualityConstraintsVector = Eigen::VectorXd::Zero(m_numberOfTaskConstraints - 6);
+    }
+
     if(m_retargetingType == RetargetingType::handRetargeting)
         if(!initializeHandRetargeting(config))
         {
@@ -133,6 +172,10 @@ bool WalkingQPIK::initialize(const yarp::os::Searchable &config,
 
     instantiateSolver();
 
+    if(m_useLeastSquaresFastPath)
+        m_leastSquaresSolver = std::make_unique<GoldfarbIdnaniSolver>(m_numberOfVariables,
+                                                                      m_numberOfTaskConstraints);
+
     return true;
 }
 
@@ -303,6 +346,9 @@ bool WalkingQPIK::initializeHandRetargeting(const yarp::os::Searchable& config)
     m_handWeightSmoother = std::make_unique<iCub::ctrl::minJerkTrajGen>(6, dT, smoothingTime);
     m_handWeightSmoother->init(m_handWeightStanceVector);
 
+    m_currentHandWeight.resize(6);
+    updateSmoothedWeights();
+
     return true;
 }
 
@@ -382,6 +428,10 @@ bool WalkingQPIK::initializeJointRetargeting(const yarp::os::Searchable& config)
     m_torsoWeightSmoother = std::make_unique<iCub::ctrl::minJerkTrajGen>(1, dT, smoothingTime);
     m_torsoWeightSmoother->init(yarp::sig::Vector(1, m_torsoWeightStance));
 
+    m_currentJointRegularizationWeight.resize(m_actuatedDOFs);
+    m_currentJointRetargetingWeight.resize(m_actuatedDOFs);
+    updateSmoothedWeights();
+
     return true;
 }
 
@@ -400,6 +450,33 @@ bool WalkingQPIK::setRobotState(WalkingFK& kinDynWrapper)
     return true;
 }
 
+bool WalkingQPIK::setJacobians(WalkingFK& kinDynWrapper)
+{
+    // the jacobians are evaluated directly in the matrices used by the solver (the kinematic tree
+    // is traversed only once)
+    bool ok = kinDynWrapper.computeTaskJacobians(m_leftFootJacobian, m_rightFootJacobian,
+                                                 m_neckJacobian, m_comJacobian);
+
+    if(m_retargetingType == RetargetingType::handRetargeting)
+    {
+        ok &= kinDynWrapper.getLeftHandJacobian(m_leftHandJacobian);
+        ok &= kinDynWrapper.getRightHandJacobian(m_rightHandJacobian);
+    }
+
+    if(!ok)
+    {
+        yError() << "[setJacobians] Unable to evaluate the jacobians.";
+        return false;
+    }
+
+    return true;
+}
+
+void WalkingQPIK::setStanceFoot(const bool& isLeftFootStance)
+{
+    m_isLeftFootStance = isLeftFootStance;
+}
+
 void WalkingQPIK::setPhase(const bool& isStancePhase)
 {
     if(isStancePhase)
@@ -426,6 +503,21 @@ void WalkingQPIK::setPhase(const bool& isStancePhase)
             m_jointRegularizationWeightSmoother->computeNextValues(m_jointRegularizationWeightWalking);
         }
     }
+
+    updateSmoothedWeights();
+}
+
+void WalkingQPIK::updateSmoothedWeights()
+{
+    if(m_retargetingType == RetargetingType::handRetargeting)
+        iDynTree::toEigen(m_currentHandWeight) = iDynTree::toEigen(m_handWeightSmoother->getPos());
+
+    else if(m_retargetingType == RetargetingType::jointRetargeting)
+    {
+        m_currentTorsoWeight = m_torsoWeightSmoother->getPos()(0);
+        iDynTree::toEigen(m_currentJointRetargetingWeight) = iDynTree::toEigen(m_jointRetargetingWeightSmoother->getPos());
+        iDynTree::toEigen(m_currentJointRegularizationWeight) = iDynTree::toEigen(m_jointRegularizationWeightSmoother->getPos());
+    }
 }
 
 void WalkingQPIK::setDesiredNeckOrientation(const iDynTree::Rotation& desiredNeckOrientation)
@@ -541,8 +633,7 @@ bool WalkingQPIK::setNeckJacobian(const iDynTree::MatrixDynSize& neckJacobian)
         return false;
     }
 
-    iDynTree::toEigen(m_neckJacobian) = iDynTree::toEigen(neckJacobian).block(3, 0, 3,
-                                                                              m_actuatedDOFs + 6);
+    m_neckJacobian = neckJacobian;
 
     return true;
 }
@@ -627,36 +718,148 @@ void WalkingQPIK::evaluateHessianMatrix()
     auto hessianDense(iDynTree::toEigen(m_hessianDense));
 
     // if the joint retargeting is enable the weights of the cost function are time variant
+    // the jacobians of the neck (only the angular part is used) and of the CoM have only three rows.
+    // The products are evaluated coefficient-wise (lazyProduct and rank one updates) to avoid the
+    // memory allocated by the general matrix-matrix product
+    auto neckJacobian(iDynTree::toEigen(m_neckJacobian).bottomRows<3>());
     if (m_retargetingType != RetargetingType::jointRetargeting)
     {
-        hessianDense = iDynTree::toEigen(m_neckJacobian).transpose() * m_neckWeight * iDynTree::toEigen(m_neckJacobian);
+        hessianDense.noalias() = m_neckWeight * neckJacobian.transpose().lazyProduct(neckJacobian);
         hessianDense.bottomRightCorner(m_actuatedDOFs, m_actuatedDOFs) += iDynTree::toEigen(m_jointRegularizationWeights).asDiagonal();
     }
     else
     {
-        hessianDense = iDynTree::toEigen(m_neckJacobian).transpose() *
-            m_torsoWeightSmoother->getPos()(0) *
-            iDynTree::toEigen(m_neckJacobian);
+        hessianDense.noalias() = m_currentTorsoWeight * neckJacobian.transpose().lazyProduct(neckJacobian);
         hessianDense.bottomRightCorner(m_actuatedDOFs, m_actuatedDOFs) +=
-            (iDynTree::toEigen(m_jointRegularizationWeightSmoother->getPos()) +
-             iDynTree::toEigen(m_jointRetargetingWeightSmoother->getPos())).asDiagonal();
+            (iDynTree::toEigen(m_currentJointRegularizationWeight) +
+             iDynTree::toEigen(m_currentJointRetargetingWeight)).asDiagonal();
     }
 
     if(m_retargetingType == RetargetingType::handRetargeting)
     {
         // think about the possibility to project in the null space the joint regularization
         hessianDense +=  iDynTree::toEigen(m_leftHandJacobian).transpose()
-            * iDynTree::toEigen(m_handWeightSmoother->getPos()).asDiagonal()
+            * iDynTree::toEigen(m_currentHandWeight).asDiagonal()
             * iDynTree::toEigen(m_leftHandJacobian)
             + iDynTree::toEigen(m_rightHandJacobian).transpose()
-            * iDynTree::toEigen(m_handWeightSmoother->getPos()).asDiagonal()
+            * iDynTree::toEigen(m_currentHandWeight).asDiagonal()
             * iDynTree::toEigen(m_rightHandJacobian);
     }
 
     if(!m_useCoMAsConstraint)
     {
-        hessianDense += iDynTree::toEigen(m_comJacobian).transpose() *
-            iDynTree::toEigen(m_comWeight).asDiagonal() * iDynTree::toEigen(m_comJacobian);
+        auto comJacobian(iDynTree::toEigen(m_comJacobian));
+        for(int i = 0; i < 3; i++)
+            hessianDense.noalias() += (m_comWeight(i) * comJacobian.row(i).transpose()) * comJacobian.row(i);
+    }
+}
+
+void WalkingQPIK::initializeHessianSparsityPattern()
+{
+    // a variable affects a task if the related column of the jacobian is different from zero
+    Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> isNonZero(m_numberOfVariables, m_numberOfVariables);
+    isNonZero.setConstant(false);
+
+    // the floating base is the stance foot, so the path between a task and the base changes with
+    // the stance foot. The support of the feet jacobians contains the joints of both legs (the path
+    // between the two feet) whatever the stance foot is, and it is added to the support of each task
+    auto leftFootJacobian(iDynTree::toEigen(m_leftFootJacobian));
+    auto rightFootJacobian(iDynTree::toEigen(m_rightFootJacobian));
+    std::vector<bool> isInFeetSupport(m_numberOfVariables);
+    for(int i = 0; i < m_numberOfVariables; i++)
+        isInFeetSupport[i] = !leftFootJacobian.col(i).isZero(0.0) || !rightFootJacobian.col(i).isZero(0.0);
+
+    auto addTask = [this, &isNonZero, &isInFeetSupport](const auto& jacobianEigen) {
+        std::vector<int> support;
+        for(int i = 0; i < m_numberOfVariables; i++)
+            if(isInFeetSupport[i] || !jacobianEigen.col(i).isZero(0.0))
+                support.push_back(i);
+
+        for(int i : support)
+            for(int j : support)
+                isNonZero(i, j) = true;
+    };
+
+    addTask(iDynTree::toEigen(m_neckJacobian).bottomRows<3>());
+
+    if(m_retargetingType == RetargetingType::handRetargeting)
+    {
+        addTask(iDynTree::toEigen(m_leftHandJacobian));
+        addTask(iDynTree::toEigen(m_rightHandJacobian));
+    }
+
+    // the CoM depends on all the variables even if a column of the jacobian may vanish in
+    // some configurations. In this case the pattern is dense
+    m_isHessianPatternDense = !m_useCoMAsConstraint;
+    if(m_isHessianPatternDense)
+        isNonZero.setConstant(true);
+
+    // joint regularization and joint retargeting. The diagonal of the base is added to
+    // guarantee that each column of the matrix is not empty
+    isNonZero.diagonal().setConstant(true);
+
+    // only the upper triangular part is stored
+    std::vector<Eigen::Triplet<double>> triplets;
+    for(int j = 0; j < m_numberOfVariables; j++)
+        for(int i = 0; i <= j; i++)
+            if(isNonZero(i, j))
+                triplets.emplace_back(i, j, 0.0);
+
+    m_hessianSparse.resize(m_numberOfVariables, m_numberOfVariables);
+    m_hessianSparse.setFromTriplets(triplets.begin(), triplets.end());
+    m_hessianSparse.makeCompressed();
+
+    evaluateHessianMatrixSparse();
+}
+
+void WalkingQPIK::evaluateHessianMatrixSparse()
+{
+    // the values are stored column by column (CSC format)
+    double* values = m_hessianSparse.valuePtr();
+    const int* rows = m_hessianSparse.innerIndexPtr();
+    const int* columnsBegin = m_hessianSparse.outerIndexPtr();
+
+    if(m_isHessianPatternDense)
+    {
+        // the dense hessian matrix is symmetric, the column j of its upper triangular part
+        // is stored contiguously in the row j of the row major matrix
+        auto hessianDense(iDynTree::toEigen(m_hessianDense));
+        for(int j = 0; j < m_numberOfVariables; j++)
+            Eigen::Map<Eigen::VectorXd>(values + columnsBegin[j], j + 1) = hessianDense.row(j).head(j + 1).transpose();
+
+        return;
+    }
+
+    // only the entries of the pattern are evaluated from the jacobians of the tasks
+    const bool useHandRetargeting = m_retargetingType == RetargetingType::handRetargeting;
+    const bool useJointRetargeting = m_retargetingType == RetargetingType::jointRetargeting;
+    const double neckWeight = useJointRetargeting ? m_currentTorsoWeight : m_neckWeight;
+    auto neckJacobian(iDynTree::toEigen(m_neckJacobian).bottomRows<3>());
+    auto leftHandJacobian(iDynTree::toEigen(m_leftHandJacobian));
+    auto rightHandJacobian(iDynTree::toEigen(m_rightHandJacobian));
+    auto handWeight(iDynTree::toEigen(m_currentHandWeight));
+
+    for(int j = 0; j < m_numberOfVariables; j++)
+    {
+        for(int k = columnsBegin[j]; k < columnsBegin[j + 1]; k++)
+        {
+            const int i = rows[k];
+            values[k] = neckWeight * neckJacobian.col(i).dot(neckJacobian.col(j));
+
+            if(useHandRetargeting)
+                values[k] += handWeight.dot(leftHandJacobian.col(i).cwiseProduct(leftHandJacobian.col(j)))
+                    + handWeight.dot(rightHandJacobian.col(i).cwiseProduct(rightHandJacobian.col(j)));
+        }
+    }
+
+    // the diagonal element is the last one of each column of the upper triangular part
+    for(int j = 6; j < m_numberOfVariables; j++)
+    {
+        const int k = columnsBegin[j + 1] - 1;
+        if(useJointRetargeting)
+            values[k] += m_currentJointRegularizationWeight(j - 6) + m_currentJointRetargetingWeight(j - 6);
+        else
+            values[k] += m_jointRegularizationWeights(j - 6);
     }
 }
 
@@ -664,7 +867,7 @@ void WalkingQPIK::evaluateGradientVector()
 {
     auto gradient(iDynTree::toEigen(m_gradient));
 
-    auto neckJacobian(iDynTree::toEigen(m_neckJacobian));
+    auto neckJacobian(iDynTree::toEigen(m_neckJacobian).bottomRows<3>());
 
     auto jointRegularizationGains(iDynTree::toEigen(m_jointRegularizationGains));
     auto jointPosition(iDynTree::toEigen(m_jointPosition));
@@ -682,7 +885,7 @@ void WalkingQPIK::evaluateGradientVector()
     {
         auto jointRegularizationGainsTimeWeights(iDynTree::toEigen(m_jointRegularizationGainsTimeWeights));
 
-        gradient = -neckJacobian.transpose() * m_neckWeight * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)));
+        gradient.noalias() = -neckJacobian.transpose() * m_neckWeight * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)));
 
         // g = Weight * K_p * (regularizationTerm - jointPosition)
         // Weight  and K_p are two diagonal matrices so their product can be also evaluated multiplying component-wise
@@ -694,18 +897,16 @@ void WalkingQPIK::evaluateGradientVector()
         auto jointRetargetingGains(iDynTree::toEigen(m_jointRetargetingGains));
         auto jointRetargetingValues(iDynTree::toEigen(m_retargetingJointValue));
 
-        gradient = -neckJacobian.transpose() * m_torsoWeightSmoother->getPos()(0)
+        gradient.noalias() = -neckJacobian.transpose() * m_currentTorsoWeight
             * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)));
 
         // g = Weight * K_p * (regularizationTerm - jointPosition)
         // Weight  and K_p are two diagonal matrices so their product can be also evaluated multiplying component-wise
         // the elements of the vectors and then generating the diagonal matrix
-        const auto& jointRegularizationWeight = m_jointRegularizationWeightSmoother->getPos();
-        gradient.tail(m_actuatedDOFs) += (-jointRegularizationGains.cwiseProduct(iDynTree::toEigen(jointRegularizationWeight))).asDiagonal()
+        gradient.tail(m_actuatedDOFs) += (-jointRegularizationGains.cwiseProduct(iDynTree::toEigen(m_currentJointRegularizationWeight))).asDiagonal()
             * (regularizationTerm - jointPosition);
 
-        const auto& jointRetargetingWeight = m_jointRetargetingWeightSmoother->getPos();
-        gradient.tail(m_actuatedDOFs) += (-jointRetargetingGains.cwiseProduct(iDynTree::toEigen(jointRetargetingWeight))).asDiagonal()
+        gradient.tail(m_actuatedDOFs) += (-jointRetargetingGains.cwiseProduct(iDynTree::toEigen(m_currentJointRetargetingWeight))).asDiagonal()
             * (jointRetargetingValues - jointPosition);
     }
 
@@ -763,25 +964,173 @@ void WalkingQPIK::evaluateGradientVector()
 
 
         gradient += - iDynTree::toEigen(m_leftHandJacobian).transpose()
-            * iDynTree::toEigen(m_handWeightSmoother->getPos()).asDiagonal() * (-iDynTree::toEigen(m_leftHandCorrection))
+            * iDynTree::toEigen(m_currentHandWeight).asDiagonal() * (-iDynTree::toEigen(m_leftHandCorrection))
             - iDynTree::toEigen(m_rightHandJacobian).transpose()
-            * iDynTree::toEigen(m_handWeightSmoother->getPos()).asDiagonal() * (-iDynTree::toEigen(m_rightHandCorrection));
+            * iDynTree::toEigen(m_currentHandWeight).asDiagonal() * (-iDynTree::toEigen(m_rightHandCorrection));
     }
 
     if(!m_useCoMAsConstraint)
     {
-        gradient += -comJacobian.transpose() * comWeight.asDiagonal() *
-            (desiredComVelocity - m_kCom * (comPosition - desiredComPosition));
+        gradient.noalias() -= comJacobian.transpose() * (comWeight.asDiagonal() *
+            (desiredComVelocity - m_kCom * (comPosition - desiredComPosition)));
     }
 }
 
+bool WalkingQPIK::initializeConstraintsMatrixPattern()
+{
+    // the constraints are saved in the following order (lf, rf, com (if it is present))
+    m_numberOfTaskConstraints = 6 + 6;
+    if(m_useCoMAsConstraint)
+        m_numberOfTaskConstraints += 3;
+
+    // the jacobians are dense so all the task rows belong to the pattern
+    for(int j = 0; j < m_numberOfVariables; j++)
+        for(int i = 0; i < m_numberOfTaskConstraints; i++)
+            m_constraintsMatrixSparse(i, j) = 0;
+
+    auto constraintsMatrix(iDynTree::toEigen(m_constraintsMatrixSparse));
+    const int* rows = constraintsMatrix.innerIndexPtr();
+    const int* columnsBegin = constraintsMatrix.outerIndexPtr();
+
+    m_constraintsColumnsOffset.resize(m_numberOfVariables);
+    for(int j = 0; j < m_numberOfVariables; j++)
+    {
+        // the task rows are the first rows of each column
+        for(int i = 0; i < m_numberOfTaskConstraints; i++)
+        {
+            if(rows[columnsBegin[j] + i] != i)
+            {
+                yError() << "[initializeConstraintsMatrixPattern] The task rows of the column" << j
+                         << "are not contiguous.";
+                return false;
+            }
+        }
+        m_constraintsColumnsOffset[j] = columnsBegin[j];
+    }
+
+    return true;
+}
+
 void WalkingQPIK::evaluateLinearConstraintMatrix()
 {
-    copyDenseIntoSparse(m_leftFootJacobian, 0, 0, m_constraintsMatrixSparse);
-    copyDenseIntoSparse(m_rightFootJacobian, 6, 0, m_constraintsMatrixSparse);
+    double* values = iDynTree::toEigen(m_constraintsMatrixSparse).valuePtr();
+
+    auto copyJacobian = [this, values](const iDynTree::MatrixDynSize& jacobian, int startingRow) {
+        auto jacobianEigen(iDynTree::toEigen(jacobian));
+        for(int j = 0; j < m_numberOfVariables; j++)
+            Eigen::Map<Eigen::VectorXd>(values + m_constraintsColumnsOffset[j] + startingRow,
+                                        jacobianEigen.rows()) = jacobianEigen.col(j);
+    };
+
+    copyJacobian(m_leftFootJacobian, 0);
+    copyJacobian(m_rightFootJacobian, 6);
+
+    if(m_useCoMAsConstraint)
+        copyJacobian(m_comJacobian, 6 + 6);
+}
+
+void WalkingQPIK::evaluateEqualityConstraintsMatrix()
+{
+    m_equalityConstraintsMatrix.middleRows<6>(0) = iDynTree::toEigen(m_leftFootJacobian);
+    m_equalityConstraintsMatrix.middleRows<6>(6) = iDynTree::toEigen(m_rightFootJacobian);
+
+    if(m_useCoMAsConstraint)
+        m_equalityConstraintsMatrix.middleRows<3>(6 + 6) = iDynTree::toEigen(m_comJacobian);
+}
+
+bool WalkingQPIK::isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                const double& margin) const
+{
+    return !m_useJointsLimitsConstraint;
+}
+
+bool WalkingQPIK::solveLeastSquares()
+{
+    if(!m_useLeastSquaresFastPath || m_isJointVelocitiesBoundActive)
+        return false;
+
+    evaluateEqualityConstraintsMatrix();
+
+    // the hessian matrix is symmetric, its transpose is a column major view of the same memory.
+    // The lower and upper bounds of the task constraints are equal
+    if(!m_leastSquaresSolver->solveEqualityConstrained(iDynTree::toEigen(m_hessianDense).transpose(),
+                                                       iDynTree::toEigen(m_gradient),
+                                                       m_equalityConstraintsMatrix,
+                                                       iDynTree::toEigen(m_lowerBound).head(m_numberOfTaskConstraints)))
+        return false;
+
+    // if the bounds are satisfied the solution is also the solution of the QP problem
+    if(!isInsideJointVelocitiesBounds(m_leastSquaresSolver->getSolution(), 0.0))
+        return false;
+
+    iDynTree::toEigen(m_solution) = m_leastSquaresSolver->getSolution();
+    return true;
+}
+
+void WalkingQPIK::updateActiveBoundsStatus()
+{
+    // the margin takes into account the tolerance of the QP solvers. If the solution of the QP
+    // is far from the bounds the closed form solution is evaluated at the next step
+    m_isJointVelocitiesBoundActive = !isInsideJointVelocitiesBounds(iDynTree::toEigen(m_solution), 1e-3);
+}
+
+bool WalkingQPIK::isReducedFormulationSupported() const
+{
+    return false;
+}
+
+bool WalkingQPIK::evaluateReducedProblem()
+{
+    // the constraints are saved in the following order (lf, rf, com (if it is present))
+    const int stanceRow = m_isLeftFootStance ? 0 : 6;
+    const int swingRow = m_isLeftFootStance ? 6 : 0;
+    auto stanceFootJacobian(iDynTree::toEigen(m_isLeftFootStance ? m_leftFootJacobian : m_rightFootJacobian));
+    auto swingFootJacobian(iDynTree::toEigen(m_isLeftFootStance ? m_rightFootJacobian : m_leftFootJacobian));
+    auto lowerBound(iDynTree::toEigen(m_lowerBound));
+
+    // J_b v_b + J_s qdot = t hence v_b = J_b^-1 t - J_b^-1 J_s qdot. The base block of the jacobian
+    // (mixed representation) is always invertible
+    m_stanceBaseJacobianLU.compute(stanceFootJacobian.leftCols<6>());
+    if(std::abs(m_stanceBaseJacobianLU.determinant()) < 1e-10)
+    {
+        yError() << "[evaluateReducedProblem] The base block of the stance foot jacobian is singular.";
+        return false;
+    }
+
+    m_baseEliminationMatrix.topRows<6>() = m_stanceBaseJacobianLU.solve(stanceFootJacobian.rightCols(m_actuatedDOFs));
+    m_baseEliminationMatrix.topRows<6>() *= -1.0;
+    m_baseEliminationOffset.head<6>() = m_stanceBaseJacobianLU.solve(lowerBound.segment<6>(stanceRow));
+
+    // cost function
+    auto hessian(iDynTree::toEigen(m_hessianDense));
+    m_hessianTimesEliminationMatrix.noalias() = hessian * m_baseEliminationMatrix;
+    m_reducedHessian.noalias() = m_baseEliminationMatrix.transpose() * m_hessianTimesEliminationMatrix;
+
+    m_auxiliaryGradient = iDynTree::toEigen(m_gradient);
+    m_auxiliaryGradient.noalias() += hessian * m_baseEliminationOffset;
+    m_reducedGradient.noalias() = m_baseEliminationMatrix.transpose() * m_auxiliaryGradient;
+
+    // remaining constraints (swing foot and CoM)
+    m_reducedEqualityConstraintsMatrix.topRows<6>().noalias() = swingFootJacobian * m_baseEliminationMatrix;
+    m_reducedEqualityConstraintsVector.head<6>() = lowerBound.segment<6>(swingRow);
+    m_reducedEqualityConstraintsVector.head<6>().noalias() -= swingFootJacobian * m_baseEliminationOffset;
 
     if(m_useCoMAsConstraint)
-        copyDenseIntoSparse(m_comJacobian, 6 + 6, 0, m_constraintsMatrixSparse);
+    {
+        auto comJacobian(iDynTree::toEigen(m_comJacobian));
+        m_reducedEqualityConstraintsMatrix.bottomRows<3>().noalias() = comJacobian * m_baseEliminationMatrix;
+        m_reducedEqualityConstraintsVector.tail<3>() = lowerBound.segment<3>(6 + 6);
+        m_reducedEqualityConstraintsVector.tail<3>().noalias() -= comJacobian * m_baseEliminationOffset;
+    }
+
+    return true;
+}
+
+void WalkingQPIK::setSolutionFromReducedProblem(const Eigen::Ref<const Eigen::VectorXd>& jointVelocities)
+{
+    auto solution(iDynTree::toEigen(m_solution));
+    solution = m_baseEliminationOffset;
+    solution.noalias() += m_baseEliminationMatrix * jointVelocities;
 }
 
 void WalkingQPIK::evaluateBounds()
@@ -873,6 +1222,11 @@ const iDynTree::MatrixDynSize& WalkingQPIK::getHessianMatrix() const
     return m_hessianDense;
 }
 
+const Eigen::SparseMatrix<double>& WalkingQPIK::getHessianMatrixSparse() const
+{
+    return m_hessianSparse;
+}
+
 const iDynSparseMatrix& WalkingQPIK::getConstraintMatrix() const
 {
     return m_constraintsMatrixSparse;
@@ -0,0 +1,135 @@
+/**
+ * @file QPInverseKinematics_activeSet.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cmath>
+#include <limits>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_activeSet.h>
+
+using namespace WalkingControllers;
+
+void WalkingQPIK_activeSet::setNumberOfConstraints()
+{
+    // only the equality constraints are stored in the constraint matrix. The joint
+    // limits are handled as bounds of the variables
+    if(m_useCoMAsConstraint)
+        m_numberOfConstraints = 6 + 6 + 3;
+    else
+        m_numberOfConstraints = 6 + 6;
+}
+
+void WalkingQPIK_activeSet::initializeSolverSpecificMatrices()
+{
+    m_minJointLimit.resize(m_numberOfVariables);
+    m_maxJointLimit.resize(m_numberOfVariables);
+
+    // infinite bounds are ignored by the solver
+    for(int i = 0; i < m_numberOfVariables; i++)
+    {
+        m_minJointLimit(i) = -std::numeric_limits<double>::infinity();
+        m_maxJointLimit(i) = std::numeric_limits<double>::infinity();
+    }
+}
+
+void WalkingQPIK_activeSet::setJointVelocitiesBounds()
+{
+    if(m_useJointsLimitsConstraint)
+        for(int i = 0; i < m_actuatedDOFs; i++)
+        {
+            m_minJointLimit(i + 6) = m_kJointLimitsLowerBound *
+                std::tanh(m_jointPosition(i) - m_jointPositionsLowerBounds(i))
+                * (-m_jointVelocitiesBounds(i));
+
+            m_maxJointLimit(i + 6) = m_kJointLimitsUpperBound *
+                std::tanh(m_jointPositionsUpperBounds(i) - m_jointPosition(i))
+                * m_jointVelocitiesBounds(i);
+        }
+
+    return;
+}
+
+bool WalkingQPIK_activeSet::isReducedFormulationSupported() const
+{
+    return true;
+}
+
+void WalkingQPIK_activeSet::instantiateSolver()
+{
+    // in the reduced formulation the variables are the joint velocities and the stance foot
+    // constraint is removed
+    if(m_useReducedFormulation)
+        m_optimizer = std::make_unique<GoldfarbIdnaniSolver>(m_actuatedDOFs,
+                                                             m_numberOfConstraints - 6);
+    else
+        m_optimizer = std::make_unique<GoldfarbIdnaniSolver>(m_numberOfVariables,
+                                                             m_numberOfConstraints);
+}
+
+bool WalkingQPIK_activeSet::solve()
+{
+    evaluateHessianMatrix();
+    evaluateGradientVector();
+    evaluateBounds();
+
+    if(m_useReducedFormulation)
+    {
+        if(!evaluateReducedProblem())
+        {
+            yError() << "[solve] Unable to evaluate the reduced problem.";
+            return false;
+        }
+
+        // the bounds of the reduced problem are the joint velocities bounds
+        if(!m_optimizer->solve(m_reducedHessian,
+                               m_reducedGradient,
+                               m_reducedEqualityConstraintsMatrix,
+                               m_reducedEqualityConstraintsVector,
+                               iDynTree::toEigen(m_minJointLimit).tail(m_actuatedDOFs),
+                               iDynTree::toEigen(m_maxJointLimit).tail(m_actuatedDOFs)))
+        {
+            yError() << "[solve] Unable to solve the reduced problem.";
+            return false;
+        }
+
+        setSolutionFromReducedProblem(m_optimizer->getSolution());
+
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
+
+        return true;
+    }
+
+    evaluateEqualityConstraintsMatrix();
+
+    // the hessian matrix is symmetric, its transpose is a column major view of the same memory.
+    // The lower and upper bounds of the equality constraints are equal
+    if(!m_optimizer->solve(iDynTree::toEigen(m_hessianDense).transpose(),
+                           iDynTree::toEigen(m_gradient),
+                           m_equalityConstraintsMatrix,
+                           iDynTree::toEigen(m_lowerBound),
+                           iDynTree::toEigen(m_minJointLimit),
+                           iDynTree::toEigen(m_maxJointLimit)))
+    {
+        yError() << "[solve] Unable to solve the problem.";
+        return false;
+    }
+
+    iDynTree::toEigen(m_solution) = m_optimizer->getSolution();
+
+    for(int i = 0; i < m_actuatedDOFs; i++)
+        m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
+
+    return true;
+}
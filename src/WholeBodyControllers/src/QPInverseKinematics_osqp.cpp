@@ -53,19 +53,13 @@ void WalkingQPIK_osqp::setJointVelocitiesBounds()
 {
     if(m_useJointsLimitsConstraint)
     {
-        int numberOfTaskConstraints;
-        if(m_useCoMAsConstraint)
-            numberOfTaskConstraints = 6 + 6 + 3;
-        else
-            numberOfTaskConstraints = 6 + 6;
-
         for(unsigned int i = 0; i < m_actuatedDOFs; i++)
         {
-            m_lowerBound(i + numberOfTaskConstraints) = m_kJointLimitsLowerBound *
+            m_lowerBound(i + m_numberOfTaskConstraints) = m_kJointLimitsLowerBound *
                 std::tanh(m_jointPosition(i) - m_jointPositionsLowerBounds(i))
                 * (-m_jointVelocitiesBounds(i));
 
-            m_upperBound(i + numberOfTaskConstraints) = m_kJointLimitsUpperBound *
+            m_upperBound(i + m_numberOfTaskConstraints) = m_kJointLimitsUpperBound *
                 std::tanh(m_jointPositionsUpperBounds(i) - m_jointPosition(i))
                 * m_jointVelocitiesBounds(i);
         }
@@ -73,6 +67,21 @@ void WalkingQPIK_osqp::setJointVelocitiesBounds()
     return;
 }
 
+bool WalkingQPIK_osqp::isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                     const double& margin) const
+{
+    if(!m_useJointsLimitsConstraint)
+        return true;
+
+    for(unsigned int i = 0; i < m_actuatedDOFs; i++)
+    {
+        if(solution(i + 6) < m_lowerBound(i + m_numberOfTaskConstraints) + margin
+           || solution(i + 6) > m_upperBound(i + m_numberOfTaskConstraints) - margin)
+            return false;
+    }
+    return true;
+}
+
 void WalkingQPIK_osqp::instantiateSolver()
 {
     // instantiate the solver
@@ -87,10 +96,9 @@ void WalkingQPIK_osqp::instantiateSolver()
 
 bool WalkingQPIK_osqp::initializeSolver()
 {
-    // Hessian matrix
-    auto hessianDense(iDynTree::toEigen(m_hessianDense));
-    Eigen::SparseMatrix<double> hessianSparse = hessianDense.sparseView();
-    if(!m_optimizerSolver->data()->setHessianMatrix(hessianSparse))
+    // Hessian matrix. The sparsity pattern is evaluated only once
+    initializeHessianSparsityPattern();
+    if(!m_optimizerSolver->data()->setHessianMatrix(m_hessianSparse))
     {
         yError() << "[initializeSolver] Unable to set the hessian matrix.";
         return false;
@@ -138,10 +146,11 @@ bool WalkingQPIK_osqp::initializeSolver()
 
 bool WalkingQPIK_osqp::updateSolver()
 {
-    // Hessian matrix
-    auto hessianDense(iDynTree::toEigen(m_hessianDense));
-    Eigen::SparseMatrix<double> hessianSparse = hessianDense.sparseView();
-    if(!m_optimizerSolver->updateHessianMatrix(hessianSparse))
+    // Hessian matrix. Since the sparsity pattern is fixed only the values are
+    // passed to osqp (the order is the same of the upper triangular CSC matrix)
+    evaluateHessianMatrixSparse();
+    if(osqp_update_P(m_optimizerSolver->workspace().get(), m_hessianSparse.valuePtr(),
+                     OSQP_NULL, m_hessianSparse.nonZeros()) != 0)
     {
         yError() << "[updateSolver] Unable to set the hessian matrix.";
         return false;
@@ -155,8 +164,10 @@ bool WalkingQPIK_osqp::updateSolver()
         return false;
     }
 
+    // the sparsity pattern of the constraint matrix does not change
     auto constraintsMatrixSparse(iDynTree::toEigen(m_constraintsMatrixSparse));
-    if(!m_optimizerSolver->updateLinearConstraintsMatrix(constraintsMatrixSparse))
+    if(osqp_update_A(m_optimizerSolver->workspace().get(), constraintsMatrixSparse.valuePtr(),
+                     OSQP_NULL, constraintsMatrixSparse.nonZeros()) != 0)
     {
         yError() << "[updateSolver] Unable to set the constraints matrix.";
         return false;
@@ -175,11 +186,27 @@ bool WalkingQPIK_osqp::updateSolver()
 
 bool WalkingQPIK_osqp::solve()
 {
-    evaluateHessianMatrix();
+    // the dense hessian matrix is required by the least squares fast path and to fill the sparse
+    // matrix when the pattern is dense (CoM task). The pattern is evaluated when the solver is
+    // initialized. Otherwise only the entries of the pattern are evaluated by updateSolver()
+    const bool isLeastSquaresFastPathActive = m_useLeastSquaresFastPath && !m_isJointVelocitiesBoundActive;
+    if(isLeastSquaresFastPathActive || !m_optimizerSolver->isInitialized() || m_isHessianPatternDense)
+        evaluateHessianMatrix();
+
     evaluateGradientVector();
-    evaluateLinearConstraintMatrix();
     evaluateBounds();
 
+    // the QP is solved only if a joint velocities bound is active
+    if(solveLeastSquares())
+    {
+        for(unsigned int i = 0; i < m_actuatedDOFs; i++)
+            m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
+
+        return true;
+    }
+
+    evaluateLinearConstraintMatrix();
+
     if(!m_optimizerSolver->isInitialized())
     {
         if(!initializeSolver())
@@ -204,6 +231,8 @@ bool WalkingQPIK_osqp::solve()
     }
 
     iDynTree::toEigen(m_solution) = m_optimizerSolver->getSolution();
+    updateActiveBoundsStatus();
+
     for(unsigned int i = 0; i < m_actuatedDOFs; i++)
         m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
 
@@ -20,8 +20,6 @@
 
 using namespace WalkingControllers;
 
-typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXd;
-
 void WalkingQPIK_qpOASES::setNumberOfConstraints()
 {
     if(m_useCoMAsConstraint)
@@ -32,6 +30,9 @@ void WalkingQPIK_qpOASES::setNumberOfConstraints()
 
 void WalkingQPIK_qpOASES::initializeSolverSpecificMatrices()
 {
+    m_constraintsMatrix.resize(m_numberOfConstraints, m_numberOfVariables);
+    m_constraintsMatrix.zero();
+
     m_minJointLimit.resize(m_numberOfVariables);
     m_maxJointLimit.resize(m_numberOfVariables);
 
@@ -59,6 +60,21 @@ void WalkingQPIK_qpOASES::setJointVelocitiesBounds()
     return;
 }
 
+bool WalkingQPIK_qpOASES::isInsideJointVelocitiesBounds(const Eigen::Ref<const Eigen::VectorXd>& solution,
+                                                        const double& margin) const
+{
+    if(!m_useJointsLimitsConstraint)
+        return true;
+
+    for(int i = 0; i < m_actuatedDOFs; i++)
+    {
+        if(solution(i + 6) < m_minJointLimit(i + 6) + margin
+           || solution(i + 6) > m_maxJointLimit(i + 6) - margin)
+            return false;
+    }
+    return true;
+}
+
 void WalkingQPIK_qpOASES::instantiateSolver()
 {
     m_optimizer = std::make_unique<qpOASES::SQProblem>(m_numberOfVariables,
@@ -68,36 +84,40 @@ void WalkingQPIK_qpOASES::instantiateSolver()
     m_isFirstTime = true;
 }
 
-bool WalkingQPIK_qpOASES::solve()
+void WalkingQPIK_qpOASES::evaluateDenseConstraintsMatrix()
 {
-    evaluateHessianMatrix();
-    evaluateGradientVector();
-    evaluateLinearConstraintMatrix();
-    evaluateBounds();
+    // the jacobians and the constraint matrix are both row major, hence each jacobian
+    // is a contiguous block of memory of the constraint matrix
+    auto constraintsMatrix(iDynTree::toEigen(m_constraintsMatrix));
+    constraintsMatrix.middleRows<6>(0) = iDynTree::toEigen(m_leftFootJacobian);
+    constraintsMatrix.middleRows<6>(6) = iDynTree::toEigen(m_rightFootJacobian);
 
-    // convert sparse matrix into a dense matrix
-    MatrixXd constraintMatrix = MatrixXd(iDynTree::toEigen(m_constraintsMatrixSparse));
+    if(m_useCoMAsConstraint)
+        constraintsMatrix.middleRows<3>(6 + 6) = iDynTree::toEigen(m_comJacobian);
+}
 
+bool WalkingQPIK_qpOASES::solveOptimizationProblem()
+{
     int nWSR = 100;
     if(!m_isFirstTime)
     {
-        if(m_optimizer->hotstart(m_hessianDense.data(), m_gradient.data(), constraintMatrix.data(),
+        if(m_optimizer->hotstart(m_hessianDense.data(), m_gradient.data(), m_constraintsMatrix.data(),
                                  m_minJointLimit.data(), m_maxJointLimit.data(),
                                  m_lowerBound.data(), m_upperBound.data(), nWSR, 0)
            != qpOASES::SUCCESSFUL_RETURN)
         {
-            yError() << "[solve] Unable to solve the problem.";
+            yError() << "[solveOptimizationProblem] Unable to solve the problem.";
             return false;
         }
     }
     else
     {
-        if(m_optimizer->init(m_hessianDense.data(), m_gradient.data(), constraintMatrix.data(),
+        if(m_optimizer->init(m_hessianDense.data(), m_gradient.data(), m_constraintsMatrix.data(),
                              m_minJointLimit.data(), m_maxJointLimit.data(),
                              m_lowerBound.data(), m_upperBound.data(), nWSR, 0)
            != qpOASES::SUCCESSFUL_RETURN)
         {
-            yError() << "[solve] Unable to solve the problem.";
+            yError() << "[solveOptimizationProblem] Unable to solve the problem.";
             return false;
         }
 
@@ -105,6 +125,33 @@ bool WalkingQPIK_qpOASES::solve()
     }
 
     m_optimizer->getPrimalSolution(m_solution.data());
+    return true;
+}
+
+bool WalkingQPIK_qpOASES::solve()
+{
+    evaluateHessianMatrix();
+    evaluateGradientVector();
+    evaluateBounds();
+
+    // the QP is solved only if a joint velocities bound is active
+    if(solveLeastSquares())
+    {
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
+
+        return true;
+    }
+
+    evaluateDenseConstraintsMatrix();
+
+    if(!solveOptimizationProblem())
+    {
+        yError() << "[solve] Unable to solve the problem.";
+        return false;
+    }
+
+    updateActiveBoundsStatus();
 
     for(int i = 0; i < m_actuatedDOFs; i++)
         m_desiredJointVelocitiesOutput(i) = m_solution(i + 6);
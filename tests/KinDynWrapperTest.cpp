@@ -0,0 +1,105 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include <WalkingControllers/KinDynWrapper/GeneratedKinematics.h>
+#include <WalkingControllers/KinDynWrapper/GeneratedKinematicsKernel.h>
+
+using namespace WalkingControllers;
+
+TEST_CASE("Check GeneratedKinematics against iDynTree", "[GeneratedKinematics]")
+{
+    using Kinematics = GeneratedKinematics<GeneratedKinematicsKernel>;
+    const int numberOfDOFs = GeneratedKinematicsKernel::numberOfDOFs;
+
+    std::vector<std::string> joints;
+    for(int i = 0; i < numberOfDOFs; i++)
+        joints.push_back(GeneratedKinematicsKernel::jointName(i));
+
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromFile(WALKING_CONTROLLERS_KINEMATICS_KERNEL_URDF, joints));
+    const iDynTree::Model& model = loader.model();
+
+    std::unique_ptr<Kinematics> kinematics(new Kinematics());
+    REQUIRE(kinematics->getNrOfDOFs() == static_cast<int>(model.getNrOfDOFs()));
+    for(int i = 0; i < numberOfDOFs; i++)
+        REQUIRE(kinematics->getJointName(i) == model.getJointName(i));
+
+    std::srand(0);
+
+    // the floating base is changed to check the jacobians w.r.t. different bases
+    for(int linkIndex = 0; linkIndex < model.getNrOfLinks(); linkIndex++)
+    {
+        const std::string baseName = model.getLinkName(linkIndex);
+        const int baseIndex = kinematics->getFrameIndex(baseName);
+        REQUIRE(baseIndex >= 0);
+
+        iDynTree::KinDynComputations kinDyn;
+        REQUIRE(kinDyn.loadRobotModel(model));
+        REQUIRE(kinDyn.setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION));
+        REQUIRE(kinDyn.setFloatingBase(baseName));
+
+        Eigen::VectorXd jointPositions = Eigen::VectorXd::Random(numberOfDOFs);
+        Eigen::Matrix3d baseRotation = Eigen::Quaterniond(Eigen::Vector4d::Random().normalized()).toRotationMatrix();
+        Eigen::Vector3d basePosition = Eigen::Vector3d::Random();
+
+        iDynTree::Transform worldToBase;
+        iDynTree::Rotation baseRotationIDyn;
+        iDynTree::Position basePositionIDyn;
+        iDynTree::toEigen(baseRotationIDyn) = baseRotation;
+        iDynTree::toEigen(basePositionIDyn) = basePosition;
+        worldToBase.setRotation(baseRotationIDyn);
+        worldToBase.setPosition(basePositionIDyn);
+
+        iDynTree::VectorDynSize jointPositionsIDyn(numberOfDOFs);
+        iDynTree::VectorDynSize jointVelocitiesIDyn(numberOfDOFs);
+        iDynTree::toEigen(jointPositionsIDyn) = jointPositions;
+        jointVelocitiesIDyn.zero();
+        iDynTree::Twist baseTwist;
+        baseTwist.zero();
+        iDynTree::Vector3 gravity;
+        gravity.zero();
+        REQUIRE(kinDyn.setRobotState(worldToBase, jointPositionsIDyn, baseTwist, jointVelocitiesIDyn, gravity));
+
+        kinematics->setRobotState(baseIndex, baseRotation, basePosition, jointPositions);
+
+        // all the frames of the model that are links of the URDF
+        KinematicsBackend::RowMajorMatrix jacobian(6, numberOfDOFs + 6);
+        iDynTree::MatrixDynSize jacobianIDyn(6, numberOfDOFs + 6);
+        for(int frameIndex = 0; frameIndex < model.getNrOfFrames(); frameIndex++)
+        {
+            const int index = kinematics->getFrameIndex(model.getFrameName(frameIndex));
+            if(index < 0)
+                continue;
+
+            Eigen::Matrix3d rotation;
+            Eigen::Vector3d position;
+            kinematics->getWorldTransform(index, rotation, position);
+            iDynTree::Transform transform = kinDyn.getWorldTransform(frameIndex);
+            REQUIRE(rotation.isApprox(iDynTree::toEigen(transform.getRotation()), 1e-8));
+            REQUIRE((position - iDynTree::toEigen(transform.getPosition())).norm() < 1e-8);
+
+            kinematics->getFrameJacobian(index, jacobian);
+            REQUIRE(kinDyn.getFrameFreeFloatingJacobian(frameIndex, jacobianIDyn));
+            REQUIRE((jacobian - iDynTree::toEigen(jacobianIDyn)).cwiseAbs().maxCoeff() < 1e-8);
+        }
+
+        Eigen::Vector3d comPosition;
+        kinematics->getCoMPosition(comPosition);
+        REQUIRE((comPosition - iDynTree::toEigen(kinDyn.getCenterOfMassPosition())).norm() < 1e-8);
+
+        KinematicsBackend::RowMajorMatrix comJacobian(3, numberOfDOFs + 6);
+        iDynTree::MatrixDynSize comJacobianIDyn(3, numberOfDOFs + 6);
+        kinematics->getCoMJacobian(comJacobian);
+        REQUIRE(kinDyn.getCenterOfMassJacobian(comJacobianIDyn));
+        REQUIRE((comJacobian - iDynTree::toEigen(comJacobianIDyn)).cwiseAbs().maxCoeff() < 1e-8);
+    }
+}
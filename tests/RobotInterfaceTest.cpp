@@ -0,0 +1,90 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <cmath>
+
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Vector.h>
+
+#include <WalkingControllers/RobotInterface/SensorMailbox.h>
+
+using namespace WalkingControllers;
+
+namespace
+{
+    // the samples are received now, their age is not checked
+    const double maxAge = 1e3;
+
+    yarp::sig::Vector vector(double first, double second)
+    {
+        yarp::sig::Vector sample(2);
+        sample[0] = first;
+        sample[1] = second;
+        return sample;
+    }
+}
+
+TEST_CASE("Check SensorMailbox history", "[SensorMailbox]")
+{
+    SensorMailbox mailbox(3);
+    mailbox.setAngleIndices({1});
+
+    yarp::sig::Vector sample;
+    double age;
+    REQUIRE_FALSE(mailbox.getSample(1.0, sample, age, maxAge));
+
+    mailbox.addSample(vector(0.0, 3.1), yarp::os::Stamp(0, 1.0));
+    mailbox.addSample(vector(1.0, -3.1), yarp::os::Stamp(1, 1.1));
+
+    SECTION("Interpolation")
+    {
+        REQUIRE(mailbox.getSample(1.05, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(0.5));
+        REQUIRE(age == Approx(-0.05));
+
+        // the angle is interpolated along the shortest arc
+        REQUIRE(std::cos(sample[1]) == Approx(-1.0).epsilon(1e-6));
+    }
+
+    SECTION("Outside the history")
+    {
+        // the signal is not extrapolated
+        REQUIRE(mailbox.getSample(1.2, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(1.0));
+        REQUIRE(age == Approx(0.1));
+
+        REQUIRE(mailbox.getSample(0.9, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(0.0));
+
+        // the oldest sample is removed
+        mailbox.addSample(vector(2.0, 0.0), yarp::os::Stamp(2, 1.2));
+        mailbox.addSample(vector(3.0, 0.0), yarp::os::Stamp(3, 1.3));
+        REQUIRE(mailbox.getSample(0.9, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(1.0));
+        REQUIRE(mailbox.getSample(1.25, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(2.5));
+    }
+
+    SECTION("Samples without envelope")
+    {
+        // the arrival time is not compared with the time of the envelopes
+        mailbox.addSample(vector(2.0, 0.0), yarp::os::Stamp());
+        REQUIRE(mailbox.getSample(1.05, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(2.0));
+        REQUIRE(age >= 0.0);
+
+        // the history is interrupted by the sample without envelope
+        mailbox.addSample(vector(3.0, 0.0), yarp::os::Stamp(2, 1.3));
+        REQUIRE(mailbox.getSample(1.05, sample, age, maxAge));
+        REQUIRE(sample[0] == Approx(3.0));
+    }
+
+    SECTION("Stale samples")
+    {
+        REQUIRE_FALSE(mailbox.getSample(1.05, sample, age, -1.0));
+        REQUIRE_FALSE(mailbox.getLatestSample(sample, -1.0));
+
+        mailbox.reset();
+        REQUIRE_FALSE(mailbox.getLatestSample(sample, maxAge));
+    }
+}
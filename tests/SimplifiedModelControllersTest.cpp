@@ -0,0 +1,109 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <yarp/os/Property.h>
+
+#include <iDynTree/Core/Transform.h>
+#include <iDynTree/Core/VectorFixSize.h>
+
+#include <WalkingControllers/SimplifiedModelControllers/DCMModelPredictiveController.h>
+
+using namespace WalkingControllers;
+
+namespace
+{
+    const double samplingTime = 0.01;
+    const double comHeight = 0.53;
+    const double gravityAcceleration = 9.81;
+    const int numberOfTicks = 200;
+
+    /**
+     * Run the DCM MPC in closed loop with the DCM dynamics and store the desired ZMP and the
+     * solve time of each tick.
+     */
+    void runController(const std::string& formulation, double controllerHorizon,
+                       std::vector<iDynTree::Vector2>& zmp, double& averageSolveTime)
+    {
+        yarp::os::Property config;
+        config.fromConfig(("sampling_time " + std::to_string(samplingTime) + "\n"
+                           + "controllerHorizon " + std::to_string(controllerHorizon) + "\n"
+                           + "com_height " + std::to_string(comHeight) + "\n"
+                           + "mpc_formulation " + formulation + "\n"
+                           + "stateWeightTriplets ((0,0,7500), (1,1,7500))\n"
+                           + "inputWeightTriplets ((0,0,9000000), (1,1,9000000))\n"
+                           + "foot_size ((-0.02 0.05), (-0.025 0.025))\n"
+                           + "initial_zmp_position (0.0 0.0)\n"
+                           + "convex_hull_tolerance 0.05\n").c_str());
+
+        WalkingController controller;
+        REQUIRE(controller.initialize(config));
+        int horizon = controller.getControllerHorizon();
+
+        // double support. The DCM moves towards the left foot
+        std::vector<iDynTree::Transform> leftFoot(1, iDynTree::Transform(iDynTree::Rotation::Identity(),
+                                                                          iDynTree::Position(0, 0.05, 0)));
+        std::vector<iDynTree::Transform> rightFoot(1, iDynTree::Transform(iDynTree::Rotation::Identity(),
+                                                                           iDynTree::Position(0, -0.05, 0)));
+        const bool inContactData[1] = {true};
+        StdUtilities::Span<bool> inContact(inContactData, 1);
+
+        std::vector<iDynTree::Vector2> reference(numberOfTicks + horizon + 1);
+        for(std::size_t i = 0; i < reference.size(); i++)
+        {
+            reference[i](0) = 0.01;
+            reference[i](1) = 0.04 * (1 - std::exp(-static_cast<double>(i) * samplingTime));
+        }
+
+        double stateDynamics = std::exp(std::sqrt(gravityAcceleration / comHeight) * samplingTime);
+        double inputDynamics = 1 - stateDynamics;
+
+        iDynTree::Vector2 dcm;
+        dcm.zero();
+        zmp.resize(numberOfTicks);
+        averageSolveTime = 0;
+        for(int i = 0; i < numberOfTicks; i++)
+        {
+            REQUIRE(controller.setConvexHullConstraint(leftFoot, rightFoot, inContact, inContact));
+            REQUIRE(controller.setFeedback(dcm));
+            REQUIRE(controller.setReferenceSignal(StdUtilities::Span<iDynTree::Vector2>(reference.data() + i,
+                                                                                        horizon + 1),
+                                                  i == 0));
+
+            auto start = std::chrono::steady_clock::now();
+            REQUIRE(controller.solve());
+            averageSolveTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            zmp[i] = controller.getControllerOutput();
+            for(int j = 0; j < 2; j++)
+                dcm(j) = stateDynamics * dcm(j) + inputDynamics * zmp[i](j);
+        }
+        averageSolveTime /= numberOfTicks;
+    }
+}
+
+TEST_CASE("Compare the sparse and condensed DCM MPC", "[DCMModelPredictiveController]")
+{
+    // the condensed hessian does not grow with the horizon, the longest horizon is 3.5 s
+    for(double controllerHorizon : {1.0, 2.0, 3.5})
+    {
+        std::vector<iDynTree::Vector2> sparseZMP, condensedZMP;
+        double sparseSolveTime, condensedSolveTime;
+        runController("sparse", controllerHorizon, sparseZMP, sparseSolveTime);
+        runController("condensed", controllerHorizon, condensedZMP, condensedSolveTime);
+
+        std::cout << "Horizon " << controllerHorizon << " s. Average solve time: sparse "
+                  << sparseSolveTime * 1e3 << " ms, condensed " << condensedSolveTime * 1e3 << " ms."
+                  << std::endl;
+
+        // the two formulations have the same optimal input (up to the solver tolerance)
+        for(int i = 0; i < numberOfTicks; i++)
+            for(int j = 0; j < 2; j++)
+                REQUIRE(std::abs(sparseZMP[i](j) - condensedZMP[i](j)) < 5e-3);
+    }
+}
@@ -0,0 +1,181 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+
+#include <WalkingControllers/StdUtilities/RingBuffer.h>
+#include <WalkingControllers/StdUtilities/HermiteSpline.h>
+#include <WalkingControllers/StdUtilities/SampledTrajectory.h>
+
+TEST_CASE("Check RingBuffer", "[RingBuffer]")
+{
+    // two fields stored as a struct of arrays
+    WalkingControllers::StdUtilities::RingBuffer<int, double> buffer;
+    buffer.reserve(4);
+
+    std::vector<int> trajectory{0, 1, 2, 3};
+    std::vector<double> doubleTrajectory{0.0, 0.5, 1.0, 1.5};
+    REQUIRE(buffer.splice(0, trajectory, doubleTrajectory));
+    REQUIRE(buffer.size() == 4);
+
+    SECTION("Advance")
+    {
+        // the last element is repeated
+        for(int i = 0; i < 6; i++)
+            REQUIRE(buffer.advance());
+
+        REQUIRE(buffer.size() == 4);
+        for(const auto& element : buffer.view<0>())
+            REQUIRE(element == 3);
+        for(const auto& element : buffer.view<1>())
+            REQUIRE(element == 1.5);
+    }
+
+    SECTION("Splice")
+    {
+        REQUIRE(buffer.advance());
+        REQUIRE(buffer.advance());
+        REQUIRE(buffer.advance());
+
+        // the view is valid also when the buffer wraps around
+        std::vector<int> newTrajectory{4, 5, 6};
+        std::vector<double> newDoubleTrajectory{2.0, 2.5, 3.0};
+        REQUIRE(buffer.splice(1, newTrajectory, newDoubleTrajectory));
+        REQUIRE(buffer.capacity() == 4);
+
+        auto view = buffer.view<0>();
+        REQUIRE(view.size() == 4);
+        for(int i = 0; i < 4; i++)
+        {
+            REQUIRE(view[i] == i + 3);
+            REQUIRE(buffer.get<1>(i) == 0.5 * (i + 3));
+        }
+
+        int expected = 3;
+        for(const auto& element : view)
+            REQUIRE(element == expected++);
+
+        // the inputs must have the same size
+        REQUIRE_FALSE(buffer.splice(1, newTrajectory, doubleTrajectory));
+    }
+
+    SECTION("Reallocation")
+    {
+        REQUIRE(buffer.advance());
+
+        // only the required memory is allocated
+        std::vector<int> newTrajectory{4, 5, 6, 7, 8};
+        std::vector<double> newDoubleTrajectory{2.0, 2.5, 3.0, 3.5, 4.0};
+        REQUIRE(buffer.splice(2, newTrajectory, newDoubleTrajectory));
+        REQUIRE(buffer.size() == 7);
+        REQUIRE(buffer.capacity() == 7);
+        REQUIRE(buffer.front<0>() == 1);
+        REQUIRE(buffer.get<0>(1) == 2);
+        REQUIRE(buffer.back<0>() == 8);
+        REQUIRE(buffer.front<1>() == 0.5);
+        REQUIRE(buffer.back<1>() == 4.0);
+
+        REQUIRE_FALSE(buffer.splice(8, newTrajectory, newDoubleTrajectory));
+    }
+}
+
+TEST_CASE("Check HermiteSpline", "[HermiteSpline]")
+{
+    // a cubic polynomial is represented exactly
+    auto polynomial = [](double t){ return t * t * t - 2 * t + 1; };
+    auto polynomialDerivative = [](double t){ return 3 * t * t - 2; };
+
+    WalkingControllers::StdUtilities::HermiteSpline<1> spline;
+    std::vector<double> knots{0.0, 0.5, 2.0};
+    for(const auto& knot : knots)
+        REQUIRE(spline.addKnot(knot, {{polynomial(knot)}}, {{polynomialDerivative(knot)}}));
+
+    REQUIRE(spline.getNumberOfKnots() == 3);
+    REQUIRE_FALSE(spline.addKnot(1.0, {{0.0}}, {{0.0}}));
+
+    WalkingControllers::StdUtilities::HermiteSpline<1>::Point value, derivative;
+    for(double t = 0; t <= 2.0; t += 0.1)
+    {
+        REQUIRE(spline.evaluate(t, value, derivative));
+        REQUIRE(value[0] == Approx(polynomial(t)));
+        REQUIRE(derivative[0] == Approx(polynomialDerivative(t)));
+    }
+
+    // the last value is held
+    REQUIRE(spline.evaluate(3.0, value, derivative));
+    REQUIRE(value[0] == Approx(polynomial(2.0)));
+    REQUIRE(derivative[0] == 0.0);
+}
+
+TEST_CASE("Check SampledTrajectory", "[SampledTrajectory]")
+{
+    WalkingControllers::StdUtilities::SampledTrajectory<int> trajectory;
+
+    // the samples are evaluated by the segments
+    REQUIRE(trajectory.splice([](std::size_t index, int& value){ value = index; }, 4, 0));
+    REQUIRE(trajectory.size() == 4);
+    REQUIRE(trajectory.front() == 0);
+    REQUIRE(trajectory[3] == 3);
+
+    SECTION("Advance")
+    {
+        // the last sample is repeated
+        for(int i = 0; i < 6; i++)
+            REQUIRE(trajectory.advance());
+
+        REQUIRE(trajectory.size() == 4);
+        for(const auto& element : trajectory.view(4))
+            REQUIRE(element == 3);
+    }
+
+    SECTION("Splice")
+    {
+        REQUIRE(trajectory.advance());
+        REQUIRE(trajectory.splice([](std::size_t index, int& value){ value = 10 + index; }, 3, 2));
+        REQUIRE(trajectory.size() == 5);
+
+        auto view = trajectory.view(10);
+        REQUIRE(view.size() == 5);
+        REQUIRE(view[0] == 1);
+        REQUIRE(view[1] == 2);
+        for(int i = 2; i < 5; i++)
+            REQUIRE(view[i] == 10 + i - 2);
+
+        // the old segment is removed when it cannot be accessed anymore
+        REQUIRE(trajectory.advance());
+        REQUIRE(trajectory.advance());
+        REQUIRE(trajectory.front() == 10);
+
+        REQUIRE_FALSE(trajectory.splice([](std::size_t index, int& value){ value = index; }, 1, 6));
+    }
+
+    SECTION("Cached view")
+    {
+        // the samples are evaluated once, an advance evaluates only the new last sample
+        int evaluations = 0;
+        REQUIRE(trajectory.splice([&evaluations](std::size_t index, int& value){ evaluations++; value = index; },
+                                  10, 0));
+        REQUIRE(trajectory.view(4).size() == 4);
+        REQUIRE(evaluations == 4);
+
+        for(int i = 1; i < 8; i++)
+        {
+            REQUIRE(trajectory.advance());
+            auto view = trajectory.view(4);
+            REQUIRE(evaluations == 4 + i);
+            for(int j = 0; j < 4; j++)
+                REQUIRE(view[j] == std::min(i + j, 9));
+        }
+
+        // only the replaced samples are evaluated again
+        REQUIRE(trajectory.splice([&evaluations](std::size_t index, int& value){ evaluations++; value = -index; },
+                                  5, 2));
+        evaluations = 0;
+        auto view = trajectory.view(4);
+        REQUIRE(evaluations == 2);
+        REQUIRE(view[0] == 7);
+        REQUIRE(view[1] == 8);
+        REQUIRE(view[2] == 0);
+        REQUIRE(view[3] == -1);
+    }
+}
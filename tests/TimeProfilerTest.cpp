@@ -0,0 +1,81 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+#include <WalkingControllers/TimeProfiler/TimeProfiler.h>
+
+TEST_CASE("Check LatencyHistogram", "[LatencyHistogram]")
+{
+    WalkingControllers::LatencyHistogram histogram;
+    REQUIRE(histogram.initialize(0.01, 1.0));
+
+    double latency;
+    REQUIRE_FALSE(histogram.getPercentile(0.5, latency));
+
+    // samples at 5, 15, ..., 95 ms
+    for(int i = 0; i < 10; i++)
+        histogram.addSample(0.005 + 0.01 * i);
+
+    REQUIRE(histogram.getNumberOfSamples() == 10);
+
+    SECTION("Percentile")
+    {
+        REQUIRE(histogram.getPercentile(0.5, latency));
+        REQUIRE(latency == Approx(0.05));
+
+        REQUIRE(histogram.getPercentile(1.0, latency));
+        REQUIRE(latency == Approx(0.1));
+
+        REQUIRE(histogram.getPercentile(0.0, latency));
+        REQUIRE(latency == Approx(0.01));
+    }
+
+    SECTION("Out of range")
+    {
+        histogram.addSample(10.0);
+        REQUIRE(histogram.getPercentile(1.0, latency));
+        REQUIRE(latency == Approx(1.0));
+    }
+
+    SECTION("Reset")
+    {
+        histogram.reset();
+        REQUIRE(histogram.getNumberOfSamples() == 0);
+        REQUIRE_FALSE(histogram.getPercentile(0.5, latency));
+    }
+}
+
+TEST_CASE("Check LatencyHistogram window", "[LatencyHistogram]")
+{
+    WalkingControllers::LatencyHistogram histogram;
+    REQUIRE(histogram.initialize(0.01, 1.0, 5));
+
+    // the old samples are slow, the recent ones are fast
+    for(int i = 0; i < 20; i++)
+        histogram.addSample(0.505);
+    for(int i = 0; i < 5; i++)
+        histogram.addSample(0.015);
+
+    double latency;
+    REQUIRE(histogram.getNumberOfSamples() == 5);
+    REQUIRE(histogram.getPercentile(1.0, latency));
+    REQUIRE(latency == Approx(0.02));
+
+    // a new slow sample replaces the oldest fast one
+    histogram.addSample(0.505);
+    REQUIRE(histogram.getNumberOfSamples() == 5);
+    REQUIRE(histogram.getPercentile(0.8, latency));
+    REQUIRE(latency == Approx(0.02));
+    REQUIRE(histogram.getPercentile(1.0, latency));
+    REQUIRE(latency == Approx(0.51));
+}
+
+TEST_CASE("Check TimeProfiler counters", "[TimeProfiler]")
+{
+    WalkingControllers::TimeProfiler profiler;
+    profiler.setPeriod(2);
+
+    REQUIRE(profiler.addCounter("hits"));
+    REQUIRE_FALSE(profiler.addCounter("hits"));
+
+    REQUIRE(profiler.increaseCounter("hits", 3));
+    REQUIRE_FALSE(profiler.increaseCounter("misses", 1));
+}
@@ -0,0 +1,1019 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <yarp/os/Property.h>
+
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/Utils.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include <WalkingControllers/KinDynWrapper/Wrapper.h>
+#include <WalkingControllers/WholeBodyControllers/GoldfarbIdnaniSolver.h>
+#include <WalkingControllers/WholeBodyControllers/InverseKinematics.h>
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_activeSet.h>
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_osqp.h>
+#include <WalkingControllers/WholeBodyControllers/QPInverseKinematics_qpOASES.h>
+
+using namespace WalkingControllers;
+
+namespace
+{
+    std::atomic<bool> isCountingAllocations{false}; /**< True if the allocations are counted. */
+    std::atomic<std::size_t> numberOfAllocations{0}; /**< Number of allocations since the counter was reset. */
+}
+
+#if defined(__GLIBC__)
+// Eigen allocates with malloc instead of operator new, with glibc malloc is counted as well
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void* malloc(std::size_t size) noexcept
+{
+    if(isCountingAllocations)
+        numberOfAllocations++;
+    return __libc_malloc(size);
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+#if !defined(__GLIBC__)
+    if(isCountingAllocations)
+        numberOfAllocations++;
+#endif
+    void* pointer = std::malloc(size > 0 ? size : 1);
+    if(pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    const double samplingTime = 0.01;
+
+    std::string link(const std::string& name, double mass)
+    {
+        return "<link name='" + name + "'><inertial><origin xyz='0 0 0' rpy='0 0 0'/>"
+            + "<mass value='" + std::to_string(mass) + "'/>"
+            + "<inertia ixx='0.01' ixy='0' ixz='0' iyy='0.01' iyz='0' izz='0.01'/></inertial></link>";
+    }
+
+    std::string fixedJoint(const std::string& parent, const std::string& child, const std::string& xyz)
+    {
+        return "<joint name='" + child + "_fixed_joint' type='fixed'><origin xyz='" + xyz + "' rpy='0 0 0'/>"
+            + "<parent link='" + parent + "'/><child link='" + child + "'/></joint>";
+    }
+
+    std::string revoluteJoint(const std::string& name, const std::string& parent, const std::string& child,
+                              const std::string& xyz, const std::string& axis, double limit)
+    {
+        return "<joint name='" + name + "' type='revolute'><origin xyz='" + xyz + "' rpy='0 0 0'/>"
+            + "<axis xyz='" + axis + "'/><parent link='" + parent + "'/><child link='" + child + "'/>"
+            + "<limit lower='" + std::to_string(-limit) + "' upper='" + std::to_string(limit)
+            + "' effort='100' velocity='5'/></joint>";
+    }
+
+    /**
+     * Small humanoid: two legs with six joints and two arms with one joint. The frames have the
+     * names used in the configuration files of the robots.
+     */
+    std::string humanoidURDF()
+    {
+        std::string urdf = "<robot name='humanoid'>" + link("root_link", 5.0)
+            + link("neck", 0.0) + fixedJoint("root_link", "neck", "0 0 0.3")
+            + link("head", 0.0) + fixedJoint("root_link", "head", "0 0 0.4");
+
+        for(const std::string side : {"l", "r"})
+        {
+            const std::string y = side == "l" ? "0.07" : "-0.07";
+            const std::string armY = side == "l" ? "0.15" : "-0.15";
+            urdf += link(side + "_hip_1", 0.5) + link(side + "_hip_2", 0.5) + link(side + "_upper_leg", 1.0)
+                + link(side + "_lower_leg", 1.0) + link(side + "_ankle_1", 0.5) + link(side + "_foot", 0.5)
+                + link(side + "_sole", 0.0) + link(side + "_arm", 0.5) + link(side + "_hand", 0.0)
+                + revoluteJoint(side + "_hip_pitch", "root_link", side + "_hip_1", "0 " + y + " -0.1", "0 1 0", 1.5)
+                + revoluteJoint(side + "_hip_roll", side + "_hip_1", side + "_hip_2", "0 0 0", "1 0 0", 1.5)
+                + revoluteJoint(side + "_hip_yaw", side + "_hip_2", side + "_upper_leg", "0 0 0", "0 0 1", 1.5)
+                + revoluteJoint(side + "_knee", side + "_upper_leg", side + "_lower_leg", "0 0 -0.2", "0 1 0", 1.5)
+                + revoluteJoint(side + "_ankle_pitch", side + "_lower_leg", side + "_ankle_1", "0 0 -0.2", "0 1 0", 1.5)
+                + revoluteJoint(side + "_ankle_roll", side + "_ankle_1", side + "_foot", "0 0 0", "1 0 0", 1.5)
+                + fixedJoint(side + "_foot", side + "_sole", "0 0 -0.03")
+                + revoluteJoint(side + "_shoulder_pitch", "root_link", side + "_arm", "0 " + armY + " 0.2", "0 1 0", 0.5)
+                + fixedJoint(side + "_arm", side + "_hand", "0 0 -0.2");
+        }
+
+        return urdf + "</robot>";
+    }
+
+    std::vector<std::string> humanoidJoints()
+    {
+        std::vector<std::string> joints;
+        for(const std::string side : {"l", "r"})
+            for(const std::string joint : {"_hip_pitch", "_hip_roll", "_hip_yaw", "_knee",
+                        "_ankle_pitch", "_ankle_roll", "_shoulder_pitch"})
+                joints.push_back(side + joint);
+        return joints;
+    }
+
+    /**
+     * Initial posture with bent knees and flat feet.
+     */
+    iDynTree::VectorDynSize humanoidPosture()
+    {
+        iDynTree::VectorDynSize jointPositions(humanoidJoints().size());
+        jointPositions.zero();
+        for(int leg = 0; leg < 2; leg++)
+        {
+            jointPositions(7 * leg) = 0.3;
+            jointPositions(7 * leg + 3) = -0.6;
+            jointPositions(7 * leg + 4) = 0.3;
+        }
+        return jointPositions;
+    }
+
+    /**
+     * Evaluate the feet and CoM targets of the inverse kinematics with the forward kinematics
+     * (the root link is the world frame).
+     */
+    void evaluateTargets(iDynTree::KinDynComputations& kinDyn, const iDynTree::VectorDynSize& jointPositions,
+                         iDynTree::Transform& leftFoot, iDynTree::Transform& rightFoot, iDynTree::Position& comPosition)
+    {
+        iDynTree::VectorDynSize jointVelocities(jointPositions.size());
+        jointVelocities.zero();
+        iDynTree::Twist baseVelocity;
+        baseVelocity.zero();
+        iDynTree::Vector3 gravity;
+        gravity.zero();
+        REQUIRE(kinDyn.setRobotState(iDynTree::Transform::Identity(), jointPositions, baseVelocity,
+                                     jointVelocities, gravity));
+
+        leftFoot = kinDyn.getWorldTransform("l_sole");
+        rightFoot = kinDyn.getWorldTransform("r_sole");
+        comPosition = kinDyn.getCenterOfMassPosition();
+    }
+
+    std::string list(std::size_t size, double value)
+    {
+        std::string values = "(";
+        for(std::size_t i = 0; i < size; i++)
+            values += std::to_string(value) + " ";
+        return values + ")";
+    }
+
+    /**
+     * Initialize the forward kinematics with the frames of humanoidURDF(). The world frame is
+     * the left sole in the initial posture.
+     */
+    void initializeFK(WalkingFK& fk, const iDynTree::Model& model)
+    {
+        yarp::os::Property config;
+        config.fromConfig("left_foot_frame l_sole\n"
+                          "right_foot_frame r_sole\n"
+                          "left_hand_frame l_hand\n"
+                          "right_hand_frame r_hand\n"
+                          "head_frame head\n"
+                          "root_frame root_link\n"
+                          "torso_frame neck\n"
+                          "com_height 0.4\n"
+                          "sampling_time 0.01\n"
+                          "cut_frequency 10.0\n");
+        REQUIRE(fk.initialize(config, model));
+
+        iDynTree::VectorDynSize jointVelocities(model.getNrOfDOFs());
+        jointVelocities.zero();
+        REQUIRE(fk.evaluateWorldToBaseTransformation(iDynTree::Transform::Identity(),
+                                                     iDynTree::Transform::Identity(), true));
+        REQUIRE(fk.setInternalRobotState(humanoidPosture(), jointVelocities));
+    }
+
+    /**
+     * Configuration of the QP-IK. The CoM is a constraint as in the configuration files of the
+     * robots, the options are appended to the configuration. The joint regularization is set
+     * by setQPIKProblem().
+     */
+    std::string qpIKConfig(std::size_t numberOfDOFs, const std::string& options)
+    {
+        return "use_com_as_constraint 1\n"
+            "neck_weight 5.0\n"
+            "additional_rotation ((1.0 0.0 0.0) (0.0 1.0 0.0) (0.0 0.0 1.0))\n"
+            "joint_regularization " + list(numberOfDOFs, 0.0) + "\n"
+            + "joint_regularization_weights " + list(numberOfDOFs, 0.5) + "\n"
+            + "joint_regularization_gains " + list(numberOfDOFs, 0.5) + "\n"
+            + "k_posCom 1.5\n"
+            + "k_posFoot 2.5\n"
+            + "k_attFoot 5.0\n"
+            + "k_neck 0.5\n"
+            + "k_joint_limit_lower_bound 1.0\n"
+            + "k_joint_limit_upper_bound 1.0\n"
+            + "use_joint_limits_constraint 1\n"
+            + options;
+    }
+
+    /**
+     * Joint limits of humanoidURDF(). The velocity of the shoulders is limited to maxShoulderVelocity.
+     */
+    void humanoidLimits(double maxShoulderVelocity, iDynTree::VectorDynSize& velocityLimits,
+                        iDynTree::VectorDynSize& upperLimits, iDynTree::VectorDynSize& lowerLimits)
+    {
+        const std::size_t numberOfDOFs = humanoidJoints().size();
+        velocityLimits.resize(numberOfDOFs);
+        upperLimits.resize(numberOfDOFs);
+        lowerLimits.resize(numberOfDOFs);
+        for(std::size_t i = 0; i < numberOfDOFs; i++)
+        {
+            const bool isShoulder = i % 7 == 6;
+            velocityLimits(i) = isShoulder ? maxShoulderVelocity : 5.0;
+            upperLimits(i) = isShoulder ? 0.5 : 1.5;
+            lowerLimits(i) = -upperLimits(i);
+        }
+    }
+
+    /**
+     * Joint regularization of the QP-IK: the initial posture with the shoulders rotated by
+     * shoulderPosition. The regularization moves the shoulders towards it.
+     */
+    iDynTree::VectorDynSize humanoidRegularization(double shoulderPosition)
+    {
+        iDynTree::VectorDynSize regularization = humanoidPosture();
+        regularization(6) = shoulderPosition;
+        regularization(13) = -shoulderPosition;
+        return regularization;
+    }
+
+    /**
+     * Set the state and the references of the QP-IK. The feet do not move and the CoM
+     * moves towards desiredCoMPosition.
+     */
+    void setQPIKProblem(WalkingQPIK& solver, WalkingFK& fk, bool isLeftFootStance,
+                        const iDynTree::Transform& leftFoot, const iDynTree::Transform& rightFoot,
+                        const iDynTree::Position& desiredCoMPosition,
+                        const iDynTree::VectorDynSize& regularization)
+    {
+        iDynTree::Twist zeroTwist;
+        zeroTwist.zero();
+        iDynTree::Vector3 zeroVelocity;
+        zeroVelocity.zero();
+
+        solver.setPhase(true);
+        solver.setStanceFoot(isLeftFootStance);
+        REQUIRE(solver.setRobotState(fk));
+        REQUIRE(solver.setJacobians(fk));
+        REQUIRE(solver.setDesiredJointPosition(regularization));
+        solver.setDesiredNeckOrientation(iDynTree::Rotation::Identity());
+        solver.setDesiredFeetTransformation(leftFoot, rightFoot);
+        solver.setDesiredFeetTwist(zeroTwist, zeroTwist);
+        solver.setDesiredCoMVelocity(zeroVelocity);
+        solver.setDesiredCoMPosition(desiredCoMPosition);
+    }
+
+    /**
+     * qpOASES QP-IK that counts separately the allocations of qpOASES.
+     */
+    class AllocationCountingQPIK_qpOASES : public WalkingQPIK_qpOASES
+    {
+    public:
+        std::size_t numberOfQPs{0}; /**< Number of QP problems solved. */
+        std::size_t numberOfSolverAllocations{0}; /**< Number of allocations of qpOASES. */
+
+    protected:
+        virtual bool solveOptimizationProblem() override
+        {
+            const std::size_t allocations = numberOfAllocations;
+            const bool ok = WalkingQPIK_qpOASES::solveOptimizationProblem();
+            numberOfSolverAllocations += numberOfAllocations - allocations;
+            numberOfAllocations = allocations;
+            numberOfQPs++;
+            return ok;
+        }
+    };
+
+    /**
+     * QP-IK that exposes the status of the joint velocities bounds.
+     */
+    template <class Solver>
+    class BoundsStatusQPIK : public Solver
+    {
+    public:
+        bool isJointVelocitiesBoundActive() const
+        {
+            return this->m_isJointVelocitiesBoundActive;
+        }
+    };
+
+    /**
+     * Solve the same problems with Solver, using the least squares fast path, and with the active
+     * set solver without the fast path. The shoulders reach their velocity bound only when the
+     * regularization moves them (from the 20th step).
+     * @param model model of humanoidURDF();
+     * @param isFastPathSupported true if Solver uses the least squares fast path;
+     * @param tolerance accuracy of the QP solver.
+     */
+    template <class Solver>
+    void checkLeastSquaresFastPath(const iDynTree::Model& model, bool isFastPathSupported, double tolerance)
+    {
+        const int numberOfDOFs = model.getNrOfDOFs();
+
+        WalkingFK fk;
+        initializeFK(fk, model);
+        const iDynTree::Transform leftFoot = fk.getLeftFootToWorldTransform();
+        const iDynTree::Transform rightFoot = fk.getRightFootToWorldTransform();
+        iDynTree::Position desiredCoMPosition = fk.getCoMPosition();
+        desiredCoMPosition(1) += 0.005;
+
+        iDynTree::VectorDynSize velocityLimits, upperLimits, lowerLimits;
+        humanoidLimits(0.1, velocityLimits, upperLimits, lowerLimits);
+
+        yarp::os::Property config, referenceConfig;
+        config.fromConfig(qpIKConfig(numberOfDOFs, "use_least_squares_fast_path 1\n").c_str());
+        referenceConfig.fromConfig(qpIKConfig(numberOfDOFs, "use_least_squares_fast_path 0\n").c_str());
+        BoundsStatusQPIK<Solver> solver;
+        WalkingQPIK_activeSet reference;
+        REQUIRE(solver.initialize(config, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+        REQUIRE(reference.initialize(referenceConfig, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+
+        iDynTree::VectorDynSize jointPositions = humanoidPosture();
+        iDynTree::VectorDynSize jointVelocities(numberOfDOFs);
+        jointVelocities.zero();
+        for(int tick = 0; tick < 40; tick++)
+        {
+            const bool isBoundReached = tick >= 20;
+            const iDynTree::VectorDynSize regularization = isBoundReached ? humanoidRegularization(0.3)
+                : humanoidPosture();
+
+            REQUIRE(fk.setInternalRobotState(jointPositions, jointVelocities));
+            setQPIKProblem(solver, fk, true, leftFoot, rightFoot, desiredCoMPosition, regularization);
+            setQPIKProblem(reference, fk, true, leftFoot, rightFoot, desiredCoMPosition, regularization);
+            REQUIRE(solver.solve());
+            REQUIRE(reference.solve());
+
+            INFO("Tick " << tick);
+
+            // the velocity of the left shoulder is at its bound only in the second part
+            jointVelocities = reference.getDesiredJointVelocities();
+            const double shoulderBound = std::tanh(upperLimits(6) - jointPositions(6)) * velocityLimits(6);
+            REQUIRE((jointVelocities(6) > shoulderBound - 1e-6) == isBoundReached);
+
+            // without active bounds the closed form solution is the solution of the QP problem.
+            // When a bound becomes active the closed form solution does not satisfy it and the
+            // QP problem is solved
+            if(isFastPathSupported)
+                REQUIRE(solver.isJointVelocitiesBoundActive() == isBoundReached);
+
+            const double accuracy = isFastPathSupported && !isBoundReached ? 1e-8 : tolerance;
+            REQUIRE((iDynTree::toEigen(solver.getDesiredJointVelocities())
+                     - iDynTree::toEigen(jointVelocities)).cwiseAbs().maxCoeff() < accuracy);
+            REQUIRE(solver.getDesiredJointVelocities()(6) < shoulderBound + tolerance);
+
+            iDynTree::toEigen(jointPositions) += samplingTime * iDynTree::toEigen(jointVelocities);
+        }
+    }
+}
+
+TEST_CASE("Check GoldfarbIdnaniSolver", "[GoldfarbIdnaniSolver]")
+{
+    const int numberOfVariables = 5;
+    const int numberOfEqualityConstraints = 2;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    std::srand(0);
+    Eigen::MatrixXd weight = Eigen::MatrixXd::Random(numberOfVariables, numberOfVariables);
+    Eigen::MatrixXd hessian = weight.transpose() * weight
+        + 0.1 * Eigen::MatrixXd::Identity(numberOfVariables, numberOfVariables);
+    Eigen::VectorXd gradient = 10 * Eigen::VectorXd::Random(numberOfVariables);
+    Eigen::MatrixXd equalityMatrix = Eigen::MatrixXd::Random(numberOfEqualityConstraints, numberOfVariables);
+    Eigen::VectorXd equalityVector = Eigen::VectorXd::Random(numberOfEqualityConstraints);
+
+    // the first variable is not bounded
+    Eigen::VectorXd lowerBound = -0.5 * Eigen::VectorXd::Ones(numberOfVariables);
+    Eigen::VectorXd upperBound = 0.5 * Eigen::VectorXd::Ones(numberOfVariables);
+    lowerBound(0) = -infinity;
+    upperBound(0) = infinity;
+
+    GoldfarbIdnaniSolver solver(numberOfVariables, numberOfEqualityConstraints);
+
+    SECTION("Equality constrained")
+    {
+        REQUIRE(solver.solveEqualityConstrained(hessian, gradient, equalityMatrix, equalityVector));
+
+        // KKT conditions
+        Eigen::MatrixXd kkt = Eigen::MatrixXd::Zero(numberOfVariables + numberOfEqualityConstraints,
+                                                    numberOfVariables + numberOfEqualityConstraints);
+        kkt.topLeftCorner(numberOfVariables, numberOfVariables) = hessian;
+        kkt.topRightCorner(numberOfVariables, numberOfEqualityConstraints) = equalityMatrix.transpose();
+        kkt.bottomLeftCorner(numberOfEqualityConstraints, numberOfVariables) = equalityMatrix;
+        Eigen::VectorXd kktVector(numberOfVariables + numberOfEqualityConstraints);
+        kktVector << -gradient, equalityVector;
+        Eigen::VectorXd kktSolution = kkt.fullPivLu().solve(kktVector);
+
+        REQUIRE(solver.getSolution().isApprox(kktSolution.head(numberOfVariables), 1e-8));
+    }
+
+    SECTION("Bounds")
+    {
+        REQUIRE(solver.solve(hessian, gradient, equalityMatrix, equalityVector, lowerBound, upperBound));
+        Eigen::VectorXd solution = solver.getSolution();
+
+        REQUIRE((equalityMatrix * solution - equalityVector).norm() < 1e-8);
+        REQUIRE((solution - lowerBound).minCoeff() > -1e-8);
+        REQUIRE((upperBound - solution).minCoeff() > -1e-8);
+
+        // brute force: the bounds of each variable can be free, lower or upper active
+        double optimalCost = infinity;
+        int numberOfActiveSets = 1;
+        for(int i = 0; i < numberOfVariables; i++)
+            numberOfActiveSets *= 3;
+
+        for(int code = 0; code < numberOfActiveSets; code++)
+        {
+            std::vector<int> rows;
+            Eigen::VectorXd values(numberOfVariables);
+            int remainder = code;
+            bool isValid = true;
+            for(int i = 0; i < numberOfVariables; i++)
+            {
+                int type = remainder % 3;
+                remainder /= 3;
+                if(type == 0)
+                    continue;
+
+                double bound = type == 1 ? lowerBound(i) : upperBound(i);
+                if(!std::isfinite(bound))
+                {
+                    isValid = false;
+                    break;
+                }
+                values(rows.size()) = bound;
+                rows.push_back(i);
+            }
+
+            if(!isValid || numberOfEqualityConstraints + rows.size() > numberOfVariables)
+                continue;
+
+            const int numberOfConstraints = numberOfEqualityConstraints + rows.size();
+            Eigen::MatrixXd augmentedMatrix = Eigen::MatrixXd::Zero(numberOfConstraints, numberOfVariables);
+            Eigen::VectorXd augmentedVector(numberOfConstraints);
+            augmentedMatrix.topRows(numberOfEqualityConstraints) = equalityMatrix;
+            augmentedVector.head(numberOfEqualityConstraints) = equalityVector;
+            for(std::size_t j = 0; j < rows.size(); j++)
+            {
+                augmentedMatrix(numberOfEqualityConstraints + j, rows[j]) = 1;
+                augmentedVector(numberOfEqualityConstraints + j) = values(j);
+            }
+
+            GoldfarbIdnaniSolver equalitySolver(numberOfVariables, numberOfConstraints);
+            if(!equalitySolver.solveEqualityConstrained(hessian, gradient, augmentedMatrix, augmentedVector))
+                continue;
+
+            const Eigen::VectorXd& candidate = equalitySolver.getSolution();
+            if((candidate - lowerBound).minCoeff() < -1e-8 || (upperBound - candidate).minCoeff() < -1e-8)
+                continue;
+
+            optimalCost = std::min(optimalCost, 0.5 * candidate.dot(hessian * candidate) + gradient.dot(candidate));
+        }
+
+        double cost = 0.5 * solution.dot(hessian * solution) + gradient.dot(solution);
+        REQUIRE(cost == Approx(optimalCost).epsilon(1e-8));
+
+        // hot start: the same problem is solved starting from the previous active set
+        int activeSetSize = solver.getActiveSetSize();
+        REQUIRE(solver.solve(hessian, gradient, equalityMatrix, equalityVector, lowerBound, upperBound));
+        REQUIRE(solver.getSolution().isApprox(solution, 1e-8));
+        REQUIRE(solver.getActiveSetSize() == activeSetSize);
+        REQUIRE(solver.getNumberOfIterations() == 0);
+
+        // the hot started solver and a new one have the same solution if the problem changes
+        for(int i = 0; i < 20; i++)
+        {
+            gradient += Eigen::VectorXd::Random(numberOfVariables);
+            if(i % 2 == 0)
+                hessian += 0.01 * Eigen::MatrixXd::Identity(numberOfVariables, numberOfVariables);
+
+            GoldfarbIdnaniSolver coldSolver(numberOfVariables, numberOfEqualityConstraints);
+            REQUIRE(solver.solve(hessian, gradient, equalityMatrix, equalityVector, lowerBound, upperBound));
+            REQUIRE(coldSolver.solve(hessian, gradient, equalityMatrix, equalityVector, lowerBound, upperBound));
+            REQUIRE((solver.getSolution() - coldSolver.getSolution()).norm() < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("Check the task jacobians of the forward kinematics", "[WalkingFK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+    const int numberOfDOFs = loader.model().getNrOfDOFs();
+
+    WalkingFK fk;
+    initializeFK(fk, loader.model());
+    const iDynTree::Transform leftFoot = fk.getLeftFootToWorldTransform();
+    const iDynTree::Transform rightFoot = fk.getRightFootToWorldTransform();
+
+    iDynTree::KinDynComputations kinDyn;
+    REQUIRE(kinDyn.loadRobotModel(loader.model()));
+    REQUIRE(kinDyn.setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION));
+    const iDynTree::Model& model = kinDyn.model();
+
+    iDynTree::VectorDynSize jointVelocities(numberOfDOFs);
+    jointVelocities.zero();
+    iDynTree::Twist baseVelocity;
+    baseVelocity.zero();
+    iDynTree::Vector3 gravity;
+    gravity.zero();
+    gravity(2) = -9.81;
+
+    iDynTree::MatrixDynSize leftFootJacobian, rightFootJacobian, neckJacobian, comJacobian;
+    iDynTree::MatrixDynSize leftHandJacobian, rightHandJacobian, jacobian, expectedJacobian;
+
+    // the floating base changes from the left to the right foot and back
+    const bool stances[] = {true, false, true};
+    for(int step = 0; step < 3; step++)
+    {
+        const bool isLeftFootStance = stances[step];
+        INFO("Step " << step << ", left foot stance " << isLeftFootStance);
+
+        iDynTree::VectorDynSize jointPositions = humanoidPosture();
+        for(int i = 0; i < numberOfDOFs; i++)
+            jointPositions(i) += 0.05 * (step + 1) * std::sin(i + 1.0);
+
+        REQUIRE(fk.evaluateWorldToBaseTransformation(leftFoot, rightFoot, isLeftFootStance));
+        REQUIRE(fk.setInternalRobotState(jointPositions, jointVelocities));
+
+        // the base of KinDynComputations is the link of the stance sole
+        const iDynTree::FrameIndex soleIndex = model.getFrameIndex(isLeftFootStance ? "l_sole" : "r_sole");
+        const iDynTree::LinkIndex baseIndex = model.getFrameLink(soleIndex);
+        REQUIRE(kinDyn.setFloatingBase(model.getLinkName(baseIndex)));
+        const iDynTree::Transform worldToBase = (isLeftFootStance ? leftFoot : rightFoot)
+            * model.getFrameTransform(soleIndex).inverse();
+        REQUIRE(kinDyn.setRobotState(worldToBase, jointPositions, baseVelocity, jointVelocities, gravity));
+
+        // the jacobians are evaluated directly in the output matrices
+        fk.resetCacheCounters();
+        REQUIRE(fk.computeTaskJacobians(leftFootJacobian, rightFootJacobian, neckJacobian, comJacobian));
+        REQUIRE(fk.getCacheMisses() == 4);
+        REQUIRE(fk.getCacheHits() == 0);
+        REQUIRE(fk.getLeftHandJacobian(leftHandJacobian));
+        REQUIRE(fk.getRightHandJacobian(rightHandJacobian));
+
+        const std::pair<std::string, const iDynTree::MatrixDynSize*> frames[] =
+            {{"l_sole", &leftFootJacobian}, {"r_sole", &rightFootJacobian}, {"neck", &neckJacobian},
+             {"l_hand", &leftHandJacobian}, {"r_hand", &rightHandJacobian}};
+        for(const auto& frame : frames)
+        {
+            INFO("Frame " << frame.first);
+            expectedJacobian.resize(6, numberOfDOFs + 6);
+            REQUIRE(kinDyn.getFrameFreeFloatingJacobian(frame.first, expectedJacobian));
+            REQUIRE((iDynTree::toEigen(*frame.second) - iDynTree::toEigen(expectedJacobian)).cwiseAbs().maxCoeff() < 1e-10);
+        }
+
+        // getCoMJacobian() evaluates the same jacobian and stores it in the cache
+        expectedJacobian.resize(3, numberOfDOFs + 6);
+        REQUIRE(kinDyn.getCenterOfMassJacobian(expectedJacobian));
+        REQUIRE((iDynTree::toEigen(comJacobian) - iDynTree::toEigen(expectedJacobian)).cwiseAbs().maxCoeff() < 1e-10);
+        REQUIRE(fk.getCoMJacobian(jacobian));
+        REQUIRE((iDynTree::toEigen(jacobian) - iDynTree::toEigen(expectedJacobian)).cwiseAbs().maxCoeff() < 1e-10);
+
+        // the CoM position of the forward kinematics is consistent with the reference
+        REQUIRE((iDynTree::toEigen(fk.getCoMPosition())
+                 - iDynTree::toEigen(kinDyn.getCenterOfMassPosition())).cwiseAbs().maxCoeff() < 1e-10);
+    }
+}
+
+TEST_CASE("Check that the QP-IK does not allocate memory", "[WalkingQPIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+    const int numberOfDOFs = loader.model().getNrOfDOFs();
+
+    WalkingFK fk;
+    initializeFK(fk, loader.model());
+    const iDynTree::Transform leftFoot = fk.getLeftFootToWorldTransform();
+    const iDynTree::Transform rightFoot = fk.getRightFootToWorldTransform();
+    const iDynTree::Position initialCoMPosition = fk.getCoMPosition();
+
+    // the regularization moves the shoulders faster than their velocity limit, hence the
+    // velocity bounds are active and the least squares fast path is never used
+    iDynTree::VectorDynSize velocityLimits, upperLimits, lowerLimits;
+    humanoidLimits(0.1, velocityLimits, upperLimits, lowerLimits);
+    const iDynTree::VectorDynSize regularization = humanoidRegularization(0.3);
+
+    yarp::os::Property config;
+    config.fromConfig(qpIKConfig(numberOfDOFs, "use_least_squares_fast_path 1\n").c_str());
+
+    const std::string solvers[] = {"qpOASES", "active_set"};
+    for(const std::string& solverName : solvers)
+    {
+        // the allocations of SQProblem::hotstart() are counted separately
+        AllocationCountingQPIK_qpOASES* qpOASESSolver = nullptr;
+        std::unique_ptr<WalkingQPIK> solver;
+        if(solverName == "qpOASES")
+        {
+            qpOASESSolver = new AllocationCountingQPIK_qpOASES();
+            solver = std::unique_ptr<WalkingQPIK>(qpOASESSolver);
+        }
+        else
+            solver = std::unique_ptr<WalkingQPIK>(new WalkingQPIK_activeSet());
+        REQUIRE(solver->initialize(config, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+
+        iDynTree::VectorDynSize jointPositions = humanoidPosture();
+        iDynTree::VectorDynSize jointVelocities(numberOfDOFs);
+        jointVelocities.zero();
+        const int numberOfTicks = 50;
+        for(int tick = 0; tick < numberOfTicks; tick++)
+        {
+            // the CoM moves towards the left foot
+            iDynTree::Position desiredCoMPosition = initialCoMPosition;
+            desiredCoMPosition(1) += 0.02 * (1 - std::exp(-tick * samplingTime));
+
+            REQUIRE(fk.setInternalRobotState(jointPositions, jointVelocities));
+            setQPIKProblem(*solver, fk, true, leftFoot, rightFoot, desiredCoMPosition, regularization);
+
+            // the memory is allocated only by the first call
+            numberOfAllocations = 0;
+            isCountingAllocations = tick > 0;
+            bool ok = solver->solve();
+            isCountingAllocations = false;
+
+            INFO("Solver " << solverName << ", tick " << tick);
+            REQUIRE(ok);
+            REQUIRE(numberOfAllocations == 0);
+
+            jointVelocities = solver->getDesiredJointVelocities();
+            iDynTree::toEigen(jointPositions) += samplingTime * iDynTree::toEigen(jointVelocities);
+        }
+
+        if(qpOASESSolver != nullptr)
+        {
+            // the dense constraint matrix is evaluated and the QP is solved at each step
+            REQUIRE(qpOASESSolver->numberOfQPs == static_cast<std::size_t>(numberOfTicks));
+            WARN("SQProblem::hotstart() allocated memory " << qpOASESSolver->numberOfSolverAllocations
+                 << " times in " << numberOfTicks - 1 << " steps");
+        }
+    }
+}
+
+TEST_CASE("Check the sparse hessian of the osqp QP-IK when the stance foot changes", "[WalkingQPIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+    const int numberOfDOFs = loader.model().getNrOfDOFs();
+
+    WalkingFK fk;
+    initializeFK(fk, loader.model());
+    const iDynTree::Transform leftFoot = fk.getLeftFootToWorldTransform();
+    const iDynTree::Transform rightFoot = fk.getRightFootToWorldTransform();
+    const iDynTree::Position initialCoMPosition = fk.getCoMPosition();
+
+    // the regularization moves the shoulders faster than their velocity limit, so the QP is
+    // always solved. The active set solver uses the dense hessian matrix
+    iDynTree::VectorDynSize velocityLimits, upperLimits, lowerLimits;
+    humanoidLimits(0.1, velocityLimits, upperLimits, lowerLimits);
+    const iDynTree::VectorDynSize regularization = humanoidRegularization(0.3);
+
+    yarp::os::Property config;
+    config.fromConfig(qpIKConfig(numberOfDOFs, "use_least_squares_fast_path 0\n").c_str());
+    WalkingQPIK_osqp osqpSolver;
+    WalkingQPIK_activeSet activeSetSolver;
+    REQUIRE(osqpSolver.initialize(config, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+    REQUIRE(activeSetSolver.initialize(config, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+
+    iDynTree::VectorDynSize jointPositions = humanoidPosture();
+    iDynTree::VectorDynSize jointVelocities(numberOfDOFs);
+    jointVelocities.zero();
+    for(int tick = 0; tick < 40; tick++)
+    {
+        // the sparsity pattern is evaluated with the left foot as floating base, then the
+        // right foot becomes the stance foot
+        const bool isLeftFootStance = tick < 20;
+        REQUIRE(fk.evaluateWorldToBaseTransformation(leftFoot, rightFoot, isLeftFootStance));
+        REQUIRE(fk.setInternalRobotState(jointPositions, jointVelocities));
+
+        iDynTree::Position desiredCoMPosition = initialCoMPosition;
+        desiredCoMPosition(1) += isLeftFootStance ? 0.01 : -0.01;
+
+        for(WalkingQPIK* solver : {static_cast<WalkingQPIK*>(&osqpSolver), static_cast<WalkingQPIK*>(&activeSetSolver)})
+        {
+            setQPIKProblem(*solver, fk, isLeftFootStance, leftFoot, rightFoot, desiredCoMPosition, regularization);
+            REQUIRE(solver->solve());
+        }
+
+        INFO("Tick " << tick);
+
+        // all the entries of the dense hessian matrix belong to the sparsity pattern
+        Eigen::MatrixXd hessian = iDynTree::toEigen(activeSetSolver.getHessianMatrix()).triangularView<Eigen::Upper>();
+        Eigen::MatrixXd sparseHessian = osqpSolver.getHessianMatrixSparse();
+        REQUIRE((hessian - sparseHessian).cwiseAbs().maxCoeff() < 1e-10);
+
+        // the osqp solution has the accuracy of the solver
+        jointVelocities = activeSetSolver.getDesiredJointVelocities();
+        REQUIRE((iDynTree::toEigen(osqpSolver.getDesiredJointVelocities())
+                 - iDynTree::toEigen(jointVelocities)).cwiseAbs().maxCoeff() < 1e-2);
+        iDynTree::toEigen(jointPositions) += samplingTime * iDynTree::toEigen(jointVelocities);
+    }
+}
+
+TEST_CASE("Check the reduced formulation of the QP-IK", "[WalkingQPIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+    const int numberOfDOFs = loader.model().getNrOfDOFs();
+
+    WalkingFK fk;
+    initializeFK(fk, loader.model());
+    const iDynTree::Transform leftFoot = fk.getLeftFootToWorldTransform();
+    const iDynTree::Transform rightFoot = fk.getRightFootToWorldTransform();
+    const iDynTree::Position initialCoMPosition = fk.getCoMPosition();
+
+    // the shoulders reach their velocity bound, hence the bounds of the reduced problem are checked
+    iDynTree::VectorDynSize velocityLimits, upperLimits, lowerLimits;
+    humanoidLimits(0.1, velocityLimits, upperLimits, lowerLimits);
+    const iDynTree::VectorDynSize regularization = humanoidRegularization(0.3);
+
+    yarp::os::Property fullConfig, reducedConfig;
+    fullConfig.fromConfig(qpIKConfig(numberOfDOFs, "qp_ik_formulation full\n").c_str());
+    reducedConfig.fromConfig(qpIKConfig(numberOfDOFs, "qp_ik_formulation reduced\n").c_str());
+    WalkingQPIK_activeSet fullSolver;
+    WalkingQPIK_activeSet reducedSolver;
+    REQUIRE(fullSolver.initialize(fullConfig, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+    REQUIRE(reducedSolver.initialize(reducedConfig, numberOfDOFs, velocityLimits, upperLimits, lowerLimits));
+
+    iDynTree::VectorDynSize jointPositions = humanoidPosture();
+    iDynTree::VectorDynSize jointVelocities(numberOfDOFs);
+    jointVelocities.zero();
+    for(int tick = 0; tick < 40; tick++)
+    {
+        // the left foot is the stance foot, then the right one
+        const bool isLeftFootStance = tick < 20;
+        REQUIRE(fk.evaluateWorldToBaseTransformation(leftFoot, rightFoot, isLeftFootStance));
+        REQUIRE(fk.setInternalRobotState(jointPositions, jointVelocities));
+
+        iDynTree::Position desiredCoMPosition = initialCoMPosition;
+        desiredCoMPosition(1) += isLeftFootStance ? 0.01 : -0.01;
+
+        setQPIKProblem(fullSolver, fk, isLeftFootStance, leftFoot, rightFoot, desiredCoMPosition, regularization);
+        setQPIKProblem(reducedSolver, fk, isLeftFootStance, leftFoot, rightFoot, desiredCoMPosition, regularization);
+        REQUIRE(fullSolver.solve());
+        REQUIRE(reducedSolver.solve());
+
+        INFO("Tick " << tick);
+
+        // the two formulations solve the same problem
+        jointVelocities = fullSolver.getDesiredJointVelocities();
+        REQUIRE((iDynTree::toEigen(reducedSolver.getDesiredJointVelocities())
+                 - iDynTree::toEigen(jointVelocities)).cwiseAbs().maxCoeff() < 1e-8);
+
+        // the stance foot constraint is eliminated by the reduced formulation and it is satisfied
+        // by the base velocity. The constraint of the other foot is still part of the problem
+        const iDynTree::VectorDynSize stanceFootError = isLeftFootStance ? reducedSolver.getLeftFootError()
+            : reducedSolver.getRightFootError();
+        const iDynTree::VectorDynSize swingFootError = isLeftFootStance ? reducedSolver.getRightFootError()
+            : reducedSolver.getLeftFootError();
+        REQUIRE(iDynTree::toEigen(stanceFootError).cwiseAbs().maxCoeff() < 1e-8);
+        REQUIRE(iDynTree::toEigen(swingFootError).cwiseAbs().maxCoeff() < 1e-8);
+
+        iDynTree::toEigen(jointPositions) += samplingTime * iDynTree::toEigen(jointVelocities);
+    }
+}
+
+TEST_CASE("Check the least squares fast path of the QP-IK", "[WalkingQPIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+
+    SECTION("osqp")
+    {
+        checkLeastSquaresFastPath<WalkingQPIK_osqp>(loader.model(), true, 1e-2);
+    }
+
+    SECTION("qpOASES")
+    {
+        checkLeastSquaresFastPath<WalkingQPIK_qpOASES>(loader.model(), true, 1e-6);
+    }
+
+    // the active set solver does not use the fast path, its solution is the same as the reference
+    SECTION("active_set")
+    {
+        checkLeastSquaresFastPath<WalkingQPIK_activeSet>(loader.model(), false, 1e-10);
+    }
+}
+
+TEST_CASE("Check the damped least squares inverse kinematics", "[WalkingIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+    const int numberOfDOFs = loader.model().getNrOfDOFs();
+
+    iDynTree::KinDynComputations kinDyn;
+    REQUIRE(kinDyn.loadRobotModel(loader.model()));
+
+    // the joint regularization is the initial posture (degrees)
+    const iDynTree::VectorDynSize initialPosture = humanoidPosture();
+    std::string jointRegularization = "(";
+    for(int i = 0; i < numberOfDOFs; i++)
+        jointRegularization += std::to_string(iDynTree::rad2deg(initialPosture(i))) + " ";
+    jointRegularization += ")";
+
+    auto initializeIK = [&](WalkingIK& ik, int maxIterations)
+    {
+        yarp::os::Property config;
+        config.fromConfig(("online_solver damped_least_squares\n"
+                           "dls_max_iterations " + std::to_string(maxIterations) + "\n"
+                           + "dls_error_tolerance 0.001\n"
+                           + "jointRegularization " + jointRegularization + "\n").c_str());
+        REQUIRE(ik.initialize(config, loader.model(), humanoidJoints()));
+        REQUIRE(ik.setInitialGuess(initialPosture));
+    };
+
+    // the targets are evaluated from a posture with the knees bent more than the initial one
+    iDynTree::VectorDynSize targetPosture = initialPosture;
+    for(int leg = 0; leg < 2; leg++)
+    {
+        targetPosture(7 * leg) = 0.6;
+        targetPosture(7 * leg + 3) = -1.2;
+        targetPosture(7 * leg + 4) = 0.6;
+    }
+    targetPosture(1) = 0.05;
+
+    iDynTree::Transform leftFoot, rightFoot;
+    iDynTree::Position comPosition;
+    evaluateTargets(kinDyn, targetPosture, leftFoot, rightFoot, comPosition);
+
+    // the error of the targets is evaluated in the left foot frame
+    auto checkSolution = [&](const iDynTree::VectorDynSize& solution,
+                             const iDynTree::Transform& desiredLeftFoot,
+                             const iDynTree::Transform& desiredRightFoot,
+                             const iDynTree::Position& desiredCoMPosition)
+    {
+        iDynTree::Transform left, right;
+        iDynTree::Position com;
+        evaluateTargets(kinDyn, solution, left, right, com);
+
+        iDynTree::Transform desiredRelative = desiredLeftFoot.inverse() * desiredRightFoot;
+        iDynTree::Transform relative = left.inverse() * right;
+        REQUIRE((iDynTree::toEigen(desiredRelative.getPosition()) - iDynTree::toEigen(relative.getPosition())).norm() < 2e-3);
+        REQUIRE((iDynTree::toEigen(desiredRelative.getRotation()) - iDynTree::toEigen(relative.getRotation())).norm() < 2e-3);
+        REQUIRE((iDynTree::toEigen(desiredLeftFoot.inverse() * desiredCoMPosition)
+                 - iDynTree::toEigen(left.inverse() * com)).norm() < 2e-3);
+
+        for(int i = 0; i < numberOfDOFs; i++)
+        {
+            const double limit = i % 7 == 6 ? 0.5 : 1.5;
+            REQUIRE(std::abs(solution(i)) <= limit + 1e-12);
+        }
+    };
+
+    SECTION("Convergence and warm start")
+    {
+        WalkingIK ik;
+        initializeIK(ik, 10);
+
+        iDynTree::VectorDynSize solution;
+        REQUIRE(ik.computeIKDampedLeastSquares(leftFoot, rightFoot, comPosition, solution));
+        checkSolution(solution, leftFoot, rightFoot, comPosition);
+
+        // the second call starts from the previous solution, a single iteration is enough
+        WalkingIK warmStartedIK;
+        initializeIK(warmStartedIK, 1);
+        REQUIRE(warmStartedIK.setInitialGuess(solution));
+        iDynTree::VectorDynSize warmStartedSolution;
+        REQUIRE(warmStartedIK.computeIKDampedLeastSquares(leftFoot, rightFoot, comPosition, warmStartedSolution));
+        REQUIRE((iDynTree::toEigen(warmStartedSolution) - iDynTree::toEigen(solution)).norm() < 1e-3);
+
+        // the same iteration from the initial posture does not reach the targets
+        WalkingIK coldStartedIK;
+        initializeIK(coldStartedIK, 1);
+        REQUIRE_FALSE(coldStartedIK.computeIKDampedLeastSquares(leftFoot, rightFoot, comPosition,
+                                                                warmStartedSolution));
+
+        // the targets move along a trajectory, each solution is the guess of the next call. The
+        // memory is allocated only by the first call
+        for(int i = 1; i <= 20; i++)
+        {
+            iDynTree::Position desiredCoMPosition = comPosition;
+            desiredCoMPosition(1) += 0.002 * i;
+
+            numberOfAllocations = 0;
+            isCountingAllocations = true;
+            bool ok = ik.computeIKDampedLeastSquares(leftFoot, rightFoot, desiredCoMPosition, solution);
+            isCountingAllocations = false;
+
+            INFO("Step " << i);
+            REQUIRE(ok);
+            REQUIRE(numberOfAllocations == 0);
+            checkSolution(solution, leftFoot, rightFoot, desiredCoMPosition);
+        }
+    }
+
+    SECTION("Joint limits")
+    {
+        WalkingIK ik;
+        initializeIK(ik, 20);
+
+        // the CoM is lowered until the knees are close to their limit
+        iDynTree::VectorDynSize limitPosture = initialPosture;
+        for(int leg = 0; leg < 2; leg++)
+        {
+            limitPosture(7 * leg) = 0.74;
+            limitPosture(7 * leg + 3) = -1.48;
+            limitPosture(7 * leg + 4) = 0.74;
+        }
+        evaluateTargets(kinDyn, limitPosture, leftFoot, rightFoot, comPosition);
+
+        iDynTree::VectorDynSize solution;
+        REQUIRE(ik.computeIKDampedLeastSquares(leftFoot, rightFoot, comPosition, solution));
+        checkSolution(solution, leftFoot, rightFoot, comPosition);
+
+        // the CoM cannot be much lower than the one obtained with the knees close to the limit
+        iDynTree::Position unreachableCoMPosition = comPosition;
+        unreachableCoMPosition(2) -= 0.2;
+        REQUIRE_FALSE(ik.computeIKDampedLeastSquares(leftFoot, rightFoot, unreachableCoMPosition, solution));
+    }
+}
+
+TEST_CASE("Check the solution cache of the inverse kinematics", "[WalkingIK]")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadReducedModelFromString(humanoidURDF(), humanoidJoints()));
+
+    iDynTree::KinDynComputations kinDyn;
+    REQUIRE(kinDyn.loadRobotModel(loader.model()));
+
+    const std::string cacheFile = std::string(WALKING_CONTROLLERS_TEST_OUTPUT_DIR) + "/walking_ik_cache.txt";
+    std::remove(cacheFile.c_str());
+
+    // the cache can contain two solutions
+    yarp::os::Property config;
+    config.fromConfig(("solution_cache_file \"" + cacheFile + "\"\n"
+                       + "solution_cache_size 2\n"
+                       + "solution_cache_tolerance 0.1\n").c_str());
+
+    auto readCache = [&]()
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(cacheFile);
+        std::string line;
+        while(std::getline(file, line))
+            if(!line.empty() && line[0] != '#')
+                lines.push_back(line);
+        return lines;
+    };
+
+    // the targets are evaluated bending the knees
+    std::vector<iDynTree::Transform> leftFoot(3), rightFoot(3);
+    std::vector<iDynTree::Position> comPosition(3);
+    for(int i = 0; i < 3; i++)
+    {
+        iDynTree::VectorDynSize posture = humanoidPosture();
+        for(int leg = 0; leg < 2; leg++)
+        {
+            posture(7 * leg) = 0.3 + 0.05 * i;
+            posture(7 * leg + 3) = -0.6 - 0.1 * i;
+            posture(7 * leg + 4) = 0.3 + 0.05 * i;
+        }
+        evaluateTargets(kinDyn, posture, leftFoot[i], rightFoot[i], comPosition[i]);
+    }
+
+    std::vector<iDynTree::VectorDynSize> solutions(3);
+    {
+        WalkingIK ik;
+        REQUIRE(ik.initialize(config, loader.model(), humanoidJoints()));
+        for(int i = 0; i < 3; i++)
+            REQUIRE(ik.computeCachedIK(leftFoot[i], rightFoot[i], comPosition[i], solutions[i]));
+    }
+
+    // the first solution is removed
+    const std::vector<std::string> savedCache = readCache();
+    REQUIRE(savedCache.size() == 2);
+
+    WalkingIK ik;
+    REQUIRE(ik.initialize(config, loader.model(), humanoidJoints()));
+
+    // the loaded solution is the same computed before and the file does not change
+    iDynTree::VectorDynSize solution;
+    REQUIRE(ik.computeCachedIK(leftFoot[2], rightFoot[2], comPosition[2], solution));
+    REQUIRE(iDynTree::toEigen(solution) == iDynTree::toEigen(solutions[2]));
+    REQUIRE(readCache() == savedCache);
+
+    // the first solution is computed again and the oldest one (second target) is removed. The
+    // loaded solution is saved without changes
+    REQUIRE(ik.computeCachedIK(leftFoot[0], rightFoot[0], comPosition[0], solution));
+    const std::vector<std::string> updatedCache = readCache();
+    REQUIRE(updatedCache.size() == 2);
+    REQUIRE(updatedCache[0] == savedCache[1]);
+    REQUIRE(updatedCache[1] != savedCache[0]);
+
+    std::remove(cacheFile.c_str());
+}